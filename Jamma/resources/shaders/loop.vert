@@ -0,0 +1,27 @@
+#version 330 core
+
+// x is the grain edge, y the height and z is -1 on
+// the inside of the ring and 1 on the outside
+layout(location = 0) in vec3 PositionIN;
+layout(location = 1) in vec2 UvIN;
+
+out vec2 UV;
+out vec3 ModelPos;
+
+uniform mat4 MVP;
+uniform float NumGrains;
+uniform float Radius;
+
+const float TwoPi = 6.28318531;
+const float RadialThicknessFrac = 1.0 / 20.0;
+
+void main()
+{
+	float angle = TwoPi * PositionIN.x / NumGrains;
+	float radius = Radius * (1.0 + PositionIN.z * RadialThicknessFrac);
+	vec3 pos = vec3(sin(angle) * radius, PositionIN.y, cos(angle) * radius);
+
+	gl_Position = MVP * vec4(pos, 1);
+	UV = vec2(UvIN.x / NumGrains, UvIN.y);
+	ModelPos = pos;
+}
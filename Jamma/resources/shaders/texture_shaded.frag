@@ -1,7 +1,7 @@
 #version 330 core
 
 in vec2 UV;
-in float diff;
+in vec3 ModelPos;
 
 out vec4 ColorOUT;
 
@@ -9,6 +9,11 @@ uniform sampler2D TextureSampler;
 
 void main()
 {
+	// Flat face normal from screen-space derivatives
+	vec3 normal = normalize(cross(dFdx(ModelPos), dFdy(ModelPos)));
+	vec3 lightDir = normalize(vec3(1.0, -0.5, -0.3));
+	float diff = 0.1 + clamp(dot(normal, lightDir), 0, 0.9);
+
     ColorOUT = 0.05 + vec4((0.1 + diff) * texture(TextureSampler, UV).xyz, 1.0);
 	//ColorOUT = vec4(1.0, 0.3, 0.3, 1.0);
 }
\ No newline at end of file
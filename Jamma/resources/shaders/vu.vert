@@ -1,26 +1,41 @@
 #version 330 core
 
-layout(location = 0) in vec3 PositionIN;
-layout(location = 1) in vec2 UvIN;
+layout(location = 0) in vec4 Mvp0IN;
+layout(location = 1) in vec4 Mvp1IN;
+layout(location = 2) in vec4 Mvp2IN;
+layout(location = 3) in vec4 Mvp3IN;
+layout(location = 4) in vec4 LedIN;
+layout(location = 5) in vec4 ColourIN;
 
-out vec2 UV;
 out float LedAlpha;
 out vec3 Rgb;
 
-uniform mat4 MVP;
-uniform float Value;
+// Unit LED box: x is angular, y is height and z is radial
+const vec3 Box[36] = vec3[36](
+	vec3(-1, 0, 1), vec3(1, 1, 1), vec3(-1, 1, 1),
+	vec3(-1, 0, 1), vec3(1, 0, 1), vec3(1, 1, 1),
+	vec3(-1, 1, 1), vec3(1, 1, -1), vec3(-1, 1, -1),
+	vec3(-1, 1, 1), vec3(1, 1, 1), vec3(1, 1, -1),
+	vec3(-1, 0, -1), vec3(-1, 1, -1), vec3(1, 1, -1),
+	vec3(-1, 0, -1), vec3(1, 1, -1), vec3(1, 0, -1),
+	vec3(-1, 0, 1), vec3(-1, 0, -1), vec3(1, 0, -1),
+	vec3(-1, 0, 1), vec3(1, 0, -1), vec3(1, 0, 1),
+	vec3(-1, 0, -1), vec3(-1, 1, 1), vec3(-1, 1, -1),
+	vec3(-1, 0, -1), vec3(-1, 0, 1), vec3(-1, 1, 1),
+	vec3(1, 0, -1), vec3(1, 1, -1), vec3(1, 1, 1),
+	vec3(1, 0, -1), vec3(1, 1, 1), vec3(1, 0, 1));
 
-vec3 hsv2rgb(vec3 c)
-{
-    vec4 K = vec4(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
-    vec3 p = abs(fract(c.xxx + K.xyz) * 6.0 - K.www);
-    return c.z * mix(K.xxx, clamp(p - K.xxx, 0.0, 1.0), c.y);
-}
+const float HalfAngle = 0.01;
+const float RadialThicknessFrac = 1.0 / 15.0;
 
 void main()
 {
-    gl_Position =  MVP * vec4(PositionIN,1);
-    UV = UvIN;
-	LedAlpha = sign(Value - UvIN.y) * .5 + .5;
-	Rgb = hsv2rgb(vec3(1.4 - (UvIN.y * 0.4), 1., 1.));
-}
\ No newline at end of file
+	vec3 box = Box[gl_VertexID];
+	float radius = LedIN.x * (1.0 + box.z * RadialThicknessFrac);
+	float angle = LedIN.y + box.x * HalfAngle;
+	vec3 pos = vec3(sin(angle) * radius, mix(LedIN.z, LedIN.w, box.y), cos(angle) * radius);
+
+	gl_Position = mat4(Mvp0IN, Mvp1IN, Mvp2IN, Mvp3IN) * vec4(pos, 1);
+	LedAlpha = ColourIN.a;
+	Rgb = ColourIN.rgb;
+}
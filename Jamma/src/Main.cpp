@@ -10,7 +10,9 @@
 #include "PathUtils.h"
 #include "../io/TextReadWriter.h"
 #include "../io/InitFile.h"
+#include "../io/SessionFile.h"
 #include <vector>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 
@@ -105,30 +107,60 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmd
 {
 	SetupConsole();
 
+#if defined(JAMMA_REALTIME_CHECKS)
+	RealtimeCheck::Enable();
+#endif
+
 	auto defaults = LoadIni();
 
 	SceneParams sceneParams(DrawableParams{ "" }, SizeableParams{ 1400, 1000 });
 	JamFile jam;
 	RigFile rig;
+	std::optional<std::shared_ptr<SessionFile>> session;
 
 	if (defaults.has_value())
 	{
-		auto jamOpt = LoadJam(defaults.value());
-		if (jamOpt.has_value())
-			jam = jamOpt.value();
+		if (SessionFile::IsSessionFile(defaults.value().Jam))
+			session = SessionFile::Open(defaults.value().Jam);
+
+		if (!session.has_value())
+		{
+			auto jamOpt = LoadJam(defaults.value());
+			if (jamOpt.has_value())
+				jam = jamOpt.value();
+		}
 
 		auto rigOpt = LoadRig(defaults.value());
 		if (rigOpt.has_value())
 			rig = rigOpt.value();
 	}
 
-	auto scene = Scene::FromFile(sceneParams, jam, rig, utils::GetParentDirectory(defaults.value().Jam));
+	auto loaderParams = JamLoader::DefaultParams();
+	loaderParams.OnProgress = [](unsigned int numDone, unsigned int numLoops) {
+		std::cout << "\rLoading loops " << numDone << "/" << numLoops << std::flush;
+	};
+	JamLoader loader(loaderParams);
+
+	auto scene = session.has_value() ?
+		Scene::FromFile(sceneParams, session.value(), rig, loader) :
+		Scene::FromFile(sceneParams, jam, rig, utils::GetParentDirectory(defaults.value().Jam), loader);
 	if (!scene.has_value())
 	{
 		std::cout << "Failed to create Scene... quitting" << std::endl;
 		return -1;
 	}
 
+	auto loadStats = loader.Stats();
+	std::cout << std::endl << "Loaded " << loadStats.NumLoaded << " of " << loadStats.NumLoops << " loops in " << loadStats.Seconds << "s" << std::endl;
+
+	scene.value()->SetTelemetryFile(GetPath(PATH_ROAMING) + L"/Jamma/telemetry.json");
+	// Saving a session writes a jam and wavs alongside it
+	auto jamFile = std::filesystem::path(defaults.value().Jam);
+	if (session.has_value())
+		jamFile.replace_extension(L".jam");
+
+	scene.value()->SetJamFile(jamFile.wstring());
+
 	ResourceLib resourceLib;
 	Window window(*(scene.value()), resourceLib);
 
@@ -159,5 +191,10 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmd
 
 	window.Release();
 
+#if defined(JAMMA_REALTIME_CHECKS)
+	RealtimeCheck::Disable();
+	RealtimeCheck::WriteReport(std::cout);
+#endif
+
 	return (int)msg.wParam;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <string_view>
 #include "../base/ActionUndo.h"
 
 namespace base { class GuiElement; };
@@ -17,7 +18,7 @@ namespace actions
 	struct ActionResult
 	{
 		bool IsEaten;
-		std::string Id;
+		std::string_view Id; // Borrowed from the receiver, copy it to keep it
 		ActionResultType ResultType;
 		std::shared_ptr<base::ActionUndo> Undo;
 		std::weak_ptr<base::GuiElement> ActiveElement;
@@ -25,7 +25,9 @@ namespace actions
 		enum JobType
 		{
 			JOB_UPDATELOOPS,
-			JOB_ENDRECORDING
+			JOB_PACKLOOP,
+			JOB_COMPRESSLOOP,
+			JOB_RESTORELOOP
 		};
 
 		JobType JobActionType;
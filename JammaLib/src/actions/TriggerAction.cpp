@@ -7,7 +7,7 @@ TriggerAction::TriggerAction() :
 	TargetId(""),
 	OverbudTargetId(""),
 	SampleCount(0),
-	InputChannels({})
+	InputChannels(nullptr)
 {
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <string_view>
 #include "Action.h"
 #include "CommonTypes.h"
 
@@ -27,10 +28,12 @@ namespace actions
 		};
 
 	public:
+		// Ids and channels are borrowed from the sender for the length
+		// of the call, so nothing is copied on the audio thread
 		TriggerActionType ActionType;
-		std::string TargetId;
-		std::string OverbudTargetId;
+		std::string_view TargetId;
+		std::string_view OverbudTargetId;
 		unsigned long SampleCount;
-		std::vector<unsigned int> InputChannels;
+		const std::vector<unsigned int>* InputChannels; // Only set to start recording
 	};
 }
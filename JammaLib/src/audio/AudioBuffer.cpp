@@ -4,18 +4,28 @@ using namespace audio;
 
 AudioBuffer::AudioBuffer() :
 	AudioSource({}),
-	_playIndex(0),
+	_sizeMode(SIZE_EXACT),
+	_mask(0u),
 	_sampsRecorded(0),
+	_playIndex(0),
 	_buffer(std::vector<float>(constants::MaxBlockSize, 0.0f))
 {
 }
 
 AudioBuffer::AudioBuffer(unsigned int size) :
+	AudioBuffer(size, SIZE_EXACT)
+{
+}
+
+AudioBuffer::AudioBuffer(unsigned int size, SizeMode sizeMode) :
 	AudioSource({}),
-	_playIndex(0),
+	_sizeMode(sizeMode),
+	_mask(0u),
 	_sampsRecorded(0),
-	_buffer(std::vector<float>(size < constants::MaxBlockSize ? constants::MaxBlockSize : size, 0.0f))
+	_playIndex(0),
+	_buffer()
 {
+	SetSize(size);
 }
 
 AudioBuffer::~AudioBuffer()
@@ -28,27 +38,26 @@ void AudioBuffer::OnPlay(const std::shared_ptr<base::AudioSink> dest,
 	if (0 == _sampsRecorded)
 		return;
 
-	auto bufSize = (unsigned int)_buffer.size();
-
-	auto index = _playIndex;
-	while (index >= bufSize)
-		index -= bufSize;
-
+	auto index = _Wrap((unsigned int)_playIndex);
 	auto destIndex = 0;
+	auto samp = 0u;
 
-	for (auto i = 0u; i < numSamps; i++)
+	while (samp < numSamps)
 	{
-		destIndex = dest->OnWrite(_buffer[index], destIndex);
+		auto spans = _Spans(index, numSamps - samp);
+		destIndex = dest->OnWriteBlock(spans.First, spans.NumFirst, destIndex);
+
+		if (spans.NumSecond > 0)
+			destIndex = dest->OnWriteBlock(spans.Second, spans.NumSecond, destIndex);
 
-		index++;
-		if (index >= bufSize)
-			index -= bufSize;
+		auto spanSamps = spans.NumFirst + spans.NumSecond;
+		samp += spanSamps;
+		index = _Wrap(index + spanSamps);
 	}
 }
 
 void AudioBuffer::EndPlay(unsigned int numSamps)
 {
-	auto bufSize = (unsigned int)_buffer.size();
 	_playIndex += numSamps;
 
 	if (0 == _sampsRecorded)
@@ -65,8 +74,7 @@ void AudioBuffer::EndPlay(unsigned int numSamps)
 		return;
 	}*/
 
-	while (bufSize <= _playIndex)
-		_playIndex -= bufSize;
+	_playIndex = _Wrap((unsigned int)_playIndex);
 }
 
 inline int AudioBuffer::OnWrite(float samp, int indexOffset)
@@ -79,12 +87,10 @@ inline int AudioBuffer::OnWrite(float samp, int indexOffset)
 		return 0;
 	}
 
-	while (bufSize <= _writeIndex + indexOffset)
-		indexOffset -= (int)_buffer.size();
-
-	_buffer[_writeIndex + indexOffset]+= samp;
+	auto index = _Wrap((unsigned int)(_writeIndex + indexOffset));
+	_buffer[index] += samp;
 
-	return indexOffset + 1;
+	return (int)index - (int)_writeIndex + 1;
 }
 
 inline int AudioBuffer::OnOverwrite(float samp, int indexOffset)
@@ -97,12 +103,25 @@ inline int AudioBuffer::OnOverwrite(float samp, int indexOffset)
 		return 0;
 	}
 
-	while (bufSize <= _writeIndex + indexOffset)
-		indexOffset -= (int)_buffer.size();
+	auto index = _Wrap((unsigned int)(_writeIndex + indexOffset));
+	_buffer[index] = samp;
+
+	return (int)index - (int)_writeIndex + 1;
+}
+
+int AudioBuffer::OnWriteBlock(const float* samps, unsigned int numSamps, int indexOffset)
+{
+	return _WriteBlock(samps, numSamps, indexOffset, WRITE_MIX);
+}
 
-	_buffer[_writeIndex + indexOffset] = samp;
+int AudioBuffer::OnOverwriteBlock(const float* samps, unsigned int numSamps, int indexOffset)
+{
+	return _WriteBlock(samps, numSamps, indexOffset, WRITE_OVERWRITE);
+}
 
-	return indexOffset + 1;
+void AudioBuffer::Zero(unsigned int numSamps)
+{
+	_WriteBlock(nullptr, numSamps, 0, WRITE_ZERO);
 }
 
 void AudioBuffer::EndWrite(unsigned int numSamps, bool updateIndex)
@@ -115,9 +134,71 @@ void AudioBuffer::EndWrite(unsigned int numSamps, bool updateIndex)
 		_SetWriteIndex(_writeIndex + numSamps);
 }
 
+std::tuple<float*, unsigned int> AudioBuffer::WriteSpan(int indexOffset, unsigned int numSamps)
+{
+	auto bufSize = (unsigned int)_buffer.size();
+
+	if (0 == bufSize)
+		return { nullptr, 0u };
+
+	auto index = _Wrap((unsigned int)(_writeIndex + indexOffset));
+	return { _buffer.data() + index, std::min(numSamps, bufSize - index) };
+}
+
+BufferSpans AudioBuffer::WriteSpans(int indexOffset, unsigned int numSamps)
+{
+	if (_buffer.empty())
+		return { nullptr, 0u, nullptr, 0u };
+
+	return _Spans(_Wrap((unsigned int)(_writeIndex + indexOffset)), numSamps);
+}
+
+BufferSpans AudioBuffer::ReadSpans(unsigned int numSamps)
+{
+	if (_buffer.empty())
+		return { nullptr, 0u, nullptr, 0u };
+
+	return _Spans(_Wrap((unsigned int)_playIndex), numSamps);
+}
+
 void AudioBuffer::SetSize(unsigned int size)
 {
-	_buffer.resize(size < constants::MaxBlockSize ? constants::MaxBlockSize : size);
+	if (size < constants::MaxBlockSize)
+		size = constants::MaxBlockSize;
+
+	if (SIZE_POWEROFTWO == _sizeMode)
+	{
+		auto pow2Size = 1u;
+		while (pow2Size < size)
+			pow2Size <<= 1;
+
+		size = pow2Size;
+		_mask = size - 1;
+	}
+
+	_buffer.resize(size);
+}
+
+inline unsigned int AudioBuffer::_Wrap(unsigned int index) const
+{
+	if (SIZE_POWEROFTWO == _sizeMode)
+		return index & _mask;
+
+	auto bufSize = (unsigned int)_buffer.size();
+	while (index >= bufSize)
+		index -= bufSize;
+
+	return index;
+}
+
+BufferSpans AudioBuffer::_Spans(unsigned int index, unsigned int numSamps)
+{
+	auto bufSize = (unsigned int)_buffer.size();
+	if (numSamps > bufSize)
+		numSamps = bufSize;
+
+	auto numFirst = std::min(numSamps, bufSize - index);
+	return { _buffer.data() + index, numFirst, _buffer.data(), numSamps - numFirst };
 }
 
 void AudioBuffer::_SetWriteIndex(unsigned int index)
@@ -130,10 +211,51 @@ void AudioBuffer::_SetWriteIndex(unsigned int index)
 		return;
 	}
 
-	while (index >= bufSize)
-		index-= bufSize;
+	_writeIndex = _Wrap(index);
+}
+
+int AudioBuffer::_WriteBlock(const float* samps, unsigned int numSamps, int indexOffset, BlockWriteMode mode)
+{
+	auto bufSize = (unsigned int)_buffer.size();
+
+	if (0 == bufSize)
+	{
+		_writeIndex = 0;
+		return 0;
+	}
+
+	indexOffset = (int)_Wrap((unsigned int)(_writeIndex + indexOffset)) - (int)_writeIndex;
+
+	auto samp = 0u;
 
-	_writeIndex = index;
+	while (samp < numSamps)
+	{
+		auto index = (unsigned int)(_writeIndex + indexOffset);
+		auto blockSamps = std::min(numSamps - samp, bufSize - index);
+		auto dest = _buffer.data() + index;
+
+		switch (mode)
+		{
+		case WRITE_MIX:
+			for (auto i = 0u; i < blockSamps; i++)
+				dest[i] += samps[samp + i];
+			break;
+		case WRITE_OVERWRITE:
+			std::copy(samps + samp, samps + samp + blockSamps, dest);
+			break;
+		case WRITE_ZERO:
+			std::fill(dest, dest + blockSamps, 0.0f);
+			break;
+		}
+
+		samp += blockSamps;
+		indexOffset += (int)blockSamps;
+
+		if (bufSize <= _writeIndex + indexOffset)
+			indexOffset -= (int)bufSize;
+	}
+
+	return indexOffset;
 }
 
 unsigned int AudioBuffer::SampsRecorded() const
@@ -146,6 +268,11 @@ unsigned int AudioBuffer::BufSize() const
 	return (unsigned int)_buffer.size();
 }
 
+AudioBuffer::SizeMode AudioBuffer::BufSizeMode() const
+{
+	return _sizeMode;
+}
+
 std::vector<float>::iterator AudioBuffer::Start()
 {
 	return _buffer.begin();
@@ -3,18 +3,47 @@
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <algorithm>
+#include <tuple>
 #include "../include/Constants.h"
 #include "AudioSource.h"
 
 namespace audio
 {
+	// A region of the ring as at most two contiguous runs,
+	// the second starting at the beginning of the buffer
+	struct BufferSpans
+	{
+		float* First;
+		unsigned int NumFirst;
+		float* Second;
+		unsigned int NumSecond;
+	};
+
 	class AudioBuffer :
 		public virtual base::AudioSink,
 		public virtual base::AudioSource
 	{
+	public:
+		enum BlockWriteMode
+		{
+			WRITE_MIX,
+			WRITE_OVERWRITE,
+			WRITE_ZERO
+		};
+
+		// Power-of-two buffers round their size up
+		// and wrap indices with a mask
+		enum SizeMode
+		{
+			SIZE_EXACT,
+			SIZE_POWEROFTWO
+		};
+
 	public:
 		AudioBuffer();
 		AudioBuffer(unsigned int size);
+		AudioBuffer(unsigned int size, SizeMode sizeMode);
 		~AudioBuffer();
 
 	public:
@@ -27,20 +56,32 @@ namespace audio
 		virtual void EndPlay(unsigned int numSamps) override;
 		inline virtual int OnWrite(float samp, int indexOffset) override;
 		inline virtual int OnOverwrite(float samp, int indexOffset) override;
+		virtual int OnWriteBlock(const float* samps, unsigned int numSamps, int indexOffset) override;
+		virtual int OnOverwriteBlock(const float* samps, unsigned int numSamps, int indexOffset) override;
+		virtual void Zero(unsigned int numSamps) override;
 		virtual void EndWrite(unsigned int numSamps, bool updateIndex) override;
 
+		std::tuple<float*, unsigned int> WriteSpan(int indexOffset, unsigned int numSamps);
+		BufferSpans WriteSpans(int indexOffset, unsigned int numSamps);
+		BufferSpans ReadSpans(unsigned int numSamps);
 		void SetSize(unsigned int size);
 		unsigned int SampsRecorded() const;
 		unsigned int BufSize() const;
+		SizeMode BufSizeMode() const;
 
 		std::vector<float>::iterator Start();
 		std::vector<float>::iterator End();
 		std::vector<float>::iterator Delay(unsigned int sampsDelay);
 
 	protected:
+		inline unsigned int _Wrap(unsigned int index) const;
+		BufferSpans _Spans(unsigned int index, unsigned int numSamps);
 		void _SetWriteIndex(unsigned int index);
+		int _WriteBlock(const float* samps, unsigned int numSamps, int indexOffset, BlockWriteMode mode);
 
 	protected:
+		SizeMode _sizeMode;
+		unsigned int _mask;
 		unsigned int _sampsRecorded;
 		unsigned long _playIndex;
 		std::vector<float> _buffer;
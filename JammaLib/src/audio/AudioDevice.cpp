@@ -56,6 +56,14 @@ RtAudio::DeviceInfo AudioDevice::GetOutputStreamInfo()
 	return _outDeviceInfo;
 }
 
+unsigned int AudioDevice::SampleRate()
+{
+	if (!_stream || !_stream->isStreamOpen())
+		return constants::DefaultSampleRate;
+
+	return _stream->getStreamSampleRate();
+}
+
 std::optional<std::unique_ptr<AudioDevice>> AudioDevice::Open(
 	std::function<int(void*,void*,unsigned int,double,RtAudioStreamStatus,void*)> onAudio,
 	std::function<void(RtAudioError::Type,const std::string&)> onError,
@@ -106,7 +114,7 @@ std::optional<std::unique_ptr<AudioDevice>> AudioDevice::Open(
 		rtAudio->openStream(outParams.nChannels > 0 ? &outParams : nullptr,
 			inParams.nChannels > 0 ? &inParams : nullptr,
 			RTAUDIO_FLOAT32,
-			44100,
+			constants::DefaultSampleRate,
 			&bufFrames,
 			*onAudio.target<RtAudioCallback>(),
 			(void*)AudioSink,
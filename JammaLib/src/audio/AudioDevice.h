@@ -9,6 +9,7 @@
 #include <functional>
 #include "../base/AudioSource.h"
 #include "rtaudio/RtAudio.h"
+#include "../include/Constants.h"
 
 namespace audio
 {
@@ -27,6 +28,7 @@ namespace audio
 		void Stop();
 		RtAudio::DeviceInfo GetInputStreamInfo();
 		RtAudio::DeviceInfo GetOutputStreamInfo();
+		unsigned int SampleRate();
 
 	private:
 		RtAudio::DeviceInfo _inDeviceInfo;
@@ -11,13 +11,18 @@ using gui::GuiSliderParams;
 const utils::Size2d AudioMixer::_Gap = { 2, 4 };
 const utils::Size2d AudioMixer::_DragGap = { 4, 4 };
 const utils::Size2d AudioMixer::_DragSize = { 32, 32 };
+const double AudioMixer::_MutedLevel = 0.001;
 
 AudioMixer::AudioMixer(AudioMixerParams params) :
 	GuiElement(params),
 	_inputChannel(params.InputChannel),
+	_behaviourParams(params.Behaviour),
 	_behaviour(std::unique_ptr<MixBehaviour>()),
 	_slider(std::make_shared<GuiSlider>(GetSliderParams(params.Size))),
-	_fade(std::make_unique<InterpolatedValueExp>())
+	_fade(std::make_unique<InterpolatedValueExp>()),
+	_level(1.0),
+	_isHeldMuted(false),
+	_gains(std::vector<float>(constants::MaxBlockSize, 0.0f))
 {
 	_behaviour = std::visit(MixerBehaviourFactory{}, params.Behaviour);
 
@@ -46,7 +51,12 @@ void AudioMixer::SetSize(utils::Size2d size)
 
 ActionResult AudioMixer::OnAction(DoubleAction val)
 {
-	_fade->SetTarget(val.Value());
+	_level = val.Value();
+
+	// Passed on so the owner can react to the new level
+	if (_receiver)
+		_receiver->OnAction(val);
+
 	return { true, "", ACTIONRESULT_DEFAULT, nullptr };
 }
 
@@ -55,13 +65,58 @@ double AudioMixer::Level() const
 	return _fade->Current();
 }
 
+bool AudioMixer::IsMuted() const
+{
+	// Not while held, if a level has been asked for
+	return (_level <= _MutedLevel) && (_fade->Current() <= _MutedLevel);
+}
+
+void AudioMixer::HoldMuted(bool isHeld)
+{
+	_isHeldMuted = isHeld;
+}
+
+BehaviourParams AudioMixer::Behaviour() const
+{
+	return _behaviourParams;
+}
+
 void AudioMixer::OnPlay(const std::shared_ptr<MultiAudioSink> dest,
 	float samp,
 	unsigned int index)
 {
+	UpdateTarget();
 	_behaviour->Apply(dest, samp * (float)_fade->Next(), index);
 }
 
+void AudioMixer::OnPlay(const std::shared_ptr<MultiAudioSink> dest,
+	const float* samps,
+	unsigned int numSamps,
+	unsigned int index)
+{
+	if (!_behaviour)
+		return;
+
+	UpdateTarget();
+	auto samp = 0u;
+
+	while (samp < numSamps)
+	{
+		auto blockSamps = std::min(numSamps - samp, (unsigned int)_gains.size());
+
+		for (auto i = 0u; i < blockSamps; i++)
+			_gains[i] = (float)_fade->Next();
+
+		_behaviour->ApplyBlock(dest, samps + samp, _gains.data(), blockSamps, index + samp);
+		samp += blockSamps;
+	}
+}
+
+void AudioMixer::UpdateTarget()
+{
+	_fade->SetTarget(_isHeldMuted ? 0.0 : _level.load());
+}
+
 void AudioMixer::Offset(unsigned int numSamps)
 {
 	// TODO: Update fader state
@@ -77,6 +132,30 @@ void AudioMixer::SetInputChannel(unsigned int channel)
 	_inputChannel = channel;
 }
 
+void MixBehaviour::ApplyBlock(const std::shared_ptr<MultiAudioSink> dest,
+	const float* samps,
+	const float* gains,
+	unsigned int numSamps,
+	unsigned int index) const
+{
+	auto numChans = dest->NumInputChannels();
+	auto numRoutes = (unsigned int)(std::lower_bound(_routeChannels.begin(), _routeChannels.end(), numChans) - _routeChannels.begin());
+
+	if (numRoutes > 0)
+		dest->OnMixChannels(samps, gains, _routeChannels.data(), _routeLevels.data(), numRoutes, numSamps, index);
+}
+
+void MixBehaviour::AddRoute(unsigned int channel, float level)
+{
+	auto pos = std::lower_bound(_routeChannels.begin(), _routeChannels.end(), channel);
+
+	if ((pos != _routeChannels.end()) && (*pos == channel))
+		return;
+
+	_routeLevels.insert(_routeLevels.begin() + (pos - _routeChannels.begin()), level);
+	_routeChannels.insert(pos, channel);
+}
+
 void WireMixBehaviour::Apply(const std::shared_ptr<MultiAudioSink> dest,
 	float samp,
 	unsigned int index) const
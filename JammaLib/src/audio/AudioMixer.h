@@ -3,6 +3,8 @@
 #include <vector>
 #include <memory>
 #include <variant>
+#include <algorithm>
+#include <atomic>
 #include "AudioSource.h"
 #include "MultiAudioSink.h"
 #include "InterpolatedValue.h"
@@ -18,6 +20,20 @@ namespace audio
 		virtual void Apply(const std::shared_ptr<base::MultiAudioSink> dest,
 			float samp,
 			unsigned int index) const {};
+		virtual void ApplyBlock(const std::shared_ptr<base::MultiAudioSink> dest,
+			const float* samps,
+			const float* gains,
+			unsigned int numSamps,
+			unsigned int index) const;
+
+	protected:
+		void AddRoute(unsigned int channel, float level);
+
+	protected:
+		// Sorted by channel, so the routes a sink can
+		// accept are always a prefix of the list
+		std::vector<unsigned int> _routeChannels;
+		std::vector<float> _routeLevels;
 	};
 
 	class MixBehaviourParams {};
@@ -35,6 +51,9 @@ namespace audio
 			MixBehaviour()
 		{
 			_mixParams = mixParams;
+
+			for (auto chan : _mixParams.Channels)
+				AddRoute(chan, 1.0f);
 		}
 
 	public:
@@ -59,6 +78,9 @@ namespace audio
 			MixBehaviour()
 		{
 			_mixParams = mixParams;
+
+			for (auto chan = 0u; chan < _mixParams.ChannelLevels.size(); chan++)
+				AddRoute(chan, _mixParams.ChannelLevels[chan]);
 		}
 
 	public:
@@ -126,9 +148,19 @@ namespace audio
 		virtual void SetSize(utils::Size2d size) override;
 
 		double Level() const;
+		// Faded all the way out, and staying there
+		bool IsMuted() const;
+		// Keeps the fade at silence without losing the level asked
+		// for, which it fades up to once released (audio thread)
+		void HoldMuted(bool isHeld);
+		BehaviourParams Behaviour() const;
 		void OnPlay(const std::shared_ptr<base::MultiAudioSink> dest,
 			float samp,
 			unsigned int index);
+		void OnPlay(const std::shared_ptr<base::MultiAudioSink> dest,
+			const float* samps,
+			unsigned int numSamps,
+			unsigned int index);
 		void Offset(unsigned int numSamps);
 		
 		unsigned int InputChannel() const;
@@ -136,15 +168,22 @@ namespace audio
 
 	protected:
 		gui::GuiSliderParams GetSliderParams(utils::Size2d size);
+		// Only the audio thread moves the fade
+		void UpdateTarget();
 
 	protected:
 		static const utils::Size2d _Gap;
 		static const utils::Size2d _DragGap;
 		static const utils::Size2d _DragSize;
+		static const double _MutedLevel;
 
 		unsigned int _inputChannel;
+		BehaviourParams _behaviourParams;
 		std::unique_ptr<MixBehaviour> _behaviour;
 		std::shared_ptr<gui::GuiSlider> _slider;
 		std::unique_ptr<InterpolatedValue> _fade;
+		std::atomic<double> _level; // Set by the gui thread
+		std::atomic<bool> _isHeldMuted;
+		std::vector<float> _gains;
 	};
 }
@@ -1,33 +1,579 @@
 #include "BufferBank.h"
+#include "LosslessCodec.h"
+#include "MixKernels.h"
+#include <cfloat>
+#include <cmath>
 
 using namespace audio;
 
+namespace
+{
+	struct SummaryNode
+	{
+		float Min;
+		float Max;
+		float SumSquares;
+	};
+
+	const unsigned int NumSummaryLeaves = BufferBank::_BufferBankSize / BufferBank::_SummaryLeafSamps;
+	const unsigned int SummaryNodeFloats = 3u;
+
+	constexpr unsigned int NumSummaryLevels(unsigned int numNodes)
+	{
+		return numNodes <= 1u ? 1u : 1u + NumSummaryLevels((numNodes + 1u) / 2u);
+	}
+
+	const unsigned int NumLevels = NumSummaryLevels(NumSummaryLeaves);
+
+	// Level 0 holds the leaves, and node n of each level
+	// above covers nodes 2n and 2n+1 of the level below
+	struct SummaryLevels
+	{
+		unsigned int Offsets[NumLevels];
+		unsigned int Sizes[NumLevels];
+		unsigned int NumNodes;
+	};
+
+	constexpr SummaryLevels MakeSummaryLevels()
+	{
+		SummaryLevels levels = {};
+		auto size = NumSummaryLeaves;
+
+		for (auto level = 0u; level < NumLevels; level++)
+		{
+			levels.Offsets[level] = levels.NumNodes;
+			levels.Sizes[level] = size;
+			levels.NumNodes += size;
+			size = (size + 1u) / 2u;
+		}
+
+		return levels;
+	}
+
+	constexpr SummaryLevels Levels = MakeSummaryLevels();
+
+	const long long PageBytes = (long long)BufferBank::_BufferBankSize * (long long)sizeof(float);
+	std::atomic<long long> StorageBytesCount[BufferBank::NUM_STORAGEMODES] = {};
+
+	void CountBytes(BufferBank::StorageMode mode, long long numBytes)
+	{
+		StorageBytesCount[mode] += numBytes;
+	}
+
+	void CountPages(BufferBank::StorageMode mode, int numPages)
+	{
+		CountBytes(mode, numPages * PageBytes);
+	}
+
+	SummaryNode EmptyNode()
+	{
+		return { FLT_MAX, -FLT_MAX, 0.0f };
+	}
+
+	float* Node(float* summary, unsigned int level, unsigned int index)
+	{
+		return summary + (Levels.Offsets[level] + index) * SummaryNodeFloats;
+	}
+
+	const float* Node(const float* summary, unsigned int level, unsigned int index)
+	{
+		return summary + (Levels.Offsets[level] + index) * SummaryNodeFloats;
+	}
+
+	void MergeNode(const float* node, SummaryNode& acc)
+	{
+		acc.Min = node[0] < acc.Min ? node[0] : acc.Min;
+		acc.Max = node[1] > acc.Max ? node[1] : acc.Max;
+		acc.SumSquares += node[2];
+	}
+
+	void WriteNode(float* node, const SummaryNode& summary)
+	{
+		node[0] = summary.Min;
+		node[1] = summary.Max;
+		node[2] = summary.SumSquares;
+	}
+
+	void ScanSamps(const float* samps, unsigned long numSamps, SummaryNode& acc)
+	{
+		for (auto i = 0ul; i < numSamps; i++)
+		{
+			auto samp = samps[i];
+			acc.Min = samp < acc.Min ? samp : acc.Min;
+			acc.Max = samp > acc.Max ? samp : acc.Max;
+			acc.SumSquares += samp * samp;
+		}
+	}
+
+	void UpdateBankSummary(const float* samps, unsigned long numSamps, float* summary, unsigned long lo, unsigned long hi)
+	{
+		// Leaves are rebuilt whole, so one that is only partly
+		// written will be correct once its last sample arrives
+		auto node1 = (unsigned int)(lo / BufferBank::_SummaryLeafSamps);
+		auto node2 = (unsigned int)((hi - 1) / BufferBank::_SummaryLeafSamps) + 1u;
+
+		for (auto leaf = node1; leaf < node2; leaf++)
+		{
+			// Mapped samples can end part way through a leaf
+			auto leafStart = leaf * BufferBank::_SummaryLeafSamps;
+			auto leafSamps = numSamps - leafStart < BufferBank::_SummaryLeafSamps ?
+				numSamps - leafStart :
+				BufferBank::_SummaryLeafSamps;
+
+			auto node = EmptyNode();
+			ScanSamps(samps + leafStart, leafSamps, node);
+			WriteNode(Node(summary, 0u, leaf), node);
+		}
+
+		for (auto level = 1u; level < NumLevels; level++)
+		{
+			node1 = node1 / 2u;
+			node2 = (node2 + 1u) / 2u;
+
+			for (auto index = node1; index < node2; index++)
+			{
+				auto node = EmptyNode();
+				MergeNode(Node(summary, level - 1u, index * 2u), node);
+
+				if (index * 2u + 1u < Levels.Sizes[level - 1u])
+					MergeNode(Node(summary, level - 1u, index * 2u + 1u), node);
+
+				WriteNode(Node(summary, level, index), node);
+			}
+		}
+	}
+
+	// scan(lo, numSamps, acc) scans samples of the bank directly
+	template <typename Scan>
+	void BankSummary(const Scan& scan, const float* summary, unsigned long lo, unsigned long hi, SummaryNode& acc)
+	{
+		// Partial leaves at either end are scanned directly
+		auto leaf1 = (unsigned int)((lo + BufferBank::_SummaryLeafSamps - 1) / BufferBank::_SummaryLeafSamps);
+		auto leaf2 = (unsigned int)(hi / BufferBank::_SummaryLeafSamps);
+
+		if (leaf1 >= leaf2)
+		{
+			scan(lo, hi - lo, acc);
+			return;
+		}
+
+		scan(lo, leaf1 * BufferBank::_SummaryLeafSamps - lo, acc);
+		scan(leaf2 * BufferBank::_SummaryLeafSamps, hi - leaf2 * BufferBank::_SummaryLeafSamps, acc);
+
+		for (auto level = 0u; leaf1 < leaf2; level++)
+		{
+			if (leaf1 & 1u)
+				MergeNode(Node(summary, level, leaf1++), acc);
+
+			if (leaf2 & 1u)
+				MergeNode(Node(summary, level, --leaf2), acc);
+
+			leaf1 /= 2u;
+			leaf2 /= 2u;
+		}
+	}
+}
+
 BufferBank::BufferBank() :
-	_length(0ul)
+	_dummy(0.0f),
+	_length(0ul),
+	_numBanks(0u),
+	_generation(0u),
+	_numSnapshots(0u),
+	_bufferBank(_MaxBanks),
+	_summaryBank(_MaxBanks),
+	_mapping(),
+	_mappedSamps(nullptr),
+	_mappedLength(0ul),
+	_storage(STORAGE_FLOAT),
+	_packedBank(_MaxPackedPages),
+	_packedLength(0ul)
 {
-	Init();
 }
 
 BufferBank::~BufferBank()
 {
+	Init();
 }
 
 void BufferBank::Init()
 {
-	_length = 0;
-	_bufferBank.clear();
+	BeginChange();
+	Clear();
+	EndChange();
+}
+
+void BufferBank::Map(std::shared_ptr<const void> owner, const float* samps, unsigned long length)
+{
+	BeginChange();
+	Clear();
+
+	auto numBanks = NumBanksToHold(length, false);
+	numBanks = numBanks < _MaxBanks ? numBanks : _MaxBanks;
+	auto capacity = _BufferBankSize * (unsigned long)numBanks;
+
+	_mapping = owner;
+	_mappedSamps = samps;
+	_mappedLength = length < capacity ? length : capacity;
+	_length = _mappedLength;
+
+	// Only the summaries need pages of their own
+	while (numBanks > _numBanks)
+	{
+		_summaryBank[_numBanks] = SummaryPool().Allocate();
+		_numBanks++;
+	}
+
+	EndChange();
+}
+
+void BufferBank::Unmap()
+{
+	if (!IsMapped() || !AcquireBanks())
+		return;
+
+	BeginChange();
+
+	for (auto bank = 0u; bank < _numBanks; bank++)
+	{
+		CountPages(STORAGE_FLOAT, 1);
+		std::copy(BankSamps(bank), BankSamps(bank) + BankLength(bank), _bufferBank[bank].get());
+	}
+
+	// Summaries already cover the copied samples
+	_mappedSamps = nullptr;
+	_mappedLength = 0;
+	ReleaseMapping();
+
+	EndChange();
+
+	UpdateCapacity();
+}
+
+bool BufferBank::IsMapped() const
+{
+	return nullptr != _mappedSamps;
+}
+
+bool BufferBank::PackInto(StorageMode mode, PackedSamps& packed) const
+{
+	// Pages from a pack that was never swapped in
+	packed.Pages.clear();
+
+	// Read before anything else, so the length
+	// can't belong to a newer recording
+	packed.Mode = mode;
+	packed.Generation = _generation;
+	packed.Length = _length;
+
+	if ((STORAGE_FLOAT == mode) || IsMapped() || IsPacked() || (0ul == packed.Length))
+		return false;
+
+	auto numPages = (NumBanksToHold(packed.Length, false) + 1u) / 2u;
+
+	for (auto page = 0u; page < numPages; page++)
+		packed.Pages.push_back(std::unique_ptr<float[]>(new float[_BufferBankSize]));
+
+	auto index = 0ul;
+
+	// Spans never cross a bank, so each packs into one half page
+	return Snapshot(packed.Generation, packed.Length, [&packed, &index](const float* samps, unsigned int numSamps) {
+		auto bank = index / _BufferBankSize;
+		auto out = reinterpret_cast<std::uint16_t*>(packed.Pages[bank / 2u].get()) +
+			(bank % 2u) * _BufferBankSize +
+			index % _BufferBankSize;
+
+		if (STORAGE_INT16 == packed.Mode)
+			MixKernels::FloatToInt16(samps, reinterpret_cast<std::int16_t*>(out), numSamps);
+		else
+			MixKernels::FloatToHalf(samps, out, numSamps);
+
+		index += numSamps;
+		return true;
+	});
+}
+
+bool BufferBank::Pack(PackedSamps& packed, SpentSamps& spent)
+{
+	// Everything swapped out, or turned down, fits in spent
+	if (!CanHandOut(spent, _numBanks + packed.Pages.size()))
+		return false;
+
+	auto isCurrent = !IsMapped() &&
+		!IsPacked() &&
+		(STORAGE_FLOAT != packed.Mode) &&
+		(packed.Generation == _generation) &&
+		(packed.Length == _length) &&
+		(packed.Pages.size() * 2u >= NumBanksToHold(_length, false)) &&
+		(packed.Pages.size() <= _MaxPackedPages) &&
+		(0u == _numSnapshots);
+
+	if (isCurrent)
+	{
+		BeginChange();
+
+		// A snapshot counted before the change began may be
+		// reading the float pages, one counted after stops
+		isCurrent = 0u == _numSnapshots;
+
+		if (!isCurrent)
+			EndChange();
+	}
+
+	if (!isCurrent)
+	{
+		for (auto& page : packed.Pages)
+			spent.Pages.push_back(std::move(page));
+
+		packed.Pages.clear();
+		return false;
+	}
+
+	for (auto bank = 0u; bank < _numBanks; bank++)
+	{
+		if (!_bufferBank[bank])
+			continue;
+
+		CountPages(STORAGE_FLOAT, -1);
+		spent.Pages.push_back(std::move(_bufferBank[bank]));
+	}
+
+	// Pages left from an earlier unpack are handed out first
+	for (auto page = 0u; page < packed.Pages.size(); page++)
+	{
+		if (_packedBank[page])
+			spent.Pages.push_back(std::move(_packedBank[page]));
+
+		_packedBank[page] = std::move(packed.Pages[page]);
+		CountPages(packed.Mode, 1);
+	}
+
+	packed.Pages.clear();
+	_storage = packed.Mode;
+	_packedLength = packed.Length;
+
+	EndChange();
+
+	return true;
+}
+
+void BufferBank::Unpack()
+{
+	if (!IsPacked() || !AcquireBanks())
+		return;
+
+	BeginChange();
+
+	for (auto bank = 0u; bank < _numBanks; bank++)
+	{
+		CountPages(STORAGE_FLOAT, 1);
+
+		auto bankStart = bank * (unsigned long)_BufferBankSize;
+		if (bankStart < _packedLength)
+			Read(bankStart, _bufferBank[bank].get(), (unsigned int)BankLength(bank));
+	}
+
+	// Summaries already cover the decoded samples
+	CountBytes(_storage, -PackedBytes());
+
+	_storage = STORAGE_FLOAT;
+	_packedLength = 0;
+	ReleasePacked();
+
+	EndChange();
 
 	UpdateCapacity();
 }
 
+bool BufferBank::CompressInto(CompressedSamps& compressed) const
+{
+	// Data that was never swapped in, or handed back
+	std::vector<std::uint8_t>().swap(compressed.Data);
+
+	compressed.Generation = _generation;
+	compressed.Length = _length;
+
+	if (IsMapped() || (STORAGE_COMPRESSED == _storage) || (0ul == compressed.Length))
+		return false;
+
+	LosslessEncoder encoder(compressed.Length);
+
+	auto isCurrent = Snapshot(compressed.Generation, compressed.Length, [&encoder](const float* samps, unsigned int numSamps) {
+		encoder.Write(samps, numSamps);
+		return true;
+	});
+
+	if (isCurrent)
+		compressed.Data = encoder.Finish();
+
+	return isCurrent && !compressed.Data.empty();
+}
+
+bool BufferBank::Compress(CompressedSamps& compressed, SpentSamps& spent)
+{
+	auto isCurrent = !IsMapped() &&
+		(STORAGE_COMPRESSED != _storage) &&
+		!compressed.Data.empty() &&
+		(compressed.Generation == _generation) &&
+		(compressed.Length == _length) &&
+		(0u == _numSnapshots) &&
+		CanHandOut(spent, _numBanks);
+
+	if (isCurrent)
+	{
+		BeginChange();
+
+		// As when packing, a snapshot counted before
+		// the change began may still be reading
+		isCurrent = 0u == _numSnapshots;
+
+		if (!isCurrent)
+		{
+			EndChange();
+			return false;
+		}
+	}
+	else
+		return false;
+
+	for (auto bank = 0u; bank < _numBanks; bank++)
+	{
+		if (!_bufferBank[bank])
+			continue;
+
+		CountPages(STORAGE_FLOAT, -1);
+		spent.Pages.push_back(std::move(_bufferBank[bank]));
+	}
+
+	// Anything still held from before goes out with the pages
+	HandOutStorage(spent);
+
+	_compressed.swap(compressed.Data);
+	CountBytes(STORAGE_COMPRESSED, (long long)_compressed.size());
+
+	_storage = STORAGE_COMPRESSED;
+	_packedLength = compressed.Length;
+
+	EndChange();
+
+	return true;
+}
+
+bool BufferBank::RestoreInto(PackedSamps& restored) const
+{
+	restored.Pages.clear();
+
+	restored.Mode = STORAGE_FLOAT;
+	restored.Generation = _generation;
+	restored.Length = _length;
+
+	// The bank count stays put while mapped or packed
+	auto numBanks = _numBanks.load();
+
+	if ((!IsMapped() && !IsPacked()) || (0ul == restored.Length) || (numBanks * (unsigned long)_BufferBankSize < restored.Length))
+		return false;
+
+	for (auto bank = 0u; bank < numBanks; bank++)
+		restored.Pages.push_back(std::unique_ptr<float[]>(new float[_BufferBankSize]()));
+
+	auto index = 0ul;
+
+	// Decoded spans never cross a bank
+	return Snapshot(restored.Generation, restored.Length, [&restored, &index](const float* samps, unsigned int numSamps) {
+		std::copy(samps, samps + numSamps, restored.Pages[index / _BufferBankSize].get() + index % _BufferBankSize);
+		index += numSamps;
+		return true;
+	});
+}
+
+bool BufferBank::Restore(PackedSamps& restored, SpentSamps& spent)
+{
+	if (!CanHandOut(spent, restored.Pages.size()))
+		return false;
+
+	auto isCurrent = (IsMapped() || IsPacked()) &&
+		(STORAGE_FLOAT == restored.Mode) &&
+		(restored.Generation == _generation) &&
+		(restored.Length == _length) &&
+		(restored.Pages.size() == _numBanks) &&
+		(0u == _numSnapshots);
+
+	if (isCurrent)
+	{
+		BeginChange();
+		isCurrent = 0u == _numSnapshots;
+
+		if (!isCurrent)
+			EndChange();
+	}
+
+	if (!isCurrent)
+	{
+		for (auto& page : restored.Pages)
+			spent.Pages.push_back(std::move(page));
+
+		restored.Pages.clear();
+		return false;
+	}
+
+	// Mapped and packed banks only hold summaries
+	for (auto bank = 0u; bank < _numBanks; bank++)
+	{
+		_bufferBank[bank] = std::move(restored.Pages[bank]);
+		CountPages(STORAGE_FLOAT, 1);
+	}
+
+	restored.Pages.clear();
+	HandOutStorage(spent);
+
+	EndChange();
+
+	return true;
+}
+
+bool BufferBank::Discard(SpentSamps& spent)
+{
+	if ((_numSnapshots > 0u) || !CanHandOut(spent, 0u))
+		return false;
+
+	BeginChange();
+
+	if (_numSnapshots > 0u)
+	{
+		EndChange();
+		return false;
+	}
+
+	HandOutStorage(spent);
+
+	// Pages come back from the pool as it is recorded over
+	_length = 0;
+	ReleaseBanks(0u);
+
+	EndChange();
+
+	return true;
+}
+
+bool BufferBank::IsPacked() const
+{
+	return STORAGE_FLOAT != _storage;
+}
+
+BufferBank::StorageMode BufferBank::Storage() const
+{
+	return _storage;
+}
+
 const float& audio::BufferBank::operator[](unsigned long index) const
 {
-	if (index < Capacity())
+	// Packed samples need decoding, so read as silence here
+	if (!IsPacked() && (index < Capacity()))
 	{
 		auto bank = index / _BufferBankSize;
 		auto offset = index % _BufferBankSize;
 
-		return _bufferBank[bank][offset];
+		return BankSamps(bank)[offset];
 	}
 
 	return _dummy;
@@ -35,7 +581,8 @@ const float& audio::BufferBank::operator[](unsigned long index) const
 
 float& audio::BufferBank::operator[](unsigned long index)
 {
-	if (index < Capacity())
+	// Mapped and packed samples are read-only
+	if (!IsMapped() && !IsPacked() && (index < Capacity()))
 	{
 		auto bank = index / _BufferBankSize;
 		auto offset = index % _BufferBankSize;
@@ -46,25 +593,138 @@ float& audio::BufferBank::operator[](unsigned long index)
 	return _dummy;
 }
 
-void BufferBank::SetLength(unsigned long length)
+void BufferBank::Overwrite(unsigned long index, const float* samps, unsigned int numSamps)
+{
+	auto capacity = (IsMapped() || IsPacked()) ? 0ul : Capacity();
+	auto samp = 0u;
+
+	while ((samp < numSamps) && (index < capacity))
+	{
+		auto bank = index / _BufferBankSize;
+		auto offset = index % _BufferBankSize;
+		auto blockSamps = std::min((unsigned long)(numSamps - samp), _BufferBankSize - offset);
+		blockSamps = std::min(blockSamps, capacity - index);
+
+		std::copy(samps + samp, samps + samp + blockSamps, _bufferBank[bank].get() + offset);
+
+		samp += (unsigned int)blockSamps;
+		index += blockSamps;
+	}
+}
+
+unsigned int BufferBank::Read(unsigned long index, float* out, unsigned int numSamps) const
 {
 	auto capacity = Capacity();
-	_length = length < capacity ? length : capacity;
+	auto numRead = 0u;
+
+	if (STORAGE_COMPRESSED == _storage)
+	{
+		if (index >= capacity)
+			return 0u;
+
+		return LosslessDecoder::Read(_compressed.data(),
+			_compressed.size(),
+			index,
+			out,
+			(unsigned int)std::min((unsigned long)numSamps, capacity - index));
+	}
+
+	while ((numRead < numSamps) && (index < capacity))
+	{
+		auto bank = index / _BufferBankSize;
+		auto offset = index % _BufferBankSize;
+		auto blockSamps = std::min((unsigned long)(numSamps - numRead), BankLength(bank) - offset);
+		blockSamps = std::min(blockSamps, capacity - index);
+
+		switch (_storage)
+		{
+		case STORAGE_INT16:
+			MixKernels::Int16ToFloat(reinterpret_cast<const std::int16_t*>(BankPacked(bank)) + offset, 1u, out + numRead, (unsigned int)blockSamps);
+			break;
+		case STORAGE_FLOAT16:
+			MixKernels::HalfToFloat(BankPacked(bank) + offset, out + numRead, (unsigned int)blockSamps);
+			break;
+		default:
+			std::copy(BankSamps(bank) + offset, BankSamps(bank) + offset + blockSamps, out + numRead);
+			break;
+		}
+
+		numRead += (unsigned int)blockSamps;
+		index += blockSamps;
+	}
+
+	return numRead;
 }
 
-void BufferBank::UpdateCapacity()
+std::tuple<const float*, unsigned int> BufferBank::ReadSpan(unsigned long index, unsigned int numSamps) const
+{
+	auto capacity = Capacity();
+
+	if (IsPacked() || (index >= capacity))
+		return { nullptr, 0u };
+
+	auto bank = index / _BufferBankSize;
+	auto offset = index % _BufferBankSize;
+	auto blockSamps = std::min((unsigned long)numSamps, BankLength(bank) - offset);
+
+	return { BankSamps(bank) + offset, (unsigned int)blockSamps };
+}
+
+std::tuple<float*, unsigned int> BufferBank::WriteSpan(unsigned long index, unsigned int numSamps)
 {
-	int numBanks = NumBanksToHold(_length, true);
+	if (IsMapped() || IsPacked() || (index >= Capacity()))
+		return { nullptr, 0u };
+
+	auto bank = index / _BufferBankSize;
+	auto offset = index % _BufferBankSize;
+	auto blockSamps = std::min((unsigned long)numSamps, _BufferBankSize - offset);
+
+	return { _bufferBank[bank].get() + offset, (unsigned int)blockSamps };
+}
 
-	if (numBanks > _bufferBank.size())
+void BufferBank::SetLength(unsigned long length, bool updateCapacity)
+{
+	// Cutting the bank short means it is being recorded afresh
+	if (length < _length)
 	{
-		while (numBanks > _bufferBank.size())
-			_bufferBank.push_back(std::vector<float>(_BufferBankSize, 0.0f));
+		BeginChange();
+		EndChange();
 	}
-	else if (numBanks < _bufferBank.size())
+
+	_length = length;
+
+	if (updateCapacity)
+		UpdateCapacity();
+
+	auto capacity = Capacity();
+	_length = length < capacity ? length : capacity;
+}
+
+void BufferBank::Reserve(unsigned long length)
+{
+	if (IsMapped() || IsPacked())
+		return;
+
+	AddBanks(std::min(NumBanksToHold(length, false), _MaxBanks), true);
+}
+
+void BufferBank::UpdateCapacity()
+{
+	// Pages come from and go back to the pool, so this is safe
+	// to call on the audio thread. If the pool runs dry, capacity
+	// falls short until it has been refilled. Mapped and packed
+	// samples keep their capacity until restored or discarded.
+	if (IsMapped() || IsPacked())
+		return;
+
+	auto numBanks = std::min(NumBanksToHold(_length, true), _MaxBanks);
+	AddBanks(numBanks, false);
+
+	if (numBanks < _numBanks)
 	{
-		while (numBanks < _bufferBank.size())
-			_bufferBank.pop_back();
+		BeginChange();
+		ReleaseBanks(numBanks);
+		EndChange();
 	}
 }
 
@@ -75,56 +735,192 @@ unsigned long BufferBank::Length() const
 
 unsigned long BufferBank::Capacity() const
 {
-	return _BufferBankSize * (unsigned long)_bufferBank.size();
+	if (IsMapped())
+		return _mappedLength;
+
+	if (IsPacked())
+		return _packedLength;
+
+	return _BufferBankSize * (unsigned long)_numBanks;
 }
 
-float BufferBank::SubMin(unsigned long i1, unsigned long i2) const
+void BufferBank::UpdateSummary(unsigned long index, unsigned long numSamps)
 {
-	auto length = Length();
+	// Summaries were finished before the samples were packed
+	if (IsPacked())
+		return;
+
+	auto end = std::min(index + numSamps, Capacity());
+
+	while (index < end)
+	{
+		auto bank = index / _BufferBankSize;
+		auto bankStart = bank * _BufferBankSize;
+		auto bankEnd = std::min(end, bankStart + _BufferBankSize);
+
+		UpdateBankSummary(BankSamps(bank),
+			BankLength(bank),
+			_summaryBank[bank].get(),
+			index - bankStart,
+			bankEnd - bankStart);
+
+		index = bankEnd;
+	}
+}
+
+BufferSummary BufferBank::Summary(unsigned long i1, unsigned long i2) const
+{
+	// Held like a snapshot, so nothing is swapped out or
+	// released while the pages are scanned
+	_numSnapshots++;
+
+	auto generation = _generation.load();
+	auto summary = (0u == (generation & 1u)) ?
+		ScanSummary(i1, i2) :
+		BufferSummary{ 0.0f, 0.0f, 0.0f };
+
+	if (generation != _generation)
+		summary = { 0.0f, 0.0f, 0.0f };
 
-	if (0 == length)
-		return 0.0f;
+	_numSnapshots--;
 
-	i1 = i1 > 0 ? i1 : 0;
+	return summary;
+}
+
+BufferSummary BufferBank::ScanSummary(unsigned long i1, unsigned long i2) const
+{
+	auto length = Length();
 	i1 = i1 < length ? i1 : length;
 	i2 = i2 < length ? i2 : length;
 
 	if (i2 <= i1)
-		return 0.0f;
+		return { 0.0f, 0.0f, 0.0f };
+
+	auto acc = EmptyNode();
+	auto numSamps = i2 - i1;
 
-	auto curMin = (*this)[0];
-	for (auto i = i1; i < i2; i++)
+	while (i1 < i2)
 	{
-		if ((*this)[i] < curMin)
-			curMin = (*this)[i];
+		auto bank = i1 / _BufferBankSize;
+		auto bankStart = bank * _BufferBankSize;
+		auto bankEnd = std::min(i2, bankStart + _BufferBankSize);
+
+		if (IsPacked())
+		{
+			auto scan = [this, bankStart](unsigned long lo, unsigned long numSamps, SummaryNode& acc) {
+				float samps[_SummaryLeafSamps];
+
+				while (numSamps > 0)
+				{
+					auto numRead = Read(bankStart + lo, samps, (unsigned int)std::min(numSamps, (unsigned long)_SummaryLeafSamps));
+
+					if (0u == numRead)
+						break;
+
+					ScanSamps(samps, numRead, acc);
+					lo += numRead;
+					numSamps -= numRead;
+				}
+			};
+
+			BankSummary(scan, _summaryBank[bank].get(), i1 - bankStart, bankEnd - bankStart, acc);
+		}
+		else
+		{
+			auto samps = BankSamps(bank);
+			auto scan = [samps](unsigned long lo, unsigned long numSamps, SummaryNode& acc) {
+				ScanSamps(samps + lo, numSamps, acc);
+			};
+
+			BankSummary(scan, _summaryBank[bank].get(), i1 - bankStart, bankEnd - bankStart, acc);
+		}
+
+		i1 = bankEnd;
 	}
 
-	return curMin;
+	return { acc.Min, acc.Max, std::sqrt(acc.SumSquares / (float)numSamps) };
+}
+
+bool BufferBank::IsSilent(unsigned long i1, unsigned long i2, float threshold) const
+{
+	auto summary = Summary(i1, i2);
+	return (summary.Max < threshold) && (summary.Min > -threshold);
 }
 
+float BufferBank::SubMin(unsigned long i1, unsigned long i2) const
+{
+	return Summary(i1, i2).Min;
+}
 
 float BufferBank::SubMax(unsigned long i1, unsigned long i2) const
 {
-	auto length = Length();
+	return Summary(i1, i2).Max;
+}
+
+unsigned int BufferBank::Generation() const
+{
+	return _generation;
+}
 
-	if (0 == length)
-		return 0.0f;
+bool BufferBank::Snapshot(unsigned int generation,
+	unsigned long numSamps,
+	const std::function<bool(const float*, unsigned int)>& onSamps) const
+{
+	// Counted before the generation is checked, so any change
+	// that starts after this point holds back its releases
+	_numSnapshots++;
 
-	i1 = i1 > 0 ? i1 : 0;
-	i1 = i1 < length ? i1 : length;
-	i2 = i2 < length ? i2 : length;
+	auto isCurrent = (0u == (generation & 1u)) &&
+		(generation == _generation) &&
+		(numSamps <= Capacity());
+	auto index = 0ul;
 
-	if (i2 <= i1)
-		return 0.0f;
+	// Packing waits for snapshots to finish, so this holds
+	std::vector<float> decoded(IsPacked() ? _SnapshotSamps : 0u);
 
-	auto curMax = (*this)[0ul];
-	for (auto i = i1; i < i2; i++)
+	while (isCurrent && (index < numSamps))
 	{
-		if ((*this)[i]> curMax)
-			curMax = (*this)[i];
+		const float* samps = nullptr;
+		auto spanSamps = (unsigned int)std::min(numSamps - index, (unsigned long)_BufferBankSize);
+
+		if (decoded.empty())
+			std::tie(samps, spanSamps) = ReadSpan(index, spanSamps);
+		else
+		{
+			spanSamps = Read(index, decoded.data(), spanSamps < _SnapshotSamps ? spanSamps : _SnapshotSamps);
+			samps = decoded.data();
+		}
+
+		if ((nullptr == samps) || (0u == spanSamps) || !onSamps(samps, spanSamps))
+			isCurrent = false;
+		else
+		{
+			index += spanSamps;
+			isCurrent = generation == _generation;
+		}
 	}
 
-	return curMax;
+	_numSnapshots--;
+
+	return isCurrent;
+}
+
+BufferPool& BufferBank::Pool()
+{
+	static BufferPool pool(_BufferBankSize, _PoolPages);
+	return pool;
+}
+
+BufferPool& BufferBank::SummaryPool()
+{
+	static BufferPool pool(Levels.NumNodes * SummaryNodeFloats, _PoolPages);
+	return pool;
+}
+
+unsigned long long BufferBank::StorageBytes(StorageMode mode)
+{
+	auto numBytes = StorageBytesCount[mode].load();
+	return numBytes > 0 ? (unsigned long long)numBytes : 0ull;
 }
 
 unsigned int BufferBank::NumBanksToHold(unsigned long length, bool includeCapacityAhead)
@@ -138,3 +934,187 @@ unsigned int BufferBank::NumBanksToHold(unsigned long length, bool includeCapaci
 
 	return numBanks;
 }
+
+const float* BufferBank::BankSamps(unsigned long bank) const
+{
+	if (IsMapped())
+		return _mappedSamps + bank * _BufferBankSize;
+
+	return _bufferBank[bank].get();
+}
+
+const std::uint16_t* BufferBank::BankPacked(unsigned long bank) const
+{
+	return reinterpret_cast<const std::uint16_t*>(_packedBank[bank / 2u].get()) + (bank % 2u) * _BufferBankSize;
+}
+
+void BufferBank::AddBanks(unsigned int numBanks, bool canAllocate)
+{
+	while (numBanks > _numBanks)
+	{
+		auto samps = canAllocate ? Pool().Allocate() : Pool().Acquire();
+		auto summary = canAllocate ? SummaryPool().Allocate() : SummaryPool().Acquire();
+
+		if (!samps || !summary)
+		{
+			Pool().Release(std::move(samps));
+			SummaryPool().Release(std::move(summary));
+			return;
+		}
+
+		_bufferBank[_numBanks] = std::move(samps);
+		_summaryBank[_numBanks] = std::move(summary);
+		CountPages(STORAGE_FLOAT, 1);
+		_numBanks++;
+	}
+}
+
+bool BufferBank::AcquireBanks()
+{
+	// Taken before anything changes, so a dry pool leaves
+	// the bank as it was rather than part way copied
+	for (auto bank = 0u; bank < _numBanks; bank++)
+	{
+		_bufferBank[bank] = Pool().Acquire();
+
+		if (!_bufferBank[bank])
+		{
+			for (auto taken = 0u; taken < bank; taken++)
+				Pool().Release(std::move(_bufferBank[taken]));
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool BufferBank::CanHandOut(const SpentSamps& spent, std::size_t numPages) const
+{
+	for (auto& page : _packedBank)
+	{
+		if (page)
+			numPages++;
+	}
+
+	return (spent.Pages.capacity() - spent.Pages.size() >= numPages) &&
+		(_compressed.empty() || spent.Data.empty()) &&
+		(!_mapping || !spent.Mapping);
+}
+
+void BufferBank::HandOutStorage(SpentSamps& spent)
+{
+	if (IsPacked())
+		CountBytes(_storage, -PackedBytes());
+
+	for (auto& page : _packedBank)
+	{
+		if (page)
+			spent.Pages.push_back(std::move(page));
+	}
+
+	if (!_compressed.empty())
+		spent.Data.swap(_compressed);
+
+	if (_mapping)
+		spent.Mapping = std::move(_mapping);
+
+	_mappedSamps = nullptr;
+	_mappedLength = 0;
+	_storage = STORAGE_FLOAT;
+	_packedLength = 0;
+}
+
+void BufferBank::Clear()
+{
+	if (IsPacked())
+		CountBytes(_storage, -PackedBytes());
+
+	_length = 0;
+	_mappedSamps = nullptr;
+	_mappedLength = 0;
+	_storage = STORAGE_FLOAT;
+	_packedLength = 0;
+
+	ReleaseBanks(0u);
+	ReleaseMapping();
+	ReleasePacked();
+}
+
+void BufferBank::ReleaseBanks(unsigned int numBanks)
+{
+	while (numBanks < _numBanks)
+	{
+		// Samples a snapshot may be reading are left for a later
+		// capacity update to give back. Banks left over from a
+		// mapping only hold summaries, which snapshots never read.
+		if ((_numSnapshots > 0u) && _bufferBank[_numBanks - 1])
+			return;
+
+		_numBanks--;
+
+		if (_bufferBank[_numBanks])
+			CountPages(STORAGE_FLOAT, -1);
+
+		Pool().Release(std::move(_bufferBank[_numBanks]));
+		SummaryPool().Release(std::move(_summaryBank[_numBanks]));
+	}
+}
+
+void BufferBank::ReleaseMapping()
+{
+	if (IsMapped() || (_numSnapshots > 0u))
+		return;
+
+	_mapping.reset();
+}
+
+void BufferBank::ReleasePacked()
+{
+	// Held back, like the mapping, while snapshots may decode them
+	if (IsPacked() || (_numSnapshots > 0u))
+		return;
+
+	for (auto& page : _packedBank)
+		Pool().Release(std::move(page));
+
+	std::vector<std::uint8_t>().swap(_compressed);
+}
+
+long long BufferBank::PackedBytes() const
+{
+	if (STORAGE_COMPRESSED == _storage)
+		return (long long)_compressed.size();
+
+	auto numPages = 0ll;
+
+	for (auto& page : _packedBank)
+	{
+		if (page)
+			numPages++;
+	}
+
+	return numPages * PageBytes;
+}
+
+void BufferBank::BeginChange()
+{
+	_generation++;
+}
+
+void BufferBank::EndChange()
+{
+	_generation++;
+}
+
+unsigned long BufferBank::BankLength(unsigned long bank) const
+{
+	if (IsMapped() || IsPacked())
+	{
+		auto length = IsMapped() ? _mappedLength : _packedLength;
+		auto bankStart = bank * _BufferBankSize;
+		return length - bankStart < _BufferBankSize ? length - bankStart : _BufferBankSize;
+	}
+
+	return _BufferBankSize;
+}
\ No newline at end of file
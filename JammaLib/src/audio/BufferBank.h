@@ -1,37 +1,274 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <cstdint>
+#include "../include/Constants.h"
+#include "BufferPool.h"
 
 namespace audio
 {
+	struct BufferSummary
+	{
+		float Min;
+		float Max;
+		float Rms;
+	};
+
+	// Samples are kept in pages of _BufferBankSize. Each page
+	// has a matching summary page holding a binary pyramid of
+	// min, max and sum of squares, built over leaves of
+	// _SummaryLeafSamps samples. UpdateSummary must be called
+	// once samples have been written for queries to see them.
+	// A bank can instead be mapped over samples it does not own
+	// (e.g. a mapped file), which are read in place until the
+	// bank is restored (or unmapped) to take writes.
+	// Snapshots read the bank from other threads while the audio
+	// thread carries on. Pages and mappings are held back from
+	// release while one is running, and a generation count
+	// (odd mid-change) tells it if the bank was cleared, cut
+	// short or remapped under it.
+	// A finished bank can be packed to 16-bit samples, two banks
+	// to a page, which are decoded as they are read. Packing is
+	// done off the audio thread and then swapped in by Pack.
+	// An idle bank can likewise be compressed losslessly, and
+	// is decoded a frame at a time when read until restored.
+	// Whatever the audio thread swaps out is handed out to a
+	// SpentSamps, to be freed from another thread.
 	class BufferBank
 	{
+	public:
+		enum StorageMode
+		{
+			STORAGE_FLOAT,
+			STORAGE_INT16,
+			STORAGE_FLOAT16,
+			STORAGE_COMPRESSED,
+			NUM_STORAGEMODES
+		};
+
+		struct PackedSamps
+		{
+			StorageMode Mode;
+			unsigned int Generation; // Of the bank when packed
+			unsigned long Length;
+			std::vector<std::unique_ptr<float[]>> Pages;
+		};
+
+		struct CompressedSamps
+		{
+			unsigned int Generation; // Of the bank when compressed
+			unsigned long Length;
+			std::vector<std::uint8_t> Data;
+		};
+
+		// Storage swapped out on the audio thread, held until it
+		// can be freed (or pages given back to the pool) from another
+		// thread. Room is reserved up front so handing out never allocates.
+		struct SpentSamps
+		{
+			SpentSamps() { Pages.reserve(_MaxBanks + 2u * _MaxPackedPages); }
+
+			bool IsEmpty() const { return Pages.empty() && Data.empty() && !Mapping; }
+
+			std::vector<std::unique_ptr<float[]>> Pages;
+			std::vector<std::uint8_t> Data;
+			std::shared_ptr<const void> Mapping;
+		};
+
 	public:
 		BufferBank();
 		~BufferBank();
 
+		// Copy
+		BufferBank(const BufferBank&) = delete;
+		BufferBank& operator=(const BufferBank&) = delete;
+
+		// Move
+		BufferBank(BufferBank&& other) :
+			_dummy(0.0f),
+			_length(other._length),
+			_numBanks(other._numBanks.load()),
+			_generation(0u),
+			_numSnapshots(0u),
+			_bufferBank(std::move(other._bufferBank)),
+			_summaryBank(std::move(other._summaryBank)),
+			_mapping(std::move(other._mapping)),
+			_mappedSamps(other._mappedSamps),
+			_mappedLength(other._mappedLength),
+			_storage(other._storage),
+			_packedBank(std::move(other._packedBank)),
+			_packedLength(other._packedLength),
+			_compressed(std::move(other._compressed))
+		{
+			other._length = 0;
+			other._numBanks = 0;
+			other._mappedSamps = nullptr;
+			other._mappedLength = 0;
+			other._storage = STORAGE_FLOAT;
+			other._packedLength = 0;
+			other._bufferBank = std::vector<std::unique_ptr<float[]>>(_MaxBanks);
+			other._summaryBank = std::vector<std::unique_ptr<float[]>>(_MaxBanks);
+			other._packedBank = std::vector<std::unique_ptr<float[]>>(_MaxPackedPages);
+		}
+
+		BufferBank& operator=(BufferBank&& other)
+		{
+			if (this != &other)
+			{
+				std::swap(_length, other._length);
+				std::swap(_bufferBank, other._bufferBank);
+				std::swap(_summaryBank, other._summaryBank);
+				std::swap(_mapping, other._mapping);
+				std::swap(_mappedSamps, other._mappedSamps);
+				std::swap(_mappedLength, other._mappedLength);
+				std::swap(_storage, other._storage);
+				std::swap(_packedBank, other._packedBank);
+				std::swap(_packedLength, other._packedLength);
+				std::swap(_compressed, other._compressed);
+
+				auto numBanks = _numBanks.load();
+				_numBanks = other._numBanks.load();
+				other._numBanks = numBanks;
+			}
+
+			return *this;
+		}
+
 	public:
 		const float& operator[] (unsigned long index) const;
 		float& operator[] (unsigned long index);
 
 		void Init();
-		void SetLength(unsigned long length);
+		// Reads samps in place, holding owner until unmapped
+		void Map(std::shared_ptr<const void> owner, const float* samps, unsigned long length);
+		// Copies mapped samples into pages so they can be written,
+		// staying mapped if the pool has run dry. Frees the mapping,
+		// so not for the audio thread, which restores instead.
+		void Unmap();
+		bool IsMapped() const;
+		// Packs samples [0, Length()) into packed, off the audio
+		// thread. Fails if the bank changed part way through.
+		bool PackInto(StorageMode mode, PackedSamps& packed) const;
+		// Swaps in packed samples, handing the float pages out to
+		// spent. Fails, and hands out packed's pages instead, if the
+		// bank has moved on or a snapshot is running. Fails without
+		// touching packed if spent has no room left.
+		bool Pack(PackedSamps& packed, SpentSamps& spent);
+		// Compresses samples [0, Length()) off the audio thread,
+		// failing if the bank changed part way through
+		bool CompressInto(CompressedSamps& compressed) const;
+		// Swaps in compressed samples, handing the pages out to spent.
+		// Fails if the bank has moved on, a snapshot is running or
+		// spent has no room left.
+		bool Compress(CompressedSamps& compressed, SpentSamps& spent);
+		// Decodes mapped, packed or compressed samples into float
+		// pages off the audio thread
+		bool RestoreInto(PackedSamps& restored) const;
+		// Swaps the restored pages in, handing the mapping, packed
+		// pages or compressed data out to spent. Fails, and hands out
+		// the restored pages instead, if the bank moved on. Fails
+		// without touching restored if spent has no room left.
+		bool Restore(PackedSamps& restored, SpentSamps& spent);
+		// Drops mapped, packed or compressed samples, handing them
+		// out to spent, so the bank can be recorded over afresh.
+		// Fails if a snapshot is running or spent has no room left.
+		bool Discard(SpentSamps& spent);
+		// Decodes packed or compressed samples into pages so they
+		// can be written, staying packed if the pool has run dry.
+		// Decodes in place, so not for the audio thread.
+		void Unpack();
+		// Packed or compressed, so read by decoding
+		bool IsPacked() const;
+		StorageMode Storage() const;
+		void Overwrite(unsigned long index, const float* samps, unsigned int numSamps);
+		// Copies (or decodes) samples into out, returning how many
+		// were read before reaching the end of the capacity. Too
+		// slow for the audio thread once compressed.
+		unsigned int Read(unsigned long index, float* out, unsigned int numSamps) const;
+		// Samples from index up to the end of its bank, at most
+		// numSamps. Empty when packed, as they need decoding.
+		std::tuple<const float*, unsigned int> ReadSpan(unsigned long index, unsigned int numSamps) const;
+		std::tuple<float*, unsigned int> WriteSpan(unsigned long index, unsigned int numSamps);
+		void SetLength(unsigned long length, bool updateCapacity);
+		// Grows to hold length samples, allocating if the pool
+		// runs dry, so for loading off the audio thread
+		void Reserve(unsigned long length);
 		void UpdateCapacity();
 		unsigned long Length() const;
 		unsigned long Capacity() const;
+		void UpdateSummary(unsigned long index, unsigned long numSamps);
+		// Reads as silent if the bank is mid-change or changes
+		// part way, as the pages may have been swapped out
+		BufferSummary Summary(unsigned long i1, unsigned long i2) const;
+		bool IsSilent(unsigned long i1, unsigned long i2, float threshold) const;
 		float SubMin(unsigned long i1, unsigned long i2) const;
 		float SubMax(unsigned long i1, unsigned long i2) const;
+		unsigned int Generation() const;
+		// Hands samples [0, numSamps) to onSamps a span at a time.
+		// Fails if the bank has moved on from generation, part
+		// way or before starting, or if onSamps returns false.
+		bool Snapshot(unsigned int generation,
+			unsigned long numSamps,
+			const std::function<bool(const float*, unsigned int)>& onSamps) const;
+
+		static BufferPool& Pool();
+		static BufferPool& SummaryPool();
+		// Sample pages held by every bank in the given mode
+		// (mapped samples belong to their file, so aren't counted)
+		static unsigned long long StorageBytes(StorageMode mode);
 
 	protected:
 		static unsigned int NumBanksToHold(unsigned long length, bool includeCapacityAhead);
+		BufferSummary ScanSummary(unsigned long i1, unsigned long i2) const;
+		const float* BankSamps(unsigned long bank) const;
+		const std::uint16_t* BankPacked(unsigned long bank) const;
+		unsigned long BankLength(unsigned long bank) const;
+		void AddBanks(unsigned int numBanks, bool canAllocate);
+		// Sample pages for every bank, or none if the pool runs dry
+		bool AcquireBanks();
+		// Room in spent for numPages, and for any mapping
+		// or compressed data still held
+		bool CanHandOut(const SpentSamps& spent, std::size_t numPages) const;
+		// Hands out any mapping, packed pages or compressed data
+		void HandOutStorage(SpentSamps& spent);
+		void Clear();
+		void ReleaseBanks(unsigned int numBanks);
+		void ReleaseMapping();
+		void ReleasePacked();
+		// Held in the current packed or compressed form
+		long long PackedBytes() const;
+		void BeginChange();
+		void EndChange();
 	
 	public:
 		static const unsigned int _BufferBankSize = 1000000u;
 		static const unsigned int _BufferCapacityAhead = 500000u;
+		static const unsigned int _PoolPages = 16u;
+		static const unsigned int _MaxBanks = 2u + (unsigned int)(constants::MaxLoopBufferSize / _BufferBankSize);
+		static const unsigned int _SummaryLeafSamps = 64u; // Must divide _BufferBankSize
+		static const unsigned int _MaxPackedPages = (_MaxBanks + 1u) / 2u;
+		static const unsigned int _SnapshotSamps = 16384u; // Decoded at a time when packed
 
 	protected:
 		float _dummy;
 		unsigned int _length;
-		std::vector<std::vector<float>> _bufferBank;
+		std::atomic<unsigned int> _numBanks;
+		std::atomic<unsigned int> _generation;
+		mutable std::atomic<unsigned int> _numSnapshots;
+		// Sized up front so that growing never reallocates
+		std::vector<std::unique_ptr<float[]>> _bufferBank;
+		std::vector<std::unique_ptr<float[]>> _summaryBank;
+		std::shared_ptr<const void> _mapping;
+		const float* _mappedSamps;
+		unsigned long _mappedLength;
+		StorageMode _storage;
+		std::vector<std::unique_ptr<float[]>> _packedBank;
+		unsigned long _packedLength;
+		std::vector<std::uint8_t> _compressed;
 	};
 }
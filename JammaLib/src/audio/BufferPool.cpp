@@ -0,0 +1,140 @@
+#include "BufferPool.h"
+
+using namespace audio;
+
+BufferPool::BufferPool(unsigned int pageSize, unsigned int numPages) :
+	_pageSize(pageSize),
+	_numMisses(0ul),
+	_freePages(numPages),
+	_returnedPages(nullptr)
+{
+}
+
+BufferPool::~BufferPool()
+{
+	for (auto& slot : _freePages)
+		delete[] slot.exchange(nullptr);
+
+	auto page = _returnedPages.exchange(nullptr);
+
+	while (nullptr != page)
+	{
+		auto next = NextReturned(page);
+		delete[] page;
+		page = next;
+	}
+}
+
+std::unique_ptr<float[]> BufferPool::Acquire()
+{
+	for (auto& slot : _freePages)
+	{
+		if (nullptr == slot.load(std::memory_order_relaxed))
+			continue;
+
+		auto page = slot.exchange(nullptr, std::memory_order_acquire);
+		if (nullptr != page)
+			return std::unique_ptr<float[]>(page);
+	}
+
+	// Left to the caller to cope without, as allocating
+	// here would stall the audio thread
+	_numMisses++;
+	return std::unique_ptr<float[]>();
+}
+
+std::unique_ptr<float[]> BufferPool::Allocate()
+{
+	auto page = Acquire();
+
+	if (!page)
+		page = std::unique_ptr<float[]>(new float[_pageSize]());
+
+	return page;
+}
+
+void BufferPool::Release(std::unique_ptr<float[]> page)
+{
+	if (!page)
+		return;
+
+	// Pushed onto the returned chain, which Refill takes whole,
+	// so the page is never freed on the releasing thread
+	auto head = _returnedPages.load(std::memory_order_relaxed);
+
+	do
+	{
+		std::memcpy(page.get(), &head, sizeof(head));
+	} while (!_returnedPages.compare_exchange_weak(head, page.get(), std::memory_order_release, std::memory_order_relaxed));
+
+	page.release();
+}
+
+void BufferPool::Refill()
+{
+	auto page = _returnedPages.exchange(nullptr, std::memory_order_acquire);
+
+	while (nullptr != page)
+	{
+		auto next = NextReturned(page);
+		std::fill(page, page + _pageSize, 0.0f);
+
+		auto isKept = false;
+		for (auto& freeSlot : _freePages)
+		{
+			float* empty = nullptr;
+			if (freeSlot.compare_exchange_strong(empty, page, std::memory_order_release))
+			{
+				isKept = true;
+				break;
+			}
+		}
+
+		if (!isKept)
+			delete[] page;
+
+		page = next;
+	}
+
+	for (auto& freeSlot : _freePages)
+	{
+		if (nullptr != freeSlot.load(std::memory_order_relaxed))
+			continue;
+
+		auto newPage = new float[_pageSize]();
+		float* empty = nullptr;
+		if (!freeSlot.compare_exchange_strong(empty, newPage, std::memory_order_release))
+			delete[] newPage;
+	}
+}
+
+unsigned int BufferPool::PageSize() const
+{
+	return _pageSize;
+}
+
+unsigned int BufferPool::NumFree() const
+{
+	auto numFree = 0u;
+
+	for (auto& slot : _freePages)
+	{
+		if (nullptr != slot.load(std::memory_order_relaxed))
+			numFree++;
+	}
+
+	return numFree;
+}
+
+unsigned long BufferPool::NumMisses() const
+{
+	return _numMisses;
+}
+
+float* BufferPool::NextReturned(float* page)
+{
+	float* next = nullptr;
+	std::memcpy(&next, page, sizeof(next));
+
+	return next;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+namespace audio
+{
+	// Pool of preallocated, zeroed pages for BufferBank.
+	// Acquire and Release never block, allocate or free, so are
+	// safe to call from the audio thread. Acquire comes back
+	// empty if the pool has run dry. Returned pages are chained
+	// through their own first bytes until Refill, which does all
+	// the allocating and freeing from a background thread.
+	class BufferPool
+	{
+	public:
+		BufferPool(unsigned int pageSize, unsigned int numPages);
+		~BufferPool();
+
+		// Copy
+		BufferPool(const BufferPool&) = delete;
+		BufferPool& operator=(const BufferPool&) = delete;
+
+	public:
+		std::unique_ptr<float[]> Acquire();
+		// As Acquire, but allocates if the pool has run dry,
+		// so only for threads that can wait (e.g. loading)
+		std::unique_ptr<float[]> Allocate();
+		void Release(std::unique_ptr<float[]> page);
+		void Refill();
+		unsigned int PageSize() const;
+		unsigned int NumFree() const;
+		// Acquires that found the pool dry
+		unsigned long NumMisses() const;
+
+	protected:
+		static float* NextReturned(float* page);
+
+	protected:
+		unsigned int _pageSize;
+		std::atomic<unsigned long> _numMisses;
+		std::vector<std::atomic<float*>> _freePages;
+		std::atomic<float*> _returnedPages;
+	};
+}
@@ -5,7 +5,8 @@ using namespace base;
 
 ChannelMixer::ChannelMixer(ChannelMixerParams chanMixParams) :
 	_adcMixer(std::make_shared<ChannelMixer::AdcChannelMixer>()),
-	_dacMixer(std::make_shared<ChannelMixer::DacChannelMixer>())
+	_dacMixer(std::make_shared<ChannelMixer::DacChannelMixer>()),
+	_channelBuffer(std::vector<float>(constants::MaxBlockSize, 0.0f))
 {
 	SetParams(chanMixParams);
 }
@@ -16,8 +17,10 @@ ChannelMixer::~ChannelMixer()
 
 void ChannelMixer::SetParams(ChannelMixerParams chanMixParams)
 {
-	_adcMixer->SetNumChannels(chanMixParams.NumInputChannels, chanMixParams.InputBufferSize);
-	_dacMixer->SetNumChannels(chanMixParams.NumOutputChannels, chanMixParams.OutputBufferSize);
+	// Input rings keep their exact size, as InitPlay's
+	// delay is clamped to it and so sets the input latency
+	_adcMixer->SetNumChannels(chanMixParams.NumInputChannels, chanMixParams.InputBufferSize, AudioBuffer::SIZE_EXACT);
+	_dacMixer->SetNumChannels(chanMixParams.NumOutputChannels, chanMixParams.OutputBufferSize, AudioBuffer::SIZE_POWEROFTWO);
 }
 
 void ChannelMixer::FromAdc(float* inBuf, unsigned int numChannels, unsigned int numSamps)
@@ -25,22 +28,37 @@ void ChannelMixer::FromAdc(float* inBuf, unsigned int numChannels, unsigned int
 	if (numSamps < 1 || numChannels < 1)
 		return;
 
-	for (auto chan = 0u; chan < _adcMixer->NumOutputChannels(); chan++)
+	// Deinterleaves straight into the ring buffers, splitting
+	// the block wherever any of the channels wraps
+	auto numAdcChannels = std::min(numChannels, _adcMixer->NumOutputChannels());
+	std::array<float*, MixKernels::MaxChannels> dests;
+
+	for (auto firstChan = 0u; firstChan < numAdcChannels; firstChan += MixKernels::MaxChannels)
 	{
-		auto buf = _adcMixer->Channel(chan);
+		auto numGroupChannels = (numAdcChannels - firstChan) < MixKernels::MaxChannels ? (numAdcChannels - firstChan) : MixKernels::MaxChannels;
+		auto samp = 0u;
 
-		if ((buf) && (numChannels > chan))
+		while (samp < numSamps)
 		{
-			auto currentOffset = 0;
+			auto blockSamps = numSamps - samp;
 
-			for (auto samp = 0u; samp < numSamps; samp++)
+			for (auto chan = 0u; chan < numGroupChannels; chan++)
 			{
-				currentOffset = buf->OnOverwrite(inBuf[samp*numChannels + chan], currentOffset);
+				auto [dest, contiguousSamps] = _adcMixer->Channel(firstChan + chan)->WriteSpan(samp, blockSamps);
+				dests[chan] = dest;
+				blockSamps = std::min(blockSamps, contiguousSamps);
 			}
 
-			buf->EndWrite(numSamps, true);
+			if (0 == blockSamps)
+				break;
+
+			MixKernels::Deinterleave(inBuf + samp * numChannels + firstChan, numChannels, dests.data(), numGroupChannels, blockSamps);
+			samp += blockSamps;
 		}
 	}
+
+	for (auto chan = 0u; chan < numAdcChannels; chan++)
+		_adcMixer->Channel(chan)->EndWrite(numSamps, true);
 }
 
 void ChannelMixer::InitPlay(unsigned int delaySamps, unsigned int blockSize)
@@ -56,38 +74,88 @@ void ChannelMixer::InitPlay(unsigned int delaySamps, unsigned int blockSize)
 
 void ChannelMixer::ToDac(float* outBuf, unsigned int numChannels, unsigned int numSamps)
 {
-	if (numSamps < 1 || numChannels < 1)
+	// Reading a sample clears it, so the sink is already
+	// silent by the time the ring comes back round to it
+	auto numDacChannels = _dacMixer->NumInputChannels();
+
+	if ((nullptr == outBuf) || (numChannels < 1))
+	{
+		for (auto chan = 0u; chan < numDacChannels; chan++)
+			_dacMixer->Channel(chan)->Zero(numSamps);
+
 		return;
+	}
+
+	for (auto chan = numChannels; chan < numDacChannels; chan++)
+		_dacMixer->Channel(chan)->Zero(numSamps);
 
-	for (auto chan = 0u; chan < _dacMixer->NumInputChannels(); chan++)
+	// Output channels with no sink are filled from
+	// _channelBuffer, which is kept silent
+	std::array<float*, MixKernels::MaxChannels> srcs;
+
+	for (auto firstChan = 0u; firstChan < numChannels; firstChan += MixKernels::MaxChannels)
 	{
-		auto buf = _dacMixer->Channel(chan);
+		auto numGroupChannels = (numChannels - firstChan) < MixKernels::MaxChannels ? (numChannels - firstChan) : MixKernels::MaxChannels;
+		auto samp = 0u;
 
-		if (buf)
+		while (samp < numSamps)
 		{
-			if ((numChannels > chan) && (buf->BufSize() > 0))
+			auto blockSamps = std::min(numSamps - samp, (unsigned int)_channelBuffer.size());
+
+			for (auto chan = 0u; chan < numGroupChannels; chan++)
 			{
-				auto bufIter = buf->Delay(0);
-				for (auto samp = 0u; samp < numSamps; samp++)
+				auto dacChan = firstChan + chan;
+				srcs[chan] = _channelBuffer.data();
+
+				if (dacChan < numDacChannels)
 				{
-					if (bufIter == buf->End())
-						bufIter = buf->Start();
+					auto [src, contiguousSamps] = _dacMixer->Channel(dacChan)->WriteSpan(samp, blockSamps);
 
-					outBuf[samp * numChannels + chan] = *bufIter++;
+					if (nullptr != src)
+					{
+						srcs[chan] = src;
+						blockSamps = std::min(blockSamps, contiguousSamps);
+					}
 				}
 			}
+
+			if (0 == blockSamps)
+				break;
+
+			MixKernels::Interleave(srcs.data(), numGroupChannels, outBuf + samp * numChannels + firstChan, numChannels, blockSamps, true);
+			samp += blockSamps;
 		}
 	}
 }
 
-void ChannelMixer::BufferMixer::SetNumChannels(unsigned int numChans, unsigned int bufSize)
+void ChannelMixer::MixBus(const std::shared_ptr<ChannelMixer> bus, unsigned int numSamps)
+{
+	// Adds the block most recently written to the bus's
+	// sink into this mixer's sink, channel by channel
+	auto numChannels = std::min(_dacMixer->NumInputChannels(), bus->_dacMixer->NumInputChannels());
+
+	for (auto chan = 0u; chan < numChannels; chan++)
+	{
+		auto spans = bus->_dacMixer->Channel(chan)->WriteSpans(0, numSamps);
+		if (nullptr == spans.First)
+			continue;
+
+		auto dest = _dacMixer->Channel(chan);
+		auto destIndex = dest->OnWriteBlock(spans.First, spans.NumFirst, 0);
+
+		if (spans.NumSecond > 0)
+			dest->OnWriteBlock(spans.Second, spans.NumSecond, destIndex);
+	}
+}
+
+void ChannelMixer::BufferMixer::SetNumChannels(unsigned int numChans, unsigned int bufSize, AudioBuffer::SizeMode sizeMode)
 {
 	auto numInputs = (unsigned int)_buffers.size();
 
 	if (numChans > numInputs)
 	{
 		for (auto i = 0u; i < numChans - numInputs; i++)
-			_buffers.push_back(std::make_unique<AudioBuffer>(bufSize));
+			_buffers.push_back(std::make_unique<AudioBuffer>(bufSize, sizeMode));
 	}
 
 	if (numChans < numInputs)
@@ -125,6 +193,52 @@ void ChannelMixer::DacChannelMixer::EndMultiWrite(unsigned int numSamps, bool up
 	}
 }
 
+void ChannelMixer::DacChannelMixer::OnMixChannels(const float* samps,
+	const float* gains,
+	const unsigned int* channels,
+	const float* levels,
+	unsigned int numChannels,
+	unsigned int numSamps,
+	unsigned int indexOffset)
+{
+	std::array<float*, MixKernels::MaxChannels> dests;
+	std::array<float, MixKernels::MaxChannels> destLevels;
+
+	for (auto firstRoute = 0u; firstRoute < numChannels; firstRoute += MixKernels::MaxChannels)
+	{
+		auto lastRoute = std::min(numChannels, firstRoute + MixKernels::MaxChannels);
+		auto samp = 0u;
+
+		while (samp < numSamps)
+		{
+			auto blockSamps = numSamps - samp;
+			auto numDests = 0u;
+
+			for (auto route = firstRoute; route < lastRoute; route++)
+			{
+				if (channels[route] >= _buffers.size())
+					continue;
+
+				auto [dest, contiguousSamps] = _buffers[channels[route]]->WriteSpan(indexOffset + samp, blockSamps);
+				if (nullptr == dest)
+					continue;
+
+				dests[numDests] = dest;
+				destLevels[numDests] = levels[route];
+				numDests++;
+
+				blockSamps = std::min(blockSamps, contiguousSamps);
+			}
+
+			if (0 == numDests)
+				break;
+
+			MixKernels::MixRamped(dests.data(), destLevels.data(), numDests, samps + samp, gains + samp, blockSamps);
+			samp += blockSamps;
+		}
+	}
+}
+
 unsigned int ChannelMixer::DacChannelMixer::NumInputChannels() const
 {
 	return (unsigned int)_buffers.size();
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
 #include "MultiAudioSource.h"
 #include "MultiAudioSink.h"
 #include "AudioBuffer.h"
+#include "MixKernels.h"
 
 namespace audio
 {
@@ -21,7 +23,7 @@ namespace audio
 		class BufferMixer
 		{
 		public:
-			void SetNumChannels(unsigned int numChans, unsigned int bufSize);
+			void SetNumChannels(unsigned int numChans, unsigned int bufSize, AudioBuffer::SizeMode sizeMode);
 			const std::shared_ptr<audio::AudioBuffer> Channel(unsigned int channel);
 
 		protected:
@@ -46,6 +48,13 @@ namespace audio
 		public:
 			virtual void EndMultiWrite(unsigned int numSamps) override;
 			virtual void EndMultiWrite(unsigned int numSamps, bool updateIndex) override;
+			virtual void OnMixChannels(const float* samps,
+				const float* gains,
+				const unsigned int* channels,
+				const float* levels,
+				unsigned int numChannels,
+				unsigned int numSamps,
+				unsigned int indexOffset) override;
 			virtual unsigned int NumInputChannels() const override;
 
 		protected:
@@ -60,15 +69,17 @@ namespace audio
 		void SetParams(ChannelMixerParams chanMixParams);
 		void FromAdc(float* inBuf, unsigned int numChannels, unsigned int numSamps);
 		void ToDac(float* outBuf, unsigned int numChannels, unsigned int numSamps);
+		void MixBus(const std::shared_ptr<ChannelMixer> bus, unsigned int numSamps);
 		const std::shared_ptr<base::MultiAudioSource> Source();
 		const std::shared_ptr<base::MultiAudioSink> Sink();
 		void InitPlay(unsigned int delaySamps, unsigned int blockSize);
 
 	public:
-		static const unsigned int DefaultBufferSize = 3000;
+		static const unsigned int DefaultBufferSize = 4096; // Output rings are rounded up to a power of two
 
 	protected:
 		std::shared_ptr<AdcChannelMixer> _adcMixer;
 		std::shared_ptr<DacChannelMixer> _dacMixer;
+		std::vector<float> _channelBuffer;
 	};
 }
@@ -17,6 +17,11 @@ double InterpolatedValue::Current() const
 	return _target;
 }
 
+double InterpolatedValue::Target() const
+{
+	return _target;
+}
+
 void InterpolatedValue::SetTarget(double target)
 {
 	_target = target;
@@ -65,6 +70,11 @@ double InterpolatedValueLinear::Current() const
 	return _lastVal;
 }
 
+double InterpolatedValueLinear::Target() const
+{
+	return _endVal;
+}
+
 void InterpolatedValueLinear::SetTarget(double target)
 {
 	if (_endVal != target)
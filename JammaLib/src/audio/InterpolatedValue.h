@@ -19,6 +19,7 @@ namespace audio
 	public:
 		virtual double Next();
 		virtual double Current() const;
+		virtual double Target() const;
 		virtual void SetTarget(double target);
 
 	protected:
@@ -41,6 +42,7 @@ namespace audio
 	public:
 		virtual double Next() override;
 		virtual double Current() const;
+		virtual double Target() const override;
 		virtual void SetTarget(double target) override;
 
 	protected:
@@ -0,0 +1,604 @@
+#include "LosslessCodec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace audio;
+
+namespace
+{
+	enum FrameType
+	{
+		FRAME_CONSTANT,
+		FRAME_FIXED,
+		FRAME_VERBATIM
+	};
+
+	const unsigned int FrameTypeBits = 2u;
+	const unsigned int MaxOrder = 4u;
+	const unsigned int PartitionSamps = 256u;
+	const unsigned int NumPartitions = (LosslessEncoder::FrameSamps + PartitionSamps - 1u) / PartitionSamps;
+	const unsigned int EscapeParam = 31u; // Partition held as raw 32-bit values
+	const unsigned int MaxQuotient = 255u;
+	const float IntScale = 8388608.0f; // 2^23, so 24-bit sources map to integers
+	const float IntLimit = 16777216.0f;
+
+	unsigned int CountTrailingZeros(std::uint64_t value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return (unsigned int)index;
+#else
+		return (unsigned int)__builtin_ctzll(value);
+#endif
+	}
+
+	std::uint32_t FloatBits(float samp)
+	{
+		std::uint32_t bits;
+		std::memcpy(&bits, &samp, sizeof(bits));
+		return bits;
+	}
+
+	float BitsFloat(std::uint32_t bits)
+	{
+		float samp;
+		std::memcpy(&samp, &bits, sizeof(samp));
+		return samp;
+	}
+
+	std::uint32_t ReadU32(const std::uint8_t* data)
+	{
+		return (std::uint32_t)data[0] |
+			((std::uint32_t)data[1] << 8) |
+			((std::uint32_t)data[2] << 16) |
+			((std::uint32_t)data[3] << 24);
+	}
+
+	void WriteU32(std::uint8_t* data, std::uint32_t value)
+	{
+		for (auto i = 0u; i < 4u; i++)
+			data[i] = (std::uint8_t)(value >> (8u * i));
+	}
+
+	std::size_t HeaderBytes(unsigned int numFrames)
+	{
+		return 8u + 4u * ((std::size_t)numFrames + 1u);
+	}
+
+	std::uint32_t ZigZag(std::int32_t value)
+	{
+		return ((std::uint32_t)value << 1) ^ (std::uint32_t)(value >> 31);
+	}
+
+	std::int32_t UnZigZag(std::uint32_t value)
+	{
+		return (std::int32_t)(value >> 1) ^ -(std::int32_t)(value & 1u);
+	}
+
+	std::int32_t Predict(const std::int32_t* ints, unsigned int order)
+	{
+		switch (order)
+		{
+		case 1:
+			return ints[-1];
+		case 2:
+			return 2 * ints[-1] - ints[-2];
+		case 3:
+			return 3 * ints[-1] - 3 * ints[-2] + ints[-3];
+		case 4:
+			return 4 * ints[-1] - 6 * ints[-2] + 4 * ints[-3] - ints[-4];
+		}
+
+		return 0;
+	}
+
+	// Bits are packed from the least significant end
+	class BitWriter
+	{
+	public:
+		BitWriter(std::vector<std::uint8_t>& data) :
+			_data(data),
+			_acc(0u),
+			_numBits(0u)
+		{
+		}
+
+		// Up to 32 bits, with nothing set above them
+		void Write(std::uint32_t value, unsigned int numBits)
+		{
+			_acc |= (std::uint64_t)value << _numBits;
+			_numBits += numBits;
+
+			while (_numBits >= 8u)
+			{
+				_data.push_back((std::uint8_t)_acc);
+				_acc >>= 8;
+				_numBits -= 8u;
+			}
+		}
+
+		// q zeros then a one
+		void WriteUnary(unsigned int q)
+		{
+			while (q >= 32u)
+			{
+				Write(0u, 32u);
+				q -= 32u;
+			}
+
+			Write(1u << q, q + 1u);
+		}
+
+		void Flush()
+		{
+			if (_numBits > 0u)
+				_data.push_back((std::uint8_t)_acc);
+
+			_acc = 0u;
+			_numBits = 0u;
+		}
+
+	protected:
+		std::vector<std::uint8_t>& _data;
+		std::uint64_t _acc;
+		unsigned int _numBits;
+	};
+
+	class BitReader
+	{
+	public:
+		BitReader(const std::uint8_t* data, const std::uint8_t* end) :
+			_data(data),
+			_end(end),
+			_acc(0u),
+			_numBits(0u)
+		{
+		}
+
+		bool Read(unsigned int numBits, std::uint32_t& value)
+		{
+			Refill();
+
+			if (_numBits < numBits)
+				return false;
+
+			value = (std::uint32_t)(_acc & ((1ull << numBits) - 1u));
+			Consume(numBits);
+
+			return true;
+		}
+
+		bool ReadUnary(std::uint32_t& q)
+		{
+			q = 0u;
+
+			while (q <= MaxQuotient)
+			{
+				Refill();
+
+				if (0u == _numBits)
+					return false;
+
+				// Nothing is held above _numBits
+				if (0u != _acc)
+				{
+					auto zeros = CountTrailingZeros(_acc);
+					q += zeros;
+					Consume(zeros + 1u);
+
+					return q <= MaxQuotient;
+				}
+
+				q += _numBits;
+				Consume(_numBits);
+			}
+
+			return false;
+		}
+
+	protected:
+		void Refill()
+		{
+			while ((_numBits <= 56u) && (_data < _end))
+			{
+				_acc |= (std::uint64_t)*_data++ << _numBits;
+				_numBits += 8u;
+			}
+		}
+
+		void Consume(unsigned int numBits)
+		{
+			_acc = numBits >= 64u ? 0u : _acc >> numBits;
+			_numBits -= numBits;
+		}
+
+	protected:
+		const std::uint8_t* _data;
+		const std::uint8_t* _end;
+		std::uint64_t _acc;
+		unsigned int _numBits;
+	};
+
+	// Picks the Rice parameter with the fewest bits, or the
+	// escape if any value would need too long a quotient
+	unsigned int RiceParam(const std::uint32_t* residuals, unsigned int numResiduals, std::uint64_t& numBits)
+	{
+		std::uint64_t sum = 0u;
+		std::uint32_t maxResidual = 0u;
+
+		for (auto i = 0u; i < numResiduals; i++)
+		{
+			sum += residuals[i];
+			maxResidual = std::max(maxResidual, residuals[i]);
+		}
+
+		auto mean = sum / std::max(numResiduals, 1u);
+		auto estimate = 0u;
+		while ((estimate < 30u) && ((2ull << estimate) <= mean))
+			estimate++;
+
+		auto bestParam = EscapeParam;
+		numBits = 32ull * numResiduals;
+
+		for (auto param = estimate > 0u ? estimate - 1u : 0u; param <= std::min(estimate + 1u, 30u); param++)
+		{
+			if ((maxResidual >> param) > MaxQuotient)
+				continue;
+
+			std::uint64_t paramBits = (std::uint64_t)(param + 1u) * numResiduals;
+			for (auto i = 0u; i < numResiduals; i++)
+				paramBits += residuals[i] >> param;
+
+			if (paramBits < numBits)
+			{
+				bestParam = param;
+				numBits = paramBits;
+			}
+		}
+
+		numBits += 5u;
+		return bestParam;
+	}
+}
+
+LosslessEncoder::LosslessEncoder(unsigned long numSamps) :
+	_numSamps(numSamps),
+	_numWritten(0ul),
+	_numFrames((unsigned int)((numSamps + FrameSamps - 1ul) / FrameSamps)),
+	_frameSamps(0u),
+	_frame(FrameSamps),
+	_data()
+{
+	// Most recordings pack to around half,
+	// so reserve that to save regrowing
+	_data.reserve(HeaderBytes(_numFrames) + numSamps * 2ul);
+	_data.resize(HeaderBytes(_numFrames), 0u);
+
+	WriteU32(_data.data(), (std::uint32_t)numSamps);
+	WriteU32(_data.data() + 4, _numFrames);
+}
+
+void LosslessEncoder::Write(const float* samps, unsigned int numSamps)
+{
+	while ((numSamps > 0u) && (_numWritten < _numSamps))
+	{
+		auto copySamps = (unsigned int)std::min({ (unsigned long)numSamps,
+			(unsigned long)(FrameSamps - _frameSamps),
+			_numSamps - _numWritten });
+
+		std::copy(samps, samps + copySamps, _frame.data() + _frameSamps);
+		samps += copySamps;
+		numSamps -= copySamps;
+		_frameSamps += copySamps;
+		_numWritten += copySamps;
+
+		if ((FrameSamps == _frameSamps) || (_numWritten == _numSamps))
+		{
+			auto frame = (unsigned int)((_numWritten - _frameSamps) / FrameSamps);
+			WriteU32(_data.data() + 8 + 4 * frame, (std::uint32_t)_data.size());
+
+			EncodeFrame(_frame.data(), _frameSamps);
+			_frameSamps = 0u;
+		}
+	}
+}
+
+std::vector<std::uint8_t> LosslessEncoder::Finish()
+{
+	if ((_numWritten != _numSamps) || (_data.size() > UINT32_MAX))
+		return {};
+
+	WriteU32(_data.data() + 8 + 4 * _numFrames, (std::uint32_t)_data.size());
+
+	// Copied so only what is used stays allocated
+	return std::vector<std::uint8_t>(_data.begin(), _data.end());
+}
+
+void LosslessEncoder::EncodeFrame(const float* samps, unsigned int numSamps)
+{
+	BitWriter writer(_data);
+
+	auto first = FloatBits(samps[0]);
+	auto isConstant = true;
+
+	for (auto samp = 1u; isConstant && (samp < numSamps); samp++)
+		isConstant = FloatBits(samps[samp]) == first;
+
+	if (isConstant)
+	{
+		writer.Write(FRAME_CONSTANT, FrameTypeBits);
+		writer.Write(first, 32u);
+		writer.Flush();
+		return;
+	}
+
+	// Integers only when the float maps back exactly
+	// (so no fractions, nans, infinities or negative zeros)
+	std::int32_t ints[FrameSamps];
+	std::uint32_t orBits = 0u;
+	auto isInteger = true;
+
+	for (auto samp = 0u; isInteger && (samp < numSamps); samp++)
+	{
+		auto scaled = samps[samp] * IntScale;
+		isInteger = std::fabs(scaled) < IntLimit;
+
+		if (isInteger)
+		{
+			ints[samp] = (std::int32_t)scaled;
+			isInteger = ((float)ints[samp] == scaled) && !((0 == ints[samp]) && std::signbit(samps[samp]));
+			orBits |= (std::uint32_t)ints[samp];
+		}
+	}
+
+	std::uint64_t verbatimBits = 32ull * numSamps;
+
+	if (isInteger)
+	{
+		// Low bits unused by the source, as from 16-bit audio
+		auto shift = 0u != orBits ? CountTrailingZeros(orBits) : 0u;
+
+		for (auto samp = 0u; samp < numSamps; samp++)
+			ints[samp] >>= shift;
+
+		// The fixed predictor with the smallest residuals
+		std::uint64_t orderSums[MaxOrder + 1u] = {};
+		auto maxOrder = std::min(MaxOrder, numSamps - 1u);
+
+		for (auto samp = maxOrder; samp < numSamps; samp++)
+		{
+			for (auto order = 0u; order <= maxOrder; order++)
+				orderSums[order] += (std::uint64_t)std::llabs((long long)ints[samp] - Predict(ints + samp, order));
+		}
+
+		auto order = 0u;
+		for (auto candidate = 1u; candidate <= maxOrder; candidate++)
+		{
+			if (orderSums[candidate] < orderSums[order])
+				order = candidate;
+		}
+
+		std::uint32_t residuals[FrameSamps];
+		auto numResiduals = numSamps - order;
+
+		for (auto samp = order; samp < numSamps; samp++)
+			residuals[samp - order] = ZigZag(ints[samp] - Predict(ints + samp, order));
+
+		unsigned int params[NumPartitions];
+		std::uint64_t fixedBits = 5u + 3u + 32ull * order;
+
+		for (auto partition = 0u; partition * PartitionSamps < numResiduals; partition++)
+		{
+			auto partitionSamps = std::min(PartitionSamps, numResiduals - partition * PartitionSamps);
+			std::uint64_t partitionBits = 0u;
+			params[partition] = RiceParam(residuals + partition * PartitionSamps, partitionSamps, partitionBits);
+			fixedBits += partitionBits;
+		}
+
+		if (fixedBits < verbatimBits)
+		{
+			writer.Write(FRAME_FIXED, FrameTypeBits);
+			writer.Write(shift, 5u);
+			writer.Write(order, 3u);
+
+			for (auto samp = 0u; samp < order; samp++)
+				writer.Write((std::uint32_t)ints[samp], 32u);
+
+			for (auto partition = 0u; partition * PartitionSamps < numResiduals; partition++)
+			{
+				auto param = params[partition];
+				auto start = partition * PartitionSamps;
+				auto end = std::min(start + PartitionSamps, numResiduals);
+
+				writer.Write(param, 5u);
+
+				for (auto i = start; i < end; i++)
+				{
+					if (EscapeParam == param)
+						writer.Write(residuals[i], 32u);
+					else
+					{
+						writer.WriteUnary(residuals[i] >> param);
+
+						if (param > 0u)
+							writer.Write(residuals[i] & ((1u << param) - 1u), param);
+					}
+				}
+			}
+
+			writer.Flush();
+			return;
+		}
+	}
+
+	writer.Write(FRAME_VERBATIM, FrameTypeBits);
+
+	for (auto samp = 0u; samp < numSamps; samp++)
+		writer.Write(FloatBits(samps[samp]), 32u);
+
+	writer.Flush();
+}
+
+unsigned int LosslessDecoder::Read(const std::uint8_t* data,
+	std::size_t numBytes,
+	unsigned long index,
+	float* out,
+	unsigned int numSamps)
+{
+	if (numBytes < HeaderBytes(0u))
+		return 0u;
+
+	auto totalSamps = (unsigned long)ReadU32(data);
+	auto numFrames = ReadU32(data + 4);
+
+	if ((numBytes < HeaderBytes(numFrames)) ||
+		((totalSamps + LosslessEncoder::FrameSamps - 1ul) / LosslessEncoder::FrameSamps != numFrames))
+		return 0u;
+
+	float frame[LosslessEncoder::FrameSamps];
+	auto numRead = 0u;
+
+	while ((numRead < numSamps) && (index < totalSamps))
+	{
+		auto frameIndex = (unsigned int)(index / LosslessEncoder::FrameSamps);
+		auto frameStart = (unsigned long)frameIndex * LosslessEncoder::FrameSamps;
+		auto offset = (unsigned int)(index - frameStart);
+		auto frameSamps = (unsigned int)std::min((unsigned long)LosslessEncoder::FrameSamps, totalSamps - frameStart);
+		auto blockSamps = std::min(numSamps - numRead, frameSamps - offset);
+
+		auto begin = ReadU32(data + 8 + 4 * frameIndex);
+		auto end = ReadU32(data + 12 + 4 * frameIndex);
+
+		if ((begin > end) || (end > numBytes))
+			break;
+
+		// Frames decode from their start, so a
+		// partial one goes through the scratch frame
+		if (0u == offset)
+		{
+			if (!DecodeFrame(data + begin, end - begin, out + numRead, blockSamps))
+				break;
+		}
+		else
+		{
+			if (!DecodeFrame(data + begin, end - begin, frame, offset + blockSamps))
+				break;
+
+			std::copy(frame + offset, frame + offset + blockSamps, out + numRead);
+		}
+
+		numRead += blockSamps;
+		index += blockSamps;
+	}
+
+	return numRead;
+}
+
+unsigned long LosslessDecoder::NumSamps(const std::uint8_t* data, std::size_t numBytes)
+{
+	return numBytes >= HeaderBytes(0u) ? (unsigned long)ReadU32(data) : 0ul;
+}
+
+bool LosslessDecoder::DecodeFrame(const std::uint8_t* data,
+	std::size_t numBytes,
+	float* out,
+	unsigned int numSamps)
+{
+	BitReader reader(data, data + numBytes);
+	std::uint32_t frameType = 0u;
+
+	if (!reader.Read(FrameTypeBits, frameType))
+		return false;
+
+	switch (frameType)
+	{
+	case FRAME_CONSTANT:
+	{
+		std::uint32_t bits = 0u;
+		if (!reader.Read(32u, bits))
+			return false;
+
+		std::fill(out, out + numSamps, BitsFloat(bits));
+		return true;
+	}
+	case FRAME_VERBATIM:
+	{
+		for (auto samp = 0u; samp < numSamps; samp++)
+		{
+			std::uint32_t bits = 0u;
+			if (!reader.Read(32u, bits))
+				return false;
+
+			out[samp] = BitsFloat(bits);
+		}
+
+		return true;
+	}
+	case FRAME_FIXED:
+	{
+		std::uint32_t shift = 0u;
+		std::uint32_t order = 0u;
+
+		if (!reader.Read(5u, shift) || !reader.Read(3u, order) || (shift > 23u) || (order > MaxOrder))
+			return false;
+
+		std::int32_t ints[LosslessEncoder::FrameSamps];
+		auto numWarmup = std::min((unsigned int)order, numSamps);
+
+		for (auto samp = 0u; samp < numWarmup; samp++)
+		{
+			std::uint32_t bits = 0u;
+			if (!reader.Read(32u, bits))
+				return false;
+
+			ints[samp] = (std::int32_t)bits;
+		}
+
+		std::uint32_t param = 0u;
+
+		for (auto samp = numWarmup; samp < numSamps; samp++)
+		{
+			if (0u == (samp - order) % PartitionSamps)
+			{
+				if (!reader.Read(5u, param))
+					return false;
+			}
+
+			std::uint32_t residual = 0u;
+
+			if (EscapeParam == param)
+			{
+				if (!reader.Read(32u, residual))
+					return false;
+			}
+			else
+			{
+				std::uint32_t q = 0u;
+				std::uint32_t low = 0u;
+
+				if (!reader.ReadUnary(q) || !reader.Read(param, low))
+					return false;
+
+				residual = (q << param) | low;
+			}
+
+			ints[samp] = UnZigZag(residual) + Predict(ints + samp, order);
+		}
+
+		auto scale = (float)(1u << shift) / IntScale;
+
+		for (auto samp = 0u; samp < numSamps; samp++)
+			out[samp] = (float)ints[samp] * scale;
+
+		return true;
+	}
+	}
+
+	return false;
+}
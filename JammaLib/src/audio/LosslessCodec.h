@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace audio
+{
+	// Lossless packing of a loop's samples, FLAC-style. Each
+	// frame is predicted with a fixed polynomial (order 0-4)
+	// and the residuals Rice coded in partitions. Floats that
+	// came from an integer source of up to 24 bits pack well,
+	// any other frame is kept verbatim so nothing is lost.
+	//
+	//   header  num samps, num frames, then the byte offset
+	//           of each frame and of the end (u32, little-endian)
+	//   frames  bit-packed, starting on a byte boundary
+	//
+	// Frames can be decoded on their own, so reads can start
+	// anywhere.
+	class LosslessEncoder
+	{
+	public:
+		LosslessEncoder(unsigned long numSamps);
+
+		// Copy
+		LosslessEncoder(const LosslessEncoder&) = delete;
+		LosslessEncoder& operator=(const LosslessEncoder&) = delete;
+
+	public:
+		// Samples arrive in order, in spans of any size
+		void Write(const float* samps, unsigned int numSamps);
+		// Empty unless every sample was written
+		std::vector<std::uint8_t> Finish();
+
+		static const unsigned int FrameSamps = 2048u;
+
+	protected:
+		void EncodeFrame(const float* samps, unsigned int numSamps);
+
+	protected:
+		unsigned long _numSamps;
+		unsigned long _numWritten;
+		unsigned int _numFrames;
+		unsigned int _frameSamps;
+		std::vector<float> _frame;
+		std::vector<std::uint8_t> _data;
+	};
+
+	class LosslessDecoder
+	{
+	public:
+		// Decodes the samples from index on, returning how many
+		// were read (fewer at the end, none if data is corrupt)
+		static unsigned int Read(const std::uint8_t* data,
+			std::size_t numBytes,
+			unsigned long index,
+			float* out,
+			unsigned int numSamps);
+		static unsigned long NumSamps(const std::uint8_t* data, std::size_t numBytes);
+
+	protected:
+		static bool DecodeFrame(const std::uint8_t* data,
+			std::size_t numBytes,
+			float* out,
+			unsigned int numSamps);
+	};
+}
@@ -0,0 +1,635 @@
+#include "MixKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace audio;
+
+namespace
+{
+	float HalfBitsToFloat(std::uint16_t half)
+	{
+		// Exponent and mantissa move up into place, then the
+		// exponent is rebiased (denormals renormalised by a
+		// subtract, and infinity/nan kept at the top)
+		const std::uint32_t shiftedExp = 0x7C00u << 13;
+
+		std::uint32_t bits = ((std::uint32_t)half & 0x7FFFu) << 13;
+		auto exp = bits & shiftedExp;
+		bits += (127u - 15u) << 23;
+
+		if (shiftedExp == exp)
+			bits += (128u - 16u) << 23;
+		else if (0u == exp)
+		{
+			const std::uint32_t magicBits = 113u << 23;
+			float magic;
+			std::memcpy(&magic, &magicBits, sizeof(magic));
+
+			bits += 1u << 23;
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			value -= magic;
+			std::memcpy(&bits, &value, sizeof(bits));
+		}
+
+		bits |= ((std::uint32_t)half & 0x8000u) << 16;
+
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	std::uint16_t FloatToHalfBits(float value)
+	{
+		const std::uint32_t infBits = 255u << 23;
+		const std::uint32_t halfMaxBits = (127u + 16u) << 23;
+		const std::uint32_t denormMagicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+		std::uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		auto sign = bits & 0x80000000u;
+		bits ^= sign;
+
+		std::uint16_t half;
+
+		if (bits >= halfMaxBits)
+			half = bits > infBits ? 0x7E00u : 0x7C00u;
+		else if (bits < (113u << 23))
+		{
+			// Float addition rounds the mantissa into
+			// place, to nearest even, for denormals
+			float denormMagic;
+			std::memcpy(&denormMagic, &denormMagicBits, sizeof(denormMagic));
+
+			float absValue;
+			std::memcpy(&absValue, &bits, sizeof(absValue));
+			absValue += denormMagic;
+			std::memcpy(&bits, &absValue, sizeof(bits));
+
+			half = (std::uint16_t)(bits - denormMagicBits);
+		}
+		else
+		{
+			auto isMantissaOdd = (bits >> 13) & 1u;
+			bits += ((std::uint32_t)(15 - 127) << 23) + 0xFFFu;
+			bits += isMantissaOdd;
+			half = (std::uint16_t)(bits >> 13);
+		}
+
+		return half | (std::uint16_t)(sign >> 16);
+	}
+}
+
+void MixKernels::MixRamped(float* const* dests,
+	const float* levels,
+	unsigned int numChannels,
+	const float* samps,
+	const float* gains,
+	unsigned int numSamps)
+{
+	switch (numChannels)
+	{
+	case 0:
+		break;
+	case 1:
+		_MixRamped<1>(dests, levels, numChannels, samps, gains, numSamps);
+		break;
+	case 2:
+		_MixRamped<2>(dests, levels, numChannels, samps, gains, numSamps);
+		break;
+	case 4:
+		_MixRamped<4>(dests, levels, numChannels, samps, gains, numSamps);
+		break;
+	case 8:
+		_MixRamped<8>(dests, levels, numChannels, samps, gains, numSamps);
+		break;
+	case 16:
+		_MixRamped<16>(dests, levels, numChannels, samps, gains, numSamps);
+		break;
+	case 32:
+		_MixRamped<32>(dests, levels, numChannels, samps, gains, numSamps);
+		break;
+	default:
+		_MixRamped<0>(dests, levels, numChannels, samps, gains, numSamps);
+		break;
+	}
+}
+
+// NumChannels of zero means the channel count is only known at runtime
+template<unsigned int NumChannels>
+void MixKernels::_MixRamped(float* const* dests,
+	const float* levels,
+	unsigned int numChannels,
+	const float* samps,
+	const float* gains,
+	unsigned int numSamps)
+{
+	const auto numChans = NumChannels > 0u ? NumChannels : numChannels;
+	auto samp = 0u;
+
+#if defined(JAMMA_MIX_AVX2)
+	for (; samp + 8u <= numSamps; samp += 8u)
+	{
+		auto in = _mm256_mul_ps(_mm256_loadu_ps(samps + samp), _mm256_loadu_ps(gains + samp));
+
+		for (auto chan = 0u; chan < numChans; chan++)
+		{
+			auto dest = dests[chan] + samp;
+			auto out = _mm256_add_ps(_mm256_loadu_ps(dest), _mm256_mul_ps(in, _mm256_set1_ps(levels[chan])));
+			_mm256_storeu_ps(dest, out);
+		}
+	}
+#elif defined(JAMMA_MIX_SSE)
+	for (; samp + 4u <= numSamps; samp += 4u)
+	{
+		auto in = _mm_mul_ps(_mm_loadu_ps(samps + samp), _mm_loadu_ps(gains + samp));
+
+		for (auto chan = 0u; chan < numChans; chan++)
+		{
+			auto dest = dests[chan] + samp;
+			auto out = _mm_add_ps(_mm_loadu_ps(dest), _mm_mul_ps(in, _mm_set1_ps(levels[chan])));
+			_mm_storeu_ps(dest, out);
+		}
+	}
+#elif defined(JAMMA_MIX_NEON)
+	for (; samp + 4u <= numSamps; samp += 4u)
+	{
+		auto in = vmulq_f32(vld1q_f32(samps + samp), vld1q_f32(gains + samp));
+
+		for (auto chan = 0u; chan < numChans; chan++)
+		{
+			auto dest = dests[chan] + samp;
+			auto out = vaddq_f32(vld1q_f32(dest), vmulq_f32(in, vdupq_n_f32(levels[chan])));
+			vst1q_f32(dest, out);
+		}
+	}
+#endif
+
+	for (; samp < numSamps; samp++)
+	{
+		auto in = samps[samp] * gains[samp];
+
+		for (auto chan = 0u; chan < numChans; chan++)
+			dests[chan][samp] += in * levels[chan];
+	}
+}
+
+float MixKernels::Peak(const float* samps,
+	unsigned int numSamps,
+	float peak)
+{
+	auto samp = 0u;
+
+#if defined(JAMMA_MIX_AVX2)
+	auto absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	auto peaks = _mm256_set1_ps(peak);
+
+	for (; samp + 8u <= numSamps; samp += 8u)
+		peaks = _mm256_max_ps(peaks, _mm256_and_ps(_mm256_loadu_ps(samps + samp), absMask));
+
+	auto peaks4 = _mm_max_ps(_mm256_castps256_ps128(peaks), _mm256_extractf128_ps(peaks, 1));
+	peaks4 = _mm_max_ps(peaks4, _mm_movehl_ps(peaks4, peaks4));
+	peaks4 = _mm_max_ss(peaks4, _mm_shuffle_ps(peaks4, peaks4, _MM_SHUFFLE(1, 1, 1, 1)));
+	peak = _mm_cvtss_f32(peaks4);
+#elif defined(JAMMA_MIX_SSE)
+	auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	auto peaks = _mm_set1_ps(peak);
+
+	for (; samp + 4u <= numSamps; samp += 4u)
+		peaks = _mm_max_ps(peaks, _mm_and_ps(_mm_loadu_ps(samps + samp), absMask));
+
+	peaks = _mm_max_ps(peaks, _mm_movehl_ps(peaks, peaks));
+	peaks = _mm_max_ss(peaks, _mm_shuffle_ps(peaks, peaks, _MM_SHUFFLE(1, 1, 1, 1)));
+	peak = _mm_cvtss_f32(peaks);
+#elif defined(JAMMA_MIX_NEON)
+	auto peaks = vdupq_n_f32(peak);
+
+	for (; samp + 4u <= numSamps; samp += 4u)
+		peaks = vmaxq_f32(peaks, vabsq_f32(vld1q_f32(samps + samp)));
+
+	auto peaks2 = vpmax_f32(vget_low_f32(peaks), vget_high_f32(peaks));
+	peak = vget_lane_f32(vpmax_f32(peaks2, peaks2), 0);
+#endif
+
+	for (; samp < numSamps; samp++)
+	{
+		auto value = std::abs(samps[samp]);
+		if (value > peak)
+			peak = value;
+	}
+
+	return peak;
+}
+
+void MixKernels::Deinterleave(const float* in,
+	unsigned int stride,
+	float* const* dests,
+	unsigned int numChannels,
+	unsigned int numSamps)
+{
+	if ((1u == stride) && (1u == numChannels))
+	{
+		std::copy(in, in + numSamps, dests[0]);
+		return;
+	}
+
+	if ((2u == stride) && (2u == numChannels))
+	{
+		_Deinterleave2(in, dests, numSamps);
+		return;
+	}
+
+	for (auto tile = 0u; tile < numSamps; tile += TileSamps)
+	{
+		auto tileSamps = (numSamps - tile) < TileSamps ? (numSamps - tile) : TileSamps;
+		auto frames = in + tile * stride;
+		auto chan = 0u;
+
+		for (; chan + 4u <= numChannels; chan += 4u)
+			_Deinterleave4(frames + chan, stride, dests + chan, tile, tileSamps);
+
+		for (; chan < numChannels; chan++)
+		{
+			auto dest = dests[chan] + tile;
+
+			for (auto samp = 0u; samp < tileSamps; samp++)
+				dest[samp] = frames[samp * stride + chan];
+		}
+	}
+}
+
+void MixKernels::Interleave(float* const* srcs,
+	unsigned int numChannels,
+	float* out,
+	unsigned int stride,
+	unsigned int numSamps,
+	bool isClearingSrcs)
+{
+	if ((1u == stride) && (1u == numChannels))
+	{
+		std::copy(srcs[0], srcs[0] + numSamps, out);
+
+		if (isClearingSrcs)
+			std::fill(srcs[0], srcs[0] + numSamps, 0.0f);
+
+		return;
+	}
+
+	if ((2u == stride) && (2u == numChannels))
+	{
+		_Interleave2(srcs, out, numSamps, isClearingSrcs);
+		return;
+	}
+
+	for (auto tile = 0u; tile < numSamps; tile += TileSamps)
+	{
+		auto tileSamps = (numSamps - tile) < TileSamps ? (numSamps - tile) : TileSamps;
+		auto frames = out + tile * stride;
+		auto chan = 0u;
+
+		for (; chan + 4u <= numChannels; chan += 4u)
+			_Interleave4(srcs + chan, tile, frames + chan, stride, tileSamps, isClearingSrcs);
+
+		for (; chan < numChannels; chan++)
+		{
+			auto src = srcs[chan] + tile;
+
+			for (auto samp = 0u; samp < tileSamps; samp++)
+				frames[samp * stride + chan] = src[samp];
+
+			if (isClearingSrcs)
+				std::fill(src, src + tileSamps, 0.0f);
+		}
+	}
+}
+
+void MixKernels::_Deinterleave2(const float* in,
+	float* const* dests,
+	unsigned int numSamps)
+{
+	auto left = dests[0];
+	auto right = dests[1];
+	auto samp = 0u;
+
+#if defined(JAMMA_MIX_AVX2) || defined(JAMMA_MIX_SSE)
+	for (; samp + 4u <= numSamps; samp += 4u)
+	{
+		auto lo = _mm_loadu_ps(in + samp * 2u);
+		auto hi = _mm_loadu_ps(in + samp * 2u + 4u);
+		_mm_storeu_ps(left + samp, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(right + samp, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+#elif defined(JAMMA_MIX_NEON)
+	for (; samp + 4u <= numSamps; samp += 4u)
+	{
+		auto frames = vld2q_f32(in + samp * 2u);
+		vst1q_f32(left + samp, frames.val[0]);
+		vst1q_f32(right + samp, frames.val[1]);
+	}
+#endif
+
+	for (; samp < numSamps; samp++)
+	{
+		left[samp] = in[samp * 2u];
+		right[samp] = in[samp * 2u + 1u];
+	}
+}
+
+// Moves four adjacent channels at a time, transposing
+// 4 frames x 4 channels in registers
+void MixKernels::_Deinterleave4(const float* in,
+	unsigned int stride,
+	float* const* dests,
+	unsigned int destOffset,
+	unsigned int numSamps)
+{
+	float* out[4] = { dests[0] + destOffset, dests[1] + destOffset, dests[2] + destOffset, dests[3] + destOffset };
+	auto samp = 0u;
+
+#if defined(JAMMA_MIX_AVX2) || defined(JAMMA_MIX_SSE)
+	for (; samp + 4u <= numSamps; samp += 4u)
+	{
+		auto frame = in + samp * stride;
+		auto r0 = _mm_loadu_ps(frame);
+		auto r1 = _mm_loadu_ps(frame + stride);
+		auto r2 = _mm_loadu_ps(frame + 2u * stride);
+		auto r3 = _mm_loadu_ps(frame + 3u * stride);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_ps(out[0] + samp, r0);
+		_mm_storeu_ps(out[1] + samp, r1);
+		_mm_storeu_ps(out[2] + samp, r2);
+		_mm_storeu_ps(out[3] + samp, r3);
+	}
+#elif defined(JAMMA_MIX_NEON)
+	for (; samp + 4u <= numSamps; samp += 4u)
+	{
+		auto frame = in + samp * stride;
+		auto t01 = vtrnq_f32(vld1q_f32(frame), vld1q_f32(frame + stride));
+		auto t23 = vtrnq_f32(vld1q_f32(frame + 2u * stride), vld1q_f32(frame + 3u * stride));
+		vst1q_f32(out[0] + samp, vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+		vst1q_f32(out[1] + samp, vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+		vst1q_f32(out[2] + samp, vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+		vst1q_f32(out[3] + samp, vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+	}
+#endif
+
+	for (; samp < numSamps; samp++)
+	{
+		auto frame = in + samp * stride;
+
+		for (auto chan = 0u; chan < 4u; chan++)
+			out[chan][samp] = frame[chan];
+	}
+}
+
+void MixKernels::_Interleave2(float* const* srcs,
+	float* out,
+	unsigned int numSamps,
+	bool isClearingSrcs)
+{
+	auto left = srcs[0];
+	auto right = srcs[1];
+	auto samp = 0u;
+
+#if defined(JAMMA_MIX_AVX2) || defined(JAMMA_MIX_SSE)
+	for (; samp + 4u <= numSamps; samp += 4u)
+	{
+		auto l = _mm_loadu_ps(left + samp);
+		auto r = _mm_loadu_ps(right + samp);
+		_mm_storeu_ps(out + samp * 2u, _mm_unpacklo_ps(l, r));
+		_mm_storeu_ps(out + samp * 2u + 4u, _mm_unpackhi_ps(l, r));
+	}
+#elif defined(JAMMA_MIX_NEON)
+	for (; samp + 4u <= numSamps; samp += 4u)
+	{
+		float32x4x2_t frames = { { vld1q_f32(left + samp), vld1q_f32(right + samp) } };
+		vst2q_f32(out + samp * 2u, frames);
+	}
+#endif
+
+	for (; samp < numSamps; samp++)
+	{
+		out[samp * 2u] = left[samp];
+		out[samp * 2u + 1u] = right[samp];
+	}
+
+	if (isClearingSrcs)
+	{
+		std::fill(left, left + numSamps, 0.0f);
+		std::fill(right, right + numSamps, 0.0f);
+	}
+}
+
+void MixKernels::_Interleave4(float* const* srcs,
+	unsigned int srcOffset,
+	float* out,
+	unsigned int stride,
+	unsigned int numSamps,
+	bool isClearingSrcs)
+{
+	float* in[4] = { srcs[0] + srcOffset, srcs[1] + srcOffset, srcs[2] + srcOffset, srcs[3] + srcOffset };
+	auto samp = 0u;
+
+#if defined(JAMMA_MIX_AVX2) || defined(JAMMA_MIX_SSE)
+	for (; samp + 4u <= numSamps; samp += 4u)
+	{
+		auto r0 = _mm_loadu_ps(in[0] + samp);
+		auto r1 = _mm_loadu_ps(in[1] + samp);
+		auto r2 = _mm_loadu_ps(in[2] + samp);
+		auto r3 = _mm_loadu_ps(in[3] + samp);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		auto frame = out + samp * stride;
+		_mm_storeu_ps(frame, r0);
+		_mm_storeu_ps(frame + stride, r1);
+		_mm_storeu_ps(frame + 2u * stride, r2);
+		_mm_storeu_ps(frame + 3u * stride, r3);
+	}
+#elif defined(JAMMA_MIX_NEON)
+	for (; samp + 4u <= numSamps; samp += 4u)
+	{
+		auto t01 = vtrnq_f32(vld1q_f32(in[0] + samp), vld1q_f32(in[1] + samp));
+		auto t23 = vtrnq_f32(vld1q_f32(in[2] + samp), vld1q_f32(in[3] + samp));
+
+		auto frame = out + samp * stride;
+		vst1q_f32(frame, vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+		vst1q_f32(frame + stride, vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+		vst1q_f32(frame + 2u * stride, vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+		vst1q_f32(frame + 3u * stride, vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+	}
+#endif
+
+	for (; samp < numSamps; samp++)
+	{
+		auto frame = out + samp * stride;
+
+		for (auto chan = 0u; chan < 4u; chan++)
+			frame[chan] = in[chan][samp];
+	}
+
+	if (isClearingSrcs)
+	{
+		for (auto chan = 0u; chan < 4u; chan++)
+			std::fill(in[chan], in[chan] + numSamps, 0.0f);
+	}
+}
+
+void MixKernels::Int16ToFloat(const std::int16_t* in,
+	unsigned int stride,
+	float* out,
+	unsigned int numSamps)
+{
+	const auto scale = 1.0f / 32768.0f;
+	auto samp = 0u;
+
+	if (1u == stride)
+	{
+#if defined(JAMMA_MIX_AVX2)
+		auto scales = _mm256_set1_ps(scale);
+
+		for (; samp + 8u <= numSamps; samp += 8u)
+		{
+			auto ints = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + samp)));
+			_mm256_storeu_ps(out + samp, _mm256_mul_ps(_mm256_cvtepi32_ps(ints), scales));
+		}
+#elif defined(JAMMA_MIX_SSE)
+		auto scales = _mm_set1_ps(scale);
+
+		for (; samp + 8u <= numSamps; samp += 8u)
+		{
+			auto shorts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + samp));
+			// Shorts land in the high halves, and are sign extended down
+			auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(shorts, shorts), 16);
+			auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(shorts, shorts), 16);
+			_mm_storeu_ps(out + samp, _mm_mul_ps(_mm_cvtepi32_ps(lo), scales));
+			_mm_storeu_ps(out + samp + 4u, _mm_mul_ps(_mm_cvtepi32_ps(hi), scales));
+		}
+#elif defined(JAMMA_MIX_NEON)
+		for (; samp + 8u <= numSamps; samp += 8u)
+		{
+			auto shorts = vld1q_s16(in + samp);
+			vst1q_f32(out + samp, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(shorts))), scale));
+			vst1q_f32(out + samp + 4u, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(shorts))), scale));
+		}
+#endif
+	}
+
+	for (; samp < numSamps; samp++)
+		out[samp] = (float)in[samp * stride] * scale;
+}
+
+void MixKernels::FloatToInt16(const float* in,
+	std::int16_t* out,
+	unsigned int numSamps)
+{
+	const auto scale = 32768.0f;
+	auto samp = 0u;
+
+	// Clipped before converting, as anything past
+	// the int range would come back negative
+#if defined(JAMMA_MIX_AVX2)
+	auto scales = _mm256_set1_ps(scale);
+	auto maxs = _mm256_set1_ps(scale);
+	auto mins = _mm256_set1_ps(-scale);
+
+	for (; samp + 16u <= numSamps; samp += 16u)
+	{
+		auto lo = _mm256_cvtps_epi32(_mm256_max_ps(mins, _mm256_min_ps(maxs, _mm256_mul_ps(_mm256_loadu_ps(in + samp), scales))));
+		auto hi = _mm256_cvtps_epi32(_mm256_max_ps(mins, _mm256_min_ps(maxs, _mm256_mul_ps(_mm256_loadu_ps(in + samp + 8u), scales))));
+		// Packing works within each lane, so the quarters are put back in order
+		auto shorts = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + samp), shorts);
+	}
+#elif defined(JAMMA_MIX_SSE)
+	auto scales = _mm_set1_ps(scale);
+	auto maxs = _mm_set1_ps(scale);
+	auto mins = _mm_set1_ps(-scale);
+
+	for (; samp + 8u <= numSamps; samp += 8u)
+	{
+		auto lo = _mm_cvtps_epi32(_mm_max_ps(mins, _mm_min_ps(maxs, _mm_mul_ps(_mm_loadu_ps(in + samp), scales))));
+		auto hi = _mm_cvtps_epi32(_mm_max_ps(mins, _mm_min_ps(maxs, _mm_mul_ps(_mm_loadu_ps(in + samp + 4u), scales))));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + samp), _mm_packs_epi32(lo, hi));
+	}
+#elif defined(JAMMA_MIX_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+	auto maxs = vdupq_n_f32(scale);
+	auto mins = vdupq_n_f32(-scale);
+
+	for (; samp + 8u <= numSamps; samp += 8u)
+	{
+		auto lo = vcvtnq_s32_f32(vmaxq_f32(mins, vminq_f32(maxs, vmulq_n_f32(vld1q_f32(in + samp), scale))));
+		auto hi = vcvtnq_s32_f32(vmaxq_f32(mins, vminq_f32(maxs, vmulq_n_f32(vld1q_f32(in + samp + 4u), scale))));
+		vst1q_s16(out + samp, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+	}
+#endif
+
+	for (; samp < numSamps; samp++)
+	{
+		auto value = std::clamp(in[samp] * scale, -scale, scale - 1.0f);
+		out[samp] = (std::int16_t)std::lrint(value);
+	}
+}
+
+void MixKernels::HalfToFloat(const std::uint16_t* in,
+	float* out,
+	unsigned int numSamps)
+{
+	auto samp = 0u;
+
+#if defined(JAMMA_MIX_F16C)
+	for (; samp + 8u <= numSamps; samp += 8u)
+		_mm256_storeu_ps(out + samp, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + samp))));
+#elif defined(JAMMA_MIX_AVX2) || defined(JAMMA_MIX_SSE)
+	// Exponent and mantissa are shifted into place and rescaled
+	// by 2^112 with a multiply (which also renormalises
+	// denormals), then infinity/nan and the sign are or'd back
+	auto zeros = _mm_setzero_si128();
+	auto noSignMask = _mm_set1_epi32(0x7FFF);
+	auto magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+	auto maxFinite = _mm_set1_epi32(0x7BFF);
+	auto infNanExp = _mm_set1_epi32(255 << 23);
+
+	auto convert = [&](__m128i halfs) {
+		auto expMantissa = _mm_and_si128(halfs, noSignMask);
+		auto sign = _mm_slli_epi32(_mm_xor_si128(halfs, expMantissa), 16);
+		auto scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMantissa, 13)), magic);
+		auto isInfNan = _mm_cmpgt_epi32(expMantissa, maxFinite);
+		auto signInfNan = _mm_or_si128(sign, _mm_and_si128(isInfNan, infNanExp));
+
+		return _mm_or_ps(scaled, _mm_castsi128_ps(signInfNan));
+	};
+
+	for (; samp + 8u <= numSamps; samp += 8u)
+	{
+		auto halfs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + samp));
+		_mm_storeu_ps(out + samp, convert(_mm_unpacklo_epi16(halfs, zeros)));
+		_mm_storeu_ps(out + samp + 4u, convert(_mm_unpackhi_epi16(halfs, zeros)));
+	}
+#elif defined(JAMMA_MIX_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+	for (; samp + 4u <= numSamps; samp += 4u)
+		vst1q_f32(out + samp, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(in + samp))));
+#endif
+
+	for (; samp < numSamps; samp++)
+		out[samp] = HalfBitsToFloat(in[samp]);
+}
+
+void MixKernels::FloatToHalf(const float* in,
+	std::uint16_t* out,
+	unsigned int numSamps)
+{
+	auto samp = 0u;
+
+#if defined(JAMMA_MIX_F16C)
+	for (; samp + 8u <= numSamps; samp += 8u)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + samp), _mm256_cvtps_ph(_mm256_loadu_ps(in + samp), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(JAMMA_MIX_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+	for (; samp + 4u <= numSamps; samp += 4u)
+		vst1_u16(out + samp, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in + samp))));
+#endif
+
+	for (; samp < numSamps; samp++)
+		out[samp] = FloatToHalfBits(in[samp]);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__AVX2__)
+#define JAMMA_MIX_AVX2
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define JAMMA_MIX_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define JAMMA_MIX_NEON
+#include <arm_neon.h>
+#endif
+
+// Every AVX2 cpu has F16C, but only MSVC enables it with AVX2
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(JAMMA_MIX_AVX2))
+#define JAMMA_MIX_F16C
+#endif
+
+namespace audio
+{
+	class MixKernels
+	{
+	public:
+		// dests[chan][samp] += samps[samp] * gains[samp] * levels[chan]
+		static void MixRamped(float* const* dests,
+			const float* levels,
+			unsigned int numChannels,
+			const float* samps,
+			const float* gains,
+			unsigned int numSamps);
+		// max(peak, |samps[samp]|)
+		static float Peak(const float* samps,
+			unsigned int numSamps,
+			float peak);
+		// dests[chan][samp] = in[samp * stride + chan]
+		static void Deinterleave(const float* in,
+			unsigned int stride,
+			float* const* dests,
+			unsigned int numChannels,
+			unsigned int numSamps);
+		// out[samp * stride + chan] = srcs[chan][samp], optionally
+		// zeroing each source sample once it has been read
+		static void Interleave(float* const* srcs,
+			unsigned int numChannels,
+			float* out,
+			unsigned int stride,
+			unsigned int numSamps,
+			bool isClearingSrcs);
+		// out[samp] = in[samp * stride] / 32768
+		static void Int16ToFloat(const std::int16_t* in,
+			unsigned int stride,
+			float* out,
+			unsigned int numSamps);
+		// out[samp] = in[samp] * 32768, rounded and clipped
+		static void FloatToInt16(const float* in,
+			std::int16_t* out,
+			unsigned int numSamps);
+		// IEEE half precision bits to float and back
+		// (rounding to nearest even)
+		static void HalfToFloat(const std::uint16_t* in,
+			float* out,
+			unsigned int numSamps);
+		static void FloatToHalf(const float* in,
+			std::uint16_t* out,
+			unsigned int numSamps);
+
+	public:
+		static const unsigned int MaxChannels = 32u;
+		// Samples per pass over the channels, keeping the
+		// frames being transposed resident in L1
+		static const unsigned int TileSamps = 64u;
+
+	protected:
+		template<unsigned int NumChannels>
+		static void _MixRamped(float* const* dests,
+			const float* levels,
+			unsigned int numChannels,
+			const float* samps,
+			const float* gains,
+			unsigned int numSamps);
+		static void _Deinterleave2(const float* in,
+			float* const* dests,
+			unsigned int numSamps);
+		static void _Deinterleave4(const float* in,
+			unsigned int stride,
+			float* const* dests,
+			unsigned int destOffset,
+			unsigned int numSamps);
+		static void _Interleave2(float* const* srcs,
+			float* out,
+			unsigned int numSamps,
+			bool isClearingSrcs);
+		static void _Interleave4(float* const* srcs,
+			unsigned int srcOffset,
+			float* out,
+			unsigned int stride,
+			unsigned int numSamps,
+			bool isClearingSrcs);
+	};
+}
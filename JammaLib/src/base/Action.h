@@ -15,7 +15,7 @@ namespace base
 	public:
 		Action() :
 			_actionTime(std::chrono::steady_clock::now()),
-			_userConfig(std::nullopt)
+			_userConfig(nullptr)
 		{};
 
 		~Action() {};
@@ -24,11 +24,13 @@ namespace base
 		Time GetActionTime() const { return _actionTime; }
 		void SetActionTime(Time time) { _actionTime = time; }
 
-		std::optional<io::UserConfig> GetUserConfig() const { return _userConfig; }
-		void SetUserConfig(io::UserConfig cfg) { _userConfig = cfg; }
+		// Points at the sender's config rather than copying it, as
+		// actions are handled on the audio thread (null if not set)
+		const io::UserConfig* GetUserConfig() const { return _userConfig; }
+		void SetUserConfig(const io::UserConfig& cfg) { _userConfig = &cfg; }
 
 	protected:
 		Time _actionTime;
-		std::optional<io::UserConfig> _userConfig;
+		const io::UserConfig* _userConfig;
 	};
 }
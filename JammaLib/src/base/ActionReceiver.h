@@ -24,7 +24,7 @@ namespace base
 		virtual actions::ActionResult OnAction(actions::TouchMoveAction action)	{ return { false, "", actions::ACTIONRESULT_DEFAULT }; };
 		virtual actions::ActionResult OnAction(actions::KeyAction action)		{ return { false, "", actions::ACTIONRESULT_DEFAULT }; };
 		virtual actions::ActionResult OnAction(actions::DoubleAction action)	{ return { false, "", actions::ACTIONRESULT_DEFAULT }; };
-		virtual actions::ActionResult OnAction(actions::TriggerAction action)	{ return { false, "", actions::ACTIONRESULT_DEFAULT }; };
+		virtual actions::ActionResult OnAction(const actions::TriggerAction& action)	{ return { false, "", actions::ACTIONRESULT_DEFAULT }; };
 		virtual actions::ActionResult OnAction(actions::JobAction action)		{ return { false, "", actions::ACTIONRESULT_DEFAULT }; };
 
 		std::shared_ptr<ActionReceiver> shared_from_this()
@@ -23,6 +23,20 @@ namespace base
 		}
 		inline virtual int OnWrite(float samp, int indexOffset) { return indexOffset; };
 		inline virtual int OnOverwrite(float samp, int indexOffset) { return indexOffset; };
+		virtual int OnWriteBlock(const float* samps, unsigned int numSamps, int indexOffset)
+		{
+			for (auto i = 0u; i < numSamps; i++)
+				indexOffset = OnWrite(samps[i], indexOffset);
+
+			return indexOffset;
+		}
+		virtual int OnOverwriteBlock(const float* samps, unsigned int numSamps, int indexOffset)
+		{
+			for (auto i = 0u; i < numSamps; i++)
+				indexOffset = OnOverwrite(samps[i], indexOffset);
+
+			return indexOffset;
+		}
 		virtual void EndWrite(unsigned int numSamps) { return EndWrite(numSamps, false); }
 		virtual void EndWrite(unsigned int numSamps, bool updateIndex) = 0;
 
@@ -56,15 +56,13 @@ void GuiElement::SetSize(Size2d size)
 std::vector<JobAction> GuiElement::CommitChanges()
 {
 	std::vector<JobAction> jobList = {};
-	if (_changesMade)
+	if (_changesMade.exchange(false))
 	{
 		auto jobs = _CommitChanges();
 		if (!jobs.empty())
 			jobList.insert(jobList.end(), jobs.begin(), jobs.end());
 	}
 
-	_changesMade = false;
-
 	for (auto& child : _children)
 	{
 		auto jobs = child->CommitChanges();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <tuple>
+#include <atomic>
 #include <vector>
 #include "CommonTypes.h"
 #include "Drawable.h"
@@ -98,7 +99,7 @@ namespace base
 		virtual std::vector<actions::JobAction> _CommitChanges();
 
 	protected:
-		bool _changesMade;
+		std::atomic<bool> _changesMade;
 		GuiElementParams _guiParams;
 		GuiElementState _state;
 		graphics::Image _texture;
@@ -53,6 +53,24 @@ namespace base
 			if (chan)
 				chan->OnWrite(samp, indexOffset);
 		}
+		virtual void OnMixChannels(const float* samps,
+			const float* gains,
+			const unsigned int* channels,
+			const float* levels,
+			unsigned int numChannels,
+			unsigned int numSamps,
+			unsigned int indexOffset)
+		{
+			for (auto route = 0u; route < numChannels; route++)
+			{
+				auto chan = InputChannel(channels[route]);
+				if (!chan)
+					continue;
+
+				for (auto samp = 0u; samp < numSamps; samp++)
+					chan->OnWrite(samps[samp] * gains[samp] * levels[route], indexOffset + samp);
+			}
+		}
 		virtual unsigned int NumInputChannels() const { return 0; };
 
 		std::shared_ptr<MultiAudioSink> shared_from_this()
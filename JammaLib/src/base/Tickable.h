@@ -9,6 +9,6 @@ namespace base
 	class Tickable
 	{
 	public:
-		virtual void OnTick(Time curTime, unsigned int samps, std::optional<io::UserConfig> cfg) = 0;
+		virtual void OnTick(Time curTime, unsigned int samps, const io::UserConfig& cfg) = 0;
 	};
 }
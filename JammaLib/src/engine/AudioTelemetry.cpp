@@ -0,0 +1,247 @@
+#include "AudioTelemetry.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include "../include/Constants.h"
+
+using namespace engine;
+
+AudioTelemetry::AudioTelemetry(AudioTelemetryParams params) :
+	_ring(params.RingSize),
+	_numDropped(0ull),
+	_sampleRate(params.SampleRate),
+	_statsMutex(),
+	_numCallbacks(0ull),
+	_numInputOverflows(0ull),
+	_numOutputUnderflows(0ull),
+	_windowSize(params.WindowSize),
+	_window(),
+	_windowPos(0u),
+	_wallHistogram({}),
+	_cpuHistogram({}),
+	_summary({})
+{
+	_window.reserve(params.WindowSize);
+}
+
+void AudioTelemetry::Push(CallbackTiming timing)
+{
+	if (!_ring.TryPush(std::move(timing)))
+		_numDropped.fetch_add(1ull, std::memory_order_relaxed);
+}
+
+void AudioTelemetry::SetSampleRate(unsigned int sampleRate)
+{
+	_sampleRate = sampleRate;
+}
+
+void AudioTelemetry::Update()
+{
+	std::scoped_lock lock(_statsMutex);
+
+	auto numPopped = 0u;
+
+	CallbackTiming timing;
+	while (_ring.TryPop(timing))
+	{
+		numPopped++;
+		_numCallbacks++;
+
+		if (timing.IsInputOverflow)
+			_numInputOverflows++;
+		if (timing.IsOutputUnderflow)
+			_numOutputUnderflows++;
+
+		auto deadline = Deadline(timing.NumSamps);
+		_wallHistogram[HistogramBin(timing.WallSeconds / deadline)]++;
+		_cpuHistogram[HistogramBin(timing.CpuSeconds / deadline)]++;
+
+		if (_window.size() < _windowSize)
+			_window.push_back(timing);
+		else if (!_window.empty())
+		{
+			_window[_windowPos] = timing;
+			_windowPos = (_windowPos + 1) % (unsigned int)_window.size();
+		}
+	}
+
+	if (numPopped > 0)
+		_summary = CalcSummary();
+	else
+		_summary.NumDropped = _numDropped.load();
+}
+
+void AudioTelemetry::Reset()
+{
+	std::scoped_lock lock(_statsMutex);
+
+	CallbackTiming timing;
+	while (_ring.TryPop(timing)) {}
+
+	_numDropped = 0ull;
+	_numCallbacks = 0ull;
+	_numInputOverflows = 0ull;
+	_numOutputUnderflows = 0ull;
+	_window.clear();
+	_windowPos = 0u;
+	_wallHistogram.fill(0ull);
+	_cpuHistogram.fill(0ull);
+	_summary = CalcSummary();
+}
+
+AudioTelemetrySummary AudioTelemetry::Summary()
+{
+	std::scoped_lock lock(_statsMutex);
+	return _summary;
+}
+
+std::string AudioTelemetry::LoadText()
+{
+	auto summary = Summary();
+
+	std::stringstream ss;
+	ss << "DSP " << (int)(summary.Wall.Mean * 100.0 + 0.5) << "%"
+		<< " p99 " << (int)(summary.Wall.P99 * 100.0 + 0.5) << "%"
+		<< " xruns " << summary.NumInputOverflows + summary.NumOutputUnderflows;
+
+	return ss.str();
+}
+
+void AudioTelemetry::WriteJson(std::ostream& stream)
+{
+	std::scoped_lock lock(_statsMutex);
+
+	auto& summary = _summary;
+
+	stream << "{\"version\":\"" << LIB_VERSION << "\""
+		<< ",\"sampleRate\":" << _sampleRate.load()
+		<< ",\"callbacks\":" << summary.NumCallbacks
+		<< ",\"dropped\":" << summary.NumDropped
+		<< ",\"inputOverflows\":" << summary.NumInputOverflows
+		<< ",\"outputUnderflows\":" << summary.NumOutputUnderflows
+		<< ",\"windowCallbacks\":" << summary.NumWindowCallbacks
+		<< ",\"load\":{";
+
+	WriteLoadJson(stream, "wall", summary.Wall);
+	stream << ",";
+	WriteLoadJson(stream, "cpu", summary.Cpu);
+	stream << ",";
+	WriteLoadJson(stream, "input", summary.Input);
+	stream << ",";
+	WriteLoadJson(stream, "output", summary.Output);
+	stream << ",";
+	WriteLoadJson(stream, "tick", summary.Tick);
+
+	stream << "},\"histogram\":{\"binWidth\":" << HistogramBinWidth << ",";
+	WriteHistogramJson(stream, "wall", _wallHistogram);
+	stream << ",";
+	WriteHistogramJson(stream, "cpu", _cpuHistogram);
+	stream << "}}" << std::endl;
+}
+
+double AudioTelemetry::Deadline(unsigned int numSamps) const
+{
+	auto sampleRate = _sampleRate.load();
+	if ((0u == sampleRate) || (0u == numSamps))
+		return 1.0;
+
+	return (double)numSamps / (double)sampleRate;
+}
+
+TimingLoad AudioTelemetry::CalcLoad(std::vector<double>& loads) const
+{
+	TimingLoad load = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+	if (loads.empty())
+		return load;
+
+	std::sort(loads.begin(), loads.end());
+
+	auto sum = 0.0;
+	for (auto l : loads)
+		sum += l;
+
+	auto percentile = [&loads](double frac) {
+		auto index = (size_t)(frac * (double)(loads.size() - 1) + 0.5);
+		return loads[index];
+	};
+
+	load.Mean = sum / (double)loads.size();
+	load.P50 = percentile(0.5);
+	load.P95 = percentile(0.95);
+	load.P99 = percentile(0.99);
+	load.Max = loads.back();
+
+	return load;
+}
+
+AudioTelemetrySummary AudioTelemetry::CalcSummary()
+{
+	AudioTelemetrySummary summary;
+	summary.NumCallbacks = _numCallbacks;
+	summary.NumDropped = _numDropped.load();
+	summary.NumInputOverflows = _numInputOverflows;
+	summary.NumOutputUnderflows = _numOutputUnderflows;
+	summary.NumWindowCallbacks = (unsigned int)_window.size();
+
+	std::vector<double> wall, cpu, input, output, tick;
+	wall.reserve(_window.size());
+	cpu.reserve(_window.size());
+	input.reserve(_window.size());
+	output.reserve(_window.size());
+	tick.reserve(_window.size());
+
+	for (auto& timing : _window)
+	{
+		auto deadline = Deadline(timing.NumSamps);
+		wall.push_back(timing.WallSeconds / deadline);
+		cpu.push_back(timing.CpuSeconds / deadline);
+		input.push_back(timing.InputSeconds / deadline);
+		output.push_back(timing.OutputSeconds / deadline);
+		tick.push_back(timing.TickSeconds / deadline);
+	}
+
+	summary.Wall = CalcLoad(wall);
+	summary.Cpu = CalcLoad(cpu);
+	summary.Input = CalcLoad(input);
+	summary.Output = CalcLoad(output);
+	summary.Tick = CalcLoad(tick);
+
+	return summary;
+}
+
+unsigned int AudioTelemetry::HistogramBin(double load)
+{
+	if (load <= 0.0)
+		return 0u;
+
+	auto bin = (unsigned int)(load / HistogramBinWidth);
+	return std::min(bin, NumHistogramBins - 1);
+}
+
+void AudioTelemetry::WriteLoadJson(std::ostream& stream, const std::string& name, const TimingLoad& load)
+{
+	stream << "\"" << name << "\":{"
+		<< std::setprecision(6)
+		<< "\"mean\":" << load.Mean
+		<< ",\"p50\":" << load.P50
+		<< ",\"p95\":" << load.P95
+		<< ",\"p99\":" << load.P99
+		<< ",\"max\":" << load.Max
+		<< "}";
+}
+
+void AudioTelemetry::WriteHistogramJson(std::ostream& stream, const std::string& name, const std::array<unsigned long long, NumHistogramBins>& histogram)
+{
+	stream << "\"" << name << "\":[";
+
+	for (auto bin = 0u; bin < NumHistogramBins; bin++)
+	{
+		if (bin > 0)
+			stream << ",";
+
+		stream << histogram[bin];
+	}
+
+	stream << "]";
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "../utils/SpscQueue.h"
+#include "../utils/RealtimeCheck.h"
+
+namespace engine
+{
+	// Timings for a single audio callback, in seconds
+	struct CallbackTiming
+	{
+		unsigned int NumSamps;
+		double WallSeconds; // The whole callback
+		double CpuSeconds; // CPU time used by the audio thread
+		double InputSeconds; // ADC read and station writes
+		double OutputSeconds; // Station playback, bus mix and DAC write
+		double TickSeconds; // Scene::OnTick
+		bool IsInputOverflow;
+		bool IsOutputUnderflow;
+	};
+
+	// Spread of a timing over the recent window, as a fraction
+	// of the callback's deadline (1.0 is a full buffer period)
+	struct TimingLoad
+	{
+		double Mean;
+		double P50;
+		double P95;
+		double P99;
+		double Max;
+	};
+
+	struct AudioTelemetrySummary
+	{
+		unsigned long long NumCallbacks;
+		unsigned long long NumDropped; // Callbacks the ring had no room for
+		unsigned long long NumInputOverflows;
+		unsigned long long NumOutputUnderflows;
+		unsigned int NumWindowCallbacks;
+		TimingLoad Wall;
+		TimingLoad Cpu;
+		TimingLoad Input;
+		TimingLoad Output;
+		TimingLoad Tick;
+	};
+
+	class AudioTelemetryParams
+	{
+	public:
+		unsigned int RingSize; // Callbacks that can be queued before Update drains them
+		unsigned int WindowSize; // Recent callbacks that percentiles are taken over
+		unsigned int SampleRate;
+	};
+
+	// Push is called once per callback from the audio thread and
+	// never blocks. Everything else is for non-realtime threads.
+	// Update drains the ring and refreshes the summary, which
+	// Summary then returns without recalculating.
+	class AudioTelemetry
+	{
+	public:
+		AudioTelemetry(AudioTelemetryParams params);
+
+		// Copy
+		AudioTelemetry(const AudioTelemetry&) = delete;
+		AudioTelemetry& operator=(const AudioTelemetry&) = delete;
+
+	public:
+		void Push(CallbackTiming timing);
+
+		void SetSampleRate(unsigned int sampleRate);
+		void Update();
+		void Reset();
+		AudioTelemetrySummary Summary();
+		std::string LoadText();
+		void WriteJson(std::ostream& stream);
+
+	public:
+		static const unsigned int NumHistogramBins = 40u;
+		static constexpr double HistogramBinWidth = 0.05; // Fraction of the deadline per bin
+
+	protected:
+		double Deadline(unsigned int numSamps) const;
+		TimingLoad CalcLoad(std::vector<double>& loads) const;
+		AudioTelemetrySummary CalcSummary();
+		static unsigned int HistogramBin(double load);
+		static void WriteLoadJson(std::ostream& stream, const std::string& name, const TimingLoad& load);
+		static void WriteHistogramJson(std::ostream& stream, const std::string& name, const std::array<unsigned long long, NumHistogramBins>& histogram);
+
+	protected:
+		utils::SpscQueue<CallbackTiming> _ring;
+		std::atomic<unsigned long long> _numDropped;
+		std::atomic<unsigned int> _sampleRate;
+
+		utils::CheckedMutex _statsMutex;
+		unsigned long long _numCallbacks;
+		unsigned long long _numInputOverflows;
+		unsigned long long _numOutputUnderflows;
+		unsigned int _windowSize;
+		std::vector<CallbackTiming> _window;
+		unsigned int _windowPos;
+		std::array<unsigned long long, NumHistogramBins> _wallHistogram;
+		std::array<unsigned long long, NumHistogramBins> _cpuHistogram;
+		AudioTelemetrySummary _summary;
+	};
+}
@@ -0,0 +1,134 @@
+#include "JamLoader.h"
+#include "Timer.h"
+#include <algorithm>
+
+using namespace engine;
+using utils::WorkerPool;
+using utils::WorkerPoolParams;
+
+JamLoader::JamLoader(JamLoaderParams params) :
+	_params(params),
+	_isCancelled(false),
+	_numDone(0u),
+	_stats({ 0u, 0u, 0.0 })
+{
+}
+
+JamLoader::~JamLoader()
+{
+}
+
+std::optional<JamLoader::JamLoops> JamLoader::Load(const io::JamFile& jam, const std::wstring& dir)
+{
+	return LoadLoops(jam, [&dir](unsigned int loopIndex, const io::JamFile::Loop& loopStruct) {
+		return Loop::FromFile(LoopParams(), loopStruct, dir);
+	});
+}
+
+std::optional<JamLoader::JamLoops> JamLoader::Load(std::shared_ptr<const io::SessionFile> session)
+{
+	return LoadLoops(session->Jam(), [&session](unsigned int loopIndex, const io::JamFile::Loop& loopStruct) {
+		return Loop::FromFile(LoopParams(), loopStruct, session, loopIndex);
+	});
+}
+
+std::optional<JamLoader::JamLoops> JamLoader::LoadLoops(const io::JamFile& jam, const LoopLoader& loadLoop)
+{
+	auto startTime = Timer::GetTime();
+
+	JamLoops loops(jam.Stations.size());
+	std::vector<LoopJob> jobs;
+
+	for (auto station = 0u; station < jam.Stations.size(); station++)
+	{
+		auto& takes = jam.Stations[station].LoopTakes;
+		loops[station].resize(takes.size());
+
+		for (auto take = 0u; take < takes.size(); take++)
+		{
+			loops[station][take].resize(takes[take].Loops.size());
+
+			for (auto loop = 0u; loop < takes[take].Loops.size(); loop++)
+				jobs.push_back({ station, take, loop, &takes[take].Loops[loop] });
+		}
+	}
+
+	_numDone = 0u;
+	_stats = { (unsigned int)jobs.size(), 0u, 0.0 };
+
+	if (_params.OnProgress)
+		_params.OnProgress(0u, _stats.NumLoops);
+
+	// Each job writes its own slot, so no locking needed
+	std::function<void(unsigned int)> loadJob = [&](unsigned int jobIndex) {
+		if (_isCancelled)
+			return;
+
+		auto& job = jobs[jobIndex];
+		auto loop = loadLoop(jobIndex, *job.LoopStruct);
+
+		if (loop.has_value())
+			loops[job.Station][job.Take][job.Loop] = loop.value();
+
+		auto numDone = ++_numDone;
+
+		if (_params.OnProgress)
+			_params.OnProgress(numDone, _stats.NumLoops);
+	};
+
+	if (_params.NumWorkers > 0)
+	{
+		WorkerPoolParams poolParams;
+		poolParams.NumWorkers = _params.NumWorkers;
+		poolParams.SpinIterations = 0u;
+		poolParams.IsRealtime = false;
+
+		WorkerPool pool(poolParams);
+		pool.Run((unsigned int)jobs.size(), loadJob);
+	}
+	else
+	{
+		for (auto jobIndex = 0u; jobIndex < jobs.size(); jobIndex++)
+			loadJob(jobIndex);
+	}
+
+	for (auto& stationLoops : loops)
+	{
+		for (auto& takeLoops : stationLoops)
+			_stats.NumLoaded += (unsigned int)std::count_if(takeLoops.begin(), takeLoops.end(), [](auto& loop) { return nullptr != loop; });
+	}
+
+	_stats.Seconds = Timer::GetElapsedSeconds(startTime, Timer::GetTime());
+
+	if (_isCancelled)
+		return std::nullopt;
+
+	return loops;
+}
+
+void JamLoader::Cancel()
+{
+	_isCancelled = true;
+}
+
+bool JamLoader::IsCancelled() const
+{
+	return _isCancelled;
+}
+
+JamLoadStats JamLoader::Stats() const
+{
+	return _stats;
+}
+
+JamLoaderParams JamLoader::DefaultParams()
+{
+	// Loading is mostly waiting on the disk,
+	// so every core is worth keeping busy
+	auto numCores = std::thread::hardware_concurrency();
+
+	JamLoaderParams params;
+	params.NumWorkers = numCores > 1u ? numCores - 1u : 0u;
+
+	return params;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Loop.h"
+#include "../io/JamFile.h"
+#include "../io/SessionFile.h"
+#include "../utils/WorkerPool.h"
+
+namespace engine
+{
+	class JamLoaderParams
+	{
+	public:
+		unsigned int NumWorkers; // Extra threads to load on, alongside the caller
+		std::function<void(unsigned int, unsigned int)> OnProgress; // Loops done and total, called from the loading threads
+	};
+
+	struct JamLoadStats
+	{
+		unsigned int NumLoops;
+		unsigned int NumLoaded;
+		double Seconds;
+	};
+
+	// Loads every loop of a jam across a pool of workers, each
+	// claiming whole loops (mapping and converting the wav).
+	// Loops come back per station and take, ready for the
+	// caller to put the stations together.
+	class JamLoader
+	{
+	public:
+		// Loops for each station, take and loop of the jam
+		typedef std::vector<std::vector<std::vector<std::shared_ptr<Loop>>>> JamLoops;
+
+	public:
+		JamLoader(JamLoaderParams params);
+		~JamLoader();
+
+		// Copy
+		JamLoader(const JamLoader&) = delete;
+		JamLoader& operator=(const JamLoader&) = delete;
+
+	public:
+		// Empty if cancelled before every loop was loaded
+		std::optional<JamLoops> Load(const io::JamFile& jam, const std::wstring& dir);
+		// Maps each loop from the session rather than converting
+		std::optional<JamLoops> Load(std::shared_ptr<const io::SessionFile> session);
+		// Can be called from any thread, loops not yet started are skipped
+		void Cancel();
+		bool IsCancelled() const;
+		JamLoadStats Stats() const;
+
+		static JamLoaderParams DefaultParams();
+
+	protected:
+		struct LoopJob
+		{
+			unsigned int Station;
+			unsigned int Take;
+			unsigned int Loop;
+			const io::JamFile::Loop* LoopStruct;
+		};
+
+		typedef std::function<std::optional<std::shared_ptr<Loop>>(unsigned int, const io::JamFile::Loop&)> LoopLoader;
+
+	protected:
+		// Loads each loop of the jam with loadLoop, given
+		// its index in station, take then loop order
+		std::optional<JamLoops> LoadLoops(const io::JamFile& jam, const LoopLoader& loadLoop);
+
+	protected:
+		JamLoaderParams _params;
+		std::atomic<bool> _isCancelled;
+		std::atomic<unsigned int> _numDone;
+		JamLoadStats _stats;
+	};
+}
@@ -0,0 +1,241 @@
+#include "JamSaver.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include "../utils/StringUtils.h"
+
+using namespace engine;
+using utils::WorkerPool;
+using utils::WorkerPoolParams;
+
+namespace
+{
+	bool MoveIntoPlace(const std::filesystem::path& tempPath, const std::filesystem::path& path)
+	{
+		std::error_code err;
+		std::filesystem::rename(tempPath, path, err);
+
+		if (!err)
+			return true;
+
+		std::filesystem::remove(tempPath, err);
+		return false;
+	}
+}
+
+JamSaver::JamSaver(JamSaverParams params) :
+	_params(params),
+	_numDone(0u),
+	_stats({ 0u, 0u, 0.0 })
+{
+}
+
+JamSaver::~JamSaver()
+{
+}
+
+JamSnapshot JamSaver::Snapshot(const std::string& name,
+	const std::vector<std::shared_ptr<Station>>& stations,
+	const Timer& clock)
+{
+	JamSnapshot snapshot;
+	snapshot.Jam.Version = io::JamFile::VERSION_V;
+	snapshot.Jam.Name = name;
+	snapshot.Jam.TimerTicks = 0;
+	snapshot.Jam.QuantiseSamps = clock.QuantiseSamps();
+	snapshot.Jam.Quantisation = clock.Quantisation();
+
+	auto stationNum = 0u;
+	for (auto& station : stations)
+	{
+		stationNum++;
+
+		io::JamFile::Station stationStruct;
+		stationStruct.Name = "Station" + std::to_string(stationNum);
+		stationStruct.StationType = 0;
+
+		std::vector<std::vector<JamSnapshot::SnapshotLoop>> stationLoops;
+
+		auto takeNum = 0u;
+		for (auto& take : station->Takes())
+		{
+			takeNum++;
+
+			std::vector<JamSnapshot::SnapshotLoop> takeLoops;
+
+			for (auto& loop : take->Loops())
+			{
+				auto loopSnapshot = loop->Snapshot();
+
+				if (loopSnapshot.has_value())
+					takeLoops.push_back({ loop, loopSnapshot.value() });
+			}
+
+			// Takes still recording have nothing to keep yet
+			if (takeLoops.empty())
+				continue;
+
+			io::JamFile::LoopTake takeStruct;
+			takeStruct.Name = take->Id().empty() ? "Take" + std::to_string(takeNum) : take->Id();
+
+			stationStruct.LoopTakes.push_back(takeStruct);
+			stationLoops.push_back(takeLoops);
+		}
+
+		snapshot.Jam.Stations.push_back(stationStruct);
+		snapshot.Loops.push_back(stationLoops);
+	}
+
+	return snapshot;
+}
+
+bool JamSaver::Save(const JamSnapshot& snapshot, const std::wstring& jamFile)
+{
+	auto startTime = Timer::GetTime();
+
+	std::filesystem::path jamPath(jamFile);
+	auto dir = jamPath.parent_path();
+	auto prefix = utils::EncodeUtf8(jamPath.stem().wstring());
+
+	std::vector<LoopJob> jobs;
+
+	for (auto station = 0u; station < snapshot.Loops.size(); station++)
+	{
+		auto& takes = snapshot.Loops[station];
+
+		for (auto take = 0u; take < takes.size(); take++)
+		{
+			for (auto loop = 0u; loop < takes[take].size(); loop++)
+				jobs.push_back({ station, take, loop });
+		}
+	}
+
+	_numDone = 0u;
+	_stats = { (unsigned int)jobs.size(), 0u, 0.0 };
+
+	if (_params.OnProgress)
+		_params.OnProgress(0u, _stats.NumLoops);
+
+	// Each job writes its own slot, so no locking needed
+	std::vector<std::optional<io::JamFile::Loop>> savedLoops(jobs.size());
+
+	std::function<void(unsigned int)> saveLoop = [&](unsigned int jobIndex) {
+		auto& job = jobs[jobIndex];
+		auto& snapshotLoop = snapshot.Loops[job.Station][job.Take][job.Loop];
+
+		auto wavName = prefix + "-" + std::to_string(job.Station + 1) +
+			"-" + std::to_string(job.Take + 1) +
+			"-" + std::to_string(job.Loop + 1) + ".wav";
+		auto wavPath = dir / utils::DecodeUtf8(wavName);
+		auto tempPath = wavPath;
+		tempPath += L".tmp";
+
+		std::optional<LoopSnapshot> loopSnapshot = snapshotLoop.Snapshot;
+		auto isWritten = false;
+
+		for (auto attempt = 0u; (attempt < _MaxWriteAttempts) && loopSnapshot.has_value(); attempt++)
+		{
+			isWritten = snapshotLoop.Source->WriteWav(loopSnapshot.value(), tempPath.wstring());
+
+			if (isWritten)
+				break;
+
+			// Recorded over part way, so take it as it is now
+			loopSnapshot = snapshotLoop.Source->Snapshot();
+		}
+
+		if (isWritten)
+			isWritten = MoveIntoPlace(tempPath, wavPath);
+		else
+		{
+			std::error_code err;
+			std::filesystem::remove(tempPath, err);
+		}
+
+		if (isWritten)
+		{
+			savedLoops[jobIndex] = loopSnapshot.value().Struct;
+			savedLoops[jobIndex].value().Name = wavName;
+		}
+
+		auto numDone = ++_numDone;
+
+		if (_params.OnProgress)
+			_params.OnProgress(numDone, _stats.NumLoops);
+	};
+
+	if (_params.NumWorkers > 0)
+	{
+		WorkerPoolParams poolParams;
+		poolParams.NumWorkers = _params.NumWorkers;
+		poolParams.SpinIterations = 0u;
+		poolParams.IsRealtime = false;
+
+		WorkerPool pool(poolParams);
+		pool.Run((unsigned int)jobs.size(), saveLoop);
+	}
+	else
+	{
+		for (auto jobIndex = 0u; jobIndex < jobs.size(); jobIndex++)
+			saveLoop(jobIndex);
+	}
+
+	auto jam = snapshot.Jam;
+
+	for (auto jobIndex = 0u; jobIndex < jobs.size(); jobIndex++)
+	{
+		if (!savedLoops[jobIndex].has_value())
+			continue;
+
+		auto& job = jobs[jobIndex];
+		jam.Stations[job.Station].LoopTakes[job.Take].Loops.push_back(savedLoops[jobIndex].value());
+		_stats.NumSaved++;
+	}
+
+	// A take with no loops would not load
+	for (auto& station : jam.Stations)
+	{
+		auto& takes = station.LoopTakes;
+		takes.erase(std::remove_if(takes.begin(), takes.end(), [](auto& take) { return take.Loops.empty(); }), takes.end());
+	}
+
+	auto tempPath = jamPath;
+	tempPath += L".tmp";
+
+	auto isSaved = false;
+
+	{
+		std::ofstream stream(tempPath, std::ios::trunc);
+
+		if (stream.is_open())
+		{
+			isSaved = io::JamFile::ToStream(jam, stream);
+			stream.close();
+			isSaved = isSaved && !stream.fail();
+		}
+	}
+
+	isSaved = isSaved && MoveIntoPlace(tempPath, jamPath);
+
+	_stats.Seconds = Timer::GetElapsedSeconds(startTime, Timer::GetTime());
+
+	return isSaved;
+}
+
+JamSaveStats JamSaver::Stats() const
+{
+	return _stats;
+}
+
+JamSaverParams JamSaver::DefaultParams()
+{
+	// Writing shares the machine with the band playing,
+	// and the disk is the bottleneck well before the cores
+	auto numCores = std::thread::hardware_concurrency();
+
+	JamSaverParams params;
+	params.NumWorkers = std::min(2u, numCores > 2u ? numCores - 2u : 0u);
+
+	return params;
+}
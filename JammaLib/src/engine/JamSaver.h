@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Station.h"
+#include "Timer.h"
+#include "../io/JamFile.h"
+#include "../utils/WorkerPool.h"
+
+namespace engine
+{
+	class JamSaverParams
+	{
+	public:
+		unsigned int NumWorkers; // Extra threads to write wavs on, alongside the caller
+		std::function<void(unsigned int, unsigned int)> OnProgress; // Loops done and total, called from the saving threads
+	};
+
+	struct JamSaveStats
+	{
+		unsigned int NumLoops;
+		unsigned int NumSaved;
+		double Seconds;
+	};
+
+	// The stations and takes of a jam as they stood at one
+	// moment, with each loop's samples still to be written
+	struct JamSnapshot
+	{
+		struct SnapshotLoop
+		{
+			std::shared_ptr<Loop> Source;
+			LoopSnapshot Snapshot;
+		};
+
+		io::JamFile Jam; // Takes get their loops once written
+		std::vector<std::vector<std::vector<SnapshotLoop>>> Loops;
+	};
+
+	// Saves a jam while it carries on playing. The structure is
+	// snapshotted on the gui thread, then every loop's wav is
+	// written straight from its buffer bank across a pool of
+	// workers, and the jam file last of all. A loop recorded over
+	// part way is snapshotted afresh, or left out of the jam.
+	// Files are written under a temporary name and moved into
+	// place, so a failed save leaves the old files as they were.
+	class JamSaver
+	{
+	public:
+		JamSaver(JamSaverParams params);
+		~JamSaver();
+
+		// Copy
+		JamSaver(const JamSaver&) = delete;
+		JamSaver& operator=(const JamSaver&) = delete;
+
+	public:
+		// Must be called on the gui thread
+		static JamSnapshot Snapshot(const std::string& name,
+			const std::vector<std::shared_ptr<Station>>& stations,
+			const Timer& clock);
+		// Writes the wavs alongside jamFile, then jamFile
+		// itself listing the loops that were written
+		bool Save(const JamSnapshot& snapshot, const std::wstring& jamFile);
+		JamSaveStats Stats() const;
+
+		static JamSaverParams DefaultParams();
+
+	protected:
+		struct LoopJob
+		{
+			unsigned int Station;
+			unsigned int Take;
+			unsigned int Loop;
+		};
+
+	protected:
+		static const unsigned int _MaxWriteAttempts = 3u;
+
+		JamSaverParams _params;
+		std::atomic<unsigned int> _numDone;
+		JamSaveStats _stats;
+	};
+}
@@ -0,0 +1,228 @@
+#include "JobQueue.h"
+
+using namespace engine;
+using actions::JobAction;
+
+JobQueue::JobQueue(JobQueueParams params) :
+	_params(params),
+	_isQuitting(false),
+	_mutex(),
+	_jobPosted(),
+	_jobDone(),
+	_pending(),
+	_running(),
+	_numRun(0),
+	_numCoalesced(0),
+	_totalLatencyMs(0.0),
+	_maxLatencyMs(0.0),
+	_workers()
+{
+	auto numWorkers = params.NumWorkers > 0 ? params.NumWorkers : 1u;
+
+	for (auto worker = 0u; worker < numWorkers; worker++)
+		_workers.emplace_back([this]() { WorkerLoop(); });
+}
+
+JobQueue::~JobQueue()
+{
+	Stop();
+}
+
+void JobQueue::Push(const JobAction& job)
+{
+	{
+		std::scoped_lock lock(_mutex);
+		PushLocked(job, Clock::now());
+	}
+
+	_jobPosted.notify_one();
+}
+
+void JobQueue::Push(const std::vector<JobAction>& jobs)
+{
+	if (jobs.empty())
+		return;
+
+	{
+		std::scoped_lock lock(_mutex);
+		auto now = Clock::now();
+
+		for (auto& job : jobs)
+			PushLocked(job, now);
+	}
+
+	_jobPosted.notify_all();
+}
+
+void JobQueue::Stop()
+{
+	{
+		std::scoped_lock lock(_mutex);
+
+		if (_isQuitting)
+			return;
+
+		_isQuitting = true;
+	}
+
+	_jobPosted.notify_all();
+
+	for (auto& worker : _workers)
+	{
+		if (worker.joinable())
+			worker.join();
+	}
+
+	std::scoped_lock lock(_mutex);
+
+	for (auto& queue : _queues)
+		queue.clear();
+
+	_pending.clear();
+	_jobDone.notify_all();
+}
+
+bool JobQueue::WaitIdle(std::chrono::milliseconds timeout)
+{
+	std::unique_lock lock(_mutex);
+
+	return _jobDone.wait_for(lock, timeout, [this]() {
+		return _pending.empty() && _running.empty();
+	});
+}
+
+JobQueue::Metrics JobQueue::GetMetrics() const
+{
+	std::scoped_lock lock(_mutex);
+
+	Metrics metrics;
+	metrics.Depth = (unsigned int)_pending.size();
+	metrics.NumRun = _numRun;
+	metrics.NumCoalesced = _numCoalesced;
+	metrics.MeanLatencyMs = _numRun > 0 ? _totalLatencyMs / (double)_numRun : 0.0;
+	metrics.MaxLatencyMs = _maxLatencyMs;
+
+	return metrics;
+}
+
+unsigned int JobQueue::NumWorkers() const
+{
+	return (unsigned int)_workers.size();
+}
+
+JobQueue::JobPriority JobQueue::Priority(JobAction::JobType type)
+{
+	switch (type)
+	{
+	case JobAction::JOB_RESTORELOOP:
+		return PRIORITY_HIGH;
+	case JobAction::JOB_UPDATELOOPS:
+	case JobAction::JOB_PACKLOOP:
+	case JobAction::JOB_COMPRESSLOOP:
+		return PRIORITY_LOW;
+	}
+
+	return PRIORITY_LOW;
+}
+
+void JobQueue::WorkerLoop()
+{
+	std::unique_lock lock(_mutex);
+
+	while (true)
+	{
+		_jobPosted.wait(lock, [this]() {
+			if (_isQuitting)
+				return true;
+
+			for (auto& queue : _queues)
+			{
+				if (!queue.empty())
+					return true;
+			}
+
+			return false;
+		});
+
+		if (_isQuitting)
+			break;
+
+		std::string key;
+		for (auto& queue : _queues)
+		{
+			if (!queue.empty())
+			{
+				key = queue.front();
+				queue.pop_front();
+				break;
+			}
+		}
+
+		auto pending = _pending.find(key);
+		if (pending == _pending.end())
+			continue;
+
+		// Wait for the running one to finish, it is
+		// queued again from there
+		if (_running.find(key) != _running.end())
+		{
+			pending->second.IsQueued = false;
+			continue;
+		}
+
+		auto job = std::move(pending->second.Job);
+		auto latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - pending->second.PostTime).count();
+		_pending.erase(pending);
+		_running.insert(key);
+
+		_totalLatencyMs += latencyMs;
+		_maxLatencyMs = latencyMs > _maxLatencyMs ? latencyMs : _maxLatencyMs;
+
+		lock.unlock();
+
+		if (_params.RunJob)
+			_params.RunJob(job);
+
+		lock.lock();
+
+		_running.erase(key);
+		_numRun++;
+
+		pending = _pending.find(key);
+		if ((pending != _pending.end()) && !pending->second.IsQueued)
+		{
+			pending->second.IsQueued = true;
+			_queues[Priority(pending->second.Job.JobActionType)].push_front(key);
+			_jobPosted.notify_one();
+		}
+
+		_jobDone.notify_all();
+	}
+}
+
+void JobQueue::PushLocked(const JobAction& job, Clock::time_point postTime)
+{
+	if (_isQuitting)
+		return;
+
+	auto key = Key(job);
+	auto pending = _pending.find(key);
+
+	// Only the newest job runs, but it keeps the
+	// place in the queue of the one it replaces
+	if (pending != _pending.end())
+	{
+		pending->second.Job = job;
+		_numCoalesced++;
+
+		return;
+	}
+
+	_pending.emplace(key, PendingJob{ job, postTime, true });
+	_queues[Priority(job.JobActionType)].push_back(key);
+}
+
+std::string JobQueue::Key(const JobAction& job)
+{
+	return std::to_string((int)job.JobActionType) + ":" + job.SourceId;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../actions/JobAction.h"
+#include "../utils/RealtimeCheck.h"
+
+namespace engine
+{
+	class JobQueueParams
+	{
+	public:
+		unsigned int NumWorkers;
+		std::function<void(actions::JobAction&)> RunJob;
+	};
+
+	// Runs jobs on a set of workers that sleep until one is
+	// posted. A job with the same type and source as one still
+	// waiting replaces it, and higher priority jobs are taken
+	// first. A source never has two jobs of a type running at once.
+	class JobQueue
+	{
+	public:
+		enum JobPriority
+		{
+			PRIORITY_HIGH,
+			PRIORITY_LOW,
+			NUM_PRIORITIES
+		};
+
+		struct Metrics
+		{
+			unsigned int Depth; // Jobs waiting to run
+			unsigned long long NumRun;
+			unsigned long long NumCoalesced; // Jobs replaced by a newer one before running
+			double MeanLatencyMs; // From first being posted to starting to run
+			double MaxLatencyMs;
+		};
+
+	public:
+		JobQueue(JobQueueParams params);
+		~JobQueue();
+
+		// Copy
+		JobQueue(const JobQueue&) = delete;
+		JobQueue& operator=(const JobQueue&) = delete;
+
+	public:
+		void Push(const actions::JobAction& job);
+		void Push(const std::vector<actions::JobAction>& jobs);
+		// Waits for running jobs and drops any still waiting
+		void Stop();
+		bool WaitIdle(std::chrono::milliseconds timeout);
+		Metrics GetMetrics() const;
+		unsigned int NumWorkers() const;
+
+		static JobPriority Priority(actions::JobAction::JobType type);
+
+	protected:
+		typedef std::chrono::steady_clock Clock;
+
+		struct PendingJob
+		{
+			actions::JobAction Job;
+			Clock::time_point PostTime;
+			bool IsQueued; // False while waiting for the same job to finish
+		};
+
+		void WorkerLoop();
+		void PushLocked(const actions::JobAction& job, Clock::time_point postTime);
+
+		static std::string Key(const actions::JobAction& job);
+
+	protected:
+		JobQueueParams _params;
+		bool _isQuitting;
+		mutable utils::CheckedMutex _mutex;
+		std::condition_variable_any _jobPosted;
+		std::condition_variable_any _jobDone;
+		std::deque<std::string> _queues[NUM_PRIORITIES];
+		std::unordered_map<std::string, PendingJob> _pending;
+		std::unordered_set<std::string> _running;
+		unsigned long long _numRun;
+		unsigned long long _numCoalesced;
+		double _totalLatencyMs;
+		double _maxLatencyMs;
+		std::vector<std::thread> _workers;
+	};
+}
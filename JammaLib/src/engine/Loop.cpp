@@ -1,4 +1,6 @@
 #include "Loop.h"
+#include "../audio/MixKernels.h"
+#include "../io/WavStreamWriter.h"
 
 using namespace base;
 using namespace engine;
@@ -8,12 +10,14 @@ using base::MultiAudioSource;
 using audio::BufferBank;
 using audio::AudioMixer;
 using audio::AudioMixerParams;
+using audio::MixKernels;
 using audio::PanMixBehaviour;
 using gui::GuiSliderParams;
 using gui::GuiModel;
 using gui::GuiModelParams;
 using graphics::GlDrawContext;
 using actions::ActionResult;
+using actions::DoubleAction;
 using actions::JobAction;
 
 Loop::Loop(LoopParams loopParams,
@@ -28,7 +32,24 @@ Loop::Loop(LoopParams loopParams,
 	_loopParams(loopParams),
 	_mixer(nullptr),
 	_model(nullptr),
-	_bufferBank(BufferBank())
+	_bufferBank(BufferBank()),
+	_playBuffer(std::vector<float>(constants::MaxBlockSize, 0.0f)),
+	_storageMode(loopParams.Storage),
+	_isPackReady(false),
+	_numEdits(0u),
+	_packEdits(0u),
+	_pack(),
+	_isCompressReady(false),
+	_compressEdits(0u),
+	_compress(),
+	_isRestoreReady(false),
+	_restore(),
+	_isDiscardDue(false),
+	_hasSpent(false),
+	_spent(),
+	_idleSamps(0ul),
+	_pendingState(),
+	_fileStruct()
 {
 	_mixer = std::make_unique<AudioMixer>(mixerParams);
 
@@ -36,7 +57,7 @@ Loop::Loop(LoopParams loopParams,
 	modelParams.Size = { 12, 14 };
 	modelParams.ModelScale = 1.0f;
 	modelParams.ModelTexture = "grid";
-	modelParams.ModelShader = "texture_shaded";
+	modelParams.ModelShader = "loop";
 	_model = std::make_shared<LoopModel>(modelParams);
 
 	VuParams vuParams;
@@ -54,46 +75,67 @@ Loop::Loop(LoopParams loopParams,
 
 std::optional<std::shared_ptr<Loop>> Loop::FromFile(LoopParams loopParams, io::JamFile::Loop loopStruct, std::wstring dir)
 {
-	audio::BehaviourParams behaviour;
-	audio::WireMixBehaviourParams wire;
-	audio::PanMixBehaviourParams pan;
+	auto mixerParams = GetMixerParams(loopParams.Size, GetMixBehaviour(loopStruct.Mix));
 
-	std::vector<unsigned long> chans;
-	std::vector<double> levels;
-
-	switch (loopStruct.Mix.Mix)
-	{
-	case io::JamFile::LoopMix::MIX_WIRE:
-		if (loopStruct.Mix.Params.index() == 1)
-			chans = std::get<std::vector<unsigned long>>(loopStruct.Mix.Params);
-
-		for (auto chan : chans)
-			wire.Channels.push_back(chan);
+	loopParams.Wav = utils::EncodeUtf8(dir) + "/" + loopStruct.Name;
+	auto loop = std::make_shared<Loop>(loopParams, mixerParams);
 
-		behaviour = wire;
-		break;
-	case io::JamFile::LoopMix::MIX_PAN:
-		if (loopStruct.Mix.Params.index() == 1)
-			levels = std::get<std::vector<double>>(loopStruct.Mix.Params);
+	// Left empty by the loader if its wav is missing or too short
+	if (!loop->Load(io::WavReadWriter()))
+		return std::nullopt;
 
-		for (auto level : levels)
-			pan.ChannelLevels.push_back((float)level);
+	loop->_fileStruct = loopStruct;
+	loop->Play(loopStruct.MasterLoopCount, loopStruct.Length, false);
 
-		behaviour = pan;
-		break;
-	}
+	return loop;
+}
 
-	auto mixerParams = GetMixerParams(loopParams.Size, behaviour);
+std::optional<std::shared_ptr<Loop>> Loop::FromFile(LoopParams loopParams,
+	io::JamFile::Loop loopStruct,
+	std::shared_ptr<const io::SessionFile> session,
+	unsigned int loopIndex)
+{
+	auto mixerParams = GetMixerParams(loopParams.Size, GetMixBehaviour(loopStruct.Mix));
 
-	loopParams.Wav = utils::EncodeUtf8(dir) + "/" + loopStruct.Name;
+	loopParams.Wav = loopStruct.Name;
 	auto loop = std::make_shared<Loop>(loopParams, mixerParams);
 
-	loop->Load(io::WavReadWriter());
+	if (!loop->Load(session, loopIndex))
+		return std::nullopt;
+
+	loop->_fileStruct = loopStruct;
 	loop->Play(loopStruct.MasterLoopCount, loopStruct.Length, false);
 
 	return loop;
 }
 
+audio::BehaviourParams Loop::GetMixBehaviour(const io::JamFile::LoopMix& mix)
+{
+	audio::WireMixBehaviourParams wire;
+	audio::PanMixBehaviourParams pan;
+
+	switch (mix.Mix)
+	{
+	case io::JamFile::LoopMix::MIX_PAN:
+		if (mix.Params.index() == 1)
+		{
+			for (auto level : std::get<std::vector<double>>(mix.Params))
+				pan.ChannelLevels.push_back((float)level);
+		}
+
+		return pan;
+	case io::JamFile::LoopMix::MIX_WIRE:
+	default:
+		if (mix.Params.index() == 0)
+		{
+			for (auto chan : std::get<std::vector<unsigned long>>(mix.Params))
+				wire.Channels.push_back(chan);
+		}
+
+		return wire;
+	}
+}
+
 audio::AudioMixerParams Loop::GetMixerParams(utils::Size2d loopSize,
 	audio::BehaviourParams behaviour)
 {
@@ -171,6 +213,27 @@ int Loop::OnOverwrite(float samp, int indexOffset)
 	return indexOffset + 1;
 }
 
+int Loop::OnWriteBlock(const float* samps, unsigned int numSamps, int indexOffset)
+{
+	return OnOverwriteBlock(samps, numSamps, indexOffset);
+}
+
+int Loop::OnOverwriteBlock(const float* samps, unsigned int numSamps, int indexOffset)
+{
+	if ((STATE_RECORDING != _state) &&
+		(STATE_PLAYINGRECORDING != _state) &&
+		(STATE_OVERDUBBING != _state) &&
+		(STATE_PUNCHEDIN != _state))
+		return indexOffset;
+
+	if (STATE_RECORDING == _state)
+		_lastPeak = MixKernels::Peak(samps, numSamps, _lastPeak);
+
+	_bufferBank.Overwrite(_writeIndex + indexOffset, samps, numSamps);
+
+	return indexOffset + (int)numSamps;
+}
+
 void Loop::EndWrite(unsigned int numSamps, bool updateIndex)
 {
 	// Only update if currently recording
@@ -183,8 +246,9 @@ void Loop::EndWrite(unsigned int numSamps, bool updateIndex)
 	if (!updateIndex)
 		return;
 
+	_bufferBank.UpdateSummary(_writeIndex, numSamps);
 	_writeIndex += numSamps;
-	_bufferBank.SetLength(_writeIndex);
+	_bufferBank.SetLength(_writeIndex, true);
 }
 
 void Loop::OnPlay(const std::shared_ptr<MultiAudioSink> dest,
@@ -205,22 +269,44 @@ void Loop::OnPlay(const std::shared_ptr<MultiAudioSink> dest,
 
 	auto peak = 0.0f;
 
-	auto bufBankSize = _bufferBank.Length();
+	// Compressed samples are too slow to decode here. The mixer is
+	// held muted until the restore lands, then fades in from the
+	// play index, so the loop comes in late rather than part way.
+	auto bufBankSize = BufferBank::STORAGE_COMPRESSED == _bufferBank.Storage() ? 0ul : _bufferBank.Length();
+	auto samp = 0u;
 
-	for (auto i = 0u; i < numSamps; i++)
+	while (samp < numSamps)
 	{
-		if (index < bufBankSize)
-		{
-			auto samp = _bufferBank[index];
-			_mixer->OnPlay(dest, samp, i);
+		auto blockSamps = std::min(numSamps - samp, (unsigned int)_playBuffer.size());
+		auto blockSamp = 0u;
 
-			if (std::abs(samp) > peak)
-				peak = std::abs(samp);
+		// Copy in runs that stop at the loop's wrap point
+		// and at the end of each bank
+		while (blockSamp < blockSamps)
+		{
+			auto runSamps = (unsigned int)std::min((unsigned long)(blockSamps - blockSamp), bufSize - index);
+			auto out = _playBuffer.data() + blockSamp;
+
+			if (index < bufBankSize)
+			{
+				runSamps = (unsigned int)std::min((unsigned long)runSamps, bufBankSize - index);
+
+				// Converts packed samples on the way
+				auto numRead = _bufferBank.Read(index, out, runSamps);
+				std::fill(out + numRead, out + runSamps, 0.0f);
+			}
+			else
+				std::fill(out, out + runSamps, 0.0f);
+
+			blockSamp += runSamps;
+			index += runSamps;
+			if (index >= bufSize)
+				index -= _loopLength;
 		}
 
-		index++;
-		if (index >= bufSize)
-			index -= _loopLength;
+		peak = MixKernels::Peak(_playBuffer.data(), blockSamps, peak);
+		_mixer->OnPlay(dest, _playBuffer.data(), blockSamps, samp);
+		samp += blockSamps;
 	}
 
 	_lastPeak = peak;
@@ -228,6 +314,14 @@ void Loop::OnPlay(const std::shared_ptr<MultiAudioSink> dest,
 
 void Loop::EndMultiPlay(unsigned int numSamps)
 {
+	// Whatever is swapped out waits in _spent for the job
+	// to free, so nothing more is swapped until it has
+	if (!_hasSpent)
+		SwapStorage();
+
+	auto idleSamps = _idleSamps + numSamps;
+	_idleSamps = IsIdle() ? (idleSamps < _CompressIdleSamps ? idleSamps : _CompressIdleSamps) : 0ul;
+
 	if ((STATE_PLAYING != _state) && (STATE_PLAYINGRECORDING != _state))
 		return;
 
@@ -249,6 +343,95 @@ void Loop::EndMultiPlay(unsigned int numSamps)
 	_vu->SetValue(_lastPeak, numSamps);
 }
 
+ActionResult Loop::OnAction(DoubleAction action)
+{
+	// Unmuting may need the samples restored
+	if (IsRestoreDue())
+		_changesMade = true;
+
+	return { true, "", actions::ACTIONRESULT_DEFAULT, nullptr };
+}
+
+ActionResult Loop::OnAction(JobAction action)
+{
+	switch (action.JobActionType)
+	{
+	case JobAction::JOB_UPDATELOOPS:
+	{
+		Update();
+
+		ActionResult res;
+		res.IsEaten = true;
+		res.ResultType = actions::ACTIONRESULT_DEFAULT;
+
+		return res;
+	}
+	break;
+	case JobAction::JOB_PACKLOOP:
+	{
+		// One pack at a time, taken up by the audio thread
+		if (!_isPackReady && IsPackDue())
+		{
+			_packEdits = _numEdits;
+			_isPackReady = _bufferBank.PackInto(_storageMode, _pack);
+		}
+
+		ActionResult res;
+		res.IsEaten = true;
+		res.ResultType = actions::ACTIONRESULT_DEFAULT;
+
+		return res;
+	}
+	break;
+	case JobAction::JOB_COMPRESSLOOP:
+	{
+		if (!_isCompressReady && IsCompressDue())
+		{
+			_compressEdits = _numEdits;
+			_isCompressReady = _bufferBank.CompressInto(_compress);
+		}
+
+		// Nothing to hold on to until the next time
+		if (!_isCompressReady)
+			std::vector<std::uint8_t>().swap(_compress.Data);
+
+		ActionResult res;
+		res.IsEaten = true;
+		res.ResultType = actions::ACTIONRESULT_DEFAULT;
+
+		return res;
+	}
+	break;
+	case JobAction::JOB_RESTORELOOP:
+	{
+		// The audio thread leaves what it swapped out to be freed here,
+		// keeping the room reserved for next time
+		if (_hasSpent)
+		{
+			for (auto& page : _spent.Pages)
+				BufferBank::Pool().Release(std::move(page));
+
+			_spent.Pages.clear();
+			std::vector<std::uint8_t>().swap(_spent.Data);
+			_spent.Mapping.reset();
+			_hasSpent = false;
+		}
+
+		if (!_isRestoreReady && IsRestoreWanted())
+			_isRestoreReady = _bufferBank.RestoreInto(_restore);
+
+		ActionResult res;
+		res.IsEaten = true;
+		res.ResultType = actions::ACTIONRESULT_DEFAULT;
+
+		return res;
+	}
+	break;
+	}
+
+	return { false, "", actions::ACTIONRESULT_DEFAULT };
+}
+
 void Loop::OnPlayRaw(const std::shared_ptr<base::MultiAudioSink> dest,
 	unsigned int channel,
 	unsigned int delaySamps,
@@ -264,11 +447,24 @@ void Loop::OnPlayRaw(const std::shared_ptr<base::MultiAudioSink> dest,
 	while (index >= bufSize)
 		index -= _loopLength;
 
-	for (auto i = 0u; i < numSamps; i++)
+	// Silent while compressed, as in OnPlay
+	auto isCompressed = BufferBank::STORAGE_COMPRESSED == _bufferBank.Storage();
+	float samps[256];
+	auto i = 0u;
+
+	while (i < numSamps)
 	{
-		dest->OnWriteChannel(channel, _bufferBank[index], i);
+		auto runSamps = std::min(numSamps - i, (unsigned int)(bufSize - index));
+		runSamps = std::min(runSamps, (unsigned int)(sizeof(samps) / sizeof(float)));
 
-		index++;
+		auto numRead = isCompressed ? 0u : _bufferBank.Read(index, samps, runSamps);
+		std::fill(samps + numRead, samps + runSamps, 0.0f);
+
+		for (auto j = 0u; j < runSamps; j++)
+			dest->OnWriteChannel(channel, samps[j], i + j);
+
+		i += runSamps;
+		index += runSamps;
 		if (index >= bufSize)
 			index -= _loopLength;
 	}
@@ -292,31 +488,51 @@ std::string Loop::Id() const
 void Loop::Update()
 {
 	UpdateLoopModel();
-
-	_bufferBank.UpdateCapacity();
 }
 
 bool Loop::Load(const io::WavReadWriter& readWriter)
 {
-	auto loadOpt = readWriter.Read(utils::DecodeUtf8(_loopParams.Wav), constants::MaxLoopBufferSize);
+	auto wavOpt = readWriter.Map(utils::DecodeUtf8(_loopParams.Wav));
 
-	if (!loadOpt.has_value())
+	if (!wavOpt.has_value())
 		return false;
 
-	auto [buffer, sampleRate, bitDepth] = loadOpt.value();
+	auto& wav = wavOpt.value();
+	auto length = wav.Format.NumFrames < constants::MaxLoopBufferSize ?
+		wav.Format.NumFrames :
+		(unsigned long)constants::MaxLoopBufferSize;
+
+	if (length <= constants::MaxLoopFadeSamps)
+		return false;
 
 	_loopLength = 0;
 	_bufferBank.Init();
 
-	auto length = (unsigned long)buffer.size();
-	_bufferBank.SetLength(length);
-	_bufferBank.UpdateCapacity();
-
-	for (auto i = 0u; i < length; i++)
+	if (_loopParams.IsWavMapped && wav.IsInPlace())
+		_bufferBank.Map(wav.File, reinterpret_cast<const float*>(wav.Frames()), length);
+	else
 	{
-		_bufferBank[i] = buffer[i];
+		// Converted a page at a time, straight from the mapped file
+		_bufferBank.Reserve(length);
+		_bufferBank.SetLength(length, true);
+
+		auto index = 0ul;
+		auto bytesPerFrame = wav.Format.BytesPerFrame();
+
+		while (index < length)
+		{
+			auto [samps, numSamps] = _bufferBank.WriteSpan(index, (unsigned int)(length - index));
+
+			if (nullptr == samps)
+				break;
+
+			io::WavReadWriter::Convert(wav.Format, wav.Frames() + index * bytesPerFrame, samps, numSamps);
+			index += numSamps;
+		}
 	}
 
+	_bufferBank.UpdateSummary(0, length);
+
 	_loopLength = length - constants::MaxLoopFadeSamps;
 
 	UpdateLoopModel();
@@ -324,12 +540,128 @@ bool Loop::Load(const io::WavReadWriter& readWriter)
 	return true;
 }
 
+bool Loop::Load(const std::shared_ptr<const io::SessionFile>& session, unsigned int loopIndex)
+{
+	auto [samps, numSamps] = session->LoopSamps(loopIndex);
+	auto length = numSamps < constants::MaxLoopBufferSize ?
+		numSamps :
+		(unsigned long)constants::MaxLoopBufferSize;
+
+	if ((nullptr == samps) || (length <= constants::MaxLoopFadeSamps))
+		return false;
+
+	_loopLength = 0;
+	_bufferBank.Init();
+
+	// Played straight from the mapping, nothing is copied
+	_bufferBank.Map(session, samps, length);
+	_bufferBank.UpdateSummary(0, length);
+
+	_loopLength = length - constants::MaxLoopFadeSamps;
+
+	UpdateLoopModel();
+
+	return true;
+}
+
+std::optional<LoopSnapshot> Loop::Snapshot() const
+{
+	switch (_state)
+	{
+	case STATE_PLAYING:
+	case STATE_OVERDUBBING:
+	case STATE_PUNCHEDIN:
+		break;
+	default:
+		return std::nullopt;
+	}
+
+	// Read before anything else, so the length
+	// can't belong to a newer recording
+	auto generation = _bufferBank.Generation();
+	auto loopLength = _loopLength;
+	auto numSamps = loopLength + constants::MaxLoopFadeSamps;
+	auto playIndex = _playIndex;
+
+	if ((0 == loopLength) || (numSamps > _bufferBank.Length()))
+		return std::nullopt;
+
+	// Saved as where it plays from when reloaded, so loops stay in step
+	auto phase = playIndex > constants::MaxLoopFadeSamps ?
+		(playIndex - constants::MaxLoopFadeSamps) % loopLength :
+		0ul;
+
+	io::JamFile::LoopMix mix;
+	auto behaviour = _mixer->Behaviour();
+
+	if (auto wire = std::get_if<audio::WireMixBehaviourParams>(&behaviour))
+	{
+		mix.Mix = io::JamFile::LoopMix::MIX_WIRE;
+		mix.Params = std::vector<unsigned long>(wire->Channels.begin(), wire->Channels.end());
+	}
+	else
+	{
+		std::vector<double> levels;
+
+		if (auto pan = std::get_if<audio::PanMixBehaviourParams>(&behaviour))
+			levels.assign(pan->ChannelLevels.begin(), pan->ChannelLevels.end());
+
+		mix.Mix = io::JamFile::LoopMix::MIX_PAN;
+		mix.Params = levels;
+	}
+
+	// Groups and mute aren't acted on yet, but
+	// are saved back as they were loaded
+	LoopSnapshot snapshot;
+	snapshot.Struct = _fileStruct;
+	snapshot.Struct.Name = "";
+	snapshot.Struct.Length = loopLength;
+	snapshot.Struct.MasterLoopCount = phase;
+	snapshot.Struct.Level = _mixer->Level();
+	snapshot.Struct.Speed = _pitch;
+	snapshot.Struct.Mix = mix;
+	snapshot.NumSamps = numSamps;
+	snapshot.Generation = generation;
+
+	return snapshot;
+}
+
+bool Loop::WriteWav(const LoopSnapshot& snapshot, const std::wstring& fileName) const
+{
+	io::WavStreamWriter writer;
+
+	if (!writer.Open(fileName, 1u, constants::DefaultSampleRate))
+		return false;
+
+	auto isWritten = _bufferBank.Snapshot(snapshot.Generation,
+		snapshot.NumSamps,
+		[&writer](const float* samps, unsigned int numSamps) { return writer.Write(samps, numSamps); });
+
+	return writer.Close() && isWritten;
+}
+
+void Loop::Prepare()
+{
+	// As much as Record's capacity update asks for
+	_bufferBank.Reserve(constants::MaxLoopFadeSamps + BufferBank::_BufferCapacityAhead);
+}
+
 void Loop::Record()
 {
+	JAMMA_REALTIME_TAG("Loop::Record");
+
 	Reset();
 	_state = STATE_RECORDING;
-	_bufferBank.SetLength(constants::MaxLoopFadeSamps);
-	_bufferBank.UpdateCapacity();
+	_numEdits++;
+
+	// Nothing from a mapped wav or a pack is kept, so it is
+	// handed to the job to free rather than copied
+	_isDiscardDue = _bufferBank.IsMapped() || _bufferBank.IsPacked();
+
+	if (!_hasSpent)
+		SwapStorage();
+
+	_bufferBank.SetLength(constants::MaxLoopFadeSamps, true);
 }
 
 void Loop::Play(unsigned long index,
@@ -346,9 +678,13 @@ void Loop::Play(unsigned long index,
 
 	_playIndex = (index + constants::MaxLoopFadeSamps) >= bufSize ? (bufSize-1) : index + constants::MaxLoopFadeSamps;
 	_loopLength = loopLength;
+	_pendingState.reset();
 
 	auto playState = continueRecording ? STATE_PLAYINGRECORDING : STATE_PLAYING;
 	_state = loopLength > 0 ? playState : STATE_INACTIVE;
+
+	// Committed as a restore job if compressed
+	_changesMade = true;
 }
 
 void Loop::EndRecording()
@@ -360,28 +696,173 @@ void Loop::EndRecording()
 void Loop::Ditch()
 {
 	Reset();
-	_bufferBank.SetLength(constants::MaxLoopFadeSamps);
-	_bufferBank.UpdateCapacity();
+	_numEdits++;
+
+	_isDiscardDue = _bufferBank.IsMapped() || _bufferBank.IsPacked();
+
+	if (!_hasSpent)
+		SwapStorage();
+
+	_bufferBank.SetLength(constants::MaxLoopFadeSamps, true);
 }
 
 void Loop::Overdub()
 {
-	_state = STATE_OVERDUBBING;
+	_numEdits++;
+	SetWriteState(STATE_OVERDUBBING);
 }
 
 void Loop::PunchIn()
 {
-	_state = STATE_PUNCHEDIN;
+	_numEdits++;
+	SetWriteState(STATE_PUNCHEDIN);
 }
 
 void Loop::PunchOut()
 {
-	_state = STATE_OVERDUBBING;
+	if (_pendingState.has_value())
+		_pendingState = STATE_OVERDUBBING;
+	else
+		_state = STATE_OVERDUBBING;
+}
+
+void Loop::SetStorage(BufferBank::StorageMode mode)
+{
+	_storageMode = mode;
+}
+
+BufferBank::StorageMode Loop::Storage() const
+{
+	return _storageMode;
+}
+
+bool Loop::IsPackDue() const
+{
+	// Mapped samples already live outside the heap
+	return (BufferBank::STORAGE_FLOAT != _storageMode) &&
+		(STATE_PLAYING == _state) &&
+		!_bufferBank.IsMapped() &&
+		!_bufferBank.IsPacked() &&
+		!_isPackReady;
+}
+
+bool Loop::IsCompressDue() const
+{
+	return IsIdle() &&
+		(_idleSamps >= _CompressIdleSamps) &&
+		(_bufferBank.Length() > 0) &&
+		!_bufferBank.IsMapped() &&
+		(BufferBank::STORAGE_COMPRESSED != _bufferBank.Storage()) &&
+		!_isCompressReady;
+}
+
+bool Loop::IsRestoreDue() const
+{
+	return _hasSpent || (IsRestoreWanted() && !_isRestoreReady);
+}
+
+void Loop::InitReceivers()
+{
+	_mixer->SetReceiver(ActionReceiver::shared_from_this());
+}
+
+std::vector<JobAction> Loop::_CommitChanges()
+{
+	// Asked for here as soon as it is due, rather
+	// than waiting on the scene's memory check
+	if (!IsRestoreDue())
+		return {};
+
+	JobAction job;
+	job.JobActionType = JobAction::JOB_RESTORELOOP;
+	job.SourceId = Id();
+	job.Receiver = ActionReceiver::shared_from_this();
+
+	return { job };
+}
+
+void Loop::SwapStorage()
+{
+	if (_isDiscardDue)
+		_isDiscardDue = !_bufferBank.Discard(_spent);
+
+	if (_isPackReady)
+	{
+		// Turned down, and handed out too, if the
+		// loop has been recorded over since
+		if ((STATE_PLAYING != _state) || (_packEdits != _numEdits))
+			_pack.Mode = BufferBank::STORAGE_FLOAT;
+
+		_bufferBank.Pack(_pack, _spent);
+		_isPackReady = false;
+	}
+
+	if (_isCompressReady)
+	{
+		// Turned down if the loop was heard again in the meantime,
+		// leaving the data for the next job to reuse or free
+		if (IsIdle() && (_compressEdits == _numEdits))
+			_bufferBank.Compress(_compress, _spent);
+
+		_isCompressReady = false;
+	}
+
+	if (_isRestoreReady)
+	{
+		_bufferBank.Restore(_restore, _spent);
+		_isRestoreReady = false;
+	}
+
+	// The job to free it is committed straight away
+	if (!_spent.IsEmpty())
+	{
+		_hasSpent = true;
+		_changesMade = true;
+	}
+
+	// A waiting overdub starts once there are float samples to write to
+	if (_pendingState.has_value() && !_bufferBank.IsMapped() && !_bufferBank.IsPacked())
+	{
+		_state = _pendingState.value();
+		_pendingState.reset();
+	}
+
+	_mixer->HoldMuted(BufferBank::STORAGE_COMPRESSED == _bufferBank.Storage());
+}
+
+bool Loop::IsRestoreWanted() const
+{
+	// Overdubs need float pages to write to
+	if (_pendingState.has_value() || (STATE_OVERDUBBING == _state) || (STATE_PUNCHEDIN == _state))
+		return _bufferBank.IsMapped() || _bufferBank.IsPacked();
+
+	return (BufferBank::STORAGE_COMPRESSED == _bufferBank.Storage()) && !IsIdle();
+}
+
+bool Loop::IsIdle() const
+{
+	return (STATE_INACTIVE == _state) ||
+		((STATE_PLAYING == _state) && !_pendingState.has_value() && _mixer->IsMuted());
+}
+
+void Loop::SetWriteState(LoopVisualState state)
+{
+	if (_bufferBank.IsMapped() || _bufferBank.IsPacked())
+	{
+		// Committed as a restore job, and taken up by SwapStorage
+		_pendingState = state;
+		_changesMade = true;
+		return;
+	}
+
+	_pendingState.reset();
+	_state = state;
 }
 
 void Loop::Reset()
 {
 	_state = STATE_INACTIVE;
+	_pendingState.reset();
 
 	_writeIndex = 0;
 	_playIndex = 0;
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <memory>
+#include <atomic>
+#include <optional>
 #include "MultiAudioSource.h"
 #include "ActionReceiver.h"
 #include "ResourceUser.h"
@@ -12,10 +14,12 @@
 #include "../gui/GuiModel.h"
 #include "../io/FileReadWriter.h"
 #include "../io/JamFile.h"
+#include "../io/SessionFile.h"
 #include "../audio/BufferBank.h"
 #include "../audio/AudioMixer.h"
 #include "../graphics/GlDrawContext.h"
 #include "../resources/WavResource.h"
+#include "../utils/RealtimeCheck.h"
 
 namespace engine
 {
@@ -38,7 +42,9 @@ namespace engine
 			RecordTexture(""),
 			OverdubTexture(""),
 			PunchTexture(""),
-			FadeSamps(800u)
+			FadeSamps(800u),
+			IsWavMapped(false),
+			Storage(audio::BufferBank::STORAGE_FLOAT)
 		{
 		}
 
@@ -52,7 +58,9 @@ namespace engine
 			RecordTexture(""),
 			OverdubTexture(""),
 			PunchTexture(""),
-			FadeSamps(800u)
+			FadeSamps(800u),
+			IsWavMapped(false),
+			Storage(audio::BufferBank::STORAGE_FLOAT)
 		{
 		}
 
@@ -65,6 +73,17 @@ namespace engine
 		std::string OverdubTexture;
 		std::string PunchTexture;
 		unsigned int FadeSamps;
+		bool IsWavMapped; // Play mono float wavs straight from the mapped file
+		audio::BufferBank::StorageMode Storage; // How to hold the samples once recorded
+	};
+
+	// A loop as it stood when the jam was saved, with
+	// its samples still to be written out
+	struct LoopSnapshot
+	{
+		io::JamFile::Loop Struct;
+		unsigned long NumSamps; // Including the fade in
+		unsigned int Generation; // Of the loop's buffer bank
 	};
 
 	class Loop :
@@ -104,7 +123,24 @@ namespace engine
 			_mixer(std::move(other._mixer)),
 			_model(std::move(other._model)),
 			_vu(std::move(other._vu)),
-			_bufferBank(std::move(other._bufferBank))
+			_bufferBank(std::move(other._bufferBank)),
+			_playBuffer(std::vector<float>(constants::MaxBlockSize, 0.0f)),
+			_storageMode(other._storageMode.load()),
+			_isPackReady(false),
+			_numEdits(0u),
+			_packEdits(0u),
+			_pack(),
+			_isCompressReady(false),
+			_compressEdits(0u),
+			_compress(),
+			_isRestoreReady(false),
+			_restore(),
+			_isDiscardDue(other._isDiscardDue),
+			_hasSpent(false),
+			_spent(),
+			_idleSamps(0ul),
+			_pendingState(),
+			_fileStruct(other._fileStruct)
 		{
 			other._writeIndex = 0;
 			other._loopParams = LoopParams();
@@ -124,10 +160,31 @@ namespace engine
 				std::swap(_writeIndex, other._writeIndex);
 				std::swap(_playIndex, other._playIndex);
 				std::swap(_loopParams, other._loopParams);
+				std::swap(_fileStruct, other._fileStruct);
 				_mixer.swap(other._mixer);
 				_model.swap(other._model);
 				_vu.swap(other._vu);
 				std::swap(_bufferBank, other._bufferBank);
+				std::swap(_playBuffer, other._playBuffer);
+
+				auto storageMode = _storageMode.load();
+				_storageMode = other._storageMode.load();
+				other._storageMode = storageMode;
+
+				// A pack belongs to the samples it was made from
+				_isPackReady = false;
+				other._isPackReady = false;
+				_isCompressReady = false;
+				other._isCompressReady = false;
+				_isRestoreReady = false;
+				other._isRestoreReady = false;
+				std::swap(_isDiscardDue, other._isDiscardDue);
+				_idleSamps = 0ul;
+				other._idleSamps = 0ul;
+				_pendingState.reset();
+				other._pendingState.reset();
+				_numEdits++;
+				other._numEdits++;
 			}
 
 			return *this;
@@ -137,6 +194,12 @@ namespace engine
 		static std::optional<std::shared_ptr<Loop>> FromFile(LoopParams loopParams,
 			io::JamFile::Loop loopStruct,
 			std::wstring dir);
+		// Plays the samples straight from the session's mapping
+		static std::optional<std::shared_ptr<Loop>> FromFile(LoopParams loopParams,
+			io::JamFile::Loop loopStruct,
+			std::shared_ptr<const io::SessionFile> session,
+			unsigned int loopIndex);
+		static audio::BehaviourParams GetMixBehaviour(const io::JamFile::LoopMix& mix);
 		static audio::AudioMixerParams GetMixerParams(utils::Size2d loopSize,
 			audio::BehaviourParams behaviour);
 
@@ -148,7 +211,12 @@ namespace engine
 		virtual void EndMultiPlay(unsigned int numSamps) override;
 		inline virtual int OnWrite(float samp, int indexOffset) override;
 		inline virtual int OnOverwrite(float samp, int indexOffset) override;
+		virtual int OnWriteBlock(const float* samps, unsigned int numSamps, int indexOffset) override;
+		virtual int OnOverwriteBlock(const float* samps, unsigned int numSamps, int indexOffset) override;
 		virtual void EndWrite(unsigned int numSamps, bool updateIndex) override;
+		// Passed on by the mixer when its level is changed
+		virtual actions::ActionResult OnAction(actions::DoubleAction action) override;
+		virtual actions::ActionResult OnAction(actions::JobAction action) override;
 
 		void OnPlayRaw(const std::shared_ptr<base::MultiAudioSink> dest,
 			unsigned int channel,
@@ -160,6 +228,15 @@ namespace engine
 
 		void Update();
 		bool Load(const io::WavReadWriter& readWriter);
+		bool Load(const std::shared_ptr<const io::SessionFile>& session, unsigned int loopIndex);
+		// Empty unless the loop has finished recording
+		std::optional<LoopSnapshot> Snapshot() const;
+		// Safe from any thread, but fails if the loop has
+		// been recorded over since the snapshot was taken
+		bool WriteWav(const LoopSnapshot& snapshot, const std::wstring& fileName) const;
+		// Takes the page recording starts on, so it doesn't have
+		// to come from the pool on the audio thread
+		void Prepare();
 		void Record();
 		void Play(unsigned long index,
 			unsigned long loopLength,
@@ -169,13 +246,39 @@ namespace engine
 		void Overdub();
 		void PunchIn();
 		void PunchOut();
+		// Held as float while recording, then packed
+		// in the background once the loop is playing
+		void SetStorage(audio::BufferBank::StorageMode mode);
+		audio::BufferBank::StorageMode Storage() const;
+		bool IsPackDue() const;
+		// Compressed losslessly once idle for a while, when memory runs
+		// short, and restored as soon as it is played, unmuted or armed
+		// for overdubbing. Also due while there is storage left to free.
+		bool IsCompressDue() const;
+		bool IsRestoreDue() const;
 
 	protected:
+		virtual void InitReceivers() override;
+		virtual std::vector<actions::JobAction> _CommitChanges() override;
+		// Swaps in what the jobs have readied, between blocks
+		void SwapStorage();
+		// Mapped, packed or compressed samples the loop needs as float
+		bool IsRestoreWanted() const;
+		// Held pending until the samples are float, as mapped or
+		// packed samples take no writes and the input would be lost
+		void SetWriteState(LoopVisualState state);
 		void Reset();
 		unsigned long LoopIndex() const;
+		// Not playing, or playing with the mixer faded out
+		bool IsIdle() const;
 		static double CalcDrawRadius(unsigned long loopLength);
 		void UpdateLoopModel();
 
+	public:
+		// Loops only just muted or stopped are likely to be heard
+		// again soon, so are left alone for this long
+		static const unsigned long _CompressIdleSamps = 10ul * constants::DefaultSampleRate;
+
 	protected:
 		unsigned long _playIndex;
 		float _lastPeak;
@@ -187,5 +290,22 @@ namespace engine
 		std::shared_ptr<LoopModel> _model;
 		std::shared_ptr<VU> _vu;
 		audio::BufferBank _bufferBank;
+		std::vector<float> _playBuffer;
+		std::atomic<audio::BufferBank::StorageMode> _storageMode;
+		std::atomic<bool> _isPackReady; // Set by the job, cleared by the audio thread
+		std::atomic<unsigned int> _numEdits; // Recordings and overdubs started
+		unsigned int _packEdits; // Edits the pack was made after
+		audio::BufferBank::PackedSamps _pack;
+		std::atomic<bool> _isCompressReady;
+		unsigned int _compressEdits;
+		audio::BufferBank::CompressedSamps _compress;
+		std::atomic<bool> _isRestoreReady;
+		audio::BufferBank::PackedSamps _restore;
+		bool _isDiscardDue; // Recorded over while still packed
+		std::atomic<bool> _hasSpent; // Set by the audio thread, cleared by the job
+		audio::BufferBank::SpentSamps _spent;
+		std::atomic<unsigned long> _idleSamps; // Counted by the audio thread
+		std::optional<LoopVisualState> _pendingState; // Overdub waiting on float samples
+		io::JamFile::Loop _fileStruct; // As loaded, kept for the fields saved back unchanged
 	};
 }
@@ -11,12 +11,19 @@ using utils::Size2d;
 
 const Size2d LoopModel::_LedGap = { 6, 6 };
 const float LoopModel::_MinHeight = 4.0f;
-const float LoopModel::_RadialThicknessFrac = 1.0f / 20.0f;
 const float LoopModel::_HeightScale = 50.0f;
 
 LoopModel::LoopModel(LoopModelParams params) :
 	GuiModel(params),
-	_loopIndexFrac(0)
+	_loopIndexFrac(0),
+	_modelLength(0ul),
+	_bankGeneration(0u),
+	_numCompleteGrains(0u),
+	_radius(0.0f),
+	_grainMins({}),
+	_grainMaxs({}),
+	_grainVerts({}),
+	_grainUvs({})
 {
 }
 
@@ -67,146 +74,165 @@ void LoopModel::UpdateModel(const BufferBank& buffer,
 	unsigned long loopLength,
 	float radius)
 {
-	std::vector<float> verts;
-	std::vector<float> uvs;
-
-	auto lastYMin = -_MinHeight;
-	auto lastYMax = _MinHeight;
 	auto numGrains = (unsigned int)ceil((double)loopLength / (double)constants::GrainSamps);
+	auto generation = buffer.Generation();
+
+	// A shorter loop or a bank that has been cleared or
+	// swapped out means none of the cached grains can be trusted
+	if ((loopLength < _modelLength) || (generation != _bankGeneration))
+		_numCompleteGrains = 0;
+
+	_modelLength = loopLength;
+	_bankGeneration = generation;
+	_radius = radius;
+
+	auto firstDirtyGrain = UpdateGrainHeights(buffer, numGrains);
+	auto numDirtyGrains = numGrains + 1 - firstDirtyGrain;
+
+	_grainVerts.resize(numDirtyGrains * _TrisPerGrain * 9);
+	_grainUvs.resize(numDirtyGrains * _TrisPerGrain * 6);
 
-	for (auto grain = 1u; grain < numGrains; grain++)
+	for (auto grain = firstDirtyGrain; grain <= numGrains; grain++)
 	{
-		auto [grainVerts, grainUvs, nextYMin, nextYMax] =
-			CalcGrainGeometry(buffer,
-				grain,
-				numGrains,
-				lastYMin,
-				lastYMax,
-				radius);
-
-		for (auto vert : grainVerts)
-			verts.push_back(vert);
-
-		for (auto uv : grainUvs)
-			uvs.push_back(uv);
-
-		lastYMin = nextYMin;
-		lastYMax = nextYMax;
+		CalcGrainGeometry(grain,
+			_grainVerts.data() + (grain - firstDirtyGrain) * _TrisPerGrain * 9,
+			_grainUvs.data() + (grain - firstDirtyGrain) * _TrisPerGrain * 6);
 	}
 
-	auto [grainVerts, grainUvs, nextYMin, nextYMax] =
-		CalcGrainGeometry(buffer,
-			numGrains,
-			numGrains,
-			lastYMin,
-			lastYMax,
-			radius);
+	WriteGeometry(numGrains * _TrisPerGrain, (firstDirtyGrain - 1) * _TrisPerGrain, _grainVerts, _grainUvs);
+}
 
-	for (auto vert : grainVerts)
-		verts.push_back(vert);
+void LoopModel::SetModelUniforms(GlDrawContext& ctx)
+{
+	// Taken from the uploaded geometry, so
+	// the grains always go once around
+	ctx.SetUniform("NumGrains", (float)(_numTris / _TrisPerGrain));
+	ctx.SetUniform("Radius", _radius.load());
+}
+
+unsigned int LoopModel::UpdateGrainHeights(const BufferBank& buffer, unsigned int numGrains)
+{
+	// Grains that were fully recorded last time are kept,
+	// the rest are summarised again
+	auto firstGrain = std::min(_numCompleteGrains, numGrains) + 1;
+	auto length = buffer.Length();
 
-	for (auto uv : grainUvs)
-		uvs.push_back(uv);
+	_grainMins.resize(numGrains);
+	_grainMaxs.resize(numGrains);
 
-	SetGeometry(verts, uvs);
+	for (auto grain = firstGrain; grain <= numGrains; grain++)
+	{
+		auto i1 = constants::MaxLoopFadeSamps + (grain - 1) * constants::GrainSamps;
+		auto i2 = constants::MaxLoopFadeSamps + grain * constants::GrainSamps;
+		auto summary = buffer.Summary(i1, i2);
+
+		// The bank moved on part way, so the rest
+		// is left for the next update to redo
+		if (buffer.Generation() != _bankGeneration)
+		{
+			_numCompleteGrains = 0;
+			break;
+		}
+
+		_grainMins[grain - 1] = summary.Min;
+		_grainMaxs[grain - 1] = summary.Max;
+
+		if (i2 <= length)
+			_numCompleteGrains = grain;
+	}
+
+	return firstGrain;
 }
 
-std::tuple<std::vector<float>, std::vector<float>, float, float>
-LoopModel::CalcGrainGeometry(const BufferBank& buffer,
-	unsigned int grain,
-	unsigned int numGrains,
-	float lastYMin,
-	float lastYMax,
-	float radius)
+void LoopModel::CalcGrainGeometry(unsigned int grain,
+	float* verts,
+	float* uvs) const
 {
-	const float radialThickness = radius * _RadialThicknessFrac;
-
 	auto yToUv = [](float y) {
 		auto scale = 1.0f / ((_MinHeight * 2) + (_HeightScale * 2));
 		auto offset = 0.5f;
 		return scale * y + offset;
 	};
 
-	auto angle1 = ((float)constants::TWOPI) * ((float)(grain - 1) / (float)numGrains);
-	auto angle2 = ((float)constants::TWOPI) * ((float)grain / (float)numGrains);
-	auto i1 = constants::MaxLoopFadeSamps + (grain - 1) * constants::GrainSamps;
-	auto i2 = constants::MaxLoopFadeSamps + grain * constants::GrainSamps;
-	auto gMin = buffer.SubMin(i1, i2);
-	auto gMax = buffer.SubMax(i1, i2);
-
-	auto xInner1 = sin(angle1) * (radius - radialThickness);
-	auto xInner2 = sin(angle2) * (radius - radialThickness);
-	auto xOuter1 = sin(angle1) * (radius + radialThickness);
-	auto xOuter2 = sin(angle2) * (radius + radialThickness);
-	auto yMin = (_HeightScale * gMin) - _MinHeight;
-	auto yMax = (_HeightScale * gMax) + _MinHeight;
-	auto zInner1 = cos(angle1) * (radius - radialThickness);
-	auto zInner2 = cos(angle2) * (radius - radialThickness);
-	auto zOuter1 = cos(angle1) * (radius + radialThickness);
-	auto zOuter2 = cos(angle2) * (radius + radialThickness);
-
-	std::vector<float> verts;
-	std::vector<float> uvs;
+	// x is the grain edge, y the height and z is -1 on
+	// the inside of the ring and 1 on the outside
+	auto addVert = [&verts](float x, float y, float z) {
+		*verts++ = x;
+		*verts++ = y;
+		*verts++ = z;
+	};
+
+	auto addUv = [&uvs](float u, float v) {
+		*uvs++ = u;
+		*uvs++ = v;
+	};
+
+	auto edge1 = (float)(grain - 1);
+	auto edge2 = (float)grain;
+	auto lastYMin = grain > 1 ? (_HeightScale * _grainMins[grain - 2]) - _MinHeight : -_MinHeight;
+	auto lastYMax = grain > 1 ? (_HeightScale * _grainMaxs[grain - 2]) + _MinHeight : _MinHeight;
+	auto yMin = (_HeightScale * _grainMins[grain - 1]) - _MinHeight;
+	auto yMax = (_HeightScale * _grainMaxs[grain - 1]) + _MinHeight;
+	auto inner = -1.0f;
+	auto outer = 1.0f;
 
 	// Front
-	verts.push_back(xOuter1); verts.push_back(lastYMin); verts.push_back(zOuter1);
-	verts.push_back(xOuter2); verts.push_back(yMax); verts.push_back(zOuter2);
-	verts.push_back(xOuter1); verts.push_back(lastYMax); verts.push_back(zOuter1);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMin));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMax));
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMax));
-
-	verts.push_back(xOuter1); verts.push_back(lastYMin); verts.push_back(zOuter1);
-	verts.push_back(xOuter2); verts.push_back(yMin); verts.push_back(zOuter2);
-	verts.push_back(xOuter2); verts.push_back(yMax); verts.push_back(zOuter2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMin));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMin));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMax));
+	addVert(edge1, lastYMin, outer);
+	addVert(edge2, yMax, outer);
+	addVert(edge1, lastYMax, outer);
+	addUv(edge1, yToUv(lastYMin));
+	addUv(edge2, yToUv(yMax));
+	addUv(edge1, yToUv(lastYMax));
+
+	addVert(edge1, lastYMin, outer);
+	addVert(edge2, yMin, outer);
+	addVert(edge2, yMax, outer);
+	addUv(edge1, yToUv(lastYMin));
+	addUv(edge2, yToUv(yMin));
+	addUv(edge2, yToUv(yMax));
 
 	// Top
-	verts.push_back(xOuter1); verts.push_back(lastYMax); verts.push_back(zOuter1);
-	verts.push_back(xInner2); verts.push_back(yMax); verts.push_back(zInner2);
-	verts.push_back(xInner1); verts.push_back(lastYMax); verts.push_back(zInner1);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMax));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMax));
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMax));
-
-	verts.push_back(xOuter1); verts.push_back(lastYMax); verts.push_back(zOuter1);
-	verts.push_back(xOuter2); verts.push_back(yMax); verts.push_back(zOuter2);
-	verts.push_back(xInner2); verts.push_back(yMax); verts.push_back(zInner2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMax));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMax));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMax));
+	addVert(edge1, lastYMax, outer);
+	addVert(edge2, yMax, inner);
+	addVert(edge1, lastYMax, inner);
+	addUv(edge1, yToUv(lastYMax));
+	addUv(edge2, yToUv(yMax));
+	addUv(edge1, yToUv(lastYMax));
+
+	addVert(edge1, lastYMax, outer);
+	addVert(edge2, yMax, outer);
+	addVert(edge2, yMax, inner);
+	addUv(edge1, yToUv(lastYMax));
+	addUv(edge2, yToUv(yMax));
+	addUv(edge2, yToUv(yMax));
 
 	// Back
-	verts.push_back(xInner1); verts.push_back(lastYMin); verts.push_back(zInner1);
-	verts.push_back(xInner1); verts.push_back(lastYMax); verts.push_back(zInner1);
-	verts.push_back(xInner2); verts.push_back(yMax); verts.push_back(zInner2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMin));
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMax));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMax));
-
-	verts.push_back(xInner1); verts.push_back(lastYMin); verts.push_back(zInner1);
-	verts.push_back(xInner2); verts.push_back(yMax); verts.push_back(zInner2);
-	verts.push_back(xInner2); verts.push_back(yMin); verts.push_back(zInner2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMin));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMax));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMin));
+	addVert(edge1, lastYMin, inner);
+	addVert(edge1, lastYMax, inner);
+	addVert(edge2, yMax, inner);
+	addUv(edge1, yToUv(lastYMin));
+	addUv(edge1, yToUv(lastYMax));
+	addUv(edge2, yToUv(yMax));
+
+	addVert(edge1, lastYMin, inner);
+	addVert(edge2, yMax, inner);
+	addVert(edge2, yMin, inner);
+	addUv(edge1, yToUv(lastYMin));
+	addUv(edge2, yToUv(yMax));
+	addUv(edge2, yToUv(yMin));
 
 	// Bottom
-	verts.push_back(xOuter1); verts.push_back(lastYMin); verts.push_back(zOuter1);
-	verts.push_back(xInner1); verts.push_back(lastYMin); verts.push_back(zInner1);
-	verts.push_back(xInner2); verts.push_back(yMin); verts.push_back(zInner2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMin));
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMin));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMin));
-
-	verts.push_back(xOuter1); verts.push_back(lastYMin); verts.push_back(zOuter1);
-	verts.push_back(xInner2); verts.push_back(yMin); verts.push_back(zInner2);
-	verts.push_back(xOuter2); verts.push_back(yMin); verts.push_back(zOuter2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(lastYMin));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMin));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMin));
-
-	return std::make_tuple(verts, uvs, yMin, yMax);
+	addVert(edge1, lastYMin, outer);
+	addVert(edge1, lastYMin, inner);
+	addVert(edge2, yMin, inner);
+	addUv(edge1, yToUv(lastYMin));
+	addUv(edge1, yToUv(lastYMin));
+	addUv(edge2, yToUv(yMin));
+
+	addVert(edge1, lastYMin, outer);
+	addVert(edge2, yMin, inner);
+	addVert(edge2, yMin, outer);
+	addUv(edge1, yToUv(lastYMin));
+	addUv(edge2, yToUv(yMin));
+	addUv(edge2, yToUv(yMin));
 }
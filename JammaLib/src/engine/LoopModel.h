@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <memory>
 #include "../include/Constants.h"
@@ -52,20 +53,32 @@ namespace engine
 		static unsigned int TotalNumLeds(unsigned int vuHeight, unsigned int ledHeight);
 		static unsigned int CurrentNumLeds(unsigned int vuHeight, unsigned int ledHeight, double value);
 
-		std::tuple<std::vector<float>, std::vector<float>, float, float>
-			CalcGrainGeometry(const audio::BufferBank& buffer,
-				unsigned int grain,
-				unsigned int numGrains,
-				float lastYMin,
-				float lastYMax,
-				float radius);
+		virtual void SetModelUniforms(graphics::GlDrawContext& ctx) override;
+
+		unsigned int UpdateGrainHeights(const audio::BufferBank& buffer, unsigned int numGrains);
+		void CalcGrainGeometry(unsigned int grain,
+			float* verts,
+			float* uvs) const;
 
 	protected:
 		static const utils::Size2d _LedGap;
 		static const float _MinHeight;
-		static const float _RadialThicknessFrac;
 		static const float _HeightScale;
+		static const unsigned int _TrisPerGrain = 8u;
 
 		double _loopIndexFrac;
+		// Geometry is kept between updates, and only grains
+		// that were still being recorded are rebuilt. Vertices
+		// hold grain edges rather than angles, which the shader
+		// works out from the grain count and radius, so a longer
+		// loop doesn't move the grains already built.
+		unsigned long _modelLength;
+		unsigned int _bankGeneration;
+		unsigned int _numCompleteGrains;
+		std::atomic<float> _radius;
+		std::vector<float> _grainMins;
+		std::vector<float> _grainMaxs;
+		std::vector<float> _grainVerts;
+		std::vector<float> _grainUvs;
 	};
 }
@@ -1,4 +1,5 @@
 #include "LoopTake.h"
+#include <limits>
 
 using namespace engine;
 using base::AudioSink;
@@ -20,9 +21,7 @@ const Size2d LoopTake::_Gap = { 6, 6 };
 LoopTake::LoopTake(LoopTakeParams params) :
 	GuiElement(params),
 	MultiAudioSource(),
-	_flipLoopBuffer(false),
 	_loopsNeedUpdating(false),
-	_endRecordingCompleted(false),
 	_state(STATE_DEFAULT),
 	_id(params.Id),
 	_sourceId(""),
@@ -31,7 +30,10 @@ LoopTake::LoopTake(LoopTakeParams params) :
 	_endRecordSampCount(0),
 	_endRecordSamps(0),
 	_loops({}),
-	_backLoops({})
+	_spareLoops({}),
+	_spareChannels({}),
+	_guiLoops({}),
+	_loopEdits(_MaxPendingEdits)
 {
 }
 
@@ -39,19 +41,20 @@ LoopTake::~LoopTake()
 {
 }
 
-std::optional<std::shared_ptr<LoopTake>> LoopTake::FromFile(LoopTakeParams takeParams, io::JamFile::LoopTake takeStruct, std::wstring dir)
+std::optional<std::shared_ptr<LoopTake>> LoopTake::FromFile(LoopTakeParams takeParams,
+	io::JamFile::LoopTake takeStruct,
+	std::vector<std::shared_ptr<Loop>> loops)
 {
 	auto take = std::make_shared<LoopTake>(takeParams);
 
-	LoopParams loopParams;
-	loopParams.Wav = "hh";
-
-	for (auto loopStruct : takeStruct.Loops)
+	// Loops that failed to load are left out
+	for (auto& loop : loops)
 	{
-		auto loop = Loop::FromFile(loopParams, loopStruct, dir);
-		
-		if (loop.has_value())
-			take->AddLoop(loop.value());
+		if (loop && !take->AddLoop(loop))
+		{
+			std::cout << "Too many loops in take " << takeStruct.Name << std::endl;
+			return std::nullopt;
+		}
 	}
 
 	return take;
@@ -81,10 +84,15 @@ void LoopTake::EndMultiPlay(unsigned int numSamps)
 void LoopTake::OnWrite(const std::shared_ptr<MultiAudioSource> src,
 	unsigned int numSamps)
 {
+	auto recordSamps = RecordableSamps(numSamps);
+
+	if (0 == recordSamps)
+		return;
+
 	for (auto& loop : _loops)
 	{
 		auto inChan = loop->InputChannel();
-		src->OnPlayChannel(inChan, loop, numSamps);
+		src->OnPlayChannel(inChan, loop, recordSamps);
 	}
 }
 
@@ -92,63 +100,41 @@ void LoopTake::OnWriteChannel(unsigned int channel,
 	const std::shared_ptr<base::AudioSource> src,
 	unsigned int numSamps)
 {
+	auto recordSamps = RecordableSamps(numSamps);
+
+	if (0 == recordSamps)
+		return;
+
 	for (auto& loop : _loops)
 	{
 		if (loop->InputChannel() == channel)
-			src->OnPlay(loop, numSamps);
+			src->OnPlay(loop, recordSamps);
 	}
 }
 
 void LoopTake::EndMultiWrite(unsigned int numSamps, bool updateIndex)
 {
-	for (auto& loop : _loops)
-		 loop->EndWrite(numSamps, updateIndex);
+	auto recordSamps = RecordableSamps(numSamps);
 
-	if (STATE_PLAYINGRECORDING == _state)
-	{
-		_endRecordSampCount += numSamps;
-		if (_endRecordSampCount > _endRecordSamps)
-			_endRecordingCompleted = true;
-	}
+	for (auto& loop : _loops)
+		 loop->EndWrite(recordSamps, updateIndex);
 
 	if ((STATE_RECORDING == _state) ||
 		(STATE_PLAYINGRECORDING == _state))
 	{
-		_recordedSampCount += numSamps;
+		_recordedSampCount += recordSamps;
 		_loopsNeedUpdating = true;
 		_changesMade = true;
 	}
-}
-
-ActionResult LoopTake::OnAction(JobAction action)
-{
-	switch (action.JobActionType)
-	{
-	case JobAction::JOB_UPDATELOOPS:
-	{
-		UpdateLoops();
-
-		ActionResult res;
-		res.IsEaten = true;
-		res.ResultType = actions::ACTIONRESULT_DEFAULT;
 
-		return res;
-	}
-	break;
-	case JobAction::JOB_ENDRECORDING:
+	// The tail ends at an exact sample within the block,
+	// and nothing after it is written to the loops
+	if (STATE_PLAYINGRECORDING == _state)
 	{
-		EndRecording();
-
-		ActionResult res;
-		res.IsEaten = true;
-		res.ResultType = actions::ACTIONRESULT_DEFAULT;
-
-		return res;
+		_endRecordSampCount += recordSamps;
+		if (_endRecordSampCount >= _endRecordSamps)
+			EndRecording();
 	}
-	break;
-	}
-
-	return { false, "", actions::ACTIONRESULT_DEFAULT };
 }
 
 void LoopTake::OnPlayRaw(const std::shared_ptr<MultiAudioSink> dest,
@@ -163,12 +149,12 @@ void LoopTake::OnPlayRaw(const std::shared_ptr<MultiAudioSink> dest,
 	}
 }
 
-std::string LoopTake::Id() const
+const std::string& LoopTake::Id() const
 {
 	return _id;
 }
 
-std::string LoopTake::SourceId() const
+const std::string& LoopTake::SourceId() const
 {
 	return _sourceId;
 }
@@ -178,56 +164,91 @@ LoopTake::LoopTakeSource LoopTake::SourceType() const
 	return _sourceType;
 }
 
-std::shared_ptr<Loop> LoopTake::AddLoop(unsigned int chan)
+std::vector<std::shared_ptr<Loop>> LoopTake::Loops() const
+{
+	return _guiLoops;
+}
+
+bool LoopTake::AddLoop(std::shared_ptr<Loop> loop)
 {
-	auto newNumLoops = (unsigned int)_loops.size() + 1;
+	JAMMA_REALTIME_TAG("LoopTake::AddLoop");
 
-	auto loopHeight = CalcLoopHeight(_sizeParams.Size.Height, newNumLoops);
+	// Mirrored first, so a loop is never held by the
+	// audio thread alone
+	if (!_loopEdits.TryPush({ StructureEdit<Loop>::EDIT_ADD, loop }))
+		return false;
 
-	audio::WireMixBehaviourParams wire;
-	wire.Channels = { chan };
-	auto mixerParams = Loop::GetMixerParams({ 110, loopHeight }, wire);
-	
-	LoopParams loopParams;
-	loopParams.Wav = "hh";
-	loopParams.Id = "LP-" + utils::GetGuid();
-	loopParams.TakeId = _id;
-	auto loop = std::make_shared<Loop>(loopParams, mixerParams);
-	AddLoop(loop);
+	_loops.push_back(loop);
+	_changesMade = true;
 
-	return loop;
+	return true;
 }
 
-void LoopTake::AddLoop(std::shared_ptr<Loop> loop)
+void LoopTake::Prepare(const std::vector<unsigned int>& channels)
 {
-	_backLoops.push_back(loop);
-	_children.push_back(loop);
-	Init();
+	auto numLoops = (unsigned int)channels.size();
 
-	ArrangeLoops();
+	for (auto chan : channels)
+	{
+		auto loop = MakeLoop(chan, numLoops);
+		loop->Prepare();
 
-	_flipLoopBuffer = true;
-	_changesMade = true;
+		_spareLoops.push_back(loop);
+		_spareChannels.push_back(chan);
+	}
+
+	// Record only moves pointers around from here on
+	_loops.reserve(_loops.size() + _spareLoops.size());
 }
 
-void LoopTake::Record(std::vector<unsigned int> channels)
+bool LoopTake::Record(const std::vector<unsigned int>& channels)
 {
+	JAMMA_REALTIME_TAG("LoopTake::Record");
+
+	auto numSpares = 0u;
+
+	for (auto chan : channels)
+	{
+		auto spare = std::find(_spareChannels.begin(), _spareChannels.end(), chan);
+
+		if (_spareChannels.end() == spare)
+			return false;
+
+		numSpares++;
+	}
+
+	if (!_loopEdits.CanPush((unsigned int)_loops.size() + numSpares) ||
+		(_loops.capacity() < numSpares))
+		return false;
+
 	_state = STATE_RECORDING;
 
 	_recordedSampCount = 0;
 	_endRecordSampCount = 0;
 	_endRecordSamps = 0;
-	_backLoops.clear();
+	RemoveLoops();
 
 	for (auto chan : channels)
 	{
-		auto loop = AddLoop(chan);
-		loop->Record();
+		auto spare = std::find(_spareChannels.begin(), _spareChannels.end(), chan);
+
+		if (_spareChannels.end() == spare)
+			continue;
+
+		auto index = spare - _spareChannels.begin();
+		auto loop = std::move(_spareLoops[index]);
+
+		// Left in place, so nothing is freed here
+		*spare = std::numeric_limits<unsigned int>::max();
+
+		if (loop && AddLoop(loop))
+			loop->Record();
 	}
 
-	//_flipLoopBuffer = true;
 	_loopsNeedUpdating = true;
 	_changesMade = true;
+
+	return true;
 }
 
 unsigned long LoopTake::NumRecordedSamps() const
@@ -235,6 +256,11 @@ unsigned long LoopTake::NumRecordedSamps() const
 	return _recordedSampCount;
 }
 
+LoopTake::LoopTakeState LoopTake::GetState() const
+{
+	return _state;
+}
+
 void LoopTake::Play(unsigned long index,
 	unsigned long loopLength,
 	unsigned int endRecordSamps)
@@ -249,6 +275,7 @@ void LoopTake::Play(unsigned long index,
 
 	auto playState = endRecordSamps > 0 ? STATE_PLAYINGRECORDING : STATE_PLAYING;
 	_state = loopLength > 0 ? playState : STATE_DEFAULT;
+	_changesMade = true;
 }
 
 void LoopTake::EndRecording()
@@ -260,9 +287,19 @@ void LoopTake::EndRecording()
 	{
 		loop->EndRecording();
 	}
+
+	_changesMade = true;
 }
 
-void LoopTake::Ditch()
+void LoopTake::SetStorage(audio::BufferBank::StorageMode mode)
+{
+	for (auto& loop : _loops)
+		loop->SetStorage(mode);
+
+	_changesMade = true;
+}
+
+bool LoopTake::Ditch()
 {
 	_recordedSampCount = 0;
 	_endRecordSampCount = 0;
@@ -273,7 +310,7 @@ void LoopTake::Ditch()
 		loop->Ditch();
 	}
 
-	_loops.clear();
+	return RemoveLoops();
 }
 
 void LoopTake::Overdub()
@@ -306,6 +343,34 @@ void LoopTake::PunchOut()
 	}
 }
 
+unsigned int LoopTake::RecordableSamps(unsigned int numSamps) const
+{
+	if (STATE_PLAYINGRECORDING != _state)
+		return numSamps;
+
+	auto remaining = _endRecordSamps > _endRecordSampCount ?
+		_endRecordSamps - _endRecordSampCount :
+		0u;
+
+	return numSamps < remaining ? numSamps : remaining;
+}
+
+std::shared_ptr<Loop> LoopTake::MakeLoop(unsigned int chan, unsigned int numLoops) const
+{
+	auto loopHeight = CalcLoopHeight(_sizeParams.Size.Height, numLoops);
+
+	audio::WireMixBehaviourParams wire;
+	wire.Channels = { chan };
+	auto mixerParams = Loop::GetMixerParams({ 110, loopHeight }, wire);
+
+	LoopParams loopParams;
+	loopParams.Wav = "hh";
+	loopParams.Id = "LP-" + utils::GetGuid();
+	loopParams.TakeId = _id;
+
+	return std::make_shared<Loop>(loopParams, mixerParams);
+}
+
 unsigned int LoopTake::CalcLoopHeight(unsigned int takeHeight, unsigned int numLoops)
 {
 	if (0 == numLoops)
@@ -330,56 +395,68 @@ void LoopTake::_InitResources(ResourceLib& resourceLib, bool forceInit)
 
 std::vector<JobAction> LoopTake::_CommitChanges()
 {
-	if (_flipLoopBuffer)
-	{
-		_flipLoopBuffer = false;
-
-		// Remove and add any children
-		// (difference between back and front LoopTake buffer)
-		std::vector<std::shared_ptr<Loop>> toAdd;
-		std::vector<std::shared_ptr<Loop>> toRemove;
-		std::copy_if(_backLoops.begin(), _backLoops.end(), std::back_inserter(toAdd), [&](const std::shared_ptr<Loop>& loop) { return (std::find(_loops.begin(), _loops.end(), loop) == _loops.end()); });
-		std::copy_if(_loops.begin(), _loops.end(), std::back_inserter(toRemove), [&](const std::shared_ptr<Loop>& loop) { return (std::find(_backLoops.begin(), _backLoops.end(), loop) == _backLoops.end()); });
+	// Mirror any loops the audio thread has added or removed
+	// (removed loops are released here, off the audio thread)
+	StructureEdit<Loop> edit;
+	auto numEdits = 0u;
 
-		for (auto& loop : toAdd)
+	while (_loopEdits.TryPop(edit))
+	{
+		switch (edit.EditType)
 		{
-			loop->SetParent(GuiElement::shared_from_this());
-			loop->Init();
-			_children.push_back(loop);
-		}
-
-		for (auto& loop : toRemove)
+		case StructureEdit<Loop>::EDIT_ADD:
+			edit.Item->SetParent(GuiElement::shared_from_this());
+			edit.Item->Init();
+			_children.push_back(edit.Item);
+			_guiLoops.push_back(edit.Item);
+			break;
+		case StructureEdit<Loop>::EDIT_REMOVE:
 		{
-			auto child = std::find(_children.begin(), _children.end(), loop);
+			auto child = std::find(_children.begin(), _children.end(), edit.Item);
 			if (_children.end() != child)
 				_children.erase(child);
-		}
 
-		_loops = _backLoops; // TODO: Undo?
+			auto guiLoop = std::find(_guiLoops.begin(), _guiLoops.end(), edit.Item);
+			if (_guiLoops.end() != guiLoop)
+				_guiLoops.erase(guiLoop);
+			break;
+		}
+		}
 
+		edit = StructureEdit<Loop>();
+		numEdits++;
 	}
+
+	if (numEdits > 0)
+		ArrangeLoops();
+
 	std::vector<JobAction> jobs;
 
-	if (_loopsNeedUpdating)
+	if (_loopsNeedUpdating.exchange(false))
 	{
-		_loopsNeedUpdating = false;
-
-		JobAction job;
-		job.JobActionType = JobAction::JOB_UPDATELOOPS;
-		job.SourceId = Id();
-		job.Receiver = ActionReceiver::shared_from_this();
-		jobs.push_back(job);
+		for (auto& loop : _guiLoops)
+		{
+			JobAction job;
+			job.JobActionType = JobAction::JOB_UPDATELOOPS;
+			job.SourceId = loop->Id();
+			job.Receiver = loop->ActionReceiver::shared_from_this();
+			jobs.push_back(job);
+		}
 	}
 
-	if (_endRecordingCompleted)
+	// Loops pack their samples once they settle into
+	// playing, checked again each commit until they do
+	for (auto& loop : _guiLoops)
 	{
-		_endRecordingCompleted = false;
-
-		JobAction job;
-		job.JobActionType = JobAction::JOB_ENDRECORDING;
-		job.SourceId = Id();
-		job.Receiver = ActionReceiver::shared_from_this();
-		jobs.push_back(job);
+		if (loop->IsPackDue())
+		{
+			JobAction job;
+			job.JobActionType = JobAction::JOB_PACKLOOP;
+			job.SourceId = loop->Id();
+			job.Receiver = loop->ActionReceiver::shared_from_this();
+			jobs.push_back(job);
+			_changesMade = true;
+		}
 	}
 
 	return jobs;
@@ -387,7 +464,7 @@ std::vector<JobAction> LoopTake::_CommitChanges()
 
 void LoopTake::ArrangeLoops()
 {
-	auto numLoops = (unsigned int)_backLoops.size();
+	auto numLoops = (unsigned int)_guiLoops.size();
 
 	if (0 == numLoops)
 		return;
@@ -399,7 +476,7 @@ void LoopTake::ArrangeLoops()
 	auto dScale = 0.1;
 	auto dTotalScale = 0.4 / ((double)numLoops);
 
-	for (auto& loop : _backLoops)
+	for (auto& loop : _guiLoops)
 	{
 		loop->SetPosition({ (int)_Gap.Width, (int)(_Gap.Height + (loopCount * loopHeight)) });
 		loop->SetSize(loopSize);
@@ -412,10 +489,18 @@ void LoopTake::ArrangeLoops()
 	}
 }
 
-void LoopTake::UpdateLoops()
+bool LoopTake::RemoveLoops()
 {
+	// All or nothing, so the gui thread's mirror never
+	// loses track of a loop still being played
+	if (!_loopEdits.CanPush((unsigned int)_loops.size()))
+		return false;
+
 	for (auto& loop : _loops)
-	{
-		loop->Update();
-	}
+		_loopEdits.TryPush({ StructureEdit<Loop>::EDIT_REMOVE, loop });
+
+	_loops.clear();
+	_changesMade = true;
+
+	return true;
 }
@@ -9,6 +9,8 @@
 #include "AudioSink.h"
 #include "ActionUndo.h"
 #include "Trigger.h"
+#include "StructureEdit.h"
+#include "../utils/SpscQueue.h"
 
 namespace engine
 {
@@ -74,7 +76,9 @@ namespace engine
 		LoopTake& operator=(const LoopTake&) = delete;
 
 	public:
-		static std::optional<std::shared_ptr<LoopTake>> FromFile(LoopTakeParams takeParams, io::JamFile::LoopTake takeStruct, std::wstring dir);
+		static std::optional<std::shared_ptr<LoopTake>> FromFile(LoopTakeParams takeParams,
+			io::JamFile::LoopTake takeStruct,
+			std::vector<std::shared_ptr<Loop>> loops);
 
 		virtual void SetSize(utils::Size2d size) override;
 		virtual MultiAudioDirection MultiAudibleDirection() const override { return MULTIAUDIO_BOTH; }
@@ -86,42 +90,54 @@ namespace engine
 			const std::shared_ptr<base::AudioSource> src,
 			unsigned int numSamps);
 		virtual void EndMultiWrite(unsigned int numSamps, bool updateIndex) override;
-		virtual actions::ActionResult OnAction(actions::JobAction action) override;
 
 		void OnPlayRaw(const std::shared_ptr<MultiAudioSink> dest,
 			unsigned int delaySamps,
 			unsigned int numSamps);		
-		std::string Id() const;
-		std::string SourceId() const;
+		const std::string& Id() const;
+		const std::string& SourceId() const;
 		LoopTakeSource SourceType() const;
 		unsigned long NumRecordedSamps() const;
-		std::shared_ptr<Loop> AddLoop(unsigned int chan);
-		void AddLoop(std::shared_ptr<Loop> loop);
-
-		void Record(std::vector<unsigned int> channels);
+		LoopTakeState GetState() const;
+		// The gui thread's view of the loops
+		std::vector<std::shared_ptr<Loop>> Loops() const;
+		// Fails if the gui thread has yet to catch up with earlier edits
+		bool AddLoop(std::shared_ptr<Loop> loop);
+		// Builds a loop per channel for Record to use, off the audio
+		// thread and before the take is handed to it
+		void Prepare(const std::vector<unsigned int>& channels);
+
+		// Records on the prepared loops of the given channels,
+		// failing if any are missing or can't be handed over
+		bool Record(const std::vector<unsigned int>& channels);
 		void Play(unsigned long index,
 			unsigned long loopLength,
 			unsigned int endRecordSamps);
 		void EndRecording();
-		void Ditch();
+		// Loops that can't be handed to the gui thread stay
+		// in the take, to be released along with it
+		bool Ditch();
 		void Overdub();
 		void PunchIn();
 		void PunchOut();
+		void SetStorage(audio::BufferBank::StorageMode mode);
 
 	protected:
 		static unsigned int CalcLoopHeight(unsigned int takeHeight, unsigned int numLoops);
 
+		unsigned int RecordableSamps(unsigned int numSamps) const;
+		std::shared_ptr<Loop> MakeLoop(unsigned int chan, unsigned int numLoops) const;
+
 		virtual void _InitResources(resources::ResourceLib& resourceLib, bool forceInit) override;
 		virtual std::vector<actions::JobAction> _CommitChanges() override;
 		void ArrangeLoops();
-		void UpdateLoops();
+		bool RemoveLoops();
 
 	protected:
 		static const utils::Size2d _Gap;
+		static const unsigned int _MaxPendingEdits = 256u;
 
-		bool _flipLoopBuffer;
-		bool _loopsNeedUpdating;
-		bool _endRecordingCompleted;
+		std::atomic<bool> _loopsNeedUpdating;
 		LoopTakeState _state;
 		std::string _id;
 		std::string _sourceId;
@@ -129,7 +145,13 @@ namespace engine
 		unsigned long _recordedSampCount;
 		unsigned int _endRecordSampCount;
 		unsigned int _endRecordSamps;
+		// Owned by the audio thread
 		std::vector<std::shared_ptr<Loop>> _loops;
-		std::vector<std::shared_ptr<Loop>> _backLoops;
+		// Built by Prepare, taken up by Record
+		std::vector<std::shared_ptr<Loop>> _spareLoops;
+		std::vector<unsigned int> _spareChannels;
+		// Mirror of _loops owned by the gui thread
+		std::vector<std::shared_ptr<Loop>> _guiLoops;
+		utils::SpscQueue<StructureEdit<Loop>> _loopEdits;
 	};
 }
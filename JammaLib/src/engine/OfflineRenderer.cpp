@@ -0,0 +1,218 @@
+#include "OfflineRenderer.h"
+
+using namespace engine;
+using io::JamFile;
+using io::RigFile;
+using io::TextReadWriter;
+using io::WavReadWriter;
+using io::WavStreamWriter;
+
+OfflineRenderer::OfflineRenderer(OfflineRendererParams params) :
+	_params(params),
+	_inputs({}),
+	_inBuffer({}),
+	_outBuffer({})
+{
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+}
+
+std::optional<std::shared_ptr<Scene>> OfflineRenderer::LoadScene(SceneParams sceneParams,
+	const std::wstring& jamFile,
+	const std::wstring& rigFile)
+{
+	JamLoader loader(JamLoader::DefaultParams());
+	return LoadScene(sceneParams, jamFile, rigFile, loader);
+}
+
+std::optional<std::shared_ptr<Scene>> OfflineRenderer::LoadScene(SceneParams sceneParams,
+	const std::wstring& jamFile,
+	const std::wstring& rigFile,
+	JamLoader& loader)
+{
+	TextReadWriter txtFile;
+
+	auto jamRes = txtFile.Read(jamFile, _MaxJsonChars);
+	if (!jamRes.has_value())
+		return std::nullopt;
+
+	auto rigRes = txtFile.Read(rigFile, _MaxJsonChars);
+	if (!rigRes.has_value())
+		return std::nullopt;
+
+	auto [jamJson, jamChars, jamUnused] = jamRes.value();
+	auto [rigJson, rigChars, rigUnused] = rigRes.value();
+
+	auto jam = JamFile::FromStream(std::stringstream(jamJson));
+	if (!jam.has_value())
+		return std::nullopt;
+
+	auto rig = RigFile::FromStream(std::stringstream(rigJson));
+	if (!rig.has_value())
+		return std::nullopt;
+
+	auto dir = std::filesystem::path(jamFile).parent_path().wstring();
+
+	return Scene::FromFile(sceneParams, jam.value(), rig.value(), dir, loader);
+}
+
+std::optional<OfflineStartupStats> OfflineRenderer::MeasureStartup(SceneParams sceneParams,
+	const std::wstring& jamFile,
+	const std::wstring& rigFile,
+	JamLoaderParams loaderParams)
+{
+	if ((0 == _params.BlockSize) || (_params.BlockSize > constants::MaxBlockSize))
+		return std::nullopt;
+
+	auto startTime = Timer::GetTime();
+
+	JamLoader loader(loaderParams);
+	auto scene = LoadScene(sceneParams, jamFile, rigFile, loader);
+
+	if (!scene.has_value())
+		return std::nullopt;
+
+	auto loadTime = Timer::GetTime();
+
+	_inBuffer = std::vector<float>(_params.BlockSize * _params.NumInputChannels, 0.0f);
+	_outBuffer = std::vector<float>(_params.BlockSize * _params.NumOutputChannels, 0.0f);
+
+	auto inBuf = _params.NumInputChannels > 0 ? _inBuffer.data() : nullptr;
+	auto outBuf = _params.NumOutputChannels > 0 ? _outBuffer.data() : nullptr;
+
+	scene.value()->InitOfflineAudio(_params.NumInputChannels, _params.NumOutputChannels);
+	scene.value()->RenderOfflineAudio(inBuf, outBuf, _params.BlockSize);
+
+	OfflineStartupStats stats;
+	stats.NumLoops = loader.Stats().NumLoaded;
+	stats.LoadSeconds = Timer::GetElapsedSeconds(startTime, loadTime);
+	stats.FirstAudioSeconds = Timer::GetElapsedSeconds(startTime, Timer::GetTime());
+
+	return stats;
+}
+
+std::optional<OfflineRenderStats> OfflineRenderer::Render(Scene& scene)
+{
+	return Render(scene, std::function<void(const float*, unsigned int)>());
+}
+
+std::optional<OfflineRenderStats> OfflineRenderer::Render(Scene& scene,
+	std::function<void(const float*, unsigned int)> onBlock)
+{
+	if ((0 == _params.BlockSize) || (_params.BlockSize > constants::MaxBlockSize))
+		return std::nullopt;
+
+	if (!LoadInputs())
+		return std::nullopt;
+
+	WavStreamWriter writer;
+	if (!_params.OutputFile.empty())
+	{
+		if (!writer.Open(_params.OutputFile, _params.NumOutputChannels, _params.SampleRate))
+			return std::nullopt;
+	}
+
+	_inBuffer = std::vector<float>(_params.BlockSize * _params.NumInputChannels, 0.0f);
+	_outBuffer = std::vector<float>(_params.BlockSize * _params.NumOutputChannels, 0.0f);
+
+	scene.InitOfflineAudio(_params.NumInputChannels, _params.NumOutputChannels);
+	scene.Telemetry()->SetSampleRate(_params.SampleRate);
+	scene.Telemetry()->Reset();
+
+	auto inBuf = _params.NumInputChannels > 0 ? _inBuffer.data() : nullptr;
+	auto outBuf = _params.NumOutputChannels > 0 ? _outBuffer.data() : nullptr;
+	auto samp = 0ul;
+	auto numBlocks = 0u;
+
+	utils::RealtimeCheckGuard realtimeCheck;
+	auto numViolations = utils::RealtimeCheck::NumViolations();
+	auto startTime = Timer::GetTime();
+
+	while (samp < _params.NumSamps)
+	{
+		auto blockSamps = (unsigned int)std::min((unsigned long)_params.BlockSize, _params.NumSamps - samp);
+
+		// Rendering outruns the scene's job thread, so the
+		// recording pages are topped up here between blocks
+		audio::BufferBank::Pool().Refill();
+		audio::BufferBank::SummaryPool().Refill();
+
+		FillInput(samp, blockSamps);
+		scene.RenderOfflineAudio(inBuf, outBuf, blockSamps);
+
+		if (writer.IsOpen())
+			writer.Write(_outBuffer.data(), blockSamps);
+
+		if (onBlock)
+			onBlock(_outBuffer.data(), blockSamps);
+
+		samp += blockSamps;
+		numBlocks++;
+	}
+
+	auto seconds = Timer::GetElapsedSeconds(startTime, Timer::GetTime());
+	numViolations = utils::RealtimeCheck::NumViolations() - numViolations;
+
+	if (writer.IsOpen() && !writer.Close())
+		return std::nullopt;
+
+	OfflineRenderStats stats;
+	stats.NumSamps = samp;
+	stats.NumBlocks = numBlocks;
+	stats.Seconds = seconds;
+	stats.SampsPerSecond = seconds > 0.0 ? (double)samp / seconds : 0.0;
+	stats.RealtimeFactor = _params.SampleRate > 0 ? stats.SampsPerSecond / (double)_params.SampleRate : 0.0;
+	stats.NumRealtimeViolations = numViolations;
+
+	return stats;
+}
+
+bool OfflineRenderer::LoadInputs()
+{
+	WavReadWriter wavFile;
+	_inputs = std::vector<std::vector<float>>(_params.NumInputChannels);
+
+	for (auto chan = 0u; chan < _params.NumInputChannels; chan++)
+	{
+		if ((chan >= _params.InputFiles.size()) || _params.InputFiles[chan].empty())
+			continue;
+
+		auto wav = wavFile.Read(_params.InputFiles[chan], constants::MaxLoopBufferSize);
+		if (!wav.has_value())
+		{
+			std::cout << "Offline input " << chan << " failed to load, using silence" << std::endl;
+			continue;
+		}
+
+		auto [buffer, numSamps, sampleRate] = wav.value();
+
+		// Played back at the wrong speed otherwise
+		if (sampleRate != _params.SampleRate)
+		{
+			std::cout << "Offline input " << chan << " is at " << sampleRate << "Hz, not " << _params.SampleRate << "Hz" << std::endl;
+			return false;
+		}
+
+		_inputs[chan] = std::move(buffer);
+	}
+
+	return true;
+}
+
+void OfflineRenderer::FillInput(unsigned long samp, unsigned int numSamps)
+{
+	auto numChannels = _params.NumInputChannels;
+
+	for (auto chan = 0u; chan < numChannels; chan++)
+	{
+		auto& input = _inputs[chan];
+
+		for (auto i = 0u; i < numSamps; i++)
+		{
+			auto index = samp + i;
+			_inBuffer[i * numChannels + chan] = index < input.size() ? input[index] : 0.0f;
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <filesystem>
+#include "Scene.h"
+#include "Timer.h"
+#include "JamLoader.h"
+#include "../io/WavReadWriter.h"
+#include "../io/WavStreamWriter.h"
+#include "../io/TextReadWriter.h"
+#include "../utils/RealtimeCheck.h"
+
+namespace engine
+{
+	class OfflineRendererParams
+	{
+	public:
+		unsigned int BlockSize;
+		unsigned int SampleRate;
+		unsigned int NumInputChannels;
+		unsigned int NumOutputChannels;
+		unsigned long NumSamps; // Total length to render
+		std::vector<std::wstring> InputFiles; // One mono wav per input channel at SampleRate (missing or empty is silence)
+		std::wstring OutputFile; // Multichannel float wav of the DAC output (empty to skip)
+	};
+
+	struct OfflineRenderStats
+	{
+		unsigned long NumSamps;
+		unsigned int NumBlocks;
+		double Seconds;
+		double SampsPerSecond;
+		double RealtimeFactor;
+		unsigned long long NumRealtimeViolations; // Only counted in JAMMA_REALTIME_CHECKS builds
+	};
+
+	struct OfflineStartupStats
+	{
+		unsigned int NumLoops;
+		double LoadSeconds; // Reading the jam and rig, and loading every loop
+		double FirstAudioSeconds; // From the start of loading until the first block is rendered
+	};
+
+	// Drives a Scene with no audio device, stepping it block
+	// by block as fast as the CPU allows
+	class OfflineRenderer
+	{
+	public:
+		OfflineRenderer(OfflineRendererParams params);
+		~OfflineRenderer();
+
+	public:
+		static std::optional<std::shared_ptr<Scene>> LoadScene(SceneParams sceneParams,
+			const std::wstring& jamFile,
+			const std::wstring& rigFile);
+		static std::optional<std::shared_ptr<Scene>> LoadScene(SceneParams sceneParams,
+			const std::wstring& jamFile,
+			const std::wstring& rigFile,
+			JamLoader& loader);
+
+		// Time to first audio, loading the scene from scratch
+		std::optional<OfflineStartupStats> MeasureStartup(SceneParams sceneParams,
+			const std::wstring& jamFile,
+			const std::wstring& rigFile,
+			JamLoaderParams loaderParams);
+		std::optional<OfflineRenderStats> Render(Scene& scene);
+		std::optional<OfflineRenderStats> Render(Scene& scene,
+			std::function<void(const float*, unsigned int)> onBlock);
+
+	protected:
+		// Fails if an input isn't at the render's sample rate
+		bool LoadInputs();
+		void FillInput(unsigned long samp, unsigned int numSamps);
+
+	protected:
+		static const unsigned int _MaxJsonChars = 1000000u;
+
+		OfflineRendererParams _params;
+		std::vector<std::vector<float>> _inputs;
+		std::vector<float> _inBuffer;
+		std::vector<float> _outBuffer;
+	};
+}
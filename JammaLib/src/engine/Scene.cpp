@@ -1,5 +1,7 @@
 #include "Scene.h"
 #include "glm/ext.hpp"
+#include <fstream>
+#include <filesystem>
 
 using namespace base;
 using namespace actions;
@@ -18,24 +20,52 @@ Scene::Scene(SceneParams params,
 	Sizeable(params),
 	_isSceneTouching(false),
 	_isSceneQuitting(false),
+	_isAudioRunning(false),
+	_isOfflineAudio(false),
 	_viewProj(glm::mat4()),
 	_overlayViewProj(glm::mat4()),
 	_channelMixer(std::make_shared<ChannelMixer>(ChannelMixerParams{})),
 	_label(std::unique_ptr<GuiLabel>()),
+	_ledBatch(std::make_shared<graphics::LedBatch>()),
 	_audioDevice(std::unique_ptr<AudioDevice>()),
 	_masterLoop(std::shared_ptr<Loop>()),
 	_stations(),
 	_touchDownElement(std::weak_ptr<GuiElement>()),
 	_audioCallbackCount(0),
+	_numInputChannels(0),
+	_numOutputChannels(0),
 	_camera(CameraParams(
 		MoveableParams(
 			Position2d{ 0,0 },
 			Position3d{ 0, 0, 420 },
 			1.0),
 		0)),
-	_audioMutex(std::mutex()),
+	_jobQueue(std::make_unique<JobQueue>(JobQueueParams{
+		user.Jobs.NumWorkers,
+		[this](JobAction& job) { this->RunJob(job); } })),
+	_audioKeyActions(_MaxPendingKeyActions),
+	_audioWorkers(std::make_unique<WorkerPool>(WorkerPoolParams{
+		std::min(user.Audio.NumWorkers, std::max(1u, std::thread::hardware_concurrency()) - 1),
+		_WorkerSpinIterations,
+		true })),
+	_writeStationJob([this](unsigned int stationIndex) { this->WriteStation(stationIndex); }),
+	_playStationJob([this](unsigned int stationIndex) { this->PlayStation(stationIndex); }),
+	_stationJobSamps(0),
+	_stationBuses(),
+	_busEdits(_MaxStations),
+	_numBuses(0u),
 	_userConfig(user),
-	_clock(std::make_shared<Timer>())
+	_clock(std::make_shared<Timer>()),
+	_telemetry(std::make_shared<AudioTelemetry>(AudioTelemetryParams{
+		_TelemetryRingSize,
+		_TelemetryWindowSize,
+		constants::DefaultSampleRate })),
+	_telemetryFile(),
+	_telemetryFileMutex(),
+	_jamFile(),
+	_saveRunner(),
+	_isSaving(false),
+	_lastMemoryCheckTime(Timer::GetTime())
 {
 	GuiLabelParams labelParams(GuiElementParams(
 		DrawableParams{ "" },
@@ -48,6 +78,7 @@ Scene::Scene(SceneParams params,
 	_label = std::make_unique<GuiLabel>(labelParams);
 
 	_audioDevice = std::make_unique<AudioDevice>();
+	_stationBuses.reserve(_MaxStations);
 
 	_jobRunner = std::thread([this]() { this->JobLoop(); });
 }
@@ -56,9 +87,54 @@ std::optional<std::shared_ptr<Scene>> Scene::FromFile(SceneParams sceneParams,
 	io::JamFile jamStruct,
 	io::RigFile rigStruct,
 	std::wstring dir)
+{
+	JamLoader loader(JamLoader::DefaultParams());
+	return FromFile(sceneParams, jamStruct, rigStruct, dir, loader);
+}
+
+std::optional<std::shared_ptr<Scene>> Scene::FromFile(SceneParams sceneParams,
+	io::JamFile jamStruct,
+	io::RigFile rigStruct,
+	std::wstring dir,
+	JamLoader& loader)
+{
+	// Every loop is loaded up front, in parallel,
+	// before any of the stations are put together
+	auto loops = loader.Load(jamStruct, dir);
+	if (!loops.has_value())
+		return std::nullopt;
+
+	return FromLoops(sceneParams, jamStruct, rigStruct, loops.value());
+}
+
+std::optional<std::shared_ptr<Scene>> Scene::FromFile(SceneParams sceneParams,
+	std::shared_ptr<const io::SessionFile> session,
+	io::RigFile rigStruct,
+	JamLoader& loader)
+{
+	auto loops = loader.Load(session);
+	if (!loops.has_value())
+		return std::nullopt;
+
+	return FromLoops(sceneParams, session->Jam(), rigStruct, loops.value());
+}
+
+std::shared_ptr<Scene> Scene::FromLoops(SceneParams sceneParams,
+	const io::JamFile& jamStruct,
+	io::RigFile rigStruct,
+	const JamLoader::JamLoops& loops)
 {
 	auto scene = std::make_shared<Scene>(sceneParams, rigStruct.User);
 
+	for (auto& stationLoops : loops)
+	{
+		for (auto& takeLoops : stationLoops)
+		{
+			for (auto& loop : takeLoops)
+				loop->SetStorage(rigStruct.User.Loop.Storage);
+		}
+	}
+
 	TriggerParams trigParams;
 	trigParams.Size = { 24, 24 };
 	trigParams.Position = { 6, 6 };	
@@ -74,9 +150,10 @@ std::optional<std::shared_ptr<Scene>> Scene::FromFile(SceneParams sceneParams,
 	stationParams.ModelPosition = { -50, -20 };
 	stationParams.Size = { 140, 300 };
 
+	auto stationCount = 0u;
 	for (auto stationStruct : jamStruct.Stations)
 	{
-		auto station = Station::FromFile(stationParams, stationStruct, dir);
+		auto station = Station::FromFile(stationParams, stationStruct, loops[stationCount]);
 		if (station.has_value())
 		{
 			if (rigStruct.Triggers.size() > 0)
@@ -92,6 +169,7 @@ std::optional<std::shared_ptr<Scene>> Scene::FromFile(SceneParams sceneParams,
 
 		stationParams.Position += { 0, 90 };
 		stationParams.ModelPosition += { 0, 90 };
+		stationCount++;
 	}
 
 	scene->SetQuantisation(jamStruct.QuantiseSamps, jamStruct.Quantisation);
@@ -108,6 +186,7 @@ void Scene::Draw(DrawContext& ctx)
 	glCtx.ClearMvp();
 	glCtx.PushMvp(_overlayViewProj);
 
+	_label->SetString("Jamma  " + _telemetry->LoadText() + "  " + StorageText());
 	_label->Draw(ctx);
 
 	for (auto& station : _stations)
@@ -116,6 +195,20 @@ void Scene::Draw(DrawContext& ctx)
 	glCtx.PopMvp();
 }
 
+std::string Scene::StorageText()
+{
+	auto toMb = [](unsigned long long numBytes) { return (int)((numBytes + (1ull << 19)) >> 20); };
+
+	std::stringstream ss;
+	ss << "Mem f32 " << toMb(BufferBank::StorageBytes(BufferBank::STORAGE_FLOAT)) << "MB"
+		<< " i16 " << toMb(BufferBank::StorageBytes(BufferBank::STORAGE_INT16)) << "MB"
+		<< " f16 " << toMb(BufferBank::StorageBytes(BufferBank::STORAGE_FLOAT16)) << "MB"
+		<< " zip " << toMb(BufferBank::StorageBytes(BufferBank::STORAGE_COMPRESSED)) << "MB"
+		<< " misses " << BufferBank::Pool().NumMisses() + BufferBank::SummaryPool().NumMisses();
+
+	return ss.str();
+}
+
 void Scene::Draw3d(DrawContext& ctx)
 {
 	glEnable(GL_DEPTH_TEST);
@@ -123,17 +216,27 @@ void Scene::Draw3d(DrawContext& ctx)
 	// Draw scene
 	auto& glCtx = dynamic_cast<GlDrawContext&>(ctx);
 	glCtx.ClearMvp();
+	glCtx.ResetDrawStats();
 	glCtx.PushMvp(_viewProj);
 
+	// VUs add their LEDs to the batch as
+	// they draw, then all are drawn at once
+	_ledBatch->Clear();
+	glCtx.SetLeds(_ledBatch);
+
 	for (auto& station : _stations)
 		station->Draw3d(ctx);
 
+	_ledBatch->Draw(glCtx);
+	glCtx.SetLeds(nullptr);
+
 	glCtx.PopMvp();
 }
 
 void Scene::_InitResources(ResourceLib& resourceLib, bool forceInit)
 {
 	_label->InitResources(resourceLib, forceInit);
+	_ledBatch->InitResources(resourceLib, forceInit);
 
 	for (auto& station : _stations)
 		station->InitResources(resourceLib, forceInit);
@@ -146,6 +249,7 @@ void Scene::_InitResources(ResourceLib& resourceLib, bool forceInit)
 void Scene::_ReleaseResources()
 {
 	_label->ReleaseResources();
+	_ledBatch->ReleaseResources();
 
 	for (auto& station : _stations)
 		station->ReleaseResources();
@@ -245,6 +349,115 @@ ActionResult Scene::OnAction(KeyAction action)
 		return { res };
 	}
 
+	if ((83 == action.KeyChar) && (actions::KeyAction::KEY_UP == action.KeyActionType) && (actions::MODIFIER_CTRL == action.Modifiers))
+	{
+		std::cout << ">> Save <<" << std::endl;
+
+		auto isSaving = !_jamFile.empty() && SaveJam(_jamFile);
+
+		return { isSaving, "", ACTIONRESULT_DEFAULT };
+	}
+
+	// Triggers and the takes they create belong to the
+	// audio thread while it is running, so hand it over
+	// (offline renders take them at the next block too)
+	if (_isAudioRunning || _isOfflineAudio)
+	{
+		auto isBound = std::any_of(_stations.begin(), _stations.end(),
+			[&action](const std::shared_ptr<Station>& station) { return station->IsBound(action); });
+
+		if (!isBound)
+			return { false, "", ACTIONRESULT_DEFAULT };
+
+		if (!_audioKeyActions.TryPush(action))
+		{
+			std::cout << "Key action dropped, audio thread is behind" << std::endl;
+			return { false, "", ACTIONRESULT_DEFAULT };
+		}
+
+		return { true, "", ACTIONRESULT_DEFAULT };
+	}
+
+	return DispatchKeyAction(action);
+}
+
+void Scene::WriteStation(unsigned int stationIndex)
+{
+	JAMMA_REALTIME_SCOPE("Scene::WriteStation");
+
+	auto& station = _stations[stationIndex];
+
+	_channelMixer->Source()->OnPlay(station, _stationJobSamps);
+	station->EndMultiWrite(_stationJobSamps, true);
+}
+
+void Scene::PlayStation(unsigned int stationIndex)
+{
+	JAMMA_REALTIME_SCOPE("Scene::PlayStation");
+
+	auto& station = _stations[stationIndex];
+	auto bus = _stationBuses[stationIndex]->Sink();
+
+	// Bus write index never moves, so each block lands at its start
+	bus->Zero(_stationJobSamps);
+	station->OnPlay(bus, _stationJobSamps);
+	station->EndMultiPlay(_stationJobSamps);
+}
+
+void Scene::InitChannels(unsigned int numInputChannels, unsigned int numOutputChannels)
+{
+	_numInputChannels = numInputChannels;
+	_numOutputChannels = numOutputChannels;
+
+	_channelMixer->SetParams(ChannelMixerParams({
+			_userConfig.AdcBufferDelay(),
+			ChannelMixer::DefaultBufferSize,
+			numInputChannels,
+			numOutputChannels }));
+	InitStationBuses();
+}
+
+void Scene::InitStationBuses()
+{
+	auto busParams = ChannelMixerParams({ 0, constants::MaxBlockSize, 0, _channelMixer->Sink()->NumInputChannels() });
+	auto numStations = (unsigned int)std::min(_stations.size(), _stationBuses.capacity());
+
+	// The audio thread owns the buses while running, so new
+	// ones are built here and queued for it to add
+	if (_isAudioRunning)
+	{
+		while (_numBuses < numStations)
+		{
+			auto bus = std::make_shared<ChannelMixer>(ChannelMixerParams{});
+			bus->SetParams(busParams);
+
+			if (!_busEdits.TryPush({ StructureEdit<ChannelMixer>::EDIT_ADD, bus }))
+				break;
+
+			_numBuses++;
+		}
+
+		return;
+	}
+
+	// Anything queued before the audio stopped
+	StructureEdit<ChannelMixer> edit;
+	while (_busEdits.TryPop(edit))
+		_stationBuses.push_back(std::move(edit.Item));
+
+	while (_stationBuses.size() < numStations)
+		_stationBuses.push_back(std::make_shared<ChannelMixer>(ChannelMixerParams{}));
+
+	_numBuses = (unsigned int)_stationBuses.size();
+
+	for (auto& bus : _stationBuses)
+		bus->SetParams(busParams);
+}
+
+ActionResult Scene::DispatchKeyAction(KeyAction action)
+{
+	JAMMA_REALTIME_TAG("Scene::DispatchKeyAction");
+
 	for (auto& station : _stations)
 	{
 		auto res = station->OnAction(action);
@@ -265,7 +478,7 @@ ActionResult Scene::OnAction(KeyAction action)
 	return { false, "", ACTIONRESULT_DEFAULT };
 }
 
-void Scene::OnTick(Time curTime, unsigned int samps, std::optional<io::UserConfig> cfg)
+void Scene::OnTick(Time curTime, unsigned int samps, const io::UserConfig& cfg)
 {
 	for (auto& station : _stations)
 	{
@@ -273,32 +486,11 @@ void Scene::OnTick(Time curTime, unsigned int samps, std::optional<io::UserConfi
 	}
 }
 
-void Scene::OnJobTick(Time curTime)
+void Scene::RunJob(JobAction& job)
 {
-	actions::JobAction job;
 	job.SetActionTime(Timer::GetTime());
 	job.SetUserConfig(_userConfig);
 
-	{
-		std::shared_lock lock(_jobMutex);
-
-		if (_jobList.empty())
-			return;
-
-		job = _jobList.front();
-		_jobList.pop_front();
-
-		// Run only the newest job,
-		// removing previous identical jobs
-		for (auto j = _jobList.begin(); j != _jobList.end();)
-		{
-			if (*j == job)
-				j = _jobList.erase(j);
-			else
-				++j;
-		}
-	}
-
 	auto receiver = job.Receiver.lock();
 	if (receiver)
 		receiver->OnAction(job);
@@ -306,7 +498,9 @@ void Scene::OnJobTick(Time curTime)
 
 void Scene::InitAudio()
 {
-	std::scoped_lock lock(_audioMutex);
+	// Channels and buses are only resized with the audio stopped
+	if (_isAudioRunning)
+		CloseAudio();
 
 	auto dev = AudioDevice::Open(Scene::AudioCallback,
 		[](RtAudioError::Type type, const std::string& err) { std::cout << "[" << type << " RtAudio Error] " << err << std::endl; },
@@ -318,50 +512,104 @@ void Scene::InitAudio()
 
 		auto inParams = _audioDevice->GetInputStreamInfo();
 		auto outParams = _audioDevice->GetOutputStreamInfo();
-		
-		_channelMixer->SetParams(ChannelMixerParams({
-				_userConfig.AdcBufferDelay(),
-				ChannelMixer::DefaultBufferSize,
-				inParams.inputChannels,
-				outParams.outputChannels}));
+		InitChannels(inParams.inputChannels, outParams.outputChannels);
 
 		_audioCallbackCount = 0;
+		Timer::MeasureCycleRate();
+		_telemetry->SetSampleRate(_audioDevice->SampleRate());
+		_telemetry->Reset();
+		_isOfflineAudio = false;
+		_isAudioRunning = true;
 		_audioDevice->Start();
 	}
 }
 
 void Scene::CloseAudio()
 {
-	std::scoped_lock lock(_audioMutex);
 	_audioDevice->Stop();
+	_isAudioRunning = false;
 }
 
-void Scene::CommitChanges()
+void Scene::InitOfflineAudio(unsigned int numInputChannels, unsigned int numOutputChannels)
 {
-	std::vector<JobAction> jobList = {};
+	if (_isAudioRunning)
+		return;
 
-	{
-		std::scoped_lock lock(_audioMutex);
+	InitChannels(numInputChannels, numOutputChannels);
+	_audioCallbackCount = 0;
+	Timer::MeasureCycleRate();
+	_isOfflineAudio = true;
+}
 
-		for (auto& station : _stations)
+void Scene::RenderOfflineAudio(float* inBuffer, float* outBuffer, unsigned int numSamps)
+{
+	// Only drive the engine directly when no device is
+	if (_isAudioRunning)
+		return;
+
+	OnAudio(inBuffer, outBuffer, numSamps, 0);
+}
+
+std::vector<JobAction> Scene::MemoryJobs()
+{
+	// Loops ask for their own restores, so this only
+	// needs to catch up with memory now and then
+	auto curTime = Timer::GetTime();
+	if (Timer::GetElapsedSeconds(_lastMemoryCheckTime, curTime) < (double)_MemoryCheckSeconds)
+		return {};
+
+	_lastMemoryCheckTime = curTime;
+
+	auto budgetBytes = (unsigned long long)_userConfig.Loop.MemoryBudgetMb << 20;
+	if (0 == budgetBytes)
+		return {};
+
+	auto numBytes = 0ull;
+
+	for (auto mode = 0u; mode < BufferBank::NUM_STORAGEMODES; mode++)
+		numBytes += BufferBank::StorageBytes((BufferBank::StorageMode)mode);
+
+	if (numBytes <= budgetBytes)
+		return {};
+
+	std::vector<JobAction> jobs;
+
+	for (auto& station : _stations)
+	{
+		for (auto& take : station->Takes())
 		{
-			auto jobs = station->CommitChanges();
-			if (!jobs.empty())
-				jobList.insert(jobList.end(), jobs.begin(), jobs.end());
+			for (auto& loop : take->Loops())
+			{
+				if (!loop->IsCompressDue())
+					continue;
+
+				JobAction job;
+				job.JobActionType = JobAction::JOB_COMPRESSLOOP;
+				job.SourceId = loop->Id();
+				job.Receiver = loop->ActionReceiver::shared_from_this();
+				jobs.push_back(job);
+			}
 		}
 	}
 
-	if (!jobList.empty())
-	{
-		std::scoped_lock lock(_jobMutex);
-		_jobList.insert(_jobList.end(), jobList.begin(), jobList.end());
-		std::cout << "Joblist size: " << _jobList.size() << "\n";
-	}
+	return jobs;
 }
 
-std::mutex& Scene::GetAudioMutex()
+void Scene::CommitChanges()
 {
-	return _audioMutex;
+	std::vector<JobAction> jobList = {};
+
+	for (auto& station : _stations)
+	{
+		auto jobs = station->CommitChanges();
+		if (!jobs.empty())
+			jobList.insert(jobList.end(), jobs.begin(), jobs.end());
+	}
+
+	auto memoryJobs = MemoryJobs();
+	jobList.insert(jobList.end(), memoryJobs.begin(), memoryJobs.end());
+
+	_jobQueue->Push(jobList);
 }
 
 int Scene::AudioCallback(void* outBuffer,
@@ -372,60 +620,71 @@ int Scene::AudioCallback(void* outBuffer,
 	void* userData)
 {
 	Scene* scene = (Scene*)userData;
-	std::scoped_lock lock(scene->GetAudioMutex());
-	scene->OnAudio((float*)inBuffer, (float*)outBuffer, numSamps);
+	scene->OnAudio((float*)inBuffer, (float*)outBuffer, numSamps, status);
 
 	return 0;
 }
 
 void Scene::OnAudio(float* inBuf,
 	float* outBuf,
-	unsigned int numSamps)
+	unsigned int numSamps,
+	RtAudioStreamStatus status)
 {
+	JAMMA_REALTIME_CALLBACK("Scene::OnAudio");
+
+	auto startTime = Timer::GetTime();
+	auto startCpu = Timer::GetThreadCpuSeconds();
+
+	KeyAction keyAction;
+	while (_audioKeyActions.TryPop(keyAction))
+		DispatchKeyAction(keyAction);
+
+	StructureEdit<ChannelMixer> busEdit;
+	while ((_stationBuses.size() < _stationBuses.capacity()) && _busEdits.TryPop(busEdit))
+		_stationBuses.push_back(std::move(busEdit.Item));
+
+	_stationJobSamps = numSamps;
+
 	if (nullptr != inBuf)
 	{
-		auto inDeviceInfo = nullptr == _audioDevice ?
-			RtAudio::DeviceInfo() : _audioDevice->GetInputStreamInfo();
-		_channelMixer->FromAdc(inBuf, inDeviceInfo.inputChannels, numSamps);
+		_channelMixer->FromAdc(inBuf, _numInputChannels, numSamps);
 		_channelMixer->InitPlay(_userConfig.AdcBufferDelay(), numSamps);
 
-		for (auto& station : _stations)
-		{
-			_channelMixer->Source()->OnPlay(station, numSamps);
-			station->EndMultiWrite(numSamps, true);
-		}
+		_audioWorkers->Run((unsigned int)_stations.size(), _writeStationJob);
 	}
 
+	auto inputTime = Timer::GetTime();
+
 	_channelMixer->Source()->EndMultiPlay(numSamps);
 
-	_channelMixer->Sink()->Zero(numSamps);
+	// Stations render to their own buses (in parallel if there are
+	// workers), then the buses are summed in station order, so the
+	// output is the same however many workers there are
+	auto numBuses = (unsigned int)std::min(_stations.size(), _stationBuses.size());
+	_audioWorkers->Run(numBuses, _playStationJob);
 
-	if (nullptr != outBuf)
-	{
-		auto outDeviceInfo = nullptr == _audioDevice ?
-			RtAudio::DeviceInfo() : _audioDevice->GetOutputStreamInfo();
-		std::fill(outBuf, outBuf + numSamps * outDeviceInfo.outputChannels, 0.0f);
-
-		for (auto& station : _stations)
-		{
-			station->OnPlay(_channelMixer->Sink(), numSamps);
-			station->EndMultiPlay(numSamps);
-		}
+	for (auto i = 0u; i < numBuses; i++)
+		_channelMixer->MixBus(_stationBuses[i], numSamps);
 
-		_channelMixer->ToDac(outBuf, outDeviceInfo.outputChannels, numSamps);
-	}
-	else
-	{
-		for (auto& station : _stations)
-		{
-			station->OnPlay(_channelMixer->Sink(), numSamps);
-			station->EndMultiPlay(numSamps);
-		}
-	}
+	// Also clears the sink ready for the next callback
+	_channelMixer->ToDac(outBuf, _numOutputChannels, numSamps);
 	
 	_channelMixer->Sink()->EndMultiWrite(numSamps, true);
 
-	OnTick(Timer::GetTime(), numSamps, _userConfig);
+	auto outputTime = Timer::GetTime();
+	OnTick(outputTime, numSamps, _userConfig);
+	auto endTime = Timer::GetTime();
+
+	CallbackTiming timing;
+	timing.NumSamps = numSamps;
+	timing.WallSeconds = Timer::GetElapsedSeconds(startTime, endTime);
+	timing.CpuSeconds = Timer::GetThreadCpuSeconds() - startCpu;
+	timing.InputSeconds = Timer::GetElapsedSeconds(startTime, inputTime);
+	timing.OutputSeconds = Timer::GetElapsedSeconds(inputTime, outputTime);
+	timing.TickSeconds = Timer::GetElapsedSeconds(outputTime, endTime);
+	timing.IsInputOverflow = 0 != (status & RTAUDIO_INPUT_OVERFLOW);
+	timing.IsOutputUnderflow = 0 != (status & RTAUDIO_OUTPUT_UNDERFLOW);
+	_telemetry->Push(timing);
 }
 
 bool Scene::OnUndo(std::shared_ptr<base::ActionUndo> undo)
@@ -481,6 +740,8 @@ void Scene::AddStation(std::shared_ptr<Station> station)
 
 	station->SetClock(_clock);
 	station->Init();
+
+	InitStationBuses();
 }
 
 void Scene::SetQuantisation(unsigned int quantiseSamps, Timer::QuantisationType quantisation)
@@ -490,9 +751,103 @@ void Scene::SetQuantisation(unsigned int quantiseSamps, Timer::QuantisationType
 
 void Scene::JobLoop()
 {
+	auto lastTelemetryTime = Timer::GetTime();
+
+	// Done here rather than in the first callback
+	Timer::MeasureCycleRate();
+
+	// Jobs run on _jobQueue, this thread
+	// only does periodic housekeeping
 	while (!_isSceneQuitting)
 	{
-		OnJobTick(Timer::GetTime());
+		// Keep recording pages ready for the audio thread
+		BufferBank::Pool().Refill();
+		BufferBank::SummaryPool().Refill();
+
+		_telemetry->Update();
+
+		auto curTime = Timer::GetTime();
+		if (Timer::GetElapsedSeconds(lastTelemetryTime, curTime) >= (double)_TelemetryWriteSeconds)
+		{
+			WriteTelemetry();
+			lastTelemetryTime = curTime;
+		}
+
 		std::this_thread::sleep_for(std::chrono::milliseconds(120));
 	}
+
+	WriteTelemetry();
+}
+
+std::shared_ptr<AudioTelemetry> Scene::Telemetry() const
+{
+	return _telemetry;
+}
+
+JobQueue::Metrics Scene::JobMetrics() const
+{
+	return _jobQueue->GetMetrics();
+}
+
+void Scene::SetTelemetryFile(std::wstring file)
+{
+	std::scoped_lock lock(_telemetryFileMutex);
+	_telemetryFile = file;
+}
+
+void Scene::SetJamFile(std::wstring file)
+{
+	_jamFile = file;
+}
+
+bool Scene::SaveJam(std::wstring file)
+{
+	if (_isSaving.exchange(true))
+		return false;
+
+	if (_saveRunner.joinable())
+		_saveRunner.join();
+
+	auto name = EncodeUtf8(std::filesystem::path(file).stem().wstring());
+	auto snapshot = JamSaver::Snapshot(name, _stations, *_clock);
+
+	// Only the snapshot is needed from here on, so the
+	// stations can carry on changing while it is written
+	_saveRunner = std::thread([this, snapshot = std::move(snapshot), file]() {
+		JamSaver saver(JamSaver::DefaultParams());
+		auto isSaved = saver.Save(snapshot, file);
+		auto stats = saver.Stats();
+
+		std::cout << (isSaved ? "Saved " : "Failed to save ") << stats.NumSaved << "/" << stats.NumLoops
+			<< " loops in " << stats.Seconds << "s" << std::endl;
+
+		_isSaving = false;
+	});
+
+	return true;
+}
+
+bool Scene::IsSaving() const
+{
+	return _isSaving;
+}
+
+void Scene::WriteTelemetry()
+{
+	std::wstring file;
+
+	{
+		std::scoped_lock lock(_telemetryFileMutex);
+		file = _telemetryFile;
+	}
+
+	if (file.empty())
+		return;
+
+	std::ofstream stream(std::filesystem::path(file), std::ios::trunc);
+	if (!stream.is_open())
+		return;
+
+	_telemetry->Update();
+	_telemetry->WriteJson(stream);
 }
@@ -10,6 +10,7 @@
 #include "../graphics/Image.h"
 #include "../graphics/Camera.h"
 #include "../graphics/GlDrawContext.h"
+#include "../graphics/LedBatch.h"
 #include "../gui/GuiLabel.h"
 #include "../gui/GuiSlider.h"
 #include "../io/JamFile.h"
@@ -22,6 +23,14 @@
 #include "GuiElement.h"
 #include "Station.h"
 #include "UndoHistory.h"
+#include "AudioTelemetry.h"
+#include "JobQueue.h"
+#include "JamLoader.h"
+#include "JamSaver.h"
+#include "StructureEdit.h"
+#include "../utils/SpscQueue.h"
+#include "../utils/WorkerPool.h"
+#include "../utils/RealtimeCheck.h"
 
 namespace engine
 {
@@ -52,6 +61,11 @@ namespace engine
 
 			_isSceneQuitting = true;
 			_jobRunner.join();
+
+			if (_saveRunner.joinable())
+				_saveRunner.join();
+
+			_jobQueue->Stop();
 		}
 
 		// Copy
@@ -120,6 +134,16 @@ namespace engine
 			io::JamFile jam,
 			io::RigFile rig,
 			std::wstring dir);
+		// Empty if the loader was cancelled
+		static std::optional<std::shared_ptr<Scene>> FromFile(SceneParams sceneParams,
+			io::JamFile jam,
+			io::RigFile rig,
+			std::wstring dir,
+			JamLoader& loader);
+		static std::optional<std::shared_ptr<Scene>> FromFile(SceneParams sceneParams,
+			std::shared_ptr<const io::SessionFile> session,
+			io::RigFile rig,
+			JamLoader& loader);
 		
 		virtual void Draw(base::DrawContext& ctx) override;
 		virtual void Draw3d(base::DrawContext& ctx) override;
@@ -135,16 +159,34 @@ namespace engine
 		virtual actions::ActionResult OnAction(actions::TouchAction action) override;
 		virtual actions::ActionResult OnAction(actions::TouchMoveAction action) override;
 		virtual actions::ActionResult OnAction(actions::KeyAction action) override;
-		virtual void OnTick(Time curTime, unsigned int samps, std::optional<io::UserConfig> cfg) override;
-		virtual void OnJobTick(Time curTime);
+		virtual void OnTick(Time curTime, unsigned int samps, const io::UserConfig& cfg) override;
 		virtual void InitResources(resources::ResourceLib& resourceLib, bool forceInit) override;
 
 		void InitAudio();
 		void CloseAudio();
+		void InitOfflineAudio(unsigned int numInputChannels, unsigned int numOutputChannels);
+		void RenderOfflineAudio(float* inBuffer, float* outBuffer, unsigned int numSamps);
 		void CommitChanges();
-		std::mutex& GetAudioMutex();
+		std::shared_ptr<AudioTelemetry> Telemetry() const;
+		JobQueue::Metrics JobMetrics() const;
+		void SetTelemetryFile(std::wstring file);
+		void SetJamFile(std::wstring file);
+		// Snapshots the jam on the calling (gui) thread and writes
+		// it out in the background. False if already saving.
+		bool SaveJam(std::wstring file);
+		bool IsSaving() const;
 		
 	protected:
+		static std::shared_ptr<Scene> FromLoops(SceneParams sceneParams,
+			const io::JamFile& jam,
+			io::RigFile rig,
+			const JamLoader::JamLoops& loops);
+		// Sample memory held in each storage mode
+		static std::string StorageText();
+		// Compresses idle loops while over the configured memory
+		// budget, checked every _MemoryCheckSeconds
+		std::vector<actions::JobAction> MemoryJobs();
+
 		virtual void _InitResources(resources::ResourceLib& resourceLib, bool forceInit) override;
 		virtual void _ReleaseResources() override;
 
@@ -156,9 +198,17 @@ namespace engine
 			void* userData);
 		void OnAudio(float* inBuffer,
 			float* outBuffer,
-			unsigned int numSamps);
+			unsigned int numSamps,
+			RtAudioStreamStatus status);
+		actions::ActionResult DispatchKeyAction(actions::KeyAction action);
+		void WriteStation(unsigned int stationIndex);
+		void PlayStation(unsigned int stationIndex);
+		void InitChannels(unsigned int numInputChannels, unsigned int numOutputChannels);
+		void InitStationBuses();
 		bool OnUndo(std::shared_ptr<base::ActionUndo> undo);
 		void JobLoop();
+		void RunJob(actions::JobAction& job);
+		void WriteTelemetry();
 		void InitSize();
 		glm::mat4 View();
 
@@ -166,8 +216,18 @@ namespace engine
 		void SetQuantisation(unsigned int quantiseSamps, Timer::QuantisationType quantisation);
 
 	protected:
+		static const unsigned int _MaxPendingKeyActions = 64u;
+		static const unsigned int _MaxStations = 64u;
+		static const unsigned int _WorkerSpinIterations = 2000u;
+		static const unsigned int _TelemetryRingSize = 4096u;
+		static const unsigned int _TelemetryWindowSize = 8192u;
+		static const unsigned int _TelemetryWriteSeconds = 30u;
+		static const unsigned int _MemoryCheckSeconds = 1u;
+
 		bool _isSceneTouching;
 		bool _isSceneQuitting;
+		std::atomic<bool> _isAudioRunning;
+		std::atomic<bool> _isOfflineAudio;
 		utils::Position2d _initTouchDownPosition;
 		utils::Position3d _initTouchCamPosition;
 		glm::mat4 _viewProj;
@@ -175,17 +235,34 @@ namespace engine
 		std::shared_ptr<audio::ChannelMixer> _channelMixer;
 		std::unique_ptr<audio::AudioDevice> _audioDevice;
 		std::unique_ptr<gui::GuiLabel> _label;
+		std::shared_ptr<graphics::LedBatch> _ledBatch;
 		std::vector<std::shared_ptr<Station>> _stations;
 		UndoHistory _undoHistory;
 		std::weak_ptr<base::GuiElement> _touchDownElement;
 		std::shared_ptr<Loop> _masterLoop;
 		unsigned int _audioCallbackCount;
+		unsigned int _numInputChannels;
+		unsigned int _numOutputChannels;
 		graphics::Camera _camera;
 		std::thread _jobRunner;
-		std::shared_mutex _jobMutex;
-		std::list<actions::JobAction> _jobList;
-		std::mutex _audioMutex;
+		std::unique_ptr<JobQueue> _jobQueue;
+		utils::SpscQueue<actions::KeyAction> _audioKeyActions;
+		std::unique_ptr<utils::WorkerPool> _audioWorkers;
+		std::function<void(unsigned int)> _writeStationJob;
+		std::function<void(unsigned int)> _playStationJob;
+		unsigned int _stationJobSamps;
+		// One private output bus per station, summed in order
+		std::vector<std::shared_ptr<audio::ChannelMixer>> _stationBuses;
+		utils::SpscQueue<StructureEdit<audio::ChannelMixer>> _busEdits; // Built on the gui thread, added by the audio thread
+		unsigned int _numBuses; // Including those still queued
 		io::UserConfig _userConfig;
 		std::shared_ptr<Timer> _clock;
+		std::shared_ptr<AudioTelemetry> _telemetry;
+		std::wstring _telemetryFile;
+		utils::CheckedMutex _telemetryFileMutex;
+		std::wstring _jamFile;
+		std::thread _saveRunner;
+		std::atomic<bool> _isSaving;
+		Time _lastMemoryCheckTime;
 	};
 }
@@ -24,8 +24,13 @@ Station::Station(StationParams params) :
 	MultiAudioSource(),
 	_clock(std::shared_ptr<Timer>()),
 	_loopTakes(),
-	_triggers({})
+	_triggers({}),
+	_spareTakes(_MaxSpareTakes),
+	_guiLoopTakes(),
+	_takeEdits(_MaxPendingEdits)
 {
+	// Recording only adds takes up to here, so never reallocates
+	_loopTakes.reserve(_MaxTakes);
 }
 
 Station::~Station()
@@ -34,7 +39,7 @@ Station::~Station()
 
 std::optional<std::shared_ptr<Station>> Station::FromFile(StationParams stationParams,
 	io::JamFile::Station stationStruct,
-	std::wstring dir)
+	std::vector<std::vector<std::shared_ptr<Loop>>> takeLoops)
 {
 	auto station = std::make_shared<Station>(stationParams);
 
@@ -51,10 +56,16 @@ std::optional<std::shared_ptr<Station>> Station::FromFile(StationParams stationP
 	for (auto takeStruct : stationStruct.LoopTakes)
 	{
 		takeParams.ModelPosition = { (float)gap.Width, (float)(takeCount * takeHeight + gap.Height), 0.0 };
-		auto take = LoopTake::FromFile(takeParams, takeStruct, dir);
+		auto loops = takeCount < takeLoops.size() ?
+			takeLoops[takeCount] :
+			std::vector<std::shared_ptr<Loop>>();
+		auto take = LoopTake::FromFile(takeParams, takeStruct, loops);
 		
-		if (take.has_value())
-			station->AddTake(take.value());
+		if (take.has_value() && !station->AddTake(take.value()))
+		{
+			std::cout << "Too many takes in station " << stationStruct.Name << std::endl;
+			return std::nullopt;
+		}
 
 		takeCount++;
 	}
@@ -132,7 +143,7 @@ ActionResult Station::OnAction(TouchAction action)
 	return GuiElement::OnAction(action);
 }
 
-ActionResult Station::OnAction(TriggerAction action)
+ActionResult Station::OnAction(const TriggerAction& action)
 {
 	ActionResult res;
 	res.IsEaten = false;
@@ -144,8 +155,28 @@ ActionResult Station::OnAction(TriggerAction action)
 	{
 	case TriggerAction::TRIGGER_REC_START:
 	{
-		auto newLoopTake = AddTake();
-		newLoopTake->Record(action.InputChannels);
+		// Takes are built on the gui thread ahead of time,
+		// so this only hands one over and sets it recording
+		std::shared_ptr<LoopTake> newLoopTake;
+
+		if ((_loopTakes.size() >= _loopTakes.capacity()) ||
+			!_takeEdits.CanPush(1) ||
+			!_spareTakes.TryPop(newLoopTake))
+		{
+			_changesMade = true;
+			break;
+		}
+
+		// One that can't record is sent to be released with the gui's edits
+		if ((nullptr == action.InputChannels) ||
+			!newLoopTake->Record(*action.InputChannels))
+		{
+			_takeEdits.TryPush({ StructureEdit<LoopTake>::EDIT_REMOVE, newLoopTake });
+			_changesMade = true;
+			break;
+		}
+
+		AddTake(newLoopTake);
 
 		res.Id = newLoopTake->Id();
 		res.IsEaten = true;
@@ -169,15 +200,20 @@ ActionResult Station::OnAction(TriggerAction action)
 		}
 
 		auto cfg = action.GetUserConfig();
-		auto playPos = cfg.has_value() ?
-			cfg.value().LoopPlayPos(errorSamps, loopLength) :
+		auto playPos = nullptr != cfg ?
+			cfg->LoopPlayPos(errorSamps, loopLength) :
 			0;
-		auto endRecordSamps = cfg.has_value() ?
-			cfg.value().EndRecordingSamps(errorSamps) :
+		auto endRecordSamps = nullptr != cfg ?
+			cfg->EndRecordingSamps(errorSamps) :
 			0;
 
 		if (loopTake.has_value())
+		{
+			if (nullptr != cfg)
+				loopTake.value()->SetStorage(cfg->Loop.Storage);
+
 			loopTake.value()->Play(playPos, loopLength, endRecordSamps);
+		}
 
 		res.IsEaten = true;
 		break;
@@ -185,17 +221,17 @@ ActionResult Station::OnAction(TriggerAction action)
 	case TriggerAction::TRIGGER_DITCH:
 		if (loopTake.has_value())
 		{
+			if (!_takeEdits.CanPush(1))
+				break;
+
 			loopTake.value()->Ditch();
 
-			auto id = loopTake.value()->Id();
-			auto match = std::find_if(_backLoopTakes.begin(),
-				_backLoopTakes.end(),
-				[&id](const std::shared_ptr<LoopTake>& arg) { return arg->Id() == id; });
+			auto match = std::find(_loopTakes.begin(), _loopTakes.end(), loopTake.value());
 
-			if (match != _backLoopTakes.end())
+			if (match != _loopTakes.end())
 			{
-				_backLoopTakes.erase(match);
-				ArrangeTakes();
+				_takeEdits.TryPush({ StructureEdit<LoopTake>::EDIT_REMOVE, *match });
+				_loopTakes.erase(match);
 				_changesMade = true;
 			}
 		}
@@ -207,7 +243,7 @@ ActionResult Station::OnAction(TriggerAction action)
 	return res;
 }
 
-void Station::OnTick(Time curTime, unsigned int samps, std::optional<io::UserConfig> cfg)
+void Station::OnTick(Time curTime, unsigned int samps, const io::UserConfig& cfg)
 {
 	for (auto& trig : _triggers)
 	{
@@ -215,24 +251,17 @@ void Station::OnTick(Time curTime, unsigned int samps, std::optional<io::UserCon
 	}
 }
 
-std::shared_ptr<LoopTake> Station::AddTake()
+bool Station::AddTake(std::shared_ptr<LoopTake> take)
 {
-	LoopTakeParams takeParams;
-	takeParams.Id = "TK-" + utils::GetGuid();
-
-	auto take = std::make_shared<LoopTake>(takeParams);
-	AddTake(take);
+	JAMMA_REALTIME_TAG("Station::AddTake");
 
-	return take;
-}
-
-void Station::AddTake(std::shared_ptr<LoopTake> take)
-{
-	_backLoopTakes.push_back(take);
-	Init();
+	if (!_takeEdits.TryPush({ StructureEdit<LoopTake>::EDIT_ADD, take }))
+		return false;
 
-	ArrangeTakes();
+	_loopTakes.push_back(take);
 	_changesMade = true;
+
+	return true;
 }
 
 void Station::AddTrigger(std::shared_ptr<Trigger> trigger)
@@ -241,16 +270,30 @@ void Station::AddTrigger(std::shared_ptr<Trigger> trigger)
 
 	_triggers.push_back(trigger);
 	_children.push_back(trigger);
+
+	PrepareTakes();
+}
+
+bool Station::IsBound(const KeyAction& action) const
+{
+	for (auto& trig : _triggers)
+	{
+		if (trig->IsBound(action))
+			return true;
+	}
+
+	return false;
 }
 
 void Station::Reset()
 {
-	for (auto& take : _loopTakes)
+	for (auto& take : _guiLoopTakes)
 	{
 		auto child = std::find(_children.begin(), _children.end(), take);
 		if (_children.end() != child)
 			_children.erase(child);
 	}
+	_guiLoopTakes.clear();
 	_loopTakes.clear();
 
 	for (auto& trigger : _triggers)
@@ -267,6 +310,11 @@ void Station::SetClock(std::shared_ptr<Timer> clock)
 	_clock = clock;
 }
 
+std::vector<std::shared_ptr<LoopTake>> Station::Takes() const
+{
+	return _guiLoopTakes;
+}
+
 unsigned int Station::CalcTakeHeight(unsigned int stationHeight, unsigned int numTakes)
 {
 	if (0 == numTakes)
@@ -284,40 +332,82 @@ unsigned int Station::CalcTakeHeight(unsigned int stationHeight, unsigned int nu
 
 std::vector<JobAction> Station::_CommitChanges()
 {
-	// Remove and add any children
-	// (difference between back and front LoopTake buffer)
-	std::vector<std::shared_ptr<LoopTake>> toAdd;
-	std::vector<std::shared_ptr<LoopTake>> toRemove;
-	std::copy_if(_backLoopTakes.begin(), _backLoopTakes.end(), std::back_inserter(toAdd), [&](const std::shared_ptr<LoopTake>& take) { return (std::find(_loopTakes.begin(), _loopTakes.end(), take) == _loopTakes.end()); });
-	std::copy_if(_loopTakes.begin(), _loopTakes.end(), std::back_inserter(toRemove), [&](const std::shared_ptr<LoopTake>& take) { return (std::find(_backLoopTakes.begin(), _backLoopTakes.end(), take) == _backLoopTakes.end()); });
-	
-	for (auto& take : toAdd)
+	// Mirror any takes the audio thread has added or removed
+	// (removed takes are released here, off the audio thread)
+	StructureEdit<LoopTake> edit;
+	auto numEdits = 0u;
+
+	while (_takeEdits.TryPop(edit))
 	{
-		take->SetParent(GuiElement::shared_from_this());
-		take->Init();
-		_children.push_back(take);
+		switch (edit.EditType)
+		{
+		case StructureEdit<LoopTake>::EDIT_ADD:
+			edit.Item->SetParent(GuiElement::shared_from_this());
+			edit.Item->Init();
+			_children.push_back(edit.Item);
+			_guiLoopTakes.push_back(edit.Item);
+			break;
+		case StructureEdit<LoopTake>::EDIT_REMOVE:
+		{
+			auto child = std::find(_children.begin(), _children.end(), edit.Item);
+			if (_children.end() != child)
+				_children.erase(child);
+
+			auto guiTake = std::find(_guiLoopTakes.begin(), _guiLoopTakes.end(), edit.Item);
+			if (_guiLoopTakes.end() != guiTake)
+				_guiLoopTakes.erase(guiTake);
+			break;
+		}
+		}
+
+		edit = StructureEdit<LoopTake>();
+		numEdits++;
 	}
 
-	for (auto& take : toRemove)
+	if (numEdits > 0)
+		ArrangeTakes();
+
+	PrepareTakes();
+
+	return {};
+}
+
+void Station::PrepareTakes()
+{
+	if (!_spareTakes.CanPush(1))
+		return;
+
+	std::vector<unsigned int> channels;
+
+	for (auto& trig : _triggers)
 	{
-		auto child = std::find(_children.begin(), _children.end(), take);
-		if (_children.end() != child)
-			_children.erase(child);
+		for (auto chan : trig->InputChannels())
+		{
+			if (channels.end() == std::find(channels.begin(), channels.end(), chan))
+				channels.push_back(chan);
+		}
+	}
+
+	while (_spareTakes.CanPush(1))
+	{
+		LoopTakeParams takeParams;
+		takeParams.Id = "TK-" + utils::GetGuid();
+
+		auto take = std::make_shared<LoopTake>(takeParams);
+		take->Prepare(channels);
+		_spareTakes.TryPush(take);
 	}
-	
-	_loopTakes = _backLoopTakes; // TODO: Undo?
-	return {};
 }
 
 void Station::ArrangeTakes()
 {
-	auto numTakes = (unsigned int)_backLoopTakes.size();
+	auto numTakes = (unsigned int)_guiLoopTakes.size();
 
 	auto takeHeight = CalcTakeHeight(_sizeParams.Size.Height, numTakes);
 	utils::Size2d takeSize = { _sizeParams.Size.Width - (2 * _Gap.Width), takeHeight - (2 * _Gap.Height) };
 
 	auto takeCount = 0;
-	for (auto& take : _backLoopTakes)
+	for (auto& take : _guiLoopTakes)
 	{
 		take->SetPosition({ 0, (int)(_Gap.Height + (takeCount * takeHeight)) });
 		take->SetSize(takeSize);
@@ -329,7 +419,7 @@ void Station::ArrangeTakes()
 	}
 }
 
-std::optional<std::shared_ptr<LoopTake>> Station::TryGetTake(std::string id)
+std::optional<std::shared_ptr<LoopTake>> Station::TryGetTake(std::string_view id)
 {
 	for (auto& take : _loopTakes)
 	{
@@ -41,7 +41,7 @@ namespace engine
 	public:
 		static std::optional<std::shared_ptr<Station>> FromFile(StationParams stationParams,
 			io::JamFile::Station stationStruct,
-			std::wstring dir);
+			std::vector<std::vector<std::shared_ptr<Loop>>> takeLoops);
 
 		virtual void SetSize(utils::Size2d size) override;
 		virtual	utils::Position2d Position() const override;
@@ -56,29 +56,42 @@ namespace engine
 		virtual void EndMultiWrite(unsigned int numSamps, bool updateIndex) override;
 		virtual actions::ActionResult OnAction(actions::KeyAction action) override;
 		virtual actions::ActionResult OnAction(actions::TouchAction action) override;
-		virtual actions::ActionResult OnAction(actions::TriggerAction action) override;
-		virtual void OnTick(Time curTime, unsigned int samps, std::optional<io::UserConfig> cfg) override;
+		virtual actions::ActionResult OnAction(const actions::TriggerAction& action) override;
+		virtual void OnTick(Time curTime, unsigned int samps, const io::UserConfig& cfg) override;
 		
-		std::shared_ptr<LoopTake> AddTake();
-		void AddTake(std::shared_ptr<LoopTake> take);
+		// Fails if the gui thread has yet to catch up with earlier edits
+		bool AddTake(std::shared_ptr<LoopTake> take);
 		void AddTrigger(std::shared_ptr<Trigger> trigger);
+		// Whether any trigger listens for the key, whatever its state
+		bool IsBound(const actions::KeyAction& action) const;
 		void Reset();
 		void SetClock(std::shared_ptr<Timer> clock);
+		// The gui thread's view of the takes
+		std::vector<std::shared_ptr<LoopTake>> Takes() const;
 
 	protected:
 		static unsigned int CalcTakeHeight(unsigned int stationHeight, unsigned int numTakes);
 
 		virtual std::vector<actions::JobAction> _CommitChanges() override;
 		void ArrangeTakes();
-		std::optional<std::shared_ptr<LoopTake>> TryGetTake(std::string id);
+		// Builds takes on the gui thread ready for the triggers to record on
+		void PrepareTakes();
+		std::optional<std::shared_ptr<LoopTake>> TryGetTake(std::string_view id);
 
 	protected:
 		static const utils::Size2d _Gap;
+		static const unsigned int _MaxPendingEdits = 256u;
+		static const unsigned int _MaxSpareTakes = 2u;
+		static const unsigned int _MaxTakes = 256u;
 
 		std::shared_ptr<Timer> _clock;
+		// Owned by the audio thread
 		std::vector<std::shared_ptr<LoopTake>> _loopTakes;
 		std::vector<std::shared_ptr<Trigger>> _triggers;
+		utils::SpscQueue<std::shared_ptr<LoopTake>> _spareTakes;
 
-		std::vector<std::shared_ptr<LoopTake>> _backLoopTakes;
+		// Mirror of _loopTakes owned by the gui thread
+		std::vector<std::shared_ptr<LoopTake>> _guiLoopTakes;
+		utils::SpscQueue<StructureEdit<LoopTake>> _takeEdits;
 	};
 }
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <memory>
+
+namespace engine
+{
+	// A change to an audio-owned list, passed from the audio
+	// thread to the gui thread to be mirrored, or from the gui
+	// thread for the audio thread to make
+	template<typename T>
+	class StructureEdit
+	{
+	public:
+		enum StructureEditType
+		{
+			EDIT_ADD,
+			EDIT_REMOVE
+		};
+
+	public:
+		StructureEditType EditType;
+		std::shared_ptr<T> Item;
+	};
+}
@@ -1,7 +1,43 @@
 #include "Timer.h"
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#include <atomic>
+#include <mutex>
+#else
+#include <time.h>
+#endif
 
 using namespace engine;
 
+#ifdef _WIN32
+namespace
+{
+	// Thread cycle counts tick at the TSC rate, which is
+	// measured against the performance counter
+	std::atomic<double> _cyclesPerSecond = 0.0;
+	std::once_flag _cyclesMeasured;
+
+	double MeasureCyclesPerSecond()
+	{
+		LARGE_INTEGER freq, start, now;
+		QueryPerformanceFrequency(&freq);
+		QueryPerformanceCounter(&start);
+		auto startCycles = __rdtsc();
+
+		do
+		{
+			QueryPerformanceCounter(&now);
+		} while ((now.QuadPart - start.QuadPart) < (freq.QuadPart / 50));
+
+		auto cycles = (double)(__rdtsc() - startCycles);
+		auto seconds = (double)(now.QuadPart - start.QuadPart) / (double)freq.QuadPart;
+
+		return cycles / seconds;
+	}
+}
+#endif
+
 Timer::Timer()
 {
 }
@@ -20,6 +56,40 @@ double Timer::GetElapsedSeconds(Time t1, Time t2)
 	return std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count();
 }
 
+// CPU time used so far by the calling thread. On Windows
+// this counts cycles rather than scheduler ticks, so single
+// callbacks are resolved too. Reads zero until the cycle
+// rate has been measured.
+double Timer::GetThreadCpuSeconds()
+{
+#ifdef _WIN32
+	auto cyclesPerSecond = _cyclesPerSecond.load(std::memory_order_relaxed);
+	if (0.0 == cyclesPerSecond)
+		return 0.0;
+
+	ULONG64 cycles;
+	if (!QueryThreadCycleTime(GetCurrentThread(), &cycles))
+		return 0.0;
+
+	return (double)cycles / cyclesPerSecond;
+#else
+	timespec ts;
+	if (0 != clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+		return 0.0;
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+// Busy-waits for 20 ms the first time, so is called
+// before audio starts and never from the audio thread
+void Timer::MeasureCycleRate()
+{
+#ifdef _WIN32
+	std::call_once(_cyclesMeasured, []() { _cyclesPerSecond = MeasureCyclesPerSecond(); });
+#endif
+}
+
 void Timer::Tick(unsigned int sampsIncrement, unsigned int loopCountIncrement)
 {
 	_loopCount += loopCountIncrement;
@@ -37,6 +107,16 @@ void Timer::SetQuantisation(unsigned int quantiseSamps,
 	_quantisation = quantisation;
 }
 
+unsigned int Timer::QuantiseSamps() const
+{
+	return _quantiseSamps;
+}
+
+Timer::QuantisationType Timer::Quantisation() const
+{
+	return _quantisation;
+}
+
 std::tuple<unsigned long, int> engine::Timer::QuantiseLength(unsigned long length)
 {
 	switch (_quantisation)
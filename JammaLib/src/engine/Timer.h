@@ -24,10 +24,14 @@ namespace engine
 	public:
 		static Time GetTime();
 		static double GetElapsedSeconds(Time t1, Time t2);
+		static double GetThreadCpuSeconds();
+		static void MeasureCycleRate();
 
 		void Tick(unsigned int sampsIncrement, unsigned int loopCountIncrement);
 		bool IsQuantisable() const;
 		void SetQuantisation(unsigned int quantiseSamps, QuantisationType quantisation);
+		unsigned int QuantiseSamps() const;
+		QuantisationType Quantisation() const;
 		std::tuple<unsigned long, int> QuantiseLength(unsigned long length);
 
 	private:
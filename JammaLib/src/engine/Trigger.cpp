@@ -30,8 +30,13 @@ Trigger::Trigger(TriggerParams trigParams) :
 	_textureDitchDown(ImageParams(DrawableParams{ trigParams.TextureDitchDown }, SizeableParams{ trigParams.Size,trigParams.MinSize }, "texture")),
 	_textureOverdubbing(ImageParams(DrawableParams{ trigParams.TextureOverdubbing }, SizeableParams{ trigParams.Size,trigParams.MinSize }, "texture")),
 	_texturePunchedIn(ImageParams(DrawableParams{ trigParams.TexturePunchedIn }, SizeableParams{ trigParams.Size,trigParams.MinSize }, "texture")),
-	_lastLoopTakes({})
+	_lastLoopTakes(_MaxLastTakes),
+	_numLastLoopTakes(0)
 {
+	// Ids are copied in on the audio thread, so
+	// the room for them is made up front
+	for (auto& take : _lastLoopTakes)
+		take.TakeId.reserve(_MaxTakeIdChars);
 }
 
 Trigger::~Trigger()
@@ -111,7 +116,7 @@ ActionResult Trigger::OnAction(KeyAction action)
 	return res;
 }
 
-void Trigger::OnTick(Time curTime, unsigned int samps, std::optional<io::UserConfig> cfg)
+void Trigger::OnTick(Time curTime, unsigned int samps, const io::UserConfig& cfg)
 {
 	if ((TriggerState::TRIGSTATE_DEFAULT != _state) &&
 		(TriggerState::TRIGSTATE_DITCHDOWN != _state))
@@ -131,7 +136,7 @@ void Trigger::OnTick(Time curTime, unsigned int samps, std::optional<io::UserCon
 			_lastActivateTime = curTime;
 			_isLastActivateDown = _isLastActivateDownRaw;
 
-			StateMachine(_isLastActivateDownRaw, true, cfg);
+			StateMachine(_isLastActivateDownRaw, true, &cfg);
 		}
 	}
 	
@@ -144,7 +149,7 @@ void Trigger::OnTick(Time curTime, unsigned int samps, std::optional<io::UserCon
 			_lastDitchTime = curTime;
 			_isLastDitchDown = _isLastDitchDownRaw;
 
-			StateMachine(_isLastDitchDownRaw, false, cfg);
+			StateMachine(_isLastDitchDownRaw, false, &cfg);
 		}
 	}
 }
@@ -223,6 +228,28 @@ void Trigger::ClearInputChannels()
 	_inputChannels.clear();
 }
 
+std::vector<unsigned int> Trigger::InputChannels() const
+{
+	return _inputChannels;
+}
+
+bool Trigger::IsBound(const KeyAction& action) const
+{
+	for (auto& b : _activateBindings)
+	{
+		if (b.IsBound(TriggerSource::TRIGGER_KEY, action.KeyChar))
+			return true;
+	}
+
+	for (auto& b : _ditchBindings)
+	{
+		if (b.IsBound(TriggerSource::TRIGGER_KEY, action.KeyChar))
+			return true;
+	}
+
+	return false;
+}
+
 TriggerState Trigger::GetState() const
 {
 	return _state;
@@ -240,7 +267,7 @@ void Trigger::Reset()
 
 	_state = TriggerState::TRIGSTATE_DEFAULT;
 	_recordSampCount = 0;
-	_lastLoopTakes.clear();
+	_numLastLoopTakes = 0;
 }
 
 bool Trigger::IgnoreRepeats(bool isActivate, DualBinding::TestResult trigResult)
@@ -365,7 +392,7 @@ bool Trigger::TryChangeState(DualBinding& binding,
 
 bool Trigger::StateMachine(bool isDown,
 	bool isActivate,
-	std::optional<io::UserConfig> cfg)
+	const io::UserConfig* cfg)
 {
 	bool changedState = false;
 
@@ -441,7 +468,7 @@ bool Trigger::StateMachine(bool isDown,
 	return changedState;
 }
 
-void Trigger::StartRecording(std::optional<io::UserConfig> cfg)
+void Trigger::StartRecording(const io::UserConfig* cfg)
 {
 	_state = TRIGSTATE_RECORDING;
 	_recordSampCount = 0;
@@ -450,38 +477,35 @@ void Trigger::StartRecording(std::optional<io::UserConfig> cfg)
 	{
 		TriggerAction trigAction;
 		trigAction.ActionType = TriggerAction::TRIGGER_REC_START;
-		trigAction.InputChannels = _inputChannels;
+		trigAction.InputChannels = &_inputChannels;
 
-		if (cfg.has_value())
-			trigAction.SetUserConfig(cfg.value());
+		if (nullptr != cfg)
+			trigAction.SetUserConfig(*cfg);
 
 		auto res = _receiver->OnAction(trigAction);
 
 		// TODO: History for undo
 
 		if (res.IsEaten)
-		{
-			TriggerTake newTake = { TriggerTake::SOURCE_ADC, res.Id };
-			_lastLoopTakes.push_back(newTake);
-		}
+			PushTake(TriggerTake::SOURCE_ADC, res.Id);
 	}
 }
 
-void Trigger::EndRecording(std::optional<io::UserConfig> cfg)
+void Trigger::EndRecording(const io::UserConfig* cfg)
 {
 	_state = TRIGSTATE_DEFAULT;
 
-	if ((_receiver) && !_lastLoopTakes.empty())
+	if ((_receiver) && (_numLastLoopTakes > 0))
 	{
-		auto lastTake = _lastLoopTakes.back();
+		auto& lastTake = _lastLoopTakes[_numLastLoopTakes - 1];
 
 		TriggerAction trigAction;
 		trigAction.ActionType = TriggerAction::TRIGGER_REC_END;
 		trigAction.TargetId = lastTake.TakeId;
 		trigAction.SampleCount = _recordSampCount;
 
-		if (cfg.has_value())
-			trigAction.SetUserConfig(cfg.value());
+		if (nullptr != cfg)
+			trigAction.SetUserConfig(*cfg);
 
 		// TODO: History for undo
 
@@ -489,36 +513,36 @@ void Trigger::EndRecording(std::optional<io::UserConfig> cfg)
 	}
 }
 
-void Trigger::SetDitchDown(std::optional<io::UserConfig> cfg)
+void Trigger::SetDitchDown(const io::UserConfig* cfg)
 {
 	_state = TRIGSTATE_DITCHDOWN;
 }
 
-void Trigger::Ditch(std::optional<io::UserConfig> cfg)
+void Trigger::Ditch(const io::UserConfig* cfg)
 {
 	_state = TRIGSTATE_DEFAULT;
-	auto popBack = !_lastLoopTakes.empty();
+	auto popBack = _numLastLoopTakes > 0;
 
 	if ((_receiver) && popBack)
 	{
-		auto lastTake = _lastLoopTakes.back();
+		auto& lastTake = _lastLoopTakes[_numLastLoopTakes - 1];
 
 		TriggerAction trigAction;
 		trigAction.ActionType = TriggerAction::TRIGGER_DITCH;
 		trigAction.TargetId = lastTake.TakeId;
 		trigAction.SampleCount = _recordSampCount;
 
-		if (cfg.has_value())
-			trigAction.SetUserConfig(cfg.value());
+		if (nullptr != cfg)
+			trigAction.SetUserConfig(*cfg);
 
 		_receiver->OnAction(trigAction);
 	}
 
 	if (popBack)
-		_lastLoopTakes.pop_back();
+		_numLastLoopTakes--;
 }
 
-void Trigger::StartOverdub(std::optional<io::UserConfig> cfg)
+void Trigger::StartOverdub(const io::UserConfig* cfg)
 {
 	_state = TRIGSTATE_OVERDUBBING;
 	_recordSampCount = 0;
@@ -529,70 +553,67 @@ void Trigger::StartOverdub(std::optional<io::UserConfig> cfg)
 		trigAction.ActionType = TriggerAction::TRIGGER_OVERDUB_START;
 		trigAction.SampleCount = _recordSampCount;
 
-		if (cfg.has_value())
-			trigAction.SetUserConfig(cfg.value());
+		if (nullptr != cfg)
+			trigAction.SetUserConfig(*cfg);
 
 		auto res = _receiver->OnAction(trigAction);
 
 		if (res.IsEaten)
-		{
-			TriggerTake newTake = { TriggerTake::SOURCE_ADC, res.Id };
-			_lastLoopTakes.push_back(newTake);
-		}
+			PushTake(TriggerTake::SOURCE_ADC, res.Id);
 	}
 }
 
-void Trigger::EndOverdub(std::optional<io::UserConfig> cfg)
+void Trigger::EndOverdub(const io::UserConfig* cfg)
 {
 	_state = TRIGSTATE_DEFAULT;
 
-	if ((_receiver) && !_lastLoopTakes.empty())
+	if ((_receiver) && (_numLastLoopTakes > 0))
 	{
-		auto lastTake = _lastLoopTakes.back();
+		auto& lastTake = _lastLoopTakes[_numLastLoopTakes - 1];
 
 		TriggerAction trigAction;
 		trigAction.ActionType = TriggerAction::TRIGGER_OVERDUB_END;
 		trigAction.TargetId = lastTake.TakeId;
 		trigAction.SampleCount = _recordSampCount;
 
-		if (cfg.has_value())
-			trigAction.SetUserConfig(cfg.value());
+		if (nullptr != cfg)
+			trigAction.SetUserConfig(*cfg);
 
 		_receiver->OnAction(trigAction);
 	}
 }
 
-void Trigger::DitchOverdub(std::optional<io::UserConfig> cfg)
+void Trigger::DitchOverdub(const io::UserConfig* cfg)
 {
 	_state = TRIGSTATE_DEFAULT;
 
-	auto popBack = !_lastLoopTakes.empty();
+	auto popBack = _numLastLoopTakes > 0;
 
 	if ((_receiver) && popBack)
 	{
-		auto lastTake = _lastLoopTakes.back();
+		auto& lastTake = _lastLoopTakes[_numLastLoopTakes - 1];
 		TriggerAction trigAction;
 		trigAction.ActionType = TriggerAction::TRIGGER_OVERDUB_DITCH;
 		trigAction.TargetId = lastTake.TakeId;
 		trigAction.SampleCount = _recordSampCount;
 
-		if (cfg.has_value())
-			trigAction.SetUserConfig(cfg.value());
+		if (nullptr != cfg)
+			trigAction.SetUserConfig(*cfg);
 
 		_receiver->OnAction(trigAction);
 	}
 
 	if (popBack)
-		_lastLoopTakes.pop_back();
+		_numLastLoopTakes--;
 }
 
-void Trigger::StartPunchIn(std::optional<io::UserConfig> cfg)
+void Trigger::StartPunchIn(const io::UserConfig* cfg)
 {
 	_state = TRIGSTATE_PUNCHEDIN;
 
-	if ((_receiver) && !_lastLoopTakes.empty())
+	if ((_receiver) && (_numLastLoopTakes > 0))
 	{
-		auto lastTake = _lastLoopTakes.back();
+		auto& lastTake = _lastLoopTakes[_numLastLoopTakes - 1];
 
 		TriggerAction trigAction;
 		trigAction.ActionType = TriggerAction::TRIGGER_PUNCHIN_START;
@@ -602,26 +623,37 @@ void Trigger::StartPunchIn(std::optional<io::UserConfig> cfg)
 	}
 }
 
-void Trigger::EndPunchIn(std::optional<io::UserConfig> cfg)
+void Trigger::EndPunchIn(const io::UserConfig* cfg)
 {
 	_state = TRIGSTATE_OVERDUBBING;
 
-	if ((_receiver) && !_lastLoopTakes.empty())
+	if ((_receiver) && (_numLastLoopTakes > 0))
 	{
-		auto lastTake = _lastLoopTakes.back();
+		auto& lastTake = _lastLoopTakes[_numLastLoopTakes - 1];
 
 		TriggerAction trigAction;
 		trigAction.ActionType = TriggerAction::TRIGGER_PUNCHIN_END;
 		trigAction.TargetId = lastTake.TakeId;
 		trigAction.SampleCount = _recordSampCount;
 
-		if (cfg.has_value())
-			trigAction.SetUserConfig(cfg.value());
+		if (nullptr != cfg)
+			trigAction.SetUserConfig(*cfg);
 
 		_receiver->OnAction(trigAction);
 	}
 }
 
+void Trigger::PushTake(enum TriggerTake::SourceType sourceType, std::string_view takeId)
+{
+	if (_numLastLoopTakes >= _lastLoopTakes.size())
+		return;
+
+	auto& take = _lastLoopTakes[_numLastLoopTakes];
+	take.SourceType = sourceType;
+	take.TakeId.assign(takeId);
+	_numLastLoopTakes++;
+}
+
 void Trigger::_InitResources(ResourceLib& resourceLib, bool forceInit)
 {
 	_textureRecording.InitResources(resourceLib, forceInit);
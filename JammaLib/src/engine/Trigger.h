@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <optional>
+#include <string_view>
 #include "ActionReceiver.h"
 #include "GuiElement.h"
 #include "Tickable.h"
@@ -164,6 +165,16 @@ namespace engine
 
 		void Reset() { _isDown = false;	}
 
+		bool IsBound(TriggerSource source, unsigned int value) const
+		{
+			if ((source == _triggerDown.TriggerSource) && (value == _triggerDown.Value))
+				return true;
+
+			return _triggerRelease.has_value() &&
+				(source == _triggerRelease.value().TriggerSource) &&
+				(value == _triggerRelease.value().Value);
+		}
+
 		bool operator==(const DualBinding& other) {
 			if (!(_triggerDown == other._triggerDown))
 				return false;
@@ -230,7 +241,7 @@ namespace engine
 
 		virtual	utils::Position2d Position() const override;
 		virtual actions::ActionResult OnAction(actions::KeyAction action) override;
-		virtual void OnTick(Time curTime, unsigned int samps, std::optional<io::UserConfig> cfg) override;
+		virtual void OnTick(Time curTime, unsigned int samps, const io::UserConfig& cfg) override;
 		virtual void Draw(base::DrawContext& ctx) override;
 
 		void AddBinding(DualBinding activate, DualBinding ditch);
@@ -239,6 +250,8 @@ namespace engine
 		void AddInputChannel(unsigned int chan);
 		void RemoveInputChannel(unsigned int chan);
 		void ClearInputChannels();
+		std::vector<unsigned int> InputChannels() const;
+		bool IsBound(const actions::KeyAction& action) const;
 		TriggerState GetState() const;
 		void Reset();
 
@@ -258,20 +271,24 @@ namespace engine
 			int keyState);
 		bool StateMachine(bool isDown,
 			bool isActivate,
-			std::optional<io::UserConfig> cfg);
+			const io::UserConfig* cfg);
 
 		// Only call from state machine
-		void StartRecording(std::optional<io::UserConfig> cfg);
-		void EndRecording(std::optional<io::UserConfig> cfg);
-		void SetDitchDown(std::optional<io::UserConfig> cfg);
-		void Ditch(std::optional<io::UserConfig> cfg);
-		void StartOverdub(std::optional<io::UserConfig> cfg);
-		void EndOverdub(std::optional<io::UserConfig> cfg);
-		void DitchOverdub(std::optional<io::UserConfig> cfg);
-		void StartPunchIn(std::optional<io::UserConfig> cfg);
-		void EndPunchIn(std::optional<io::UserConfig> cfg);
+		void StartRecording(const io::UserConfig* cfg);
+		void EndRecording(const io::UserConfig* cfg);
+		void SetDitchDown(const io::UserConfig* cfg);
+		void Ditch(const io::UserConfig* cfg);
+		void StartOverdub(const io::UserConfig* cfg);
+		void EndOverdub(const io::UserConfig* cfg);
+		void DitchOverdub(const io::UserConfig* cfg);
+		void StartPunchIn(const io::UserConfig* cfg);
+		void EndPunchIn(const io::UserConfig* cfg);
+		void PushTake(enum TriggerTake::SourceType sourceType, std::string_view takeId);
 
 	private:
+		static const unsigned int _MaxLastTakes = 256u;
+		static const unsigned int _MaxTakeIdChars = 64u;
+
 		double _debounceTimeMs;
 		std::vector<DualBinding> _activateBindings;
 		std::vector<DualBinding> _ditchBindings;
@@ -289,6 +306,7 @@ namespace engine
 		graphics::Image _textureDitchDown;
 		graphics::Image _textureOverdubbing;
 		graphics::Image _texturePunchedIn;
-		std::vector<TriggerTake> _lastLoopTakes;
+		std::vector<TriggerTake> _lastLoopTakes; // Fixed slots, the first _numLastLoopTakes in use
+		unsigned int _numLastLoopTakes;
 	};
 }
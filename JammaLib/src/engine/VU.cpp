@@ -1,4 +1,5 @@
 #include "VU.h"
+#include "../graphics/LedBatch.h"
 
 using namespace engine;
 using base::DrawContext;
@@ -13,7 +14,9 @@ const float VU::_LedGap = 0.4f;
 VU::VU(VuParams params) :
 	GuiModel(params),
 	_value(audio::FallingValue({ params.FallRate })),
-	_vuParams(params)
+	_vuParams(params),
+	_radius(0.0f),
+	_ledColours({})
 {
 }
 
@@ -24,15 +27,37 @@ VU::~VU()
 void VU::Draw3d(DrawContext& ctx)
 {
 	auto& glCtx = dynamic_cast<GlDrawContext&>(ctx);
-
+	auto leds = glCtx.Leds();
+	auto pos = ModelPosition();
+	auto scale = ModelScale();
 	auto val = _value.Current();
-	glCtx.SetUniform("Value",(float)val);
 
 	glCtx.PushMvp(glm::scale(glm::mat4(1.0), glm::vec3(1.0f, 4.0f + 0.2f * val, 1.0f)));
+	glCtx.PushMvp(glm::translate(glm::mat4(1.0), glm::vec3(pos.X, pos.Y, pos.Z)));
+	glCtx.PushMvp(glm::scale(glm::mat4(1.0), glm::vec3(scale, scale, scale)));
 
-	GuiModel::Draw3d(glCtx);
+	_modelScreenPos = glCtx.ProjectScreen(pos);
+	auto mvp = glCtx.Mvp();
 
 	glCtx.PopMvp();
+	glCtx.PopMvp();
+	glCtx.PopMvp();
+
+	if (!leds)
+		return;
+
+	auto height = _sizeParams.Size.Height;
+	auto ledHeight = _vuParams.LedHeight;
+
+	for (auto led = 0u; led < _ledColours.size(); led++)
+	{
+		auto yMin = (led * ledHeight) + (_LedGap * 0.5f);
+		auto yMax = ((led + 1) * ledHeight) - (_LedGap * 0.5f);
+		auto frac = height > 0 ? ((yMin + yMax) * 0.5f) / (float)height : 0.0f;
+		auto level = val > frac ? 1.0f : 0.0f;
+
+		leds->Submit(mvp, _radius, 0.0f, yMin, yMax, glm::vec4(_ledColours[led], level));
+	}
 }
 
 double VU::Value() const
@@ -51,28 +76,21 @@ void VU::SetValue(double value, unsigned int numUpdates)
 
 void VU::UpdateModel(float radius)
 {
-	std::vector<float> verts;
-	std::vector<float> uvs;
+	_radius = radius;
 
-	auto numLeds = NumLeds(_sizeParams.Size.Height,
-		_vuParams.LedHeight);
+	auto height = _sizeParams.Size.Height;
+	auto numLeds = NumLeds(height, _vuParams.LedHeight);
 
-	for (auto led = 0u; led < numLeds; led++)
-	{
-		auto [ledVerts, ledUvs] =
-			CalcLedGeometry(led,
-				radius,
-				_sizeParams.Size.Height,
-				_vuParams.LedHeight);
+	if (numLeds == _ledColours.size())
+		return;
 
-		for (auto vert : ledVerts)
-			verts.push_back(vert);
+	_ledColours.resize(numLeds);
 
-		for (auto uv : ledUvs)
-			uvs.push_back(uv);
+	for (auto led = 0u; led < numLeds; led++)
+	{
+		auto yMid = (led + 0.5f) * _vuParams.LedHeight;
+		_ledColours[led] = LedColour(height > 0 ? yMid / (float)height : 0.0f);
 	}
-
-	SetGeometry(verts, uvs);
 }
 
 unsigned int VU::NumLeds(unsigned int vuHeight,
@@ -81,127 +99,11 @@ unsigned int VU::NumLeds(unsigned int vuHeight,
 	return (unsigned int)std::ceil(((double)vuHeight) / ledHeight);
 }
 
-std::tuple<std::vector<float>, std::vector<float>>
-VU::CalcLedGeometry(unsigned int led,
-	float radius,
-	unsigned int height,
-	float ledHeight)
+glm::vec3 VU::LedColour(float frac)
 {
-	const float radialThickness = radius / 15.0f;
-
-	auto yToUv = [&height](float y) {
-		if (height > 0)
-			return y / (float)height;
-
-		return 0.0f;
-	};
-
-	auto angle1 = -0.01f;
-	auto angle2 = -angle1;
-	auto xInner1 = sin(angle1) * (radius - radialThickness);
-	auto xInner2 = sin(angle2) * (radius - radialThickness);
-	auto xOuter1 = sin(angle1) * (radius + radialThickness);
-	auto xOuter2 = sin(angle2) * (radius + radialThickness);
-	auto yMin = (led * ledHeight) + (_LedGap * 0.5f);
-	auto yMax = ((led + 1) * ledHeight) - (_LedGap * 0.5f);
-	auto yMid = (yMin + yMax) * 0.5f;
-	auto zInner1 = cos(angle1) * (radius - radialThickness);
-	auto zInner2 = cos(angle2) * (radius - radialThickness);
-	auto zOuter1 = cos(angle1) * (radius + radialThickness);
-	auto zOuter2 = cos(angle2) * (radius + radialThickness);
-
-	std::vector<float> verts;
-	std::vector<float> uvs;
-
-	// Front
-	verts.push_back(xOuter1); verts.push_back(yMin); verts.push_back(zOuter1);
-	verts.push_back(xOuter2); verts.push_back(yMax); verts.push_back(zOuter2);
-	verts.push_back(xOuter1); verts.push_back(yMax); verts.push_back(zOuter1);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	verts.push_back(xOuter1); verts.push_back(yMin); verts.push_back(zOuter1);
-	verts.push_back(xOuter2); verts.push_back(yMin); verts.push_back(zOuter2);
-	verts.push_back(xOuter2); verts.push_back(yMax); verts.push_back(zOuter2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	// Top
-	verts.push_back(xOuter1); verts.push_back(yMax); verts.push_back(zOuter1);
-	verts.push_back(xInner2); verts.push_back(yMax); verts.push_back(zInner2);
-	verts.push_back(xInner1); verts.push_back(yMax); verts.push_back(zInner1);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	verts.push_back(xOuter1); verts.push_back(yMax); verts.push_back(zOuter1);
-	verts.push_back(xOuter2); verts.push_back(yMax); verts.push_back(zOuter2);
-	verts.push_back(xInner2); verts.push_back(yMax); verts.push_back(zInner2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	// Back
-	verts.push_back(xInner1); verts.push_back(yMin); verts.push_back(zInner1);
-	verts.push_back(xInner1); verts.push_back(yMax); verts.push_back(zInner1);
-	verts.push_back(xInner2); verts.push_back(yMax); verts.push_back(zInner2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	verts.push_back(xInner1); verts.push_back(yMin); verts.push_back(zInner1);
-	verts.push_back(xInner2); verts.push_back(yMax); verts.push_back(zInner2);
-	verts.push_back(xInner2); verts.push_back(yMin); verts.push_back(zInner2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	// Bottom
-	verts.push_back(xOuter1); verts.push_back(yMin); verts.push_back(zOuter1);
-	verts.push_back(xInner1); verts.push_back(yMin); verts.push_back(zInner1);
-	verts.push_back(xInner2); verts.push_back(yMin); verts.push_back(zInner2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	verts.push_back(xOuter1); verts.push_back(yMin); verts.push_back(zOuter1);
-	verts.push_back(xInner2); verts.push_back(yMin); verts.push_back(zInner2);
-	verts.push_back(xOuter2); verts.push_back(yMin); verts.push_back(zOuter2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	// Left Side
-	verts.push_back(xOuter1); verts.push_back(yMin); verts.push_back(zInner1);
-	verts.push_back(xOuter1); verts.push_back(yMax); verts.push_back(zOuter1);
-	verts.push_back(xOuter1); verts.push_back(yMax); verts.push_back(zInner1);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	verts.push_back(xOuter1); verts.push_back(yMin); verts.push_back(zInner1);
-	verts.push_back(xOuter1); verts.push_back(yMin); verts.push_back(zOuter1);
-	verts.push_back(xOuter1); verts.push_back(yMax); verts.push_back(zOuter1);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	// Right Side
-	verts.push_back(xOuter2); verts.push_back(yMin); verts.push_back(zInner2);
-	verts.push_back(xOuter2); verts.push_back(yMax); verts.push_back(zInner2);
-	verts.push_back(xOuter2); verts.push_back(yMax); verts.push_back(zOuter2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	verts.push_back(xOuter2); verts.push_back(yMin); verts.push_back(zInner2);
-	verts.push_back(xOuter2); verts.push_back(yMax); verts.push_back(zOuter2);
-	verts.push_back(xOuter2); verts.push_back(yMin); verts.push_back(zOuter2);
-	uvs.push_back(angle1 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-	uvs.push_back(angle2 / (float)constants::TWOPI); uvs.push_back(yToUv(yMid));
-
-	return std::make_tuple(verts, uvs);
+	// Hue runs from magenta at the bottom to red at the top
+	auto hue = 1.4f - (frac * 0.4f);
+	auto rgb = glm::abs(glm::fract(glm::vec3(hue) + glm::vec3(1.0f, 2.0f / 3.0f, 1.0f / 3.0f)) * 6.0f - glm::vec3(3.0f));
+
+	return glm::clamp(rgb - glm::vec3(1.0f), 0.0f, 1.0f);
 }
@@ -50,16 +50,16 @@ namespace engine
 
 	protected:
 		static unsigned int NumLeds(unsigned int vuHeight, double ledHeight);
-		static std::tuple<std::vector<float>, std::vector<float>>
-			CalcLedGeometry(unsigned int led,
-				float radius,
-				unsigned int height,
-				float ledHeight);
+		static glm::vec3 LedColour(float frac);
 
 	protected:
 		static const float _LedGap;
 
 		audio::FallingValue _value;
 		VuParams _vuParams;
+		// LEDs are drawn as instances by the scene's LedBatch,
+		// so only their placement and colour are kept here
+		float _radius;
+		std::vector<glm::vec3> _ledColours;
 	};
 }
@@ -0,0 +1,78 @@
+#include "GlBackend.h"
+#include <gl/glew.h>
+#include <gl/gl.h>
+#include "gl/glext.h"
+#include "gl/wglext.h"
+
+using namespace graphics;
+
+namespace
+{
+	class OpenGlBackend :
+		public GlBackend
+	{
+	public:
+		virtual unsigned int GenVertexArray() override
+		{
+			GLuint vertexArray = 0;
+			glGenVertexArrays(1, &vertexArray);
+			return vertexArray;
+		}
+
+		virtual void DeleteVertexArray(unsigned int vertexArray) override
+		{
+			GLuint id = vertexArray;
+			glDeleteVertexArrays(1, &id);
+		}
+
+		virtual void BindVertexArray(unsigned int vertexArray) override
+		{
+			glBindVertexArray(vertexArray);
+		}
+
+		virtual unsigned int GenBuffer() override
+		{
+			GLuint buffer = 0;
+			glGenBuffers(1, &buffer);
+			return buffer;
+		}
+
+		virtual void DeleteBuffer(unsigned int buffer) override
+		{
+			GLuint id = buffer;
+			glDeleteBuffers(1, &id);
+		}
+
+		virtual void BindArrayBuffer(unsigned int buffer) override
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		}
+
+		virtual void BufferData(size_t numBytes, const void* data) override
+		{
+			glBufferData(GL_ARRAY_BUFFER, numBytes, data, GL_DYNAMIC_DRAW);
+		}
+
+		virtual void BufferSubData(size_t offsetBytes, size_t numBytes, const void* data) override
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, offsetBytes, numBytes, data);
+		}
+
+		virtual void VertexAttribPointer(unsigned int index, unsigned int numComponents) override
+		{
+			glEnableVertexAttribArray(index);
+			glVertexAttribPointer(index, numComponents, GL_FLOAT, GL_FALSE, 0, 0);
+		}
+
+		virtual void VertexAttribDivisor(unsigned int index, unsigned int divisor) override
+		{
+			glVertexAttribDivisor(index, divisor);
+		}
+	};
+}
+
+std::shared_ptr<GlBackend> GlBackend::Default()
+{
+	static auto backend = std::make_shared<OpenGlBackend>();
+	return backend;
+}
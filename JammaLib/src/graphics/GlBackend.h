@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <cstddef>
+
+namespace graphics
+{
+	// The GL calls used to manage vertex buffers, kept behind an
+	// interface so buffer management can be tested without a context
+	class GlBackend
+	{
+	public:
+		virtual ~GlBackend() {}
+
+	public:
+		virtual unsigned int GenVertexArray() = 0;
+		virtual void DeleteVertexArray(unsigned int vertexArray) = 0;
+		virtual void BindVertexArray(unsigned int vertexArray) = 0;
+		virtual unsigned int GenBuffer() = 0;
+		virtual void DeleteBuffer(unsigned int buffer) = 0;
+		virtual void BindArrayBuffer(unsigned int buffer) = 0;
+		// Allocates storage for the bound buffer, discarding the old store
+		virtual void BufferData(size_t numBytes, const void* data) = 0;
+		virtual void BufferSubData(size_t offsetBytes, size_t numBytes, const void* data) = 0;
+		virtual void VertexAttribPointer(unsigned int index, unsigned int numComponents) = 0;
+		virtual void VertexAttribDivisor(unsigned int index, unsigned int divisor) = 0;
+
+		static std::shared_ptr<GlBackend> Default();
+	};
+}
@@ -4,7 +4,10 @@ using namespace graphics;
 using namespace utils;
 
 GlDrawContext::GlDrawContext() :
-	DrawContext()
+	DrawContext(),
+	_leds(nullptr),
+	_numDrawCalls(0),
+	_numVerts(0)
 {
 }
 
@@ -46,6 +49,17 @@ void GlDrawContext::ClearMvp() noexcept
 	_mvp.clear();
 }
 
+glm::mat4 GlDrawContext::Mvp() const
+{
+	auto collapsed = glm::mat4(1.0);
+	for (auto& m : _mvp)
+	{
+		collapsed *= m;
+	}
+
+	return collapsed;
+}
+
 Position2d GlDrawContext::ProjectScreen(utils::Position3d pos)
 {
 	auto p = glm::vec3(pos.X, pos.Y, pos.Z);
@@ -65,4 +79,36 @@ Position2d GlDrawContext::ProjectScreen(utils::Position3d pos)
 		(int)((screenPosNorm.y + 1.0) * 0.5 * _size.Height) };
 
 	return screenPosPix;
-}
\ No newline at end of file
+}
+
+std::shared_ptr<LedBatch> GlDrawContext::Leds() const
+{
+	return _leds;
+}
+
+void GlDrawContext::SetLeds(std::shared_ptr<LedBatch> leds)
+{
+	_leds = leds;
+}
+
+void GlDrawContext::AddDrawCall(unsigned int numVerts) noexcept
+{
+	_numDrawCalls++;
+	_numVerts += numVerts;
+}
+
+void GlDrawContext::ResetDrawStats() noexcept
+{
+	_numDrawCalls = 0;
+	_numVerts = 0;
+}
+
+unsigned int GlDrawContext::NumDrawCalls() const noexcept
+{
+	return _numDrawCalls;
+}
+
+unsigned int GlDrawContext::NumVerts() const noexcept
+{
+	return _numVerts;
+}
@@ -5,6 +5,7 @@
 #include <vector>
 #include <any>
 #include <optional>
+#include <memory>
 #include <glm/glm.hpp>
 #include "../utils/CommonTypes.h"
 #include "DrawContext.h"
@@ -13,6 +14,8 @@
 
 namespace graphics
 {
+	class LedBatch;
+
 	class GlDrawContext :
 		public base::DrawContext
 	{
@@ -32,12 +35,24 @@ namespace graphics
 		void PushMvp(const glm::mat4 mat) noexcept;
 		void PopMvp() noexcept;
 		void ClearMvp() noexcept;
+		glm::mat4 Mvp() const;
 		utils::Position2d ProjectScreen(utils::Position3d pos);
 
+		std::shared_ptr<LedBatch> Leds() const;
+		void SetLeds(std::shared_ptr<LedBatch> leds);
+
+		void AddDrawCall(unsigned int numVerts) noexcept;
+		void ResetDrawStats() noexcept;
+		unsigned int NumDrawCalls() const noexcept;
+		unsigned int NumVerts() const noexcept;
+
 	private:
 		const std::string _MvpUniformName = "MVP";
 
 		std::map<std::string, std::any> _uniforms;
 		std::vector<glm::mat4> _mvp;
+		std::shared_ptr<LedBatch> _leds;
+		unsigned int _numDrawCalls;
+		unsigned int _numVerts;
 	};
 }
@@ -0,0 +1,122 @@
+#include "LedBatch.h"
+#include "GlUtils.h"
+
+using namespace graphics;
+using resources::ResourceLib;
+using resources::ShaderResource;
+using utils::GlUtils;
+
+const std::string LedBatch::_ShaderName = "vu";
+
+LedBatch::LedBatch() :
+	ResourceUser(),
+	_numInstances(0),
+	_numDrawCalls(0),
+	_numVerts(0),
+	_instanceData(NUM_ATTRIBS),
+	_vertexArray(GlBackend::Default(), { 4, 4, 4, 4, 4, 4 }, 1)
+{
+}
+
+LedBatch::~LedBatch()
+{
+}
+
+void LedBatch::Clear()
+{
+	_numInstances = 0;
+
+	for (auto& data : _instanceData)
+		data.clear();
+}
+
+void LedBatch::Submit(const glm::mat4& mvp,
+	float radius,
+	float angle,
+	float yMin,
+	float yMax,
+	const glm::vec4& colour)
+{
+	auto push = [](std::vector<float>& data, float a, float b, float c, float d) {
+		data.push_back(a);
+		data.push_back(b);
+		data.push_back(c);
+		data.push_back(d);
+	};
+
+	for (auto col = 0; col < 4; col++)
+		push(_instanceData[ATTRIB_MVP0 + col], mvp[col][0], mvp[col][1], mvp[col][2], mvp[col][3]);
+
+	push(_instanceData[ATTRIB_LED], radius, angle, yMin, yMax);
+	push(_instanceData[ATTRIB_COLOUR], colour.r, colour.g, colour.b, colour.a);
+
+	_numInstances++;
+}
+
+void LedBatch::Draw(GlDrawContext& ctx)
+{
+	_numDrawCalls = 0;
+	_numVerts = 0;
+
+	auto shader = _shader.lock();
+
+	if (!shader || (0 == _numInstances))
+		return;
+
+	// Instance data is rewritten every frame,
+	// so each upload orphans the previous store
+	_vertexArray.Resize(_numInstances);
+
+	for (auto attrib = 0u; attrib < NUM_ATTRIBS; attrib++)
+		_vertexArray.Upload(attrib, 0, _numInstances, _instanceData[attrib].data());
+
+	glUseProgram(shader->GetId());
+	shader->SetUniforms(ctx);
+
+	_vertexArray.Bind();
+	glDrawArraysInstanced(GL_TRIANGLES, 0, VertsPerLed, _numInstances);
+	_vertexArray.Unbind();
+
+	glUseProgram(0);
+
+	_numDrawCalls = 1;
+	_numVerts = VertsPerLed * _numInstances;
+	ctx.AddDrawCall(_numVerts);
+}
+
+unsigned int LedBatch::NumInstances() const
+{
+	return _numInstances;
+}
+
+unsigned int LedBatch::NumDrawCalls() const
+{
+	return _numDrawCalls;
+}
+
+unsigned int LedBatch::NumVerts() const
+{
+	return _numVerts;
+}
+
+void LedBatch::_InitResources(ResourceLib& resourceLib, bool forceInit)
+{
+	auto shaderOpt = resourceLib.GetResource(_ShaderName);
+
+	if (!shaderOpt.has_value())
+		return;
+
+	auto resource = shaderOpt.value().lock();
+
+	if (!resource || (resources::SHADER != resource->GetType()))
+		return;
+
+	_shader = std::dynamic_pointer_cast<ShaderResource>(resource);
+
+	GlUtils::CheckError("LedBatch::_InitResources()");
+}
+
+void LedBatch::_ReleaseResources()
+{
+	_vertexArray.Release();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include "ResourceUser.h"
+#include "GlDrawContext.h"
+#include "VertexArray.h"
+#include "glm/glm.hpp"
+
+namespace graphics
+{
+	// Collects the LEDs of every VU in the scene and draws them
+	// as instances of one box mesh, which lives in the vu shader
+	class LedBatch :
+		public base::ResourceUser
+	{
+	public:
+		LedBatch();
+		~LedBatch();
+
+		// Copy
+		LedBatch(const LedBatch&) = delete;
+		LedBatch& operator=(const LedBatch&) = delete;
+
+	public:
+		void Clear();
+		// Adds one LED spanning yMin to yMax, centred on the given
+		// angle at the given radius. Colour alpha is the LED level.
+		void Submit(const glm::mat4& mvp,
+			float radius,
+			float angle,
+			float yMin,
+			float yMax,
+			const glm::vec4& colour);
+		void Draw(GlDrawContext& ctx);
+
+		unsigned int NumInstances() const;
+		unsigned int NumDrawCalls() const;
+		unsigned int NumVerts() const;
+
+	public:
+		static const unsigned int VertsPerLed = 36u;
+
+	protected:
+		virtual void _InitResources(resources::ResourceLib& resourceLib, bool forceInit) override;
+		virtual void _ReleaseResources() override;
+
+	protected:
+		enum InstanceAttrib
+		{
+			ATTRIB_MVP0,
+			ATTRIB_MVP1,
+			ATTRIB_MVP2,
+			ATTRIB_MVP3,
+			ATTRIB_LED,
+			ATTRIB_COLOUR,
+			NUM_ATTRIBS
+		};
+
+		static const std::string _ShaderName;
+
+		unsigned int _numInstances;
+		unsigned int _numDrawCalls;
+		unsigned int _numVerts;
+		std::vector<std::vector<float>> _instanceData;
+		VertexArray _vertexArray;
+		std::weak_ptr<resources::ShaderResource> _shader;
+	};
+}
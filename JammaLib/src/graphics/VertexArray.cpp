@@ -0,0 +1,142 @@
+#include "VertexArray.h"
+
+using namespace graphics;
+
+VertexArray::VertexArray(std::shared_ptr<GlBackend> backend,
+	std::vector<unsigned int> attribComponents,
+	unsigned int divisor) :
+	_backend(backend),
+	_attribComponents(attribComponents),
+	_divisor(divisor),
+	_vertexArray(0),
+	_buffers({}),
+	_numVerts(0),
+	_capacity(0)
+{
+}
+
+VertexArray::~VertexArray()
+{
+}
+
+bool VertexArray::Resize(unsigned int numVerts)
+{
+	_numVerts = numVerts;
+
+	if ((0 != _vertexArray) && (numVerts <= _capacity))
+		return false;
+
+	if (0 == _vertexArray)
+		Init();
+
+	// Grow geometrically so that models which are
+	// extended every frame settle on a size quickly
+	auto grown = _capacity + _capacity / 2;
+	_capacity = numVerts > grown ? numVerts : grown;
+
+	for (auto attrib = 0u; attrib < _buffers.size(); attrib++)
+	{
+		_backend->BindArrayBuffer(_buffers[attrib]);
+		_backend->BufferData(_capacity * _attribComponents[attrib] * sizeof(float), nullptr);
+	}
+
+	_backend->BindArrayBuffer(0);
+
+	return true;
+}
+
+void VertexArray::Upload(unsigned int attrib,
+	unsigned int firstVert,
+	unsigned int numVerts,
+	const float* data)
+{
+	if ((attrib >= _buffers.size()) || (firstVert >= _capacity) || (0 == numVerts))
+		return;
+
+	if (firstVert + numVerts > _capacity)
+		numVerts = _capacity - firstVert;
+
+	auto components = _attribComponents[attrib];
+	_backend->BindArrayBuffer(_buffers[attrib]);
+
+	// Rewriting everything orphans the old store rather
+	// than waiting for the GPU to finish reading it
+	if ((0 == firstVert) && (numVerts >= _numVerts))
+		_backend->BufferData(_capacity * components * sizeof(float), nullptr);
+
+	_backend->BufferSubData(firstVert * components * sizeof(float),
+		numVerts * components * sizeof(float),
+		data);
+	_backend->BindArrayBuffer(0);
+}
+
+void VertexArray::Bind() const
+{
+	_backend->BindVertexArray(_vertexArray);
+}
+
+void VertexArray::Unbind() const
+{
+	_backend->BindVertexArray(0);
+}
+
+void VertexArray::Release()
+{
+	for (auto buffer : _buffers)
+		_backend->DeleteBuffer(buffer);
+
+	_buffers.clear();
+
+	if (0 != _vertexArray)
+		_backend->DeleteVertexArray(_vertexArray);
+
+	_vertexArray = 0;
+	_numVerts = 0;
+	_capacity = 0;
+}
+
+unsigned int VertexArray::Id() const
+{
+	return _vertexArray;
+}
+
+unsigned int VertexArray::NumVerts() const
+{
+	return _numVerts;
+}
+
+unsigned int VertexArray::Capacity() const
+{
+	return _capacity;
+}
+
+size_t VertexArray::GpuBytes() const
+{
+	size_t numBytes = 0;
+
+	for (auto attrib = 0u; attrib < _buffers.size(); attrib++)
+		numBytes += (size_t)_capacity * _attribComponents[attrib] * sizeof(float);
+
+	return numBytes;
+}
+
+void VertexArray::Init()
+{
+	_vertexArray = _backend->GenVertexArray();
+	_backend->BindVertexArray(_vertexArray);
+
+	for (auto attrib = 0u; attrib < _attribComponents.size(); attrib++)
+	{
+		auto buffer = _backend->GenBuffer();
+		_buffers.push_back(buffer);
+
+		_backend->BindArrayBuffer(buffer);
+		_backend->VertexAttribPointer(attrib, _attribComponents[attrib]);
+
+		if (_divisor > 0)
+			_backend->VertexAttribDivisor(attrib, _divisor);
+	}
+
+	_backend->BindArrayBuffer(0);
+	_backend->BindVertexArray(0);
+}
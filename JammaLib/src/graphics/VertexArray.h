@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include "GlBackend.h"
+
+namespace graphics
+{
+	// A vertex array object with one float buffer per attribute.
+	// Buffers are created once and grown in place, so updates
+	// only upload the vertices that changed. A non-zero divisor
+	// makes every attribute per-instance rather than per-vertex.
+	class VertexArray
+	{
+	public:
+		VertexArray(std::shared_ptr<GlBackend> backend,
+			std::vector<unsigned int> attribComponents,
+			unsigned int divisor = 0);
+		~VertexArray();
+
+		// Copy
+		VertexArray(const VertexArray&) = delete;
+		VertexArray& operator=(const VertexArray&) = delete;
+
+	public:
+		// Returns true if storage was (re)allocated,
+		// in which case every attribute must be uploaded again
+		bool Resize(unsigned int numVerts);
+		void Upload(unsigned int attrib,
+			unsigned int firstVert,
+			unsigned int numVerts,
+			const float* data);
+		void Bind() const;
+		void Unbind() const;
+		void Release();
+
+		unsigned int Id() const;
+		unsigned int NumVerts() const;
+		unsigned int Capacity() const;
+		size_t GpuBytes() const;
+
+	protected:
+		void Init();
+
+	protected:
+		std::shared_ptr<GlBackend> _backend;
+		std::vector<unsigned int> _attribComponents;
+		unsigned int _divisor;
+		unsigned int _vertexArray;
+		std::vector<unsigned int> _buffers;
+		unsigned int _numVerts;
+		unsigned int _capacity;
+	};
+}
@@ -10,6 +10,7 @@ using namespace resources;
 GuiLabel::GuiLabel(GuiLabelParams guiParams) :
 	GuiElement(guiParams),
 	_str(guiParams.String),
+	_isStringChanged(false),
 	_vertexArray(0),
 	_texture(std::weak_ptr<TextureResource>()),
 	_shader(std::weak_ptr<ShaderResource>()),
@@ -33,8 +34,27 @@ void GuiLabel::Draw(DrawContext& ctx)
 
 	auto font = _font.lock();
 
-	if (font)
-		font->Draw(glCtx, _vertexArray, (unsigned int)_str.size());
+	if (!font)
+		return;
+
+	if (_isStringChanged)
+	{
+		ReleaseVertexArray();
+		InitVertexArray();
+		_isStringChanged = false;
+	}
+
+	font->Draw(glCtx, _vertexArray, (unsigned int)_str.size());
+}
+
+// Only rebuilds the text geometry on the next Draw if the string differs
+void GuiLabel::SetString(std::string str)
+{
+	if (str == _str)
+		return;
+
+	_str = str;
+	_isStringChanged = true;
 }
 
 void GuiLabel::_InitResources(ResourceLib& resourceLib, bool forceInit)
@@ -53,7 +73,7 @@ void GuiLabel::_InitResources(ResourceLib& resourceLib, bool forceInit)
 
 void GuiLabel::_ReleaseResources()
 {
-	glDeleteVertexArrays(1, &_vertexArray);
+	ReleaseVertexArray();
 }
 
 bool GuiLabel::InitVertexArray()
@@ -66,3 +86,28 @@ bool GuiLabel::InitVertexArray()
 	_vertexArray = font->InitVertexArray(_str, GL_STATIC_DRAW);
 	return true;
 }
+
+void GuiLabel::ReleaseVertexArray()
+{
+	if (0 == _vertexArray)
+		return;
+
+	// Font attaches positions and uvs as attributes 0 and 1
+	glBindVertexArray(_vertexArray);
+
+	for (GLuint attrib = 0; attrib < 2; attrib++)
+	{
+		GLint buffer = 0;
+		glGetVertexAttribiv(attrib, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+
+		if (0 != buffer)
+		{
+			auto bufferId = (GLuint)buffer;
+			glDeleteBuffers(1, &bufferId);
+		}
+	}
+
+	glBindVertexArray(0);
+	glDeleteVertexArrays(1, &_vertexArray);
+	_vertexArray = 0;
+}
@@ -29,6 +29,7 @@ namespace gui
 
 	public:
 		virtual void Draw(base::DrawContext& ctx) override;
+		void SetString(std::string str);
 
 	protected:
 		virtual void _InitResources(resources::ResourceLib& resourceLib, bool forceInit) override;
@@ -36,9 +37,11 @@ namespace gui
 
 	private:
 		bool InitVertexArray();
+		void ReleaseVertexArray();
 
 	private:
 		std::string _str;
+		bool _isStringChanged;
 		GLuint _vertexArray;
 		std::weak_ptr<resources::TextureResource> _texture;
 		std::weak_ptr<resources::ShaderResource> _shader;
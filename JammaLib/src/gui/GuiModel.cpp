@@ -1,4 +1,5 @@
 #include "GuiModel.h"
+#include <algorithm>
 #include "glm/glm.hpp"
 #include "glm/ext.hpp"
 
@@ -12,7 +13,10 @@ GuiModel::GuiModel(GuiModelParams params) :
 	GuiElement(params),
 	_geometryNeedsUpdating(false),
 	_modelParams(params),
+	_vertexArray(graphics::GlBackend::Default(), { 3, 2 }),
 	_numTris(0),
+	_dirtyTriStart(0),
+	_dirtyTriEnd(0),
 	_backVerts({}),
 	_backUvs({})
 {
@@ -34,16 +38,22 @@ void GuiModel::Draw3d(DrawContext& ctx)
 	if (!texture || !shader)
 		return;
 
+	if (_geometryNeedsUpdating)
+		UpdateGeometry();
+
 	glUseProgram(shader->GetId());
 	shader->SetUniforms(dynamic_cast<GlDrawContext&>(ctx));
 
-	glBindVertexArray(_vertexArray);
+	SetModelUniforms(glCtx);
+
+	_vertexArray.Bind();
 
 	glBindTexture(GL_TEXTURE_2D, texture->GetId());
 	glDrawArrays(GL_TRIANGLES, 0, _numTris * 3);
+	glCtx.AddDrawCall(_numTris * 3);
 
 	glBindTexture(GL_TEXTURE_2D, 0);
-	glBindVertexArray(0);
+	_vertexArray.Unbind();
 	glUseProgram(0);
 
 	for (auto& child : _children)
@@ -55,11 +65,103 @@ void GuiModel::Draw3d(DrawContext& ctx)
 
 void GuiModel::SetGeometry(std::vector<float> verts, std::vector<float> uvs)
 {
+	std::scoped_lock lock(_geometryMutex);
+
 	_backVerts = verts;
 	_backUvs = uvs;
 
+	SetGeometryDirty(0, (unsigned int)_backVerts.size() / 9);
+}
+
+size_t GuiModel::GpuBytes() const
+{
+	return _vertexArray.GpuBytes();
+}
+
+void GuiModel::WriteGeometry(unsigned int numTris,
+	unsigned int firstTri,
+	const std::vector<float>& verts,
+	const std::vector<float>& uvs)
+{
+	std::scoped_lock lock(_geometryMutex);
+
+	auto isResized = _backVerts.size() != numTris * 9;
+	auto numWritten = std::min((unsigned int)verts.size() / 9, numTris > firstTri ? numTris - firstTri : 0u);
+
+	if (isResized)
+	{
+		_backVerts.resize(numTris * 9);
+		_backUvs.resize(numTris * 6);
+	}
+
+	std::copy(verts.begin(), verts.begin() + numWritten * 9, _backVerts.begin() + firstTri * 9);
+	std::copy(uvs.begin(), uvs.begin() + numWritten * 6, _backUvs.begin() + firstTri * 6);
+
+	if (isResized || (numWritten > 0))
+		SetGeometryDirty(firstTri, numWritten);
+}
+
+// Called with _geometryMutex held
+void GuiModel::SetGeometryDirty(unsigned int firstTri, unsigned int numTris)
+{
+	if (_geometryNeedsUpdating)
+	{
+		_dirtyTriStart = std::min(_dirtyTriStart, firstTri);
+		_dirtyTriEnd = std::max(_dirtyTriEnd, firstTri + numTris);
+	}
+	else
+	{
+		_dirtyTriStart = firstTri;
+		_dirtyTriEnd = firstTri + numTris;
+	}
+
 	_geometryNeedsUpdating = true;
-	_resourcesNeedInitialising = true;
+}
+
+bool GuiModel::UpdateGeometry()
+{
+	unsigned int numTris, firstTri, endTri;
+
+	{
+		std::scoped_lock lock(_geometryMutex);
+
+		_geometryNeedsUpdating = false;
+
+		numTris = (unsigned int)_backVerts.size() / 9;
+		firstTri = std::min(_dirtyTriStart, numTris);
+		endTri = std::min(_dirtyTriEnd, numTris);
+
+		_modelParams.Verts.resize(_backVerts.size());
+		_modelParams.Uvs.resize(_backUvs.size());
+
+		if (endTri > firstTri)
+		{
+			std::copy(_backVerts.begin() + firstTri * 9, _backVerts.begin() + endTri * 9, _modelParams.Verts.begin() + firstTri * 9);
+			std::copy(_backUvs.begin() + firstTri * 6, _backUvs.begin() + endTri * 6, _modelParams.Uvs.begin() + firstTri * 6);
+		}
+	}
+
+	if (0 == _vertexArray.Id())
+		return InitVertexArray(_modelParams.Verts, _modelParams.Uvs);
+
+	// Growing past capacity reallocates the
+	// buffers, so everything is uploaded again
+	if (_vertexArray.Resize(numTris * 3))
+	{
+		firstTri = 0;
+		endTri = numTris;
+	}
+
+	_numTris = numTris;
+
+	if (endTri > firstTri)
+		return UpdateVertexArray(firstTri, endTri - firstTri);
+
+	return true;
+}
+
+void GuiModel::SetModelUniforms(GlDrawContext& ctx)
+{
 }
 
 void GuiModel::_InitResources(ResourceLib& resourceLib, bool forceInit)
@@ -74,6 +176,8 @@ void GuiModel::_InitResources(ResourceLib& resourceLib, bool forceInit)
 	{
 		if (_geometryNeedsUpdating)
 		{
+			std::scoped_lock lock(_geometryMutex);
+
 			_geometryNeedsUpdating = false;
 			_modelParams.Verts = _backVerts;
 			_modelParams.Uvs = _backUvs;
@@ -87,12 +191,7 @@ void GuiModel::_InitResources(ResourceLib& resourceLib, bool forceInit)
 
 void GuiModel::_ReleaseResources()
 {
-	glDeleteBuffers(2, _vertexBuffer);
-	_vertexBuffer[0] = 0;
-	_vertexBuffer[1] = 0;
-
-	glDeleteVertexArrays(1, &_vertexArray);
-	_vertexArray = 0;
+	_vertexArray.Release();
 }
 
 bool GuiModel::InitTexture(ResourceLib& resourceLib)
@@ -135,53 +234,28 @@ bool GuiModel::InitShader(ResourceLib & resourceLib)
 	return true;
 }
 
-bool GuiModel::InitVertexArray(std::vector<float> verts, std::vector<float> uvs)
+bool GuiModel::InitVertexArray(const std::vector<float>& verts, const std::vector<float>& uvs)
 {
 	_numTris = (unsigned int)verts.size() / 9;
-	auto numFaces = _numTris / 2;
-
-	glGenVertexArrays(1, &_vertexArray);
-	glBindVertexArray(_vertexArray);
+	auto numUvVerts = (unsigned int)uvs.size() / 2;
 
-	glGenBuffers(3, _vertexBuffer);
+	_vertexArray.Resize(_numTris * 3);
+	_vertexArray.Upload(0, 0, _numTris * 3, verts.data());
+	_vertexArray.Upload(1, 0, numUvVerts < _numTris * 3 ? numUvVerts : _numTris * 3, uvs.data());
 
-	glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer[0]);
-	glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(GLfloat), verts.data(), GL_STATIC_DRAW);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+	GlUtils::CheckError("GuiModel::InitVertexArray");
 
-	glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer[1]);
-	glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(GLfloat), uvs.data(), GL_STATIC_DRAW);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
-	std::vector<GLfloat> norms;
-	for (auto tri = 0u; tri < _numTris; tri++)
-	{
-		auto v1 = glm::vec3(verts[(tri * 3 + 0) * 3], verts[(tri * 3 + 0) * 3 + 1], verts[(tri * 3 + 0) * 3 + 2]);
-		auto v2 = glm::vec3(verts[(tri * 3 + 1) * 3], verts[(tri * 3 + 1) * 3 + 1], verts[(tri * 3 + 1) * 3 + 2]);
-		auto v3 = glm::vec3(verts[(tri * 3 + 2) * 3], verts[(tri * 3 + 2) * 3 + 1], verts[(tri * 3 + 2) * 3 + 2]);
-
-		auto v12 = glm::normalize(v2 - v1);
-		auto v13 = glm::normalize(v3 - v1);
-		auto norm = glm::vec3(1.0f, 0.0f, 0.0f);
-		if ((glm::length(v12) < 1.1f) && (glm::length(v13) < 1.1f))
-			norm = glm::normalize(glm::cross(v12, v13));
-
-		norms.push_back(norm.x); norms.push_back(norm.y); norms.push_back(norm.z);
-		norms.push_back(norm.x); norms.push_back(norm.y); norms.push_back(norm.z);
-		norms.push_back(norm.x); norms.push_back(norm.y); norms.push_back(norm.z);
-	}
+	return true;
+}
 
-	glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer[2]);
-	glBufferData(GL_ARRAY_BUFFER, norms.size() * sizeof(GLfloat), norms.data(), GL_STATIC_DRAW);
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, 0);
+bool GuiModel::UpdateVertexArray(unsigned int firstTri, unsigned int numTris)
+{
+	_vertexArray.Upload(0, firstTri * 3, numTris * 3, _modelParams.Verts.data() + firstTri * 9);
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	if (_modelParams.Uvs.size() >= (firstTri + numTris) * 6)
+		_vertexArray.Upload(1, firstTri * 3, numTris * 3, _modelParams.Uvs.data() + firstTri * 6);
 
-	GlUtils::CheckError("Image::InitVertexArray");
+	GlUtils::CheckError("GuiModel::UpdateVertexArray");
 
 	return true;
 }
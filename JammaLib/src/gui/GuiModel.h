@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include "GuiElement.h"
 #include "GlUtils.h"
+#include "../graphics/VertexArray.h"
+#include "../utils/RealtimeCheck.h"
 
 namespace gui
 {
@@ -49,24 +52,42 @@ namespace gui
 		virtual void Draw3d(base::DrawContext& ctx) override;
 
 		void SetGeometry(std::vector<float> coords, std::vector<float> uvs);
+		size_t GpuBytes() const;
 
 	protected:
 		virtual void _InitResources(resources::ResourceLib& resourceLib, bool forceInit) override;
 		virtual void _ReleaseResources() override;
 
+		// For models that rebuild part of their geometry, possibly
+		// off the GUI thread, so that only the changed triangles
+		// are uploaded. The geometry is resized to numTris and
+		// verts and uvs are written from firstTri onwards.
+		void WriteGeometry(unsigned int numTris,
+			unsigned int firstTri,
+			const std::vector<float>& verts,
+			const std::vector<float>& uvs);
+		void SetGeometryDirty(unsigned int firstTri, unsigned int numTris);
+		bool UpdateGeometry();
+		// Called once the geometry is up to date, before drawing
+		virtual void SetModelUniforms(graphics::GlDrawContext& ctx);
+
 		bool InitTexture(resources::ResourceLib& resourceLib);
 		bool InitShader(resources::ResourceLib& resourceLib);
-		bool InitVertexArray(std::vector<float> verts, std::vector<float> uvs);
+		bool InitVertexArray(const std::vector<float>& verts, const std::vector<float>& uvs);
+		bool UpdateVertexArray(unsigned int firstTri, unsigned int numTris);
 
 	protected:
 		bool _resourcesInitialised;
-		bool _geometryNeedsUpdating;
+		std::atomic<bool> _geometryNeedsUpdating;
 		GuiModelParams _modelParams;
+		// Guards the back geometry and its dirty range
+		utils::CheckedMutex _geometryMutex;
 		std::vector<float> _backVerts;
 		std::vector<float> _backUvs;
-		GLuint _vertexArray;
-		GLuint _vertexBuffer[3];
+		graphics::VertexArray _vertexArray;
 		unsigned int _numTris;
+		unsigned int _dirtyTriStart;
+		unsigned int _dirtyTriEnd;
 		std::weak_ptr<resources::TextureResource> _modelTexture;
 		std::weak_ptr<resources::ShaderResource> _modelShader;
 	};
@@ -93,7 +93,25 @@ std::optional<InitFile> InitFile::FromStream(std::stringstream ss)
 	return ini;
 }
 
-bool InitFile::ToStream(InitFile jam, std::stringstream ss)
+bool InitFile::ToStream(const InitFile& ini, std::ostream& stream)
 {
-	return false;
+	JsonWriter writer(stream);
+
+	writer.StartObject();
+	writer.KeyValue("jam", utils::EncodeUtf8(ini.Jam));
+	writer.KeyValue("rig", utils::EncodeUtf8(ini.Rig));
+	writer.KeyValue("jamload", (unsigned long)ini.JamLoadType);
+	writer.KeyValue("rigload", (unsigned long)ini.RigLoadType);
+
+	// Stored as left, top, right, bottom
+	writer.Key("win");
+	writer.StartArray();
+	writer.Value((long)ini.WinPos.X);
+	writer.Value((long)ini.WinPos.Y);
+	writer.Value((long)ini.WinPos.X + (long)ini.WinSize.Width);
+	writer.Value((long)ini.WinPos.Y + (long)ini.WinSize.Height);
+	writer.EndArray();
+	writer.EndObject();
+
+	return writer.IsComplete();
 }
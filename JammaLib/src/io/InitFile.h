@@ -15,6 +15,7 @@
 #include <iostream>
 #include <sstream>
 #include "Json.h"
+#include "JsonWriter.h"
 #include "../audio/AudioMixer.h"
 #include "../utils/CommonTypes.h"
 
@@ -23,7 +24,7 @@ namespace io
 	struct InitFile
 	{
 		static std::optional<InitFile> FromStream(std::stringstream ss);
-		static bool ToStream(InitFile jam, std::stringstream ss);
+		static bool ToStream(const InitFile& ini, std::ostream& stream);
 		static const std::string DefaultJson;
 
 		enum LoadType
@@ -87,9 +87,38 @@ std::optional<JamFile> JamFile::FromStream(std::stringstream ss)
 	return jam;
 }
 
-bool JamFile::ToStream(JamFile jam, std::stringstream ss)
+bool JamFile::ToStream(const JamFile& jam, std::ostream& stream)
 {
-	return false;
+	JsonWriter writer(stream);
+
+	writer.StartObject();
+	writer.KeyValue("name", jam.Name);
+	writer.Key("stations");
+	writer.StartArray();
+
+	for (auto& station : jam.Stations)
+		station.ToJson(writer);
+
+	writer.EndArray();
+	writer.KeyValue("timerticks", jam.TimerTicks);
+	writer.KeyValue("quantisesamps", (unsigned long)jam.QuantiseSamps);
+
+	switch (jam.Quantisation)
+	{
+	case engine::Timer::QUANTISE_MULTIPLE:
+		writer.KeyValue("quantisation", "multiple");
+		break;
+	case engine::Timer::QUANTISE_POWER:
+		writer.KeyValue("quantisation", "power");
+		break;
+	default:
+		writer.KeyValue("quantisation", "off");
+		break;
+	}
+
+	writer.EndObject();
+
+	return writer.IsComplete();
 }
 
 std::optional<JamFile::LoopMix> JamFile::LoopMix::FromJson(Json::JsonPart json)
@@ -338,3 +367,71 @@ std::optional<JamFile::Station> JamFile::Station::FromJson(Json::JsonPart json)
 	station.LoopTakes = takes;
 	return station;
 }
+
+void JamFile::LoopMix::ToJson(JsonWriter& writer) const
+{
+	writer.StartObject();
+	writer.KeyValue("type", MIX_WIRE == Mix ? "wire" : "pan");
+	writer.Key("chans");
+	writer.StartArray();
+
+	if (Params.index() == 0)
+	{
+		for (auto chan : std::get<std::vector<unsigned long>>(Params))
+			writer.Value(chan);
+	}
+	else
+	{
+		for (auto level : std::get<std::vector<double>>(Params))
+			writer.Value(level);
+	}
+
+	writer.EndArray();
+	writer.EndObject();
+}
+
+void JamFile::Loop::ToJson(JsonWriter& writer) const
+{
+	writer.StartObject();
+	writer.KeyValue("name", Name);
+	writer.KeyValue("length", Length);
+	writer.KeyValue("index", Index);
+	writer.KeyValue("masterloopcount", MasterLoopCount);
+	writer.KeyValue("level", Level);
+	writer.KeyValue("speed", Speed);
+	writer.KeyValue("mutegroups", (unsigned long)MuteGroups);
+	writer.KeyValue("selectgroups", (unsigned long)SelectGroups);
+	writer.KeyValue("muted", Muted);
+	writer.Key("mix");
+	Mix.ToJson(writer);
+	writer.EndObject();
+}
+
+void JamFile::LoopTake::ToJson(JsonWriter& writer) const
+{
+	writer.StartObject();
+	writer.KeyValue("name", Name);
+	writer.Key("loops");
+	writer.StartArray();
+
+	for (auto& loop : Loops)
+		loop.ToJson(writer);
+
+	writer.EndArray();
+	writer.EndObject();
+}
+
+void JamFile::Station::ToJson(JsonWriter& writer) const
+{
+	writer.StartObject();
+	writer.KeyValue("name", Name);
+	writer.KeyValue("stationtype", (unsigned long)StationType);
+	writer.Key("takes");
+	writer.StartArray();
+
+	for (auto& take : LoopTakes)
+		take.ToJson(writer);
+
+	writer.EndArray();
+	writer.EndObject();
+}
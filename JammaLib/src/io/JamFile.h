@@ -15,6 +15,7 @@
 #include <iostream>
 #include <sstream>
 #include "Json.h"
+#include "JsonWriter.h"
 #include "../engine/Timer.h"
 #include "../audio/AudioMixer.h"
 
@@ -29,7 +30,7 @@ namespace io
 		};
 
 		static std::optional<JamFile> FromStream(std::stringstream ss);
-		static bool ToStream(JamFile jam, std::stringstream ss);
+		static bool ToStream(const JamFile& jam, std::ostream& stream);
 		static const std::string DefaultJson;
 
 		struct LoopMix
@@ -44,6 +45,7 @@ namespace io
 			std::variant<std::vector<unsigned long>,std::vector<double>> Params;
 
 			static std::optional<LoopMix> FromJson(Json::JsonPart json);
+			void ToJson(JsonWriter& writer) const;
 		};
 
 		struct Loop
@@ -60,6 +62,7 @@ namespace io
 			LoopMix Mix;
 
 			static std::optional<Loop> FromJson(Json::JsonPart json);
+			void ToJson(JsonWriter& writer) const;
 		};
 
 		struct LoopTake
@@ -68,6 +71,7 @@ namespace io
 			std::vector<Loop> Loops;
 
 			static std::optional<LoopTake> FromJson(Json::JsonPart json);
+			void ToJson(JsonWriter& writer) const;
 		};
 
 		struct Station
@@ -77,6 +81,7 @@ namespace io
 			std::vector<LoopTake> LoopTakes;
 
 			static std::optional<Station> FromJson(Json::JsonPart json);
+			void ToJson(JsonWriter& writer) const;
 		};
 
 		Version Version;
@@ -6,19 +6,442 @@
 ///////////////////////////////////////////////////////////
 
 #include "Json.h"
+#include "JsonWriter.h"
+#include <cctype>
+#include <charconv>
+#include <type_traits>
 
 using namespace io;
 
+namespace
+{
+	// Recursive descent over the whole text, building each
+	// value in place. Like the stream parser it is forgiving:
+	// unquoted words are strings, and anything left open at
+	// the end of the text is closed off.
+	class JsonReader
+	{
+	public:
+		JsonReader(std::string_view text) :
+			_text(text),
+			_pos(0)
+		{
+		}
+
+	public:
+		std::optional<Json::JsonValue> ReadValue()
+		{
+			if (!SkipSpace())
+				return std::nullopt;
+
+			switch (_text[_pos])
+			{
+			case '{':
+				_pos++;
+				return ReadPart();
+			case '[':
+				_pos++;
+				return ReadArray();
+			case '"':
+				_pos++;
+				return ReadString();
+			}
+
+			return ReadScalar();
+		}
+
+	protected:
+		bool SkipSpace()
+		{
+			while ((_pos < _text.size()) && std::isspace((unsigned char)_text[_pos]))
+				_pos++;
+
+			return _pos < _text.size();
+		}
+
+		// Skips over a separator if there is one,
+		// returning false at the closing bracket
+		bool NextItem(char close)
+		{
+			if (!SkipSpace())
+				return false;
+
+			if (close == _text[_pos])
+			{
+				_pos++;
+				return false;
+			}
+
+			if (',' == _text[_pos])
+				_pos++;
+
+			return SkipSpace();
+		}
+
+		std::optional<Json::JsonValue> ReadItem()
+		{
+			auto start = _pos;
+			auto value = ReadValue();
+
+			// A stray '}' reads as nothing, so step past it
+			if (start == _pos)
+				_pos++;
+
+			return value;
+		}
+
+		Json::JsonPart ReadPart()
+		{
+			Json::JsonPart part;
+
+			while (NextItem('}'))
+			{
+				if ('"' != _text[_pos])
+				{
+					// Not a key, so skip past it
+					_pos++;
+					continue;
+				}
+
+				_pos++;
+				auto key = ReadString();
+
+				if (!SkipSpace() || (':' != _text[_pos]))
+					continue;
+
+				_pos++;
+				auto value = ReadValue();
+
+				if (value.has_value())
+					part.KeyValues.insert_or_assign(std::move(key), std::move(value.value()));
+			}
+
+			return part;
+		}
+
+		Json::JsonArray ReadArray()
+		{
+			Json::JsonArray jsonArray = { 0u, std::vector<bool>() };
+
+			if (SkipSpace() && ('{' == _text[_pos]))
+			{
+				std::vector<Json::JsonPart> parts;
+
+				while (NextItem(']'))
+				{
+					auto value = ReadItem();
+
+					if (value.has_value() && (value.value().index() == 6))
+						parts.push_back(std::move(std::get<Json::JsonPart>(value.value())));
+				}
+
+				jsonArray.Length = (unsigned int)parts.size();
+				jsonArray.Array = std::move(parts);
+
+				return jsonArray;
+			}
+
+			std::vector<Json::JsonValue> values;
+
+			while (NextItem(']'))
+			{
+				auto value = ReadItem();
+
+				// Nested arrays have nowhere to go
+				if (value.has_value() && (value.value().index() < 5))
+					values.push_back(std::move(value.value()));
+			}
+
+			if (values.empty())
+				return jsonArray;
+
+			// The first value picks the type, but numbers widen
+			// to fit the rest (e.g. [0, 0.5] is all doubles)
+			auto type = values[0].index();
+
+			for (auto& value : values)
+			{
+				if (IsNumber(type) && IsNumber(value.index()))
+					type = WiderNumber(type, value.index());
+			}
+
+			jsonArray.Length = (unsigned int)values.size();
+
+			switch (type)
+			{
+			case 0:
+				jsonArray.Array = Convert<bool>(values);
+				break;
+			case 1:
+				jsonArray.Array = Convert<long>(values);
+				break;
+			case 2:
+				jsonArray.Array = Convert<unsigned long>(values);
+				break;
+			case 3:
+				jsonArray.Array = Convert<double>(values);
+				break;
+			default:
+				jsonArray.Array = Convert<std::string>(values);
+				break;
+			}
+
+			return jsonArray;
+		}
+
+		// Indices into JsonValue
+		static bool IsNumber(std::size_t index)
+		{
+			return (index >= 1) && (index <= 3);
+		}
+
+		static std::size_t WiderNumber(std::size_t index1, std::size_t index2)
+		{
+			if ((3 == index1) || (3 == index2))
+				return 3;
+
+			if ((1 == index1) || (1 == index2))
+				return 1;
+
+			return 2;
+		}
+
+		template <typename T>
+		static std::vector<T> Convert(const std::vector<Json::JsonValue>& values)
+		{
+			std::vector<T> vec;
+			vec.reserve(values.size());
+
+			for (auto& value : values)
+			{
+				vec.push_back(std::visit([](auto&& v) -> T {
+					typedef std::decay_t<decltype(v)> V;
+
+					if constexpr (std::is_same_v<T, std::string>)
+					{
+						if constexpr (std::is_same_v<V, std::string>)
+							return v;
+						else
+							return T();
+					}
+					else if constexpr (std::is_same_v<T, bool>)
+					{
+						if constexpr (std::is_same_v<V, bool>)
+							return v;
+						else if constexpr (std::is_same_v<V, std::string>)
+							return Json::IsTrue(v);
+						else
+							return false;
+					}
+					else if constexpr (std::is_arithmetic_v<V> && !std::is_same_v<V, bool>)
+						return (T)v;
+					else
+						return T();
+				}, value));
+			}
+
+			return vec;
+		}
+
+		std::string ReadString()
+		{
+			std::string str;
+			auto start = _pos;
+
+			while (_pos < _text.size())
+			{
+				auto c = _text[_pos];
+
+				if ('"' == c)
+				{
+					str.append(_text.data() + start, _pos - start);
+					_pos++;
+					return str;
+				}
+
+				if (('\\' == c) && (_pos + 1 < _text.size()))
+				{
+					str.append(_text.data() + start, _pos - start);
+					_pos++;
+					ReadEscape(str);
+					start = _pos;
+					continue;
+				}
+
+				_pos++;
+			}
+
+			str.append(_text.data() + start, _pos - start);
+			return str;
+		}
+
+		void ReadEscape(std::string& str)
+		{
+			auto c = _text[_pos++];
+
+			switch (c)
+			{
+			case 'b':
+				str.push_back('\b');
+				break;
+			case 'f':
+				str.push_back('\f');
+				break;
+			case 'n':
+				str.push_back('\n');
+				break;
+			case 'r':
+				str.push_back('\r');
+				break;
+			case 't':
+				str.push_back('\t');
+				break;
+			case 'u':
+				AppendUtf8(str, ReadCodePoint());
+				break;
+			default:
+				str.push_back(c);
+				break;
+			}
+		}
+
+		unsigned int ReadCodePoint()
+		{
+			auto codePoint = ReadHex();
+
+			// Surrogate pairs come as two escapes
+			if ((codePoint >= 0xD800u) && (codePoint < 0xDC00u) &&
+				(_pos + 1 < _text.size()) && ('\\' == _text[_pos]) && ('u' == _text[_pos + 1]))
+			{
+				_pos += 2;
+				auto low = ReadHex();
+				codePoint = 0x10000u + ((codePoint - 0xD800u) << 10) + (low - 0xDC00u);
+			}
+
+			return codePoint;
+		}
+
+		unsigned int ReadHex()
+		{
+			unsigned int value = 0u;
+			auto end = _pos + 4 < _text.size() ? _pos + 4 : _text.size();
+			auto res = std::from_chars(_text.data() + _pos, _text.data() + end, value, 16);
+			_pos = res.ptr - _text.data();
+
+			return value;
+		}
+
+		static void AppendUtf8(std::string& str, unsigned int codePoint)
+		{
+			if (codePoint < 0x80u)
+				str.push_back((char)codePoint);
+			else if (codePoint < 0x800u)
+			{
+				str.push_back((char)(0xC0u | (codePoint >> 6)));
+				str.push_back((char)(0x80u | (codePoint & 0x3Fu)));
+			}
+			else if (codePoint < 0x10000u)
+			{
+				str.push_back((char)(0xE0u | (codePoint >> 12)));
+				str.push_back((char)(0x80u | ((codePoint >> 6) & 0x3Fu)));
+				str.push_back((char)(0x80u | (codePoint & 0x3Fu)));
+			}
+			else
+			{
+				str.push_back((char)(0xF0u | (codePoint >> 18)));
+				str.push_back((char)(0x80u | ((codePoint >> 12) & 0x3Fu)));
+				str.push_back((char)(0x80u | ((codePoint >> 6) & 0x3Fu)));
+				str.push_back((char)(0x80u | (codePoint & 0x3Fu)));
+			}
+		}
+
+		std::optional<Json::JsonValue> ReadScalar()
+		{
+			auto start = _pos;
+
+			while ((_pos < _text.size()) &&
+				(',' != _text[_pos]) &&
+				('}' != _text[_pos]) &&
+				(']' != _text[_pos]) &&
+				!std::isspace((unsigned char)_text[_pos]))
+				_pos++;
+
+			auto token = _text.substr(start, _pos - start);
+
+			if (token.empty())
+				return std::nullopt;
+
+			auto first = token.data();
+			auto last = token.data() + token.size();
+			auto isInteger = token.find_first_of(".eE") == std::string_view::npos;
+
+			if (isInteger && ('-' == token[0]))
+			{
+				long value;
+				auto res = std::from_chars(first, last, value);
+				if ((res.ec == std::errc()) && (res.ptr == last))
+					return value;
+			}
+			else if (isInteger)
+			{
+				unsigned long value;
+				auto res = std::from_chars(first, last, value);
+				if ((res.ec == std::errc()) && (res.ptr == last))
+					return value;
+			}
+
+			double value;
+			auto res = std::from_chars(first, last, value);
+			if ((res.ec == std::errc()) && (res.ptr == last))
+				return value;
+
+			if (IsWord(token, "true"))
+				return true;
+			else if (IsWord(token, "false"))
+				return false;
+
+			return std::string(token);
+		}
+
+		static bool IsWord(std::string_view token, const char* word)
+		{
+			auto len = std::char_traits<char>::length(word);
+
+			if (token.size() != len)
+				return false;
+
+			for (auto i = 0u; i < len; i++)
+			{
+				if (std::tolower((unsigned char)token[i]) != word[i])
+					return false;
+			}
+
+			return true;
+		}
+
+	protected:
+		std::string_view _text;
+		std::size_t _pos;
+	};
+}
+
 std::optional<Json::JsonValue> Json::FromStream(std::stringstream ss)
 {
-	auto root = ParseValue(std::move(ss));
+	return FromString(ss.str());
+}
 
-	return root.Value;
+std::optional<Json::JsonValue> Json::FromString(std::string_view str)
+{
+	JsonReader reader(str);
+	return reader.ReadValue();
 }
 
-bool Json::ToStream(Json::JsonValue json, std::stringstream ss)
+bool Json::ToStream(const Json::JsonValue& json, std::ostream& stream)
 {
-	return false;
+	JsonWriter writer(stream);
+	writer.Value(json);
+
+	return writer.IsComplete();
 }
 
 bool Json::IsAllDigits(std::string str, bool includePeriod)
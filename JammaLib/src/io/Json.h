@@ -14,6 +14,7 @@
 #include <variant>
 #include <iostream>
 #include <sstream>
+#include <string_view>
 
 namespace io
 {
@@ -37,7 +38,10 @@ namespace io
 		};
 
 		static std::optional<JsonValue> FromStream(std::stringstream ss);
-		static bool ToStream(JsonValue json, std::stringstream ss);
+		// Parses in one pass straight from the text, which
+		// only needs to live as long as the call
+		static std::optional<JsonValue> FromString(std::string_view str);
+		static bool ToStream(const JsonValue& json, std::ostream& stream);
 
 		static bool IsAllDigits(std::string str, bool includePeriod);
 		static bool IsTrue(std::string str);
@@ -73,6 +77,8 @@ namespace io
 			std::optional<JsonPart> Part;
 		};
 
+		// The original stream parser, kept as a baseline
+		// for the parser benchmark
 		static KeyResult ParseKey(std::stringstream ss);
 		static ValueResult ParseValue(std::stringstream ss);
 		static PartResult ParseJsonPart(std::stringstream ss);
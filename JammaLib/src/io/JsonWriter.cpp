@@ -0,0 +1,231 @@
+#include "JsonWriter.h"
+#include <charconv>
+#include <cmath>
+#include <type_traits>
+
+using namespace io;
+
+JsonWriter::JsonWriter(std::ostream& stream) :
+	_stream(stream),
+	_isPartStarted(),
+	_isAfterKey(false),
+	_hasRoot(false)
+{
+}
+
+void JsonWriter::StartObject()
+{
+	Separate();
+	_stream.put('{');
+	_isPartStarted.push_back(false);
+}
+
+void JsonWriter::EndObject()
+{
+	if (!_isPartStarted.empty())
+		_isPartStarted.pop_back();
+
+	_stream.put('}');
+}
+
+void JsonWriter::StartArray()
+{
+	Separate();
+	_stream.put('[');
+	_isPartStarted.push_back(false);
+}
+
+void JsonWriter::EndArray()
+{
+	if (!_isPartStarted.empty())
+		_isPartStarted.pop_back();
+
+	_stream.put(']');
+}
+
+void JsonWriter::Key(std::string_view key)
+{
+	Separate();
+	WriteString(key);
+	_stream.put(':');
+	_isAfterKey = true;
+}
+
+void JsonWriter::Value(bool value)
+{
+	Separate();
+	_stream << (value ? "true" : "false");
+}
+
+void JsonWriter::Value(long value)
+{
+	Separate();
+	_stream << value;
+}
+
+void JsonWriter::Value(unsigned long value)
+{
+	Separate();
+	_stream << value;
+}
+
+void JsonWriter::Value(double value)
+{
+	Separate();
+
+	// Json has no nan or infinity
+	if (!std::isfinite(value))
+	{
+		_stream << "0.0";
+		return;
+	}
+
+	char buf[32];
+	auto [end, err] = std::to_chars(buf, buf + sizeof(buf), value);
+	std::string_view str(buf, end - buf);
+
+	_stream << str;
+
+	// Whole numbers keep a point so they read back as doubles
+	if (std::string_view::npos == str.find_first_of(".e"))
+		_stream << ".0";
+}
+
+void JsonWriter::Value(std::string_view value)
+{
+	Separate();
+	WriteString(value);
+}
+
+void JsonWriter::Value(const char* value)
+{
+	Value(std::string_view(value));
+}
+
+void JsonWriter::Value(const std::string& value)
+{
+	Value(std::string_view(value));
+}
+
+void JsonWriter::Value(const Json::JsonValue& value)
+{
+	switch (value.index())
+	{
+	case 0:
+		Value(std::get<bool>(value));
+		break;
+	case 1:
+		Value(std::get<long>(value));
+		break;
+	case 2:
+		Value(std::get<unsigned long>(value));
+		break;
+	case 3:
+		Value(std::get<double>(value));
+		break;
+	case 4:
+		Value(std::get<std::string>(value));
+		break;
+	case 5:
+		WriteArray(std::get<Json::JsonArray>(value));
+		break;
+	case 6:
+		WriteObject(std::get<Json::JsonPart>(value));
+		break;
+	}
+}
+
+bool JsonWriter::IsComplete() const
+{
+	return _hasRoot && _isPartStarted.empty() && !_isAfterKey && _stream.good();
+}
+
+void JsonWriter::Separate()
+{
+	if (_isAfterKey)
+	{
+		_isAfterKey = false;
+		return;
+	}
+
+	if (_isPartStarted.empty())
+	{
+		_hasRoot = true;
+		return;
+	}
+
+	if (_isPartStarted.back())
+		_stream.put(',');
+
+	_isPartStarted.back() = true;
+}
+
+void JsonWriter::WriteString(std::string_view str)
+{
+	static const char* Hex = "0123456789abcdef";
+
+	_stream.put('"');
+
+	for (auto ch : str)
+	{
+		switch (ch)
+		{
+		case '"':
+			_stream << "\\\"";
+			break;
+		case '\\':
+			_stream << "\\\\";
+			break;
+		case '\n':
+			_stream << "\\n";
+			break;
+		case '\r':
+			_stream << "\\r";
+			break;
+		case '\t':
+			_stream << "\\t";
+			break;
+		default:
+			if ((unsigned char)ch < 0x20)
+				_stream << "\\u00" << Hex[(ch >> 4) & 0xF] << Hex[ch & 0xF];
+			else
+				_stream.put(ch);
+		}
+	}
+
+	_stream.put('"');
+}
+
+void JsonWriter::WriteArray(const Json::JsonArray& arr)
+{
+	StartArray();
+
+	std::visit([this](const auto& values) {
+		for (const auto& value : values)
+		{
+			typedef std::decay_t<decltype(value)> ValueType;
+
+			if constexpr (std::is_same_v<ValueType, Json::JsonPart>)
+				WriteObject(value);
+			else if constexpr (std::is_same_v<ValueType, std::string>)
+				Value(value);
+			else
+				Value((ValueType)value);
+		}
+	}, arr.Array);
+
+	EndArray();
+}
+
+void JsonWriter::WriteObject(const Json::JsonPart& part)
+{
+	StartObject();
+
+	for (auto& [key, value] : part.KeyValues)
+	{
+		Key(key);
+		Value(value);
+	}
+
+	EndObject();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Json.h"
+
+namespace io
+{
+	// Writes json straight to a stream as it is built, with no
+	// tree in between. Commas and key separators are added as
+	// needed, so callers just open, fill and close each part.
+	class JsonWriter
+	{
+	public:
+		JsonWriter(std::ostream& stream);
+
+		// Copy
+		JsonWriter(const JsonWriter&) = delete;
+		JsonWriter& operator=(const JsonWriter&) = delete;
+
+	public:
+		void StartObject();
+		void EndObject();
+		void StartArray();
+		void EndArray();
+		void Key(std::string_view key);
+
+		void Value(bool value);
+		void Value(long value);
+		void Value(unsigned long value);
+		void Value(double value);
+		void Value(std::string_view value);
+		void Value(const char* value);
+		void Value(const std::string& value);
+		void Value(const Json::JsonValue& value);
+
+		template <typename T>
+		void KeyValue(std::string_view key, const T& value)
+		{
+			Key(key);
+			Value(value);
+		}
+
+		// True once every part opened has been closed
+		// and the stream took it all
+		bool IsComplete() const;
+
+	protected:
+		void Separate();
+		void WriteString(std::string_view str);
+		void WriteArray(const Json::JsonArray& arr);
+		void WriteObject(const Json::JsonPart& part);
+
+	protected:
+		std::ostream& _stream;
+		// Whether each open part has had a value yet
+		std::vector<bool> _isPartStarted;
+		bool _isAfterKey;
+		bool _hasRoot;
+	};
+}
@@ -0,0 +1,135 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <filesystem>
+#endif
+
+using namespace io;
+
+MappedFile::MappedFile() :
+#ifdef _WIN32
+	_file(INVALID_HANDLE_VALUE),
+	_mapping(NULL),
+#else
+	_file(-1),
+#endif
+	_data(nullptr),
+	_size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+std::optional<std::shared_ptr<MappedFile>> MappedFile::Open(const std::wstring& fileName)
+{
+	auto file = std::make_shared<MappedFile>();
+
+	if (!file->_Open(fileName))
+		return std::nullopt;
+
+	return file;
+}
+
+const char* MappedFile::Data() const
+{
+	return _data;
+}
+
+std::size_t MappedFile::Size() const
+{
+	return _size;
+}
+
+bool MappedFile::_Open(const std::wstring& fileName)
+{
+#ifdef _WIN32
+	_file = CreateFileW(fileName.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		NULL);
+
+	if (INVALID_HANDLE_VALUE == _file)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(_file, &size) || (0 == size.QuadPart))
+	{
+		Close();
+		return false;
+	}
+
+	_mapping = CreateFileMappingW(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (NULL == _mapping)
+	{
+		Close();
+		return false;
+	}
+
+	_data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	_size = (std::size_t)size.QuadPart;
+#else
+	_file = open(std::filesystem::path(fileName).c_str(), O_RDONLY);
+
+	if (_file < 0)
+		return false;
+
+	struct stat info;
+	if ((fstat(_file, &info) != 0) || (0 == info.st_size))
+	{
+		Close();
+		return false;
+	}
+
+	auto data = mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_PRIVATE, _file, 0);
+	_data = MAP_FAILED == data ? nullptr : static_cast<const char*>(data);
+	_size = (std::size_t)info.st_size;
+#endif
+
+	if (nullptr == _data)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (nullptr != _data)
+		UnmapViewOfFile(_data);
+
+	if (NULL != _mapping)
+		CloseHandle(_mapping);
+
+	if (INVALID_HANDLE_VALUE != _file)
+		CloseHandle(_file);
+
+	_mapping = NULL;
+	_file = INVALID_HANDLE_VALUE;
+#else
+	if (nullptr != _data)
+		munmap(const_cast<char*>(_data), _size);
+
+	if (_file >= 0)
+		close(_file);
+
+	_file = -1;
+#endif
+
+	_data = nullptr;
+	_size = 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <optional>
+#include <cstddef>
+
+namespace io
+{
+	// A read-only view of a whole file, mapped into memory.
+	// The view stays valid for as long as the object lives.
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		// Copy
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+	public:
+		static std::optional<std::shared_ptr<MappedFile>> Open(const std::wstring& fileName);
+
+		const char* Data() const;
+		std::size_t Size() const;
+
+	protected:
+		bool _Open(const std::wstring& fileName);
+		void Close();
+
+	protected:
+#ifdef _WIN32
+		// HANDLEs, kept as void* so windows.h stays out of the header
+		void* _file;
+		void* _mapping;
+#else
+		int _file;
+#endif
+		const char* _data;
+		std::size_t _size;
+	};
+}
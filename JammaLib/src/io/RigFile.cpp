@@ -76,9 +76,24 @@ std::optional<RigFile> RigFile::FromStream(std::stringstream ss)
 	return rig;
 }
 
-bool RigFile::ToStream(RigFile rig, std::stringstream ss)
+bool RigFile::ToStream(const RigFile& rig, std::ostream& stream)
 {
-	return false;
+	JsonWriter writer(stream);
+
+	writer.StartObject();
+	writer.KeyValue("name", rig.Name);
+	writer.Key("user");
+	rig.User.ToJson(writer);
+	writer.Key("triggers");
+	writer.StartArray();
+
+	for (auto& trigger : rig.Triggers)
+		trigger.ToJson(writer);
+
+	writer.EndArray();
+	writer.EndObject();
+
+	return writer.IsComplete();
 }
 
 std::optional<RigFile::TriggerPair> RigFile::TriggerPair::FromJson(Json::JsonPart json)
@@ -200,3 +215,35 @@ std::optional<RigFile::Trigger> RigFile::Trigger::FromJson(Json::JsonPart json)
 	trigger.InputChannels = inputChannels;
 	return trigger;
 }
+
+void RigFile::TriggerPair::ToJson(JsonWriter& writer) const
+{
+	writer.StartObject();
+	writer.KeyValue("activatedown", (unsigned long)ActivateDown);
+	writer.KeyValue("activateup", (unsigned long)ActivateUp);
+	writer.KeyValue("ditchdown", (unsigned long)DitchDown);
+	writer.KeyValue("ditchup", (unsigned long)DitchUp);
+	writer.EndObject();
+}
+
+void RigFile::Trigger::ToJson(JsonWriter& writer) const
+{
+	writer.StartObject();
+	writer.KeyValue("name", Name);
+	writer.KeyValue("stationtype", (unsigned long)StationType);
+	writer.Key("pairs");
+	writer.StartArray();
+
+	for (auto& pair : TriggerPairs)
+		pair.ToJson(writer);
+
+	writer.EndArray();
+	writer.Key("input");
+	writer.StartArray();
+
+	for (auto chan : InputChannels)
+		writer.Value((unsigned long)chan);
+
+	writer.EndArray();
+	writer.EndObject();
+}
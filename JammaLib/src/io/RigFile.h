@@ -28,7 +28,7 @@ namespace io
 		};
 
 		static std::optional<RigFile> FromStream(std::stringstream ss);
-		static bool ToStream(RigFile jam, std::stringstream ss);
+		static bool ToStream(const RigFile& rig, std::ostream& stream);
 		static const std::string DefaultJson;
 
 
@@ -40,6 +40,7 @@ namespace io
 			unsigned int DitchUp;
 
 			static std::optional<TriggerPair> FromJson(Json::JsonPart json);
+			void ToJson(JsonWriter& writer) const;
 		};
 
 		struct Trigger
@@ -50,6 +51,7 @@ namespace io
 			std::vector<unsigned int> InputChannels;
 
 			static std::optional<Trigger> FromJson(Json::JsonPart json);
+			void ToJson(JsonWriter& writer) const;
 		};
 
 		Version Version;
@@ -0,0 +1,434 @@
+#include "SessionFile.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include "WavReadWriter.h"
+#include "WavStreamWriter.h"
+#include "../include/Constants.h"
+#include "../utils/StringUtils.h"
+
+using namespace io;
+
+namespace
+{
+	const char Magic[4] = { 'J', 'M', 'S', 'N' };
+
+	std::uint64_t ReadUint(const char* data, unsigned int numBytes)
+	{
+		std::uint64_t value = 0;
+
+		for (auto i = 0u; i < numBytes; i++)
+			value |= (std::uint64_t)(unsigned char)data[i] << (8 * i);
+
+		return value;
+	}
+
+	unsigned int CountLoops(const JamFile& jam)
+	{
+		auto numLoops = 0u;
+
+		for (auto& station : jam.Stations)
+		{
+			for (auto& take : station.LoopTakes)
+				numLoops += (unsigned int)take.Loops.size();
+		}
+
+		return numLoops;
+	}
+
+	bool MoveIntoPlace(const std::filesystem::path& tempPath, const std::filesystem::path& path)
+	{
+		std::error_code err;
+		std::filesystem::rename(tempPath, path, err);
+
+		if (!err)
+			return true;
+
+		std::filesystem::remove(tempPath, err);
+		return false;
+	}
+}
+
+const std::wstring SessionFile::Extension = L".jamsession";
+
+SessionFile::SessionFile() :
+	_file(),
+	_version(0u),
+	_sampleRate(0u),
+	_jam(),
+	_loops()
+{
+}
+
+SessionFile::~SessionFile()
+{
+}
+
+std::optional<std::shared_ptr<SessionFile>> SessionFile::Open(const std::wstring& fileName)
+{
+	auto file = MappedFile::Open(fileName);
+
+	if (!file.has_value())
+		return std::nullopt;
+
+	auto session = std::make_shared<SessionFile>();
+	session->_file = file.value();
+
+	if (!session->ParseHeader())
+	{
+		std::cout << "Unsupported session file\n";
+		return std::nullopt;
+	}
+
+	return session;
+}
+
+bool SessionFile::IsSessionFile(const std::wstring& fileName)
+{
+	return std::filesystem::path(fileName).extension() == Extension;
+}
+
+bool SessionFile::FromJam(const std::wstring& jamFile, const std::wstring& sessionFile)
+{
+	std::filesystem::path jamPath(jamFile);
+	std::ifstream jamStream(jamPath);
+
+	if (!jamStream.is_open())
+		return false;
+
+	std::stringstream ss;
+	ss << jamStream.rdbuf();
+	auto jam = JamFile::FromStream(std::move(ss));
+
+	if (!jam.has_value())
+		return false;
+
+	WavReadWriter readWriter;
+	std::vector<MappedWav> wavs;
+
+	for (auto& station : jam.value().Stations)
+	{
+		for (auto& take : station.LoopTakes)
+		{
+			for (auto& loop : take.Loops)
+			{
+				auto wav = readWriter.Map((jamPath.parent_path() / utils::DecodeUtf8(loop.Name)).wstring());
+
+				if (!wav.has_value())
+					return false;
+
+				wavs.push_back(wav.value());
+			}
+		}
+	}
+
+	auto sampleRate = wavs.empty() ? constants::DefaultSampleRate : wavs[0].Format.SampleRate;
+
+	std::filesystem::path sessionPath(sessionFile);
+	auto tempPath = sessionPath;
+	tempPath += L".tmp";
+
+	SessionWriter writer;
+	auto isWritten = writer.Open(tempPath.wstring(), jam.value(), sampleRate);
+
+	// Converted a block at a time, straight from each mapped wav
+	std::vector<float> buffer(constants::MaxBlockSize);
+
+	for (auto& wav : wavs)
+	{
+		if (!isWritten)
+			break;
+
+		isWritten = writer.BeginLoop();
+
+		auto bytesPerFrame = wav.Format.BytesPerFrame();
+		auto index = 0ul;
+
+		while (isWritten && (index < wav.Format.NumFrames))
+		{
+			auto numSamps = (unsigned int)std::min((unsigned long)buffer.size(), wav.Format.NumFrames - index);
+			WavReadWriter::Convert(wav.Format, wav.Frames() + index * bytesPerFrame, buffer.data(), numSamps);
+			isWritten = writer.Write(buffer.data(), numSamps);
+			index += numSamps;
+		}
+	}
+
+	isWritten = writer.Close() && isWritten;
+
+	if (!isWritten)
+	{
+		std::error_code err;
+		std::filesystem::remove(tempPath, err);
+		return false;
+	}
+
+	return MoveIntoPlace(tempPath, sessionPath);
+}
+
+bool SessionFile::ToJam(const std::wstring& sessionFile, const std::wstring& jamFile)
+{
+	auto session = Open(sessionFile);
+
+	if (!session.has_value())
+		return false;
+
+	std::filesystem::path jamPath(jamFile);
+	auto& jam = session.value()->Jam();
+
+	if (jamPath.has_parent_path())
+	{
+		std::error_code err;
+		std::filesystem::create_directories(jamPath.parent_path(), err);
+	}
+
+	auto loopIndex = 0u;
+
+	for (auto& station : jam.Stations)
+	{
+		for (auto& take : station.LoopTakes)
+		{
+			for (auto& loop : take.Loops)
+			{
+				auto [samps, numSamps] = session.value()->LoopSamps(loopIndex++);
+				auto wavPath = jamPath.parent_path() / utils::DecodeUtf8(loop.Name);
+
+				WavStreamWriter writer;
+
+				if (!writer.Open(wavPath.wstring(), 1u, session.value()->SampleRate()))
+					return false;
+
+				auto isWritten = writer.Write(samps, (unsigned int)numSamps);
+
+				if (!writer.Close() || !isWritten)
+					return false;
+			}
+		}
+	}
+
+	auto tempPath = jamPath;
+	tempPath += L".tmp";
+
+	auto isSaved = false;
+
+	{
+		std::ofstream stream(tempPath, std::ios::trunc);
+
+		if (stream.is_open())
+		{
+			isSaved = JamFile::ToStream(jam, stream);
+			stream.close();
+			isSaved = isSaved && !stream.fail();
+		}
+	}
+
+	return isSaved && MoveIntoPlace(tempPath, jamPath);
+}
+
+unsigned int SessionFile::Version() const
+{
+	return _version;
+}
+
+unsigned int SessionFile::SampleRate() const
+{
+	return _sampleRate;
+}
+
+const JamFile& SessionFile::Jam() const
+{
+	return _jam;
+}
+
+unsigned int SessionFile::NumLoops() const
+{
+	return (unsigned int)_loops.size();
+}
+
+std::tuple<const float*, unsigned long> SessionFile::LoopSamps(unsigned int loopIndex) const
+{
+	if (loopIndex >= _loops.size())
+		return std::make_tuple(nullptr, 0ul);
+
+	auto& entry = _loops[loopIndex];
+	auto samps = reinterpret_cast<const float*>(_file->Data() + entry.Offset);
+
+	return std::make_tuple(samps, (unsigned long)entry.NumSamps);
+}
+
+bool SessionFile::ParseHeader()
+{
+	auto data = _file->Data();
+	auto size = (std::uint64_t)_file->Size();
+
+	if ((size < HeaderSize) || (0 != std::memcmp(data, Magic, sizeof(Magic))))
+		return false;
+
+	_version = (unsigned int)ReadUint(data + 4, 4);
+
+	// Older versions must stay readable, newer ones are refused
+	if ((_version < 1u) || (_version > CurrentVersion))
+		return false;
+
+	auto pageSize = ReadUint(data + 8, 4);
+	auto numLoops = ReadUint(data + 12, 4);
+	_sampleRate = (unsigned int)ReadUint(data + 16, 4);
+	auto jamBytes = ReadUint(data + 24, 8);
+
+	// Each block must start on a page of the mapping
+	if ((pageSize < sizeof(float)) || (0 != (pageSize & (pageSize - 1))))
+		return false;
+
+	auto jamOffset = HeaderSize + numLoops * LoopEntrySize;
+
+	if ((jamOffset > size) || (jamBytes > size - jamOffset))
+		return false;
+
+	auto jam = JamFile::FromStream(std::stringstream(std::string(data + jamOffset, (std::size_t)jamBytes)));
+
+	if (!jam.has_value() || (CountLoops(jam.value()) != numLoops))
+		return false;
+
+	auto samplesOffset = jamOffset + jamBytes;
+
+	_loops.clear();
+	_loops.reserve((std::size_t)numLoops);
+
+	for (auto loop = 0u; loop < numLoops; loop++)
+	{
+		auto entry = data + HeaderSize + loop * LoopEntrySize;
+		auto offset = ReadUint(entry, 8);
+		auto numSamps = ReadUint(entry + 8, 8);
+
+		if ((offset < samplesOffset) ||
+			(offset > size) ||
+			(0 != (offset & (pageSize - 1))) ||
+			(numSamps > (size - offset) / sizeof(float)))
+			return false;
+
+		_loops.push_back({ offset, numSamps });
+	}
+
+	_jam = jam.value();
+
+	return true;
+}
+
+SessionWriter::SessionWriter() :
+	_stream(),
+	_loops(),
+	_numLoopsBegun(0u)
+{
+}
+
+SessionWriter::~SessionWriter()
+{
+	Close();
+}
+
+bool SessionWriter::Open(const std::wstring& fileName,
+	const JamFile& jam,
+	unsigned int sampleRate)
+{
+	Close();
+
+	std::ostringstream jamStream;
+
+	if (!JamFile::ToStream(jam, jamStream))
+		return false;
+
+	auto jamJson = jamStream.str();
+
+	auto path = std::filesystem::path(fileName);
+	if (path.has_parent_path())
+	{
+		std::error_code err;
+		std::filesystem::create_directories(path.parent_path(), err);
+	}
+
+	_stream.open(path, std::ios::binary | std::ios::trunc);
+
+	if (!_stream.is_open())
+		return false;
+
+	_loops = std::vector<SessionFile::LoopEntry>(CountLoops(jam), { 0u, 0u });
+	_numLoopsBegun = 0u;
+
+	_stream.write(Magic, sizeof(Magic));
+	WriteUint(SessionFile::CurrentVersion, 4);
+	WriteUint(PageSize, 4);
+	WriteUint(_loops.size(), 4);
+	WriteUint(sampleRate, 4);
+	WriteUint(0u, 4);
+	WriteUint(jamJson.size(), 8);
+
+	// Placeholder until the samples are written
+	for (auto i = 0u; i < _loops.size(); i++)
+	{
+		WriteUint(0u, 8);
+		WriteUint(0u, 8);
+	}
+
+	_stream.write(jamJson.data(), (std::streamsize)jamJson.size());
+
+	return _stream.good();
+}
+
+bool SessionWriter::BeginLoop()
+{
+	if (!_stream.is_open() || (_numLoopsBegun >= _loops.size()))
+		return false;
+
+	auto offset = (std::uint64_t)_stream.tellp();
+	auto padding = (PageSize - (offset % PageSize)) % PageSize;
+
+	for (auto i = 0u; i < padding; i++)
+		_stream.put(0);
+
+	_loops[_numLoopsBegun] = { offset + padding, 0u };
+	_numLoopsBegun++;
+
+	return _stream.good();
+}
+
+bool SessionWriter::Write(const float* samps, unsigned int numSamps)
+{
+	if (!_stream.is_open() || (0u == _numLoopsBegun))
+		return false;
+
+	// Samples are written as-is, so assumes a little-endian host
+	_stream.write(reinterpret_cast<const char*>(samps), (std::streamsize)numSamps * sizeof(float));
+	_loops[_numLoopsBegun - 1].NumSamps += numSamps;
+
+	return _stream.good();
+}
+
+bool SessionWriter::Close()
+{
+	if (!_stream.is_open())
+		return false;
+
+	_stream.seekp(SessionFile::HeaderSize);
+
+	for (auto& loop : _loops)
+	{
+		WriteUint(loop.Offset, 8);
+		WriteUint(loop.NumSamps, 8);
+	}
+
+	auto isGood = _stream.good() && (_numLoopsBegun == _loops.size());
+	_stream.close();
+
+	return isGood;
+}
+
+bool SessionWriter::IsOpen() const
+{
+	return _stream.is_open();
+}
+
+void SessionWriter::WriteUint(std::uint64_t value, unsigned int numBytes)
+{
+	for (auto i = 0u; i < numBytes; i++)
+		_stream.put((char)((value >> (8 * i)) & 0xFF));
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include "JamFile.h"
+#include "MappedFile.h"
+
+namespace io
+{
+	// A whole jam in a single file, laid out so the samples can
+	// be played straight from a mapping of it:
+	//
+	//   header     "JMSN", version, page size, num loops,
+	//              sample rate, jam bytes (little-endian)
+	//   loop table offset and num samps of each loop
+	//   jam        the jam's json, for the station, take and
+	//              loop tree with mix and quantisation
+	//   samples    each loop's mono 32-bit floats, starting
+	//              on a page boundary
+	//
+	// Loops are listed in station, take then loop order.
+	class SessionFile
+	{
+		friend class SessionWriter;
+
+	public:
+		SessionFile();
+		~SessionFile();
+
+		// Copy
+		SessionFile(const SessionFile&) = delete;
+		SessionFile& operator=(const SessionFile&) = delete;
+
+	public:
+		static std::optional<std::shared_ptr<SessionFile>> Open(const std::wstring& fileName);
+		static bool IsSessionFile(const std::wstring& fileName);
+
+		// Convert to and from a jam file with its wavs alongside
+		static bool FromJam(const std::wstring& jamFile, const std::wstring& sessionFile);
+		static bool ToJam(const std::wstring& sessionFile, const std::wstring& jamFile);
+
+		unsigned int Version() const;
+		unsigned int SampleRate() const;
+		const JamFile& Jam() const;
+		unsigned int NumLoops() const;
+		// Samples of a loop in place, or null if out of range
+		std::tuple<const float*, unsigned long> LoopSamps(unsigned int loopIndex) const;
+
+		static const std::wstring Extension;
+		static const unsigned int CurrentVersion = 1u;
+		static const unsigned int HeaderSize = 32u;
+		static const unsigned int LoopEntrySize = 16u;
+
+	protected:
+		bool ParseHeader();
+
+	protected:
+		struct LoopEntry
+		{
+			std::uint64_t Offset;
+			std::uint64_t NumSamps;
+		};
+
+		std::shared_ptr<MappedFile> _file;
+		unsigned int _version;
+		unsigned int _sampleRate;
+		JamFile _jam;
+		std::vector<LoopEntry> _loops;
+	};
+
+	// Writes a session in one pass. The jam goes first, then
+	// the samples of each of its loops in turn, with the loop
+	// table patched in on Close.
+	class SessionWriter
+	{
+	public:
+		SessionWriter();
+		~SessionWriter();
+
+		// Copy
+		SessionWriter(const SessionWriter&) = delete;
+		SessionWriter& operator=(const SessionWriter&) = delete;
+
+	public:
+		bool Open(const std::wstring& fileName,
+			const JamFile& jam,
+			unsigned int sampleRate);
+		// Starts the next loop's samples on a page boundary
+		bool BeginLoop();
+		bool Write(const float* samps, unsigned int numSamps);
+		// Fails if any of the jam's loops were not written
+		bool Close();
+		bool IsOpen() const;
+
+		static const unsigned int PageSize = 4096u;
+
+	protected:
+		void WriteUint(std::uint64_t value, unsigned int numBytes);
+
+	protected:
+		std::ofstream _stream;
+		std::vector<SessionFile::LoopEntry> _loops;
+		unsigned int _numLoopsBegun;
+	};
+}
@@ -33,6 +33,9 @@ std::optional<UserConfig> UserConfig::FromJson(Json::JsonPart json)
 	if (!gotAudio)
 		return std::nullopt;
 
+	cfg.Loop.Storage = audio::BufferBank::STORAGE_FLOAT;
+	cfg.Loop.MemoryBudgetMb = 0;
+
 	iter = json.KeyValues.find("loop");
 	if (iter != json.KeyValues.end())
 	{
@@ -59,6 +62,21 @@ std::optional<UserConfig> UserConfig::FromJson(Json::JsonPart json)
 		}
 	}
 
+	cfg.Jobs.NumWorkers = 2;
+
+	iter = json.KeyValues.find("jobs");
+	if (iter != json.KeyValues.end())
+	{
+		if (json.KeyValues["jobs"].index() == 6)
+		{
+			auto jobsJson = std::get<Json::JsonPart>(json.KeyValues["jobs"]);
+			auto jobsOpt = JobSettings::FromJson(jobsJson);
+
+			if (jobsOpt.has_value())
+				cfg.Jobs = jobsOpt.value();
+		}
+	}
+
 	return cfg;
 }
 
@@ -69,6 +87,7 @@ std::optional<UserConfig::AudioSettings> UserConfig::AudioSettings::FromJson(Jso
 	unsigned int latency = 0;
 	unsigned int numChannelsIn = 0;
 	unsigned int numChannelsOut = 0;
+	unsigned int numWorkers = 0;
 
 	auto iter = json.KeyValues.find("name");
 	if (iter != json.KeyValues.end())
@@ -111,12 +130,20 @@ std::optional<UserConfig::AudioSettings> UserConfig::AudioSettings::FromJson(Jso
 			latency = std::get<unsigned long>(json.KeyValues["latency"]);
 	}
 
+	iter = json.KeyValues.find("numworkers");
+	if (iter != json.KeyValues.end())
+	{
+		if (json.KeyValues["numworkers"].index() == 2)
+			numWorkers = std::get<unsigned long>(json.KeyValues["numworkers"]);
+	}
+
 	AudioSettings audio;
 	audio.Name = name;
 	audio.BufSize = bufSize;
 	audio.Latency = latency;
 	audio.NumChannelsIn = numChannelsIn;
 	audio.NumChannelsOut = numChannelsOut;
+	audio.NumWorkers = numWorkers;
 	return audio;
 }
 
@@ -131,8 +158,35 @@ std::optional<UserConfig::LoopSettings> UserConfig::LoopSettings::FromJson(Json:
 			fadeSamps = std::get<unsigned long>(json.KeyValues["fadeSamps"]);
 	}
 
+	auto storage = audio::BufferBank::STORAGE_FLOAT;
+
+	iter = json.KeyValues.find("storage");
+	if (iter != json.KeyValues.end())
+	{
+		if (json.KeyValues["storage"].index() == 4)
+		{
+			auto storageName = std::get<std::string>(json.KeyValues["storage"]);
+
+			if ("int16" == storageName)
+				storage = audio::BufferBank::STORAGE_INT16;
+			else if ("float16" == storageName)
+				storage = audio::BufferBank::STORAGE_FLOAT16;
+		}
+	}
+
+	unsigned int memoryBudgetMb = 0;
+
+	iter = json.KeyValues.find("memoryBudgetMb");
+	if (iter != json.KeyValues.end())
+	{
+		if (json.KeyValues["memoryBudgetMb"].index() == 2)
+			memoryBudgetMb = std::get<unsigned long>(json.KeyValues["memoryBudgetMb"]);
+	}
+
 	LoopSettings loop;
 	loop.FadeSamps = fadeSamps;
+	loop.Storage = storage;
+	loop.MemoryBudgetMb = memoryBudgetMb;
 	return loop;
 }
 
@@ -160,3 +214,86 @@ std::optional<UserConfig::TriggerSettings> UserConfig::TriggerSettings::FromJson
 	trig.DebounceSamps = debounceSamps;
 	return trig;
 }
+
+std::optional<UserConfig::JobSettings> UserConfig::JobSettings::FromJson(Json::JsonPart json)
+{
+	unsigned int numWorkers = 2;
+
+	auto iter = json.KeyValues.find("numworkers");
+	if (iter != json.KeyValues.end())
+	{
+		if (json.KeyValues["numworkers"].index() == 2)
+			numWorkers = std::get<unsigned long>(json.KeyValues["numworkers"]);
+	}
+
+	if (0 == numWorkers)
+		return std::nullopt;
+
+	JobSettings jobs;
+	jobs.NumWorkers = numWorkers;
+	return jobs;
+}
+
+void UserConfig::ToJson(JsonWriter& writer) const
+{
+	writer.StartObject();
+	writer.Key("audio");
+	Audio.ToJson(writer);
+	writer.Key("loop");
+	Loop.ToJson(writer);
+	writer.Key("trigger");
+	Trigger.ToJson(writer);
+	writer.Key("jobs");
+	Jobs.ToJson(writer);
+	writer.EndObject();
+}
+
+void UserConfig::AudioSettings::ToJson(JsonWriter& writer) const
+{
+	writer.StartObject();
+	writer.KeyValue("name", Name);
+	writer.KeyValue("bufsize", (unsigned long)BufSize);
+	writer.KeyValue("latency", (unsigned long)Latency);
+	writer.KeyValue("numchannelsin", (unsigned long)NumChannelsIn);
+	writer.KeyValue("numchannelsout", (unsigned long)NumChannelsOut);
+	writer.KeyValue("numworkers", (unsigned long)NumWorkers);
+	writer.EndObject();
+}
+
+void UserConfig::LoopSettings::ToJson(JsonWriter& writer) const
+{
+	writer.StartObject();
+	writer.KeyValue("fadeSamps", (unsigned long)FadeSamps);
+
+	switch (Storage)
+	{
+	case audio::BufferBank::STORAGE_INT16:
+		writer.KeyValue("storage", "int16");
+		break;
+	case audio::BufferBank::STORAGE_FLOAT16:
+		writer.KeyValue("storage", "float16");
+		break;
+	default:
+		writer.KeyValue("storage", "float");
+		break;
+	}
+
+	writer.KeyValue("memoryBudgetMb", (unsigned long)MemoryBudgetMb);
+
+	writer.EndObject();
+}
+
+void UserConfig::TriggerSettings::ToJson(JsonWriter& writer) const
+{
+	writer.StartObject();
+	writer.KeyValue("preDelay", (unsigned long)PreDelay);
+	writer.KeyValue("debounceSamps", (unsigned long)DebounceSamps);
+	writer.EndObject();
+}
+
+void UserConfig::JobSettings::ToJson(JsonWriter& writer) const
+{
+	writer.StartObject();
+	writer.KeyValue("numworkers", (unsigned long)NumWorkers);
+	writer.EndObject();
+}
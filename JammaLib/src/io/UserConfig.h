@@ -15,7 +15,9 @@
 #include <iostream>
 #include <sstream>
 #include "Json.h"
+#include "JsonWriter.h"
 #include "../include/Constants.h"
+#include "../audio/BufferBank.h"
 #include "../utils/MathUtils.h"
 
 namespace io
@@ -23,6 +25,7 @@ namespace io
 	struct UserConfig
 	{
 		static std::optional<UserConfig> FromJson(Json::JsonPart json);
+		void ToJson(JsonWriter& writer) const;
 
 		struct AudioSettings
 		{
@@ -31,15 +34,20 @@ namespace io
 			unsigned int Latency; // he overall rountrip IO latency, in samples
 			unsigned int NumChannelsIn; // The number of input channels used in current scene
 			unsigned int NumChannelsOut; // The number of output channels used in current scene
+			unsigned int NumWorkers; // Extra threads to process stations on (zero processes them all on the audio thread)
 
 			static std::optional<AudioSettings> FromJson(Json::JsonPart json);
+			void ToJson(JsonWriter& writer) const;
 		};
 
 		struct LoopSettings
 		{
 			unsigned int FadeSamps; // The number of samples to fade in/out the start/end of a loop
+			audio::BufferBank::StorageMode Storage; // How recorded loops hold their samples ("float", "int16" or "float16")
+			unsigned int MemoryBudgetMb; // Idle loops are compressed beyond this much sample memory (0 for no limit)
 
 			static std::optional<LoopSettings> FromJson(Json::JsonPart json);
+			void ToJson(JsonWriter& writer) const;
 		};
 
 		struct TriggerSettings
@@ -48,6 +56,15 @@ namespace io
 			unsigned int DebounceSamps; // How many samples over which to prevent trigger bounce
 
 			static std::optional<TriggerSettings> FromJson(Json::JsonPart json);
+			void ToJson(JsonWriter& writer) const;
+		};
+
+		struct JobSettings
+		{
+			unsigned int NumWorkers; // Threads to run background jobs (waveform updates etc.) on
+
+			static std::optional<JobSettings> FromJson(Json::JsonPart json);
+			void ToJson(JsonWriter& writer) const;
 		};
 
 		// How much to (further) delay input signal from ADC, in samples
@@ -81,5 +98,6 @@ namespace io
 		AudioSettings Audio;
 		LoopSettings Loop;
 		TriggerSettings Trigger;
+		JobSettings Jobs;
 	};
 }
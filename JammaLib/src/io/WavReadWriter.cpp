@@ -1,62 +1,209 @@
 #include "WavReadWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include "../audio/MixKernels.h"
 
 using namespace io;
+using audio::MixKernels;
+
+namespace
+{
+	const unsigned int FormatPcm = 1u;
+	const unsigned int FormatFloat = 3u;
+	const unsigned int FormatExtensible = 0xFFFEu;
+
+	// Little-endian, whatever the host
+	std::uint32_t ReadUint(const char* data, unsigned int numBytes)
+	{
+		std::uint32_t value = 0;
+
+		for (auto i = 0u; i < numBytes; i++)
+			value |= ((std::uint32_t)(unsigned char)data[i]) << (8u * i);
+
+		return value;
+	}
+}
+
+unsigned int WavFormat::BytesPerFrame() const
+{
+	switch (Format)
+	{
+	case FORMAT_PCM16:
+		return NumChans * 2u;
+	case FORMAT_PCM24:
+		return NumChans * 3u;
+	default:
+		return NumChans * 4u;
+	}
+}
+
+const char* MappedWav::Frames() const
+{
+	return File->Data() + Format.DataOffset;
+}
+
+bool MappedWav::IsInPlace() const
+{
+	return (WavFormat::FORMAT_FLOAT32 == Format.Format) &&
+		(1u == Format.NumChans) &&
+		(0 == (reinterpret_cast<std::uintptr_t>(Frames()) % alignof(float)));
+}
 
 std::optional<std::tuple<std::vector<float>, unsigned int, unsigned int>>
 	WavReadWriter::_Read(const std::wstring& fileName, unsigned int maxVals) const
 {
-	struct SoundHeader info;
-	struct SoundHeader* pinfo = &info;
-
-	// The variable maxSamps represents the maximum
+	// The variable maxVals represents the maximum
 	// number of 32 bit floats the array can contain.
 	if (maxVals < 1)
 		return std::nullopt;
 
-	auto fileNameStr = utils::EncodeUtf8(fileName);
-	auto cname = new char[fileNameStr.size() + 1];
-	strcpy_s(cname, fileNameStr.size() + 1, fileNameStr.c_str());
+	auto wav = Map(fileName);
 
-	auto fid = OpenSoundIn(cname, pinfo);
+	if (!wav.has_value())
+		return std::nullopt;
 
-	delete cname;
+	auto numSampsLoaded = std::min(wav->Format.NumFrames, (unsigned long)maxVals);
 
-	if (fid == NULL)
-		return {};
+	if (numSampsLoaded < 1)
+		return std::nullopt;
 
-	size_t numSampsLoaded = maxVals;
+	std::vector<float> buffer(numSampsLoaded);
+	Convert(wav->Format, wav->Frames(), buffer.data(), (unsigned int)numSampsLoaded);
 
-	// Only load the reported number of samples
-	// (but prevent loading more than the array can hold)
-	if (info.dlength < (long)(maxVals * 2))
-		numSampsLoaded = info.dlength / 2; // Two 16 bit integers per sample (32 bit float)
+	return std::make_tuple(std::move(buffer), (unsigned int)numSampsLoaded, wav->Format.SampleRate);
+}
 
-	if (numSampsLoaded < 1)
-	{
-		numSampsLoaded = 0;
-		fclose(fid);
+std::optional<MappedWav> WavReadWriter::Map(const std::wstring& fileName) const
+{
+	auto file = MappedFile::Open(fileName);
 
-		return {};
+	if (!file.has_value())
+	{
+		std::cout << "Open (Read) wav file error\n";
+		return std::nullopt;
 	}
 
-	auto bufferIn = new char[numSampsLoaded * 2];  // Two bytes per wav file sample (16 bit integer)
-	auto bytesRead = fread(bufferIn, 1, numSampsLoaded * 2, fid);
+	auto format = ParseRiff(file.value()->Data(), file.value()->Size());
 
-	if ((bytesRead / 2) < numSampsLoaded)
-		numSampsLoaded = bytesRead / 2;  // Two bytes per wav file sample (16 bit integer)
+	if (!format.has_value())
+	{
+		std::cout << "Unsupported wav file format\n";
+		return std::nullopt;
+	}
 
-	fclose(fid);
+	return MappedWav{ file.value(), format.value() };
+}
 
-	std::vector<float> buffer(numSampsLoaded);
+std::optional<WavFormat> WavReadWriter::ParseRiff(const char* data, std::size_t numBytes)
+{
+	if ((numBytes < 12) ||
+		(0 != std::memcmp(data, "RIFF", 4)) ||
+		(0 != std::memcmp(data + 8, "WAVE", 4)))
+		return std::nullopt;
+
+	WavFormat format = {};
+	auto isFormatFound = false;
+	auto offset = (std::size_t)12;
 
-	for (auto i=0U; i<numSampsLoaded; i++)
+	while (offset + 8 <= numBytes)
 	{
-		buffer[i] = CharToFloat(bufferIn + (i * 2));
+		auto chunk = data + offset;
+		auto chunkSize = (std::size_t)ReadUint(chunk + 4, 4);
+		auto body = offset + 8;
+
+		if (0 == std::memcmp(chunk, "fmt ", 4))
+		{
+			if ((chunkSize < 16) || (body + 16 > numBytes))
+				return std::nullopt;
+
+			auto formatTag = ReadUint(data + body, 2);
+			auto blockAlign = ReadUint(data + body + 12, 2);
+			auto bitsPerSamp = ReadUint(data + body + 14, 2);
+
+			// Extensible files keep the real tag
+			// at the start of the sub-format guid
+			if ((FormatExtensible == formatTag) && (chunkSize >= 26) && (body + 26 <= numBytes))
+				formatTag = ReadUint(data + body + 24, 2);
+
+			if ((FormatPcm == formatTag) && (16 == bitsPerSamp))
+				format.Format = WavFormat::FORMAT_PCM16;
+			else if ((FormatPcm == formatTag) && (24 == bitsPerSamp))
+				format.Format = WavFormat::FORMAT_PCM24;
+			else if ((FormatPcm == formatTag) && (32 == bitsPerSamp))
+				format.Format = WavFormat::FORMAT_PCM32;
+			else if ((FormatFloat == formatTag) && (32 == bitsPerSamp))
+				format.Format = WavFormat::FORMAT_FLOAT32;
+			else
+				return std::nullopt;
+
+			format.NumChans = ReadUint(data + body + 2, 2);
+			format.SampleRate = ReadUint(data + body + 4, 4);
+
+			if ((0 == format.NumChans) || (blockAlign != format.BytesPerFrame()))
+				return std::nullopt;
+
+			isFormatFound = true;
+		}
+		else if (0 == std::memcmp(chunk, "data", 4))
+		{
+			if (!isFormatFound)
+				return std::nullopt;
+
+			// Writers that never patched the size in
+			// leave it too big, so clamp to the file
+			auto dataBytes = std::min(chunkSize, numBytes - body);
+
+			format.DataOffset = body;
+			format.NumFrames = (unsigned long)(dataBytes / format.BytesPerFrame());
+
+			return format;
+		}
+
+		// Chunks are padded to an even size
+		offset = body + chunkSize + (chunkSize & 1);
 	}
 
-	delete bufferIn;
+	return std::nullopt;
+}
+
+void WavReadWriter::Convert(const WavFormat& format,
+	const char* frames,
+	float* dest,
+	unsigned int numFrames)
+{
+	auto stride = format.BytesPerFrame();
 
-	return std::make_tuple(std::move(buffer), (unsigned int)numSampsLoaded, info.srate);
+	switch (format.Format)
+	{
+	case WavFormat::FORMAT_PCM16:
+		MixKernels::Int16ToFloat(reinterpret_cast<const std::int16_t*>(frames), format.NumChans, dest, numFrames);
+		break;
+	case WavFormat::FORMAT_PCM24:
+		for (auto i = 0u; i < numFrames; i++)
+		{
+			auto samp = (std::int32_t)(ReadUint(frames + i * stride, 3) << 8) >> 8;
+			dest[i] = (float)samp / 8388608.0f;
+		}
+		break;
+	case WavFormat::FORMAT_PCM32:
+		for (auto i = 0u; i < numFrames; i++)
+		{
+			auto samp = (std::int32_t)ReadUint(frames + i * stride, 4);
+			dest[i] = (float)samp / 2147483648.0f;
+		}
+		break;
+	case WavFormat::FORMAT_FLOAT32:
+		if (1u == format.NumChans)
+		{
+			std::memcpy(dest, frames, (std::size_t)numFrames * sizeof(float));
+			break;
+		}
+
+		for (auto i = 0u; i < numFrames; i++)
+			std::memcpy(dest + i, frames + i * stride, sizeof(float));
+		break;
+	}
 }
 
 bool WavReadWriter::_Write(std::wstring fileName,
@@ -108,31 +255,6 @@ bool WavReadWriter::_Write(std::wstring fileName,
 	return true;
 }
 
-FILE* WavReadWriter::OpenSoundIn(char *fileName, struct SoundHeader *hdr)
-{
-	FILE *myfile;
-
-	// Check file name for .wav extension
-	if (fileName[strlen(fileName) - 1] == 'v')
-	{
-		myfile = _fsopen(fileName, "rb", _SH_DENYNO);
-
-		if (myfile == NULL)
-		{
-			std::cout << "Open (Read) wav file error\n";
-		}
-		else
-			fread(hdr, 1, 44, myfile);
-	}
-	else
-	{
-		std::cout << "You must specify a valid .wav file name\n";
-		myfile = 0;
-	}
-
-	return myfile;
-}
-
 FILE *WavReadWriter::OpenSoundOut(char *fileName, struct SoundHeader *hdr)
 {
 	FILE *myfile;
@@ -184,11 +306,4 @@ void WavReadWriter::FloatToChar(float f, char* c)
 
 	*c = (char)(tempint & 0xFF);
 	*(c + 1) = (char)((tempint >> 8) & 0xFF);
-}
-
-float WavReadWriter::CharToFloat(char* c)
-{
-	short tempshort = (short)(((((short) *(c + 1)) << 8) & 0xFF00) | (((short)*c) & 0x00FF));
-
-	return (((float)tempshort) / 32768.0f);
 }
\ No newline at end of file
@@ -5,7 +5,9 @@
 #include <string>
 #include <optional>
 #include <memory>
+#include <cstddef>
 #include "FileReadWriter.h"
+#include "MappedFile.h"
 #include "../utils/StringUtils.h"
 
 namespace io
@@ -27,9 +29,52 @@ namespace io
 		long  dlength;        /* data length in bytes (filelength - 44)  */
 	};
 
+	struct WavFormat
+	{
+		enum SampleFormat
+		{
+			FORMAT_PCM16,
+			FORMAT_PCM24,
+			FORMAT_PCM32,
+			FORMAT_FLOAT32
+		};
+
+		SampleFormat Format;
+		unsigned int NumChans;
+		unsigned int SampleRate;
+		std::size_t DataOffset; // Offset of the first frame in the file
+		unsigned long NumFrames;
+
+		unsigned int BytesPerFrame() const;
+	};
+
+	// A wav file mapped into memory, whose frames
+	// can be read for as long as File is held
+	struct MappedWav
+	{
+		std::shared_ptr<MappedFile> File;
+		WavFormat Format;
+
+		const char* Frames() const;
+		// Mono float frames that can be read as they are
+		bool IsInPlace() const;
+	};
+
 	class WavReadWriter :
 		public FileReadWriter<std::vector<float>>
 	{
+	public:
+		std::optional<MappedWav> Map(const std::wstring& fileName) const;
+
+		// Walks the RIFF chunks for the format and data,
+		// skipping any others (LIST, fact, cue etc.)
+		static std::optional<WavFormat> ParseRiff(const char* data, std::size_t numBytes);
+		// Converts the first channel of each frame to float
+		static void Convert(const WavFormat& format,
+			const char* frames,
+			float* dest,
+			unsigned int numFrames);
+
 	protected:
 		std::optional<std::tuple<std::vector<float>, unsigned int, unsigned int>>
 			_Read(const std::wstring& fileName, unsigned int maxVals) const;
@@ -40,11 +85,9 @@ namespace io
 			unsigned int sampleRate) const;
 
 	protected:
-		static FILE* OpenSoundIn(char* fileName, struct SoundHeader* hdr);
 		static FILE* OpenSoundOut(char* fileName, struct SoundHeader* hdr);
 		static void FillHeader(struct SoundHeader& hdr);
 
 		static void FloatToChar(float f, char* c);
-		static float CharToFloat(char* c);
 	};
 }
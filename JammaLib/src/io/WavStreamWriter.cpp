@@ -0,0 +1,107 @@
+#include "WavStreamWriter.h"
+
+using namespace io;
+
+WavStreamWriter::WavStreamWriter() :
+	_stream(),
+	_numChannels(0),
+	_sampleRate(0),
+	_numFrames(0)
+{
+}
+
+WavStreamWriter::~WavStreamWriter()
+{
+	Close();
+}
+
+bool WavStreamWriter::Open(const std::wstring& fileName, unsigned int numChannels, unsigned int sampleRate)
+{
+	Close();
+
+	if (0 == numChannels)
+		return false;
+
+	auto path = std::filesystem::path(fileName);
+	if (path.has_parent_path())
+	{
+		std::error_code err;
+		std::filesystem::create_directories(path.parent_path(), err);
+	}
+
+	_stream.open(path, std::ios::binary | std::ios::trunc);
+
+	if (!_stream.is_open())
+		return false;
+
+	_numChannels = numChannels;
+	_sampleRate = sampleRate;
+	_numFrames = 0;
+
+	// Placeholder until the final length is known
+	WriteHeader();
+
+	return _stream.good();
+}
+
+bool WavStreamWriter::Write(const float* samps, unsigned int numFrames)
+{
+	if (!_stream.is_open())
+		return false;
+
+	// Samples are written as-is, so assumes a little-endian host
+	_stream.write(reinterpret_cast<const char*>(samps), (std::streamsize)numFrames * _numChannels * sizeof(float));
+	_numFrames += numFrames;
+
+	return _stream.good();
+}
+
+bool WavStreamWriter::Close()
+{
+	if (!_stream.is_open())
+		return false;
+
+	_stream.seekp(0);
+	WriteHeader();
+
+	auto isGood = _stream.good();
+	_stream.close();
+
+	return isGood;
+}
+
+bool WavStreamWriter::IsOpen() const
+{
+	return _stream.is_open();
+}
+
+unsigned long WavStreamWriter::NumFrames() const
+{
+	return _numFrames;
+}
+
+void WavStreamWriter::WriteHeader()
+{
+	auto bytesPerFrame = _numChannels * (unsigned int)sizeof(float);
+	auto dataLength = (std::uint32_t)(_numFrames * bytesPerFrame);
+
+	_stream.write("RIFF", 4);
+	WriteUint(HeaderSize - 8 + dataLength, 4);
+	_stream.write("WAVE", 4);
+	_stream.write("fmt ", 4);
+	WriteUint(16, 4);
+	WriteUint(3, 2); // IEEE float
+	WriteUint(_numChannels, 2);
+	WriteUint(_sampleRate, 4);
+	WriteUint(_sampleRate * bytesPerFrame, 4);
+	WriteUint(bytesPerFrame, 2);
+	WriteUint(32, 2);
+	_stream.write("data", 4);
+	WriteUint(dataLength, 4);
+}
+
+void WavStreamWriter::WriteUint(std::uint32_t value, unsigned int numBytes)
+{
+	for (auto i = 0u; i < numBytes; i++)
+		_stream.put((char)((value >> (8 * i)) & 0xFF));
+}
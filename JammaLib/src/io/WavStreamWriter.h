@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <cstdint>
+
+namespace io
+{
+	// Writes interleaved multichannel 32-bit float wav files
+	// block by block, so long renders never sit in memory.
+	// Sizes in the header are patched in on Close.
+	class WavStreamWriter
+	{
+	public:
+		WavStreamWriter();
+		~WavStreamWriter();
+
+		// Copy
+		WavStreamWriter(const WavStreamWriter&) = delete;
+		WavStreamWriter& operator=(const WavStreamWriter&) = delete;
+
+	public:
+		bool Open(const std::wstring& fileName, unsigned int numChannels, unsigned int sampleRate);
+		bool Write(const float* samps, unsigned int numFrames);
+		bool Close();
+		bool IsOpen() const;
+		unsigned long NumFrames() const;
+
+	protected:
+		void WriteHeader();
+		void WriteUint(std::uint32_t value, unsigned int numBytes);
+
+	public:
+		static const unsigned int HeaderSize = 44u;
+
+	protected:
+		std::ofstream _stream;
+		unsigned int _numChannels;
+		unsigned int _sampleRate;
+		unsigned long _numFrames;
+	};
+}
@@ -0,0 +1,438 @@
+#include "RealtimeCheck.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <streambuf>
+
+using namespace utils;
+
+namespace
+{
+	struct ViolationSlot
+	{
+		std::atomic<bool> IsWritten;
+		RealtimeCheck::Violation Violation;
+	};
+
+	// Forwards to the original stream buffer, reporting
+	// any write made from a realtime thread
+	class CheckedStreamBuf :
+		public std::streambuf
+	{
+	public:
+		CheckedStreamBuf(std::streambuf* inner) :
+			_inner(inner)
+		{
+		}
+
+	public:
+		std::streambuf* Inner() const { return _inner; }
+
+	protected:
+		int_type overflow(int_type c) override
+		{
+			RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_STDIO);
+
+			if (traits_type::eq_int_type(c, traits_type::eof()))
+				return traits_type::not_eof(c);
+
+			return _inner->sputc(traits_type::to_char_type(c));
+		}
+
+		std::streamsize xsputn(const char* s, std::streamsize n) override
+		{
+			RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_STDIO);
+			return _inner->sputn(s, n);
+		}
+
+		int sync() override
+		{
+			return _inner->pubsync();
+		}
+
+	protected:
+		std::streambuf* _inner;
+	};
+
+	std::atomic<bool> _isEnabled(false);
+	std::atomic<unsigned long long> _numCallbacks(0ull);
+	std::atomic<unsigned long long> _currentCallback(0ull);
+	std::atomic<unsigned long long> _numViolatingCallbacks(0ull);
+	std::atomic<unsigned long long> _numViolations(0ull);
+	std::atomic<unsigned int> _callbackViolations(0u);
+	std::atomic<unsigned int> _maxViolationsPerCallback(0u);
+	ViolationSlot _slots[RealtimeCheck::MaxViolations];
+
+	std::unique_ptr<CheckedStreamBuf> _coutBuf;
+	std::unique_ptr<CheckedStreamBuf> _cerrBuf;
+	std::unique_ptr<CheckedStreamBuf> _clogBuf;
+
+	thread_local unsigned int _realtimeDepth = 0u;
+	thread_local unsigned int _numTags = 0u;
+	thread_local const char* _tags[RealtimeCheck::MaxTags];
+	thread_local bool _isReporting = false;
+
+	void AppendChars(char* stack, unsigned int& pos, const char* chars)
+	{
+		for (; ('\0' != *chars) && (pos < RealtimeCheck::MaxStackChars - 1); chars++)
+			stack[pos++] = *chars;
+	}
+
+	void WriteStack(char* stack)
+	{
+		auto pos = 0u;
+		auto numTags = _numTags < RealtimeCheck::MaxTags ? _numTags : RealtimeCheck::MaxTags;
+
+		for (auto i = 0u; i < numTags; i++)
+		{
+			if (i > 0)
+				AppendChars(stack, pos, " > ");
+
+			AppendChars(stack, pos, _tags[i]);
+		}
+
+		stack[pos] = '\0';
+	}
+}
+
+void RealtimeCheck::Enable()
+{
+	if (_isEnabled.exchange(true))
+		return;
+
+	InstallStdioHooks();
+}
+
+void RealtimeCheck::Disable()
+{
+	if (!_isEnabled.exchange(false))
+		return;
+
+	RemoveStdioHooks();
+}
+
+bool RealtimeCheck::IsEnabled()
+{
+	return _isEnabled.load(std::memory_order_relaxed);
+}
+
+bool RealtimeCheck::IsRealtimeThread()
+{
+	return _realtimeDepth > 0u;
+}
+
+void RealtimeCheck::OnViolation(ViolationType type)
+{
+	// Enabled is checked first so that nothing touches
+	// thread-local state until checking is switched on
+	if (!_isEnabled.load(std::memory_order_relaxed))
+		return;
+
+	if ((0u == _realtimeDepth) || _isReporting)
+		return;
+
+	_isReporting = true;
+
+	auto indexInCallback = _callbackViolations.fetch_add(1u, std::memory_order_relaxed) + 1u;
+	auto slotIndex = _numViolations.fetch_add(1ull, std::memory_order_relaxed);
+
+	if (slotIndex < MaxViolations)
+	{
+		auto& slot = _slots[slotIndex];
+		slot.Violation.Type = type;
+		slot.Violation.Callback = _currentCallback.load(std::memory_order_relaxed);
+		slot.Violation.IndexInCallback = indexInCallback;
+		WriteStack(slot.Violation.Stack);
+		slot.IsWritten.store(true, std::memory_order_release);
+	}
+
+	_isReporting = false;
+}
+
+unsigned long long RealtimeCheck::NumViolations()
+{
+	return _numViolations.load(std::memory_order_acquire);
+}
+
+RealtimeCheck::Report RealtimeCheck::GetReport()
+{
+	Report report;
+	report.NumCallbacks = _numCallbacks.load();
+	report.NumViolatingCallbacks = _numViolatingCallbacks.load();
+	report.MaxViolationsPerCallback = _maxViolationsPerCallback.load();
+	report.NumViolations = _numViolations.load();
+
+	auto numSlots = (unsigned int)std::min(report.NumViolations, (unsigned long long)MaxViolations);
+	for (auto i = 0u; i < numSlots; i++)
+	{
+		if (_slots[i].IsWritten.load(std::memory_order_acquire))
+			report.Violations.push_back(_slots[i].Violation);
+	}
+
+	return report;
+}
+
+void RealtimeCheck::WriteReport(std::ostream& stream)
+{
+	auto report = GetReport();
+
+	stream << "[Realtime check] " << report.NumViolations << " violations in "
+		<< report.NumViolatingCallbacks << " of " << report.NumCallbacks
+		<< " callbacks (max " << report.MaxViolationsPerCallback << " per callback)" << std::endl;
+
+	for (auto& violation : report.Violations)
+	{
+		stream << "  [" << ViolationName(violation.Type) << "] callback " << violation.Callback
+			<< " #" << violation.IndexInCallback << ": " << violation.Stack << std::endl;
+	}
+
+	if (report.NumViolations > report.Violations.size())
+		stream << "  ... " << report.NumViolations - report.Violations.size() << " more not recorded" << std::endl;
+}
+
+void RealtimeCheck::Reset()
+{
+	for (auto& slot : _slots)
+		slot.IsWritten = false;
+
+	_numCallbacks = 0ull;
+	_currentCallback = 0ull;
+	_numViolatingCallbacks = 0ull;
+	_numViolations = 0ull;
+	_callbackViolations = 0u;
+	_maxViolationsPerCallback = 0u;
+}
+
+std::string RealtimeCheck::ViolationName(ViolationType type)
+{
+	switch (type)
+	{
+	case VIOLATION_ALLOC:
+		return "alloc";
+	case VIOLATION_FREE:
+		return "free";
+	case VIOLATION_LOCK:
+		return "lock";
+	case VIOLATION_STDIO:
+		return "stdio";
+	}
+
+	return "unknown";
+}
+
+void RealtimeCheck::PushTag(const char* tag)
+{
+	if (_numTags < MaxTags)
+		_tags[_numTags] = tag;
+
+	_numTags++;
+}
+
+void RealtimeCheck::PopTag()
+{
+	if (_numTags > 0u)
+		_numTags--;
+}
+
+void RealtimeCheck::BeginCallback()
+{
+	_currentCallback.store(_numCallbacks.fetch_add(1ull, std::memory_order_relaxed), std::memory_order_relaxed);
+	_callbackViolations.store(0u, std::memory_order_relaxed);
+}
+
+void RealtimeCheck::EndCallback()
+{
+	auto numViolations = _callbackViolations.exchange(0u, std::memory_order_relaxed);
+	if (0u == numViolations)
+		return;
+
+	_numViolatingCallbacks.fetch_add(1ull, std::memory_order_relaxed);
+
+	auto maxViolations = _maxViolationsPerCallback.load(std::memory_order_relaxed);
+	while ((numViolations > maxViolations) &&
+		!_maxViolationsPerCallback.compare_exchange_weak(maxViolations, numViolations, std::memory_order_relaxed))
+	{
+	}
+}
+
+void RealtimeCheck::InstallStdioHooks()
+{
+#if defined(JAMMA_REALTIME_CHECKS)
+	_coutBuf = std::make_unique<CheckedStreamBuf>(std::cout.rdbuf());
+	_cerrBuf = std::make_unique<CheckedStreamBuf>(std::cerr.rdbuf());
+	_clogBuf = std::make_unique<CheckedStreamBuf>(std::clog.rdbuf());
+
+	std::cout.rdbuf(_coutBuf.get());
+	std::cerr.rdbuf(_cerrBuf.get());
+	std::clog.rdbuf(_clogBuf.get());
+#endif
+}
+
+void RealtimeCheck::RemoveStdioHooks()
+{
+	if (_coutBuf)
+		std::cout.rdbuf(_coutBuf->Inner());
+	if (_cerrBuf)
+		std::cerr.rdbuf(_cerrBuf->Inner());
+	if (_clogBuf)
+		std::clog.rdbuf(_clogBuf->Inner());
+
+	_coutBuf.reset();
+	_cerrBuf.reset();
+	_clogBuf.reset();
+}
+
+RealtimeTag::RealtimeTag(const char* tag) :
+	_isPushed(RealtimeCheck::IsRealtimeThread())
+{
+	if (_isPushed)
+		RealtimeCheck::PushTag(tag);
+}
+
+RealtimeTag::~RealtimeTag()
+{
+	if (_isPushed)
+		RealtimeCheck::PopTag();
+}
+
+RealtimeScope::RealtimeScope(const char* tag)
+{
+	_realtimeDepth++;
+	RealtimeCheck::PushTag(tag);
+}
+
+RealtimeScope::~RealtimeScope()
+{
+	RealtimeCheck::PopTag();
+	_realtimeDepth--;
+}
+
+RealtimeCallbackScope::RealtimeCallbackScope(const char* tag) :
+	RealtimeScope(tag)
+{
+	RealtimeCheck::BeginCallback();
+}
+
+RealtimeCallbackScope::~RealtimeCallbackScope()
+{
+	RealtimeCheck::EndCallback();
+}
+
+RealtimeCheckGuard::RealtimeCheckGuard() :
+	_wasEnabled(RealtimeCheck::IsEnabled())
+{
+	RealtimeCheck::Enable();
+}
+
+RealtimeCheckGuard::~RealtimeCheckGuard()
+{
+	if (!_wasEnabled)
+		RealtimeCheck::Disable();
+}
+
+void CheckedMutex::lock()
+{
+	RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_LOCK);
+	_mutex.lock();
+}
+
+bool CheckedMutex::try_lock()
+{
+	RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_LOCK);
+	return _mutex.try_lock();
+}
+
+void CheckedMutex::unlock()
+{
+	_mutex.unlock();
+}
+
+void CheckedSharedMutex::lock()
+{
+	RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_LOCK);
+	_mutex.lock();
+}
+
+bool CheckedSharedMutex::try_lock()
+{
+	RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_LOCK);
+	return _mutex.try_lock();
+}
+
+void CheckedSharedMutex::unlock()
+{
+	_mutex.unlock();
+}
+
+void CheckedSharedMutex::lock_shared()
+{
+	RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_LOCK);
+	_mutex.lock_shared();
+}
+
+bool CheckedSharedMutex::try_lock_shared()
+{
+	RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_LOCK);
+	return _mutex.try_lock_shared();
+}
+
+void CheckedSharedMutex::unlock_shared()
+{
+	_mutex.unlock_shared();
+}
+
+#if defined(JAMMA_REALTIME_CHECKS)
+// Replacement global allocation functions. The array, nothrow
+// and sized forms all forward to these by default.
+void* operator new(std::size_t size)
+{
+	RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_ALLOC);
+
+	if (0 == size)
+		size = 1;
+
+	while (true)
+	{
+		auto ptr = std::malloc(size);
+		if (nullptr != ptr)
+			return ptr;
+
+		auto handler = std::get_new_handler();
+		if (nullptr == handler)
+			throw std::bad_alloc();
+
+		handler();
+	}
+}
+
+void operator delete(void* ptr) noexcept
+{
+	if (nullptr == ptr)
+		return;
+
+	RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_FREE);
+	std::free(ptr);
+}
+
+void* operator new[](std::size_t size)
+{
+	return ::operator new(size);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	::operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	::operator delete(ptr);
+}
+#endif
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <shared_mutex>
+
+// Build with JAMMA_REALTIME_CHECKS defined to hook operator
+// new/delete, CheckedMutex, CheckedSharedMutex and std::cout/cerr/clog, and
+// to expand the scope macros below. Without it the macros
+// compile away and only explicit calls are recorded.
+#if defined(JAMMA_REALTIME_CHECKS)
+#define JAMMA_REALTIME_CONCAT_(a, b) a##b
+#define JAMMA_REALTIME_CONCAT(a, b) JAMMA_REALTIME_CONCAT_(a, b)
+#define JAMMA_REALTIME_CALLBACK(tag) utils::RealtimeCallbackScope JAMMA_REALTIME_CONCAT(_realtimeScope, __LINE__)(tag)
+#define JAMMA_REALTIME_SCOPE(tag) utils::RealtimeScope JAMMA_REALTIME_CONCAT(_realtimeScope, __LINE__)(tag)
+#define JAMMA_REALTIME_TAG(tag) utils::RealtimeTag JAMMA_REALTIME_CONCAT(_realtimeTag, __LINE__)(tag)
+#else
+#define JAMMA_REALTIME_CALLBACK(tag)
+#define JAMMA_REALTIME_SCOPE(tag)
+#define JAMMA_REALTIME_TAG(tag)
+#endif
+
+namespace utils
+{
+	// Records things the audio thread must never do (allocate,
+	// free, lock, write to stdio). Threads are marked realtime
+	// by RealtimeScope, and each violation is stored with the
+	// chain of scope/tag names active on that thread and the
+	// callback it happened in. Recording never allocates, so
+	// it is safe to call from inside operator new.
+	class RealtimeCheck
+	{
+	public:
+		enum ViolationType
+		{
+			VIOLATION_ALLOC,
+			VIOLATION_FREE,
+			VIOLATION_LOCK,
+			VIOLATION_STDIO
+		};
+
+		static const unsigned int MaxTags = 16u;
+		static const unsigned int MaxStackChars = 256u;
+		static const unsigned int MaxViolations = 512u;
+
+		struct Violation
+		{
+			ViolationType Type;
+			unsigned long long Callback; // Index of the callback it happened in
+			unsigned int IndexInCallback; // 1 for the first violation in that callback
+			char Stack[MaxStackChars]; // Active tags, outermost first
+		};
+
+		struct Report
+		{
+			unsigned long long NumCallbacks;
+			unsigned long long NumViolatingCallbacks;
+			unsigned int MaxViolationsPerCallback;
+			unsigned long long NumViolations; // Including any that didn't fit in Violations
+			std::vector<Violation> Violations;
+		};
+
+	public:
+		static void Enable();
+		static void Disable();
+		static bool IsEnabled();
+		static bool IsRealtimeThread();
+
+		static void OnViolation(ViolationType type);
+		static unsigned long long NumViolations();
+		static Report GetReport();
+		static void WriteReport(std::ostream& stream);
+		static void Reset();
+
+		static std::string ViolationName(ViolationType type);
+
+	protected:
+		friend class RealtimeTag;
+		friend class RealtimeScope;
+		friend class RealtimeCallbackScope;
+
+		static void PushTag(const char* tag);
+		static void PopTag();
+		static void BeginCallback();
+		static void EndCallback();
+		static void InstallStdioHooks();
+		static void RemoveStdioHooks();
+	};
+
+	// Names the enclosing code in violation reports, but only
+	// while the thread is already marked realtime
+	class RealtimeTag
+	{
+	public:
+		RealtimeTag(const char* tag);
+		~RealtimeTag();
+
+		// Copy
+		RealtimeTag(const RealtimeTag&) = delete;
+		RealtimeTag& operator=(const RealtimeTag&) = delete;
+
+	protected:
+		bool _isPushed;
+	};
+
+	// Marks the current thread realtime for its lifetime,
+	// e.g. for jobs that workers run on the audio thread's behalf
+	class RealtimeScope
+	{
+	public:
+		RealtimeScope(const char* tag);
+		~RealtimeScope();
+
+		// Copy
+		RealtimeScope(const RealtimeScope&) = delete;
+		RealtimeScope& operator=(const RealtimeScope&) = delete;
+	};
+
+	// Wraps one audio callback, so that violations
+	// can be counted per callback
+	class RealtimeCallbackScope :
+		public RealtimeScope
+	{
+	public:
+		RealtimeCallbackScope(const char* tag);
+		~RealtimeCallbackScope();
+	};
+
+	// Switches checking on for its lifetime, and back off
+	// afterwards unless it was already on
+	class RealtimeCheckGuard
+	{
+	public:
+		RealtimeCheckGuard();
+		~RealtimeCheckGuard();
+
+		// Copy
+		RealtimeCheckGuard(const RealtimeCheckGuard&) = delete;
+		RealtimeCheckGuard& operator=(const RealtimeCheckGuard&) = delete;
+
+	protected:
+		bool _wasEnabled;
+	};
+
+	// Drop-in for std::mutex that reports any
+	// acquisition made from a realtime thread
+	class CheckedMutex
+	{
+	public:
+		CheckedMutex() = default;
+
+		// Copy
+		CheckedMutex(const CheckedMutex&) = delete;
+		CheckedMutex& operator=(const CheckedMutex&) = delete;
+
+	public:
+		void lock();
+		bool try_lock();
+		void unlock();
+
+	protected:
+		std::mutex _mutex;
+	};
+
+	// Drop-in for std::shared_mutex that reports any
+	// acquisition made from a realtime thread
+	class CheckedSharedMutex
+	{
+	public:
+		CheckedSharedMutex() = default;
+
+		// Copy
+		CheckedSharedMutex(const CheckedSharedMutex&) = delete;
+		CheckedSharedMutex& operator=(const CheckedSharedMutex&) = delete;
+
+	public:
+		void lock();
+		bool try_lock();
+		void unlock();
+		void lock_shared();
+		bool try_lock_shared();
+		void unlock_shared();
+
+	protected:
+		std::shared_mutex _mutex;
+	};
+}
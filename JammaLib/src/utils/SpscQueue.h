@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+namespace utils
+{
+	// Bounded lock-free queue for exactly one producer
+	// thread and one consumer thread. Items are moved out
+	// when popped, so whatever they own is released by
+	// the consumer rather than the producer.
+	template<typename T>
+	class SpscQueue
+	{
+	public:
+		SpscQueue(unsigned int capacity) :
+			_head(0),
+			_tail(0),
+			_items(std::vector<T>(capacity + 1))
+		{
+		}
+
+		// Copy
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+	public:
+		bool TryPush(T&& item)
+		{
+			auto tail = _tail.load(std::memory_order_relaxed);
+			auto next = Next(tail);
+
+			if (next == _head.load(std::memory_order_acquire))
+				return false;
+
+			_items[tail] = std::move(item);
+			_tail.store(next, std::memory_order_release);
+
+			return true;
+		}
+
+		bool TryPush(const T& item)
+		{
+			T copy = item;
+			return TryPush(std::move(copy));
+		}
+
+		bool TryPop(T& item)
+		{
+			auto head = _head.load(std::memory_order_relaxed);
+
+			if (head == _tail.load(std::memory_order_acquire))
+				return false;
+
+			item = std::move(_items[head]);
+			_items[head] = T();
+			_head.store(Next(head), std::memory_order_release);
+
+			return true;
+		}
+
+		// Only meaningful on the producer, as the consumer
+		// can only free up more room in the meantime
+		bool CanPush(unsigned int numItems) const
+		{
+			auto head = _head.load(std::memory_order_acquire);
+			auto tail = _tail.load(std::memory_order_relaxed);
+			auto size = (unsigned int)_items.size();
+			auto numUsed = tail >= head ? tail - head : tail + size - head;
+
+			return numItems <= (size - 1) - numUsed;
+		}
+
+		bool IsEmpty() const
+		{
+			return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+		}
+
+	protected:
+		unsigned int Next(unsigned int index) const
+		{
+			return (index + 1) < _items.size() ? index + 1 : 0;
+		}
+
+	protected:
+		std::atomic<unsigned int> _head;
+		std::atomic<unsigned int> _tail;
+		std::vector<T> _items;
+	};
+}
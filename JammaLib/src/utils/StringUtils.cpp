@@ -70,6 +70,11 @@ std::wstring utils::DecodeUtf8(const std::string& str)
 
 std::string utils::GetGuid()
 {
+	JAMMA_REALTIME_TAG("utils::GetGuid");
+
+	// The RPC string is allocated outside operator new
+	utils::RealtimeCheck::OnViolation(utils::RealtimeCheck::VIOLATION_ALLOC);
+
 	std::string str = "";
 
 	UUID uuid;
@@ -10,6 +10,7 @@
 #include <string>
 #include <windows.h>
 #include <Rpc.h>
+#include "RealtimeCheck.h"
 
 #pragma comment(lib,"Rpcrt4.lib")
 
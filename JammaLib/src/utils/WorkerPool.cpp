@@ -0,0 +1,197 @@
+#include "WorkerPool.h"
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+using namespace utils;
+
+WorkerPool::WorkerPool(WorkerPoolParams params) :
+	_params(params),
+	_isQuitting(false),
+	_generation(0u),
+	_numParked(0u),
+	_jobsRemaining(0u),
+	_job(nullptr),
+	_ranges(params.NumWorkers + 1),
+	_workers()
+{
+	auto numCores = std::max(1u, std::thread::hardware_concurrency());
+
+	for (auto worker = 0u; worker < params.NumWorkers; worker++)
+	{
+		_workers.push_back(std::thread([this, worker]() { this->WorkerLoop(worker + 1); }));
+
+		if (params.IsRealtime)
+			SetRealtime(_workers.back(), (worker + 1) % numCores);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	_isQuitting = true;
+	_generation++;
+	_generation.notify_all();
+
+	for (auto& worker : _workers)
+		worker.join();
+}
+
+void WorkerPool::Run(unsigned int numJobs, const std::function<void(unsigned int)>& job)
+{
+	if (0 == numJobs)
+		return;
+
+	if (_workers.empty() || (1 == numJobs))
+	{
+		for (auto i = 0u; i < numJobs; i++)
+			job(i);
+
+		return;
+	}
+
+	// Job and count must be visible before any slice is claimable
+	_job = &job;
+	_jobsRemaining.store(numJobs, std::memory_order_relaxed);
+
+	auto numParticipants = (unsigned int)_ranges.size();
+	for (auto p = 0u; p < numParticipants; p++)
+	{
+		auto begin = (numJobs * p) / numParticipants;
+		auto end = (numJobs * (p + 1)) / numParticipants;
+		_ranges[p].store(PackRange(begin, end), std::memory_order_release);
+	}
+
+	_generation.fetch_add(1, std::memory_order_release);
+	if (_numParked > 0)
+		_generation.notify_all();
+
+	RunJobs(0);
+
+	while (_jobsRemaining.load(std::memory_order_acquire) > 0)
+		Pause();
+}
+
+unsigned int WorkerPool::NumWorkers() const
+{
+	return (unsigned int)_workers.size();
+}
+
+void WorkerPool::WorkerLoop(unsigned int participant)
+{
+	auto lastGeneration = 0u;
+
+	while (true)
+	{
+		auto spins = 0u;
+		auto generation = _generation.load(std::memory_order_acquire);
+
+		while (generation == lastGeneration)
+		{
+			if (spins < _params.SpinIterations)
+			{
+				spins++;
+				Pause();
+			}
+			else
+			{
+				_numParked++;
+				_generation.wait(lastGeneration, std::memory_order_acquire);
+				_numParked--;
+			}
+
+			generation = _generation.load(std::memory_order_acquire);
+		}
+
+		lastGeneration = generation;
+
+		if (_isQuitting)
+			return;
+
+		RunJobs(participant);
+	}
+}
+
+void WorkerPool::RunJobs(unsigned int participant)
+{
+	auto jobIndex = 0u;
+
+	while (ClaimOwn(participant, jobIndex) || Steal(participant, jobIndex))
+	{
+		(*_job)(jobIndex);
+		_jobsRemaining.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+bool WorkerPool::ClaimOwn(unsigned int participant, unsigned int& jobIndex)
+{
+	auto& range = _ranges[participant];
+	auto current = range.load(std::memory_order_acquire);
+
+	while (true)
+	{
+		auto begin = (unsigned int)(current >> 32);
+		auto end = (unsigned int)(current & 0xffffffffull);
+
+		if (begin >= end)
+			return false;
+
+		// Owner takes from the front
+		if (range.compare_exchange_weak(current, PackRange(begin + 1, end), std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			jobIndex = begin;
+			return true;
+		}
+	}
+}
+
+bool WorkerPool::Steal(unsigned int participant, unsigned int& jobIndex)
+{
+	auto numParticipants = (unsigned int)_ranges.size();
+
+	for (auto i = 1u; i < numParticipants; i++)
+	{
+		auto& range = _ranges[(participant + i) % numParticipants];
+		auto current = range.load(std::memory_order_acquire);
+
+		while (true)
+		{
+			auto begin = (unsigned int)(current >> 32);
+			auto end = (unsigned int)(current & 0xffffffffull);
+
+			if (begin >= end)
+				break;
+
+			// Thieves take from the back
+			if (range.compare_exchange_weak(current, PackRange(begin, end - 1), std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				jobIndex = end - 1;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+unsigned long long WorkerPool::PackRange(unsigned int begin, unsigned int end)
+{
+	return (((unsigned long long)begin) << 32) | (unsigned long long)end;
+}
+
+void WorkerPool::Pause()
+{
+#ifdef _WIN32
+	YieldProcessor();
+#else
+	std::this_thread::yield();
+#endif
+}
+
+void WorkerPool::SetRealtime([[maybe_unused]] std::thread& thread, [[maybe_unused]] unsigned int core)
+{
+#ifdef _WIN32
+	auto handle = thread.native_handle();
+	SetThreadAffinityMask(handle, ((DWORD_PTR)1) << (core % (8 * sizeof(DWORD_PTR))));
+	SetThreadPriority(handle, THREAD_PRIORITY_TIME_CRITICAL);
+#endif
+}
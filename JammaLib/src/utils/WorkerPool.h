@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace utils
+{
+	class WorkerPoolParams
+	{
+	public:
+		unsigned int NumWorkers;
+		unsigned int SpinIterations;
+		bool IsRealtime; // Pin workers to cores and run them at high priority
+	};
+
+	// Runs batches of indexed jobs on a set of workers plus
+	// the calling thread. Each participant starts on its own
+	// slice of the batch and steals from the others once that
+	// is done. Between batches, workers spin for a while and
+	// then park until the next batch is posted.
+	class WorkerPool
+	{
+	public:
+		WorkerPool(WorkerPoolParams params);
+		~WorkerPool();
+
+		// Copy
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+	public:
+		void Run(unsigned int numJobs, const std::function<void(unsigned int)>& job);
+		unsigned int NumWorkers() const;
+
+	protected:
+		void WorkerLoop(unsigned int participant);
+		void RunJobs(unsigned int participant);
+		bool ClaimOwn(unsigned int participant, unsigned int& jobIndex);
+		bool Steal(unsigned int participant, unsigned int& jobIndex);
+
+		static unsigned long long PackRange(unsigned int begin, unsigned int end);
+		static void Pause();
+		static void SetRealtime(std::thread& thread, unsigned int core);
+
+	protected:
+		WorkerPoolParams _params;
+		std::atomic<bool> _isQuitting;
+		std::atomic<unsigned int> _generation;
+		std::atomic<unsigned int> _numParked;
+		std::atomic<unsigned int> _jobsRemaining;
+		const std::function<void(unsigned int)>* _job;
+		// Remaining [begin, end) of each participant's slice
+		std::vector<std::atomic<unsigned long long>> _ranges;
+		std::vector<std::thread> _workers;
+	};
+}
@@ -0,0 +1,107 @@
+#include "Benchmark.h"
+
+using namespace benchmarks;
+using engine::Timer;
+
+BenchmarkRunner::BenchmarkRunner(BenchmarkRunnerParams params) :
+	_params(params),
+	_results({})
+{
+}
+
+void BenchmarkRunner::Run(const std::string& name,
+	std::vector<std::pair<std::string, unsigned int>> params,
+	unsigned int sampsPerIteration,
+	std::function<void()> iteration)
+{
+	if (!IsEnabled(name))
+		return;
+
+	for (auto i = 0u; i < _params.WarmupIterations; i++)
+		iteration();
+
+	auto numIterations = 0u;
+	auto seconds = 0.0;
+	auto startTime = Timer::GetTime();
+
+	while ((numIterations < _params.MinIterations) || (seconds < _params.MinSeconds))
+	{
+		iteration();
+		numIterations++;
+
+		seconds = Timer::GetElapsedSeconds(startTime, Timer::GetTime());
+	}
+
+	BenchmarkResult result;
+	result.Name = name;
+	result.Params = params;
+	result.NumIterations = numIterations;
+	result.NumSamps = (unsigned long long)numIterations * sampsPerIteration;
+	result.Seconds = seconds;
+	result.NsPerSample = result.NumSamps > 0 ? (seconds * 1e9) / (double)result.NumSamps : 0.0;
+
+	std::cerr << name;
+	for (auto& [key, value] : params)
+		std::cerr << " " << key << "=" << value;
+	std::cerr << ": " << std::fixed << std::setprecision(3) << result.NsPerSample << " ns/samp" << std::endl;
+
+	_results.push_back(result);
+}
+
+bool BenchmarkRunner::IsEnabled(const std::string& name) const
+{
+	return _params.Filter.empty() || (name.find(_params.Filter) != std::string::npos);
+}
+
+const std::vector<BenchmarkResult>& BenchmarkRunner::Results() const
+{
+	return _results;
+}
+
+void BenchmarkRunner::WriteJson(std::ostream& stream) const
+{
+	stream << "{\"version\":\"" << LIB_VERSION << "\",\"benchmarks\":[";
+
+	auto isFirst = true;
+	for (auto& result : _results)
+	{
+		if (!isFirst)
+			stream << ",";
+		isFirst = false;
+
+		stream << "\n{\"name\":\"" << EscapeJson(result.Name) << "\",\"params\":{";
+
+		auto isFirstParam = true;
+		for (auto& [key, value] : result.Params)
+		{
+			if (!isFirstParam)
+				stream << ",";
+			isFirstParam = false;
+
+			stream << "\"" << EscapeJson(key) << "\":" << value;
+		}
+
+		stream << "},\"iterations\":" << result.NumIterations
+			<< ",\"samps\":" << result.NumSamps
+			<< ",\"seconds\":" << std::setprecision(9) << result.Seconds
+			<< ",\"nsPerSamp\":" << std::setprecision(6) << result.NsPerSample
+			<< "}";
+	}
+
+	stream << "\n]}" << std::endl;
+}
+
+std::string BenchmarkRunner::EscapeJson(const std::string& str)
+{
+	std::string escaped;
+
+	for (auto c : str)
+	{
+		if (('"' == c) || ('\\' == c))
+			escaped.push_back('\\');
+
+		escaped.push_back(c);
+	}
+
+	return escaped;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <utility>
+#include "../include/Constants.h"
+#include "engine/Timer.h"
+
+namespace benchmarks
+{
+	class BenchmarkRunnerParams
+	{
+	public:
+		double MinSeconds; // Minimum time to spend measuring each benchmark
+		unsigned int MinIterations;
+		unsigned int WarmupIterations;
+		std::string Filter; // Only run benchmarks whose name contains this
+	};
+
+	struct BenchmarkResult
+	{
+		std::string Name;
+		std::vector<std::pair<std::string, unsigned int>> Params;
+		unsigned int NumIterations;
+		unsigned long long NumSamps;
+		double Seconds;
+		double NsPerSample;
+	};
+
+	class BenchmarkRunner
+	{
+	public:
+		BenchmarkRunner(BenchmarkRunnerParams params);
+
+	public:
+		// Times repeated calls of iteration, each of which
+		// processes sampsPerIteration samples
+		void Run(const std::string& name,
+			std::vector<std::pair<std::string, unsigned int>> params,
+			unsigned int sampsPerIteration,
+			std::function<void()> iteration);
+		bool IsEnabled(const std::string& name) const;
+		const std::vector<BenchmarkResult>& Results() const;
+		void WriteJson(std::ostream& stream) const;
+
+	protected:
+		static std::string EscapeJson(const std::string& str);
+
+	protected:
+		BenchmarkRunnerParams _params;
+		std::vector<BenchmarkResult> _results;
+	};
+
+	void RunAudioBenchmarks(BenchmarkRunner& runner);
+	void RunEngineBenchmarks(BenchmarkRunner& runner);
+	void RunIoBenchmarks(BenchmarkRunner& runner);
+}
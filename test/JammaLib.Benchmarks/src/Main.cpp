@@ -0,0 +1,57 @@
+#include <fstream>
+#include <string>
+#include "Benchmark.h"
+
+using namespace benchmarks;
+
+// Usage: JammaLib.Benchmarks [--out results.json] [--filter name] [--seconds s]
+int main(int argc, char* argv[])
+{
+	BenchmarkRunnerParams params;
+	params.MinSeconds = 0.25;
+	params.MinIterations = 10;
+	params.WarmupIterations = 3;
+	params.Filter = "";
+
+	std::string outFile;
+
+	for (auto i = 1; i < argc; i++)
+	{
+		std::string arg(argv[i]);
+		auto hasValue = (i + 1) < argc;
+
+		if (("--out" == arg) && hasValue)
+			outFile = argv[++i];
+		else if (("--filter" == arg) && hasValue)
+			params.Filter = argv[++i];
+		else if (("--seconds" == arg) && hasValue)
+			params.MinSeconds = std::stod(argv[++i]);
+		else
+		{
+			std::cerr << "Unknown argument " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	BenchmarkRunner runner(params);
+	RunAudioBenchmarks(runner);
+	RunEngineBenchmarks(runner);
+	RunIoBenchmarks(runner);
+
+	if (outFile.empty())
+	{
+		runner.WriteJson(std::cout);
+		return 0;
+	}
+
+	std::ofstream stream(outFile);
+	if (!stream.is_open())
+	{
+		std::cerr << "Failed to open " << outFile << std::endl;
+		return 1;
+	}
+
+	runner.WriteJson(stream);
+
+	return 0;
+}
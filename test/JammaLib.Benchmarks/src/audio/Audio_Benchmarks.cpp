@@ -0,0 +1,183 @@
+
+#include "../Benchmark.h"
+#include "audio/AudioBuffer.h"
+#include "audio/AudioMixer.h"
+#include "audio/BufferBank.h"
+#include "audio/ChannelMixer.h"
+
+using audio::AudioBuffer;
+using audio::AudioMixer;
+using audio::AudioMixerParams;
+using audio::BufferBank;
+using audio::ChannelMixer;
+using audio::ChannelMixerParams;
+using audio::WireMixBehaviourParams;
+
+namespace benchmarks
+{
+	static const std::vector<unsigned int> BlockSizes = { 64, 256, 1024 };
+	// Results are folded in here so the optimiser keeps the work
+	static volatile float MinMaxSink = 0.0f;
+
+	static std::vector<float> RandomSamps(unsigned int numSamps)
+	{
+		auto samps = std::vector<float>(numSamps);
+
+		for (auto i = 0u; i < numSamps; i++)
+			samps[i] = ((rand() % 2000) - 1000) / 1001.0f;
+
+		return samps;
+	}
+
+	static void AudioBufferPlay(BenchmarkRunner& runner)
+	{
+		auto bufSize = 48000u;
+		auto samps = RandomSamps(bufSize);
+
+		for (auto blockSize : BlockSizes)
+		{
+			auto src = std::make_shared<AudioBuffer>(bufSize);
+			auto dest = std::make_shared<AudioBuffer>(bufSize);
+			src->OnOverwriteBlock(samps.data(), bufSize, 0);
+			src->EndWrite(bufSize, true);
+
+			runner.Run("AudioBuffer::OnPlay", { { "blockSize", blockSize } }, blockSize, [&]() {
+				src->OnPlay(dest, blockSize);
+				src->EndPlay(blockSize);
+				dest->EndWrite(blockSize, true);
+			});
+		}
+	}
+
+	static void ChannelMixerAdcDac(BenchmarkRunner& runner)
+	{
+		for (auto numChannels : { 2u, 8u })
+		{
+			for (auto blockSize : BlockSizes)
+			{
+				ChannelMixer mixer(ChannelMixerParams({ constants::MaxBlockSize, constants::MaxBlockSize, numChannels, numChannels }));
+				auto inBuf = RandomSamps(blockSize * numChannels);
+				auto outBuf = std::vector<float>(blockSize * numChannels);
+
+				runner.Run("ChannelMixer::FromAdc", { { "channels", numChannels }, { "blockSize", blockSize } }, blockSize, [&]() {
+					mixer.FromAdc(inBuf.data(), numChannels, blockSize);
+				});
+
+				runner.Run("ChannelMixer::ToDac", { { "channels", numChannels }, { "blockSize", blockSize } }, blockSize, [&]() {
+					mixer.ToDac(outBuf.data(), numChannels, blockSize);
+					mixer.Sink()->EndMultiWrite(blockSize, true);
+				});
+			}
+		}
+	}
+
+	static void AudioMixerPlay(BenchmarkRunner& runner)
+	{
+		for (auto numRoutes : { 1u, 2u, 8u })
+		{
+			WireMixBehaviourParams wire;
+			for (auto chan = 0u; chan < numRoutes; chan++)
+				wire.Channels.push_back(chan);
+
+			AudioMixerParams mixerParams;
+			mixerParams.Behaviour = wire;
+
+			for (auto blockSize : BlockSizes)
+			{
+				AudioMixer mixer(mixerParams);
+				ChannelMixer dest(ChannelMixerParams({ 0, constants::MaxBlockSize, 0, 8 }));
+				auto samps = RandomSamps(blockSize);
+
+				runner.Run("AudioMixer::OnPlay", { { "routes", numRoutes }, { "blockSize", blockSize } }, blockSize, [&]() {
+					mixer.OnPlay(dest.Sink(), samps.data(), blockSize, 0);
+					dest.Sink()->EndMultiWrite(blockSize, true);
+				});
+			}
+		}
+	}
+
+	static void BufferBankMinMax(BenchmarkRunner& runner)
+	{
+		auto length = 2u * BufferBank::_BufferBankSize;
+		auto samps = RandomSamps(length);
+
+		BufferBank bank;
+		bank.Reserve(length);
+		bank.SetLength(length, true);
+		bank.Overwrite(0, samps.data(), length);
+		bank.UpdateSummary(0, length);
+
+		for (auto rangeSamps : { (unsigned int)constants::GrainSamps, 48000u })
+		{
+			auto offset = 0ul;
+
+			runner.Run("BufferBank::SubMin", { { "range", rangeSamps } }, rangeSamps, [&]() {
+				MinMaxSink = MinMaxSink + bank.SubMin(offset, offset + rangeSamps);
+				offset = (offset + rangeSamps) % (length - rangeSamps);
+			});
+
+			runner.Run("BufferBank::SubMax", { { "range", rangeSamps } }, rangeSamps, [&]() {
+				MinMaxSink = MinMaxSink + bank.SubMax(offset, offset + rangeSamps);
+				offset = (offset + rangeSamps) % (length - rangeSamps);
+			});
+		}
+
+		for (auto numSamps : { 1024u, 48000u })
+		{
+			auto offset = 0ul;
+
+			runner.Run("BufferBank::UpdateSummary", { { "numSamps", numSamps } }, numSamps, [&]() {
+				bank.UpdateSummary(offset, numSamps);
+				offset = (offset + numSamps) % (length - numSamps);
+			});
+		}
+	}
+
+	static void BufferBankRead(BenchmarkRunner& runner)
+	{
+		auto length = 2u * BufferBank::_BufferBankSize;
+		auto samps = RandomSamps(length);
+
+		// Storage is 0 for float, 1 for int16, 2 for float16 and 3 for compressed
+		for (auto mode : { BufferBank::STORAGE_FLOAT, BufferBank::STORAGE_INT16, BufferBank::STORAGE_FLOAT16, BufferBank::STORAGE_COMPRESSED })
+		{
+			BufferBank bank;
+			bank.Reserve(length);
+			bank.SetLength(length, true);
+			bank.Overwrite(0, samps.data(), length);
+
+			BufferBank::PackedSamps packed;
+			BufferBank::CompressedSamps compressed;
+			BufferBank::SpentSamps spent;
+
+			if (BufferBank::STORAGE_COMPRESSED == mode)
+			{
+				if (bank.CompressInto(compressed))
+					bank.Compress(compressed, spent);
+			}
+			else if (bank.PackInto(mode, packed))
+				bank.Pack(packed, spent);
+
+			for (auto blockSize : BlockSizes)
+			{
+				auto out = std::vector<float>(blockSize);
+				auto offset = 0ul;
+
+				runner.Run("BufferBank::Read", { { "storage", (unsigned int)mode }, { "blockSize", blockSize } }, blockSize, [&]() {
+					bank.Read(offset, out.data(), blockSize);
+					MinMaxSink = MinMaxSink + out[0];
+					offset = (offset + blockSize) % (length - blockSize);
+				});
+			}
+		}
+	}
+
+	void RunAudioBenchmarks(BenchmarkRunner& runner)
+	{
+		AudioBufferPlay(runner);
+		ChannelMixerAdcDac(runner);
+		AudioMixerPlay(runner);
+		BufferBankMinMax(runner);
+		BufferBankRead(runner);
+	}
+}
@@ -0,0 +1,273 @@
+
+#include "../Benchmark.h"
+#include <filesystem>
+#include <fstream>
+#include "audio/ChannelMixer.h"
+#include "engine/JamLoader.h"
+#include "engine/Loop.h"
+#include "engine/LoopModel.h"
+#include "engine/LoopTake.h"
+#include "engine/OfflineRenderer.h"
+#include "engine/Station.h"
+#include "engine/Scene.h"
+#include "io/WavStreamWriter.h"
+
+using audio::AudioMixerParams;
+using audio::BufferBank;
+using audio::ChannelMixer;
+using audio::ChannelMixerParams;
+using audio::WireMixBehaviourParams;
+using engine::Loop;
+using engine::LoopParams;
+using engine::LoopModel;
+using engine::LoopModelParams;
+using engine::LoopTake;
+using engine::LoopTakeParams;
+using engine::JamLoader;
+using engine::JamLoaderParams;
+using engine::OfflineRenderer;
+using engine::OfflineRendererParams;
+using engine::Scene;
+using engine::SceneParams;
+using engine::Station;
+using engine::StationParams;
+
+namespace benchmarks
+{
+	class BenchmarkScene :
+		public Scene
+	{
+	public:
+		BenchmarkScene(SceneParams params, io::UserConfig user) :
+			Scene(params, user)
+		{
+		}
+
+	public:
+		using Scene::AddStation;
+	};
+
+	static const unsigned int LoopLength = 48000u;
+
+	static std::vector<float> RandomSamps(unsigned int numSamps)
+	{
+		auto samps = std::vector<float>(numSamps);
+
+		for (auto i = 0u; i < numSamps; i++)
+			samps[i] = ((rand() % 2000) - 1000) / 1001.0f;
+
+		return samps;
+	}
+
+	static std::shared_ptr<Loop> MakeLoop(unsigned int channel)
+	{
+		WireMixBehaviourParams wire;
+		wire.Channels = { channel };
+		AudioMixerParams mixerParams;
+		mixerParams.Behaviour = wire;
+
+		// Stands in for the scene's job thread, which keeps
+		// recording pages ready for the audio thread
+		BufferBank::Pool().Refill();
+		BufferBank::SummaryPool().Refill();
+
+		return std::make_shared<Loop>(LoopParams(), mixerParams);
+	}
+
+	// Records a loop's intro and body, then sets it playing
+	static std::shared_ptr<Loop> MakePlayingLoop(unsigned int channel, unsigned int length = LoopLength)
+	{
+		auto loop = MakeLoop(channel);
+		auto numSamps = length + constants::MaxLoopFadeSamps;
+		auto samps = RandomSamps(numSamps);
+
+		loop->Record();
+		loop->OnOverwriteBlock(samps.data(), numSamps, 0);
+		loop->EndWrite(numSamps, true);
+		loop->Play(0, length, false);
+
+		return loop;
+	}
+
+	static void LoopPlay(BenchmarkRunner& runner)
+	{
+		// The longer loop spans several buffer banks
+		for (auto length : { LoopLength, 50u * LoopLength })
+		{
+			auto loop = MakePlayingLoop(0, length);
+
+			for (auto blockSize : { 64u, 256u, 1024u })
+			{
+				auto dest = std::make_shared<ChannelMixer>(ChannelMixerParams({ 0, constants::MaxBlockSize, 0, 2 }));
+
+				runner.Run("Loop::OnPlay", { { "length", length }, { "blockSize", blockSize } }, blockSize, [&]() {
+					loop->OnPlay(dest->Sink(), blockSize);
+					loop->EndMultiPlay(blockSize);
+					dest->Sink()->EndMultiWrite(blockSize, true);
+				});
+			}
+		}
+	}
+
+	static void LoopOverwrite(BenchmarkRunner& runner)
+	{
+		auto maxSamps = 20u * LoopLength;
+
+		for (auto blockSize : { 64u, 256u, 1024u })
+		{
+			auto samps = RandomSamps(blockSize);
+			auto loop = MakeLoop(0);
+			auto numWritten = 0u;
+			loop->Record();
+
+			runner.Run("Loop::OnOverwrite", { { "blockSize", blockSize } }, blockSize, [&]() {
+				// Restart before the bank grows without bound
+				if (numWritten > maxSamps)
+				{
+					loop->Record();
+					numWritten = 0;
+				}
+
+				loop->OnOverwriteBlock(samps.data(), blockSize, 0);
+				loop->EndWrite(blockSize, true);
+				numWritten += blockSize;
+			});
+		}
+	}
+
+	static void LoopModelUpdate(BenchmarkRunner& runner)
+	{
+		for (auto length : { LoopLength, 10u * LoopLength })
+		{
+			auto samps = RandomSamps(length);
+			BufferBank bank;
+			bank.Reserve(length);
+			bank.SetLength(length, true);
+			bank.Overwrite(0, samps.data(), length);
+			bank.UpdateSummary(0, length);
+
+			LoopModel model(LoopModelParams{});
+
+			runner.Run("LoopModel::UpdateModel", { { "length", length } }, length, [&]() {
+				model.UpdateModel(bank, length, 40.0f);
+			});
+		}
+	}
+
+	static void SceneSweep(BenchmarkRunner& runner)
+	{
+		if (!runner.IsEnabled("Scene::OnAudio"))
+			return;
+
+		for (auto numStations : { 1u, 4u, 8u })
+		{
+			for (auto numTakes : { 1u, 2u })
+			{
+				for (auto numLoops : { 1u, 4u })
+				{
+					for (auto numChannels : { 2u, 8u })
+					{
+						io::UserConfig user = {};
+						BenchmarkScene scene(SceneParams(base::DrawableParams(), base::SizeableParams()), user);
+
+						for (auto s = 0u; s < numStations; s++)
+						{
+							auto station = std::make_shared<Station>(StationParams());
+
+							for (auto t = 0u; t < numTakes; t++)
+							{
+								auto take = std::make_shared<LoopTake>(LoopTakeParams());
+
+								for (auto l = 0u; l < numLoops; l++)
+									take->AddLoop(MakePlayingLoop(l % numChannels));
+
+								station->AddTake(take);
+							}
+
+							scene.AddStation(station);
+						}
+
+						scene.InitOfflineAudio(numChannels, numChannels);
+
+						for (auto blockSize : { 32u, 128u, 512u, 4096u })
+						{
+							auto inBuf = RandomSamps(blockSize * numChannels);
+							auto outBuf = std::vector<float>(blockSize * numChannels);
+
+							runner.Run("Scene::OnAudio",
+								{ { "stations", numStations },
+									{ "takes", numTakes },
+									{ "loops", numLoops },
+									{ "channels", numChannels },
+									{ "blockSize", blockSize } },
+								blockSize,
+								[&]() { scene.RenderOfflineAudio(inBuf.data(), outBuf.data(), blockSize); });
+						}
+					}
+				}
+			}
+		}
+	}
+
+	static void JamStartup(BenchmarkRunner& runner)
+	{
+		if (!runner.IsEnabled("OfflineRenderer::MeasureStartup"))
+			return;
+
+		const auto numLoops = 8u;
+		const auto loopLength = 100000u;
+		auto dir = std::filesystem::temp_directory_path() / "jamma_startup_bench";
+		std::filesystem::create_directories(dir);
+
+		std::vector<float> samps(constants::MaxLoopFadeSamps + loopLength, 0.1f);
+		std::string loopsJson;
+
+		for (auto loop = 0u; loop < numLoops; loop++)
+		{
+			auto name = "Loop" + std::to_string(loop) + ".wav";
+
+			io::WavStreamWriter writer;
+			writer.Open((dir / name).wstring(), 1, 44100);
+			writer.Write(samps.data(), (unsigned int)samps.size());
+			writer.Close();
+
+			loopsJson += (loop > 0 ? "," : "") + std::string("{\"name\":\"") + name + "\",\"length\":" + std::to_string(loopLength) + ",\"mix\":{\"type\":\"pan\",\"chans\":[0.5,0.5]}}";
+		}
+
+		std::ofstream(dir / "bench.jam") << "{\"name\":\"bench\",\"stations\":[{\"name\":\"Station\",\"stationtype\":0,\"takes\":[{\"name\":\"Take1\",\"loops\":[" << loopsJson << "]}]}],\"quantisesamps\":" << loopLength << ",\"quantisation\":\"multiple\"}";
+		std::ofstream(dir / "bench.rig") << "{\"name\":\"bench\",\"user\":{\"audio\":{\"name\":\"default\",\"bufsize\":512,\"latency\":3000,\"numchannelsin\":2,\"numchannelsout\":2},\"loop\":{\"fadeTime\":400},\"trigger\":{\"preDelay\":400,\"debounceSamps\":280}}}";
+
+		OfflineRendererParams params;
+		params.BlockSize = 256;
+		params.SampleRate = 44100;
+		params.NumInputChannels = 0;
+		params.NumOutputChannels = 2;
+		params.NumSamps = 0;
+
+		OfflineRenderer renderer(params);
+		auto sceneParams = SceneParams(base::DrawableParams(), base::SizeableParams());
+
+		for (auto numWorkers : { 0u, JamLoader::DefaultParams().NumWorkers })
+		{
+			JamLoaderParams loaderParams;
+			loaderParams.NumWorkers = numWorkers;
+
+			// Timed to the first audio block, loading included
+			runner.Run("OfflineRenderer::MeasureStartup", { { "loops", numLoops }, { "workers", numWorkers } }, numLoops * loopLength, [&]() {
+				renderer.MeasureStartup(sceneParams, (dir / "bench.jam").wstring(), (dir / "bench.rig").wstring(), loaderParams);
+			});
+		}
+
+		std::error_code err;
+		std::filesystem::remove_all(dir, err);
+	}
+
+	void RunEngineBenchmarks(BenchmarkRunner& runner)
+	{
+		LoopPlay(runner);
+		LoopOverwrite(runner);
+		LoopModelUpdate(runner);
+		SceneSweep(runner);
+		JamStartup(runner);
+	}
+}
@@ -0,0 +1,56 @@
+
+#include "../Benchmark.h"
+#include <sstream>
+#include "io/Json.h"
+
+using io::Json;
+
+namespace benchmarks
+{
+	class BenchmarkJson :
+		public Json
+	{
+	public:
+		using Json::ParseValue;
+	};
+
+	static const std::vector<std::string> JsonCorpus = {
+		"{\"bool\":true}",
+		"{\"int\":-12}",
+		"{\"ulong\":2147483648}",
+		"{\"double\":0.34}",
+		"{\"string\":\"hello\",\"int\":-7}",
+		"{\"arr\":[-3,4]}",
+		"{\"arr\":[1.1,2.2]}",
+		"{\"arr\":[\"hello\",\"you\"]}",
+		"{\"struct\":{\"name\":\"you\",\"business\":\"monkeying\"}}"
+	};
+
+	static void JsonParse(BenchmarkRunner& runner)
+	{
+		// The corpus is repeated into one large document
+		std::string doc = "{";
+		for (auto i = 0u; i < 1000u; i++)
+		{
+			for (auto j = 0u; j < JsonCorpus.size(); j++)
+				doc += (doc.size() > 1 ? ",\"" : "\"") + std::to_string(i) + "_" + std::to_string(j) + "\":" + JsonCorpus[j];
+		}
+		doc += "}";
+
+		auto numBytes = (unsigned int)doc.size();
+
+		// Samples here are bytes of json
+		runner.Run("Json::ParseValue", { { "bytes", numBytes } }, numBytes, [&]() {
+			BenchmarkJson::ParseValue(std::stringstream(doc));
+		});
+
+		runner.Run("Json::FromString", { { "bytes", numBytes } }, numBytes, [&]() {
+			Json::FromString(doc);
+		});
+	}
+
+	void RunIoBenchmarks(BenchmarkRunner& runner)
+	{
+		JsonParse(runner);
+	}
+}
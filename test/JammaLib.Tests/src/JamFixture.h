@@ -0,0 +1,96 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "io/JamFile.h"
+#include "io/WavStreamWriter.h"
+
+// A jam in its own temp directory, with a wav written for every
+// loop. Each station gets the same loops, with the samples for
+// loop n being (fadeSamps + 1000 + n) steps of a 1/100 ramp.
+class JamFixture
+{
+public:
+	JamFixture(std::string name,
+		unsigned int numStations,
+		unsigned int numLoops,
+		unsigned int fadeSamps) :
+		Dir(std::filesystem::temp_directory_path() / ("jamma_" + name + "_test")),
+		Jam(),
+		Samps()
+	{
+		std::filesystem::create_directories(Dir);
+
+		Jam.Version = io::JamFile::VERSION_V;
+		Jam.Name = name;
+		Jam.TimerTicks = 0;
+		Jam.QuantiseSamps = 1000u;
+		Jam.Quantisation = engine::Timer::QUANTISE_POWER;
+
+		for (auto loopNum = 0u; loopNum < numLoops; loopNum++)
+		{
+			std::vector<float> samps(fadeSamps + 1000u + loopNum);
+
+			for (auto i = 0u; i < samps.size(); i++)
+				samps[i] = (float)((i + loopNum) % 100) / 100.0f;
+
+			Samps.push_back(samps);
+		}
+
+		for (auto stationNum = 0u; stationNum < numStations; stationNum++)
+		{
+			io::JamFile::LoopTake take;
+			take.Name = "Take1";
+
+			for (auto loopNum = 0u; loopNum < numLoops; loopNum++)
+			{
+				io::JamFile::Loop loop = {};
+				loop.Name = "loop" + std::to_string(stationNum) + "_" + std::to_string(loopNum) + ".wav";
+				loop.Length = 1000ul + loopNum;
+				loop.Level = 0.5;
+				loop.Speed = 1.0;
+				loop.Mix.Mix = io::JamFile::LoopMix::MIX_WIRE;
+				loop.Mix.Params = std::vector<unsigned long>({ loopNum });
+				take.Loops.push_back(loop);
+
+				io::WavStreamWriter writer;
+				writer.Open((Dir / loop.Name).wstring(), 1u, SampleRate);
+				writer.Write(Samps[loopNum].data(), (unsigned int)Samps[loopNum].size());
+				writer.Close();
+			}
+
+			io::JamFile::Station station;
+			station.Name = "Station" + std::to_string(stationNum + 1);
+			station.StationType = 0;
+			station.LoopTakes.push_back(take);
+			Jam.Stations.push_back(station);
+		}
+	}
+
+	~JamFixture()
+	{
+		std::error_code err;
+		std::filesystem::remove_all(Dir, err);
+	}
+
+public:
+	// Written next to the wavs, as the loader expects
+	std::filesystem::path WriteJam() const
+	{
+		auto file = Dir / (Jam.Name + ".jam");
+
+		std::ofstream stream(file);
+		io::JamFile::ToStream(Jam, stream);
+
+		return file;
+	}
+
+public:
+	static const unsigned int SampleRate = 48000u;
+
+	std::filesystem::path Dir;
+	io::JamFile Jam;
+	std::vector<std::vector<float>> Samps;
+};
@@ -276,3 +276,112 @@ TEST(AudioBuffer, ExcessiveDelayPlaysNicely) {
 
 	ASSERT_TRUE(sink->IsZero());
 }
+
+TEST(AudioBuffer, BlockWriteMatchesSampleWrite) {
+	auto bufSize = constants::MaxBlockSize;
+	auto blockSize = 1000u;
+
+	auto blockBuf = std::make_shared<AudioBuffer>(bufSize);
+	auto sampBuf = std::make_shared<AudioBuffer>(bufSize);
+
+	std::vector<float> samps(blockSize);
+	for (auto i = 0u; i < blockSize; i++)
+		samps[i] = ((rand() % 2000) - 1000) / 1001.0f;
+
+	auto numBlocks = (bufSize * 2) / blockSize;
+	for (auto block = 0u; block < numBlocks; block++)
+	{
+		blockBuf->OnWriteBlock(samps.data(), blockSize, 0);
+		blockBuf->EndWrite(blockSize, true);
+
+		auto offset = 0;
+		for (auto i = 0u; i < blockSize; i++)
+			offset = sampBuf->OnWrite(samps[i], offset);
+		sampBuf->EndWrite(blockSize, true);
+	}
+
+	ASSERT_TRUE(std::equal(blockBuf->Start(), blockBuf->End(), sampBuf->Start()));
+}
+
+TEST(AudioBuffer, ZeroWrapsAround) {
+	auto bufSize = constants::MaxBlockSize;
+	auto blockSize = 1000u;
+
+	auto audioBuf = std::make_shared<AudioBuffer>(bufSize);
+
+	std::vector<float> samps(bufSize, 1.0f);
+	audioBuf->OnOverwriteBlock(samps.data(), bufSize, 0);
+	audioBuf->EndWrite(bufSize - (blockSize / 2), true);
+
+	audioBuf->Zero(blockSize);
+
+	auto numZeros = (unsigned int)std::count(audioBuf->Start(), audioBuf->End(), 0.0f);
+	ASSERT_EQ(blockSize, numZeros);
+	ASSERT_EQ(0.0f, *audioBuf->Start());
+	ASSERT_EQ(0.0f, *(audioBuf->End() - 1));
+}
+
+TEST(AudioBuffer, PowerOfTwoRoundsUpSize) {
+	auto audioBuf = AudioBuffer(constants::MaxBlockSize + 1, AudioBuffer::SIZE_POWEROFTWO);
+	ASSERT_EQ(constants::MaxBlockSize * 2, audioBuf.BufSize());
+
+	audioBuf.SetSize(100);
+	ASSERT_EQ(constants::MaxBlockSize, audioBuf.BufSize());
+
+	auto exactBuf = AudioBuffer(constants::MaxBlockSize + 1);
+	ASSERT_EQ(constants::MaxBlockSize + 1, exactBuf.BufSize());
+}
+
+TEST(AudioBuffer, PowerOfTwoMatchesExact) {
+	auto bufSize = constants::MaxBlockSize;
+	auto blockSize = 1000u;
+
+	auto exactBuf = std::make_shared<AudioBuffer>(bufSize);
+	auto pow2Buf = std::make_shared<AudioBuffer>(bufSize, AudioBuffer::SIZE_POWEROFTWO);
+
+	std::vector<float> samps(blockSize);
+	for (auto i = 0u; i < blockSize; i++)
+		samps[i] = ((rand() % 2000) - 1000) / 1001.0f;
+
+	auto numBlocks = (bufSize * 2) / blockSize;
+	for (auto block = 0u; block < numBlocks; block++)
+	{
+		for (auto& buf : { exactBuf, pow2Buf })
+		{
+			buf->OnWriteBlock(samps.data(), blockSize, 0);
+
+			auto offset = 0;
+			for (auto i = 0u; i < blockSize; i++)
+				offset = buf->OnWrite(samps[i], offset);
+
+			buf->EndWrite(blockSize, true);
+		}
+	}
+
+	ASSERT_TRUE(std::equal(exactBuf->Start(), exactBuf->End(), pow2Buf->Start()));
+}
+
+TEST(AudioBuffer, SpansSplitAtWrap) {
+	auto bufSize = constants::MaxBlockSize;
+	auto blockSize = 1000u;
+
+	auto audioBuf = std::make_shared<AudioBuffer>(bufSize, AudioBuffer::SIZE_POWEROFTWO);
+	audioBuf->EndWrite(bufSize - 100, true);
+
+	auto spans = audioBuf->WriteSpans(0, blockSize);
+	ASSERT_EQ(&*audioBuf->End() - 100, spans.First);
+	ASSERT_EQ(100u, spans.NumFirst);
+	ASSERT_EQ(&*audioBuf->Start(), spans.Second);
+	ASSERT_EQ(blockSize - 100, spans.NumSecond);
+
+	spans = audioBuf->WriteSpans(200, blockSize);
+	ASSERT_EQ(&*audioBuf->Start() + 100, spans.First);
+	ASSERT_EQ(blockSize, spans.NumFirst);
+	ASSERT_EQ(0u, spans.NumSecond);
+
+	audioBuf->Delay(50);
+	spans = audioBuf->ReadSpans(blockSize);
+	ASSERT_EQ(&*audioBuf->End() - 150, spans.First);
+	ASSERT_EQ(150u, spans.NumFirst);
+	ASSERT_EQ(blockSize - 150, spans.NumSecond);
+}
@@ -1,9 +1,17 @@
 
 #include "gtest/gtest.h"
 #include "audio/BufferBank.h"
+#include <cmath>
 
 using audio::BufferBank;
 
+// Stands in for the scene's job thread, which keeps the pools topped up
+void RefillPools()
+{
+	BufferBank::Pool().Refill();
+	BufferBank::SummaryPool().Refill();
+}
+
 class BufferBankSource
 {
 public:
@@ -49,8 +57,19 @@ private:
 	std::vector<float> Samples;
 };
 
+// Holds the bank mid-change, as the audio thread
+// does while swapping its storage
+class ChangingBank :
+	public BufferBank
+{
+public:
+	void Begin() { BeginChange(); }
+	void End() { EndChange(); }
+};
+
 TEST(BufferBank, Resizes) {
 	BufferBank bank;
+	RefillPools();
 	auto initCapacity = bank.Capacity();
 
 	BufferBankSource source(initCapacity + 10);
@@ -66,6 +85,7 @@ TEST(BufferBank, StoresCorrectValues) {
 	auto recordSamps = 100;
 
 	BufferBank bank;
+	RefillPools();
 	BufferBankSource source(recordSamps);
 
 	source.Fill(bank);
@@ -75,6 +95,7 @@ TEST(BufferBank, StoresCorrectValues) {
 
 TEST(BufferBank, StoresCorrectValuesDuringResize) {
 	BufferBank bank;
+	RefillPools();
 	auto initCapacity = bank.Capacity();
 
 	BufferBankSource source(initCapacity + 10);
@@ -83,3 +104,552 @@ TEST(BufferBank, StoresCorrectValuesDuringResize) {
 
 	ASSERT_TRUE(source.Matches(bank));
 }
+
+TEST(BufferBank, GrowsFromPool) {
+	RefillPools();
+
+	auto& pool = BufferBank::Pool();
+	auto initMisses = pool.NumMisses();
+
+	BufferBank bank;
+	bank.SetLength(BufferBank::_BufferBankSize * 2, true);
+
+	ASSERT_TRUE(bank.Capacity() > BufferBank::_BufferBankSize * 2);
+	ASSERT_EQ(initMisses, pool.NumMisses());
+}
+
+TEST(BufferBank, FallsShortWhenPoolIsDry) {
+	RefillPools();
+
+	auto& pool = BufferBank::Pool();
+	std::vector<std::unique_ptr<float[]>> pages;
+
+	while (pool.NumFree() > 0u)
+		pages.push_back(pool.Acquire());
+
+	BufferBank bank;
+	bank.SetLength(1000ul, true);
+
+	ASSERT_EQ(0ul, bank.Capacity());
+	ASSERT_EQ(0ul, bank.Length());
+
+	for (auto& page : pages)
+		pool.Release(std::move(page));
+
+	RefillPools();
+	bank.SetLength(1000ul, true);
+
+	ASSERT_EQ(1000ul, bank.Length());
+	ASSERT_LT(1000ul, bank.Capacity());
+}
+
+TEST(BufferBank, ReadSpanStopsAtBank) {
+	BufferBank bank;
+	RefillPools();
+	BufferBankSource source(BufferBank::_BufferBankSize + 100);
+	source.Fill(bank);
+
+	auto [samps, numSamps] = bank.ReadSpan(BufferBank::_BufferBankSize - 10, 50);
+	ASSERT_EQ(&bank[BufferBank::_BufferBankSize - 10], samps);
+	ASSERT_EQ(10u, numSamps);
+
+	std::tie(samps, numSamps) = bank.ReadSpan(BufferBank::_BufferBankSize, 50);
+	ASSERT_EQ(&bank[BufferBank::_BufferBankSize], samps);
+	ASSERT_EQ(50u, numSamps);
+
+	std::tie(samps, numSamps) = bank.ReadSpan(bank.Capacity(), 50);
+	ASSERT_EQ(nullptr, samps);
+	ASSERT_EQ(0u, numSamps);
+}
+
+TEST(BufferBank, SummaryMatchesScan) {
+	auto numSamps = BufferBank::_BufferBankSize + 5000u;
+
+	BufferBank bank;
+	RefillPools();
+	std::vector<float> samps(numSamps);
+	for (auto& samp : samps)
+		samp = ((rand() % 2000) - 1000) / 1001.0f;
+
+	// Written in uneven blocks, as recording would
+	bank.SetLength(numSamps, true);
+	for (auto index = 0u; index < numSamps; index += 333u)
+	{
+		auto blockSamps = std::min(333u, numSamps - index);
+		bank.Overwrite(index, samps.data() + index, blockSamps);
+		bank.UpdateSummary(index, blockSamps);
+	}
+
+	std::vector<std::pair<unsigned long, unsigned long>> ranges = {
+		{ 0ul, 1ul },
+		{ 10ul, 50ul },
+		{ 64ul, 128ul },
+		{ 1000ul, 2100ul },
+		{ 5ul, 700000ul },
+		{ BufferBank::_BufferBankSize - 1000ul, BufferBank::_BufferBankSize + 1000ul },
+		{ 0ul, numSamps } };
+
+	for (auto [i1, i2] : ranges)
+	{
+		auto min = samps[i1];
+		auto max = samps[i1];
+		auto sumSquares = 0.0;
+		for (auto i = i1; i < i2; i++)
+		{
+			min = std::min(min, samps[i]);
+			max = std::max(max, samps[i]);
+			sumSquares += samps[i] * samps[i];
+		}
+
+		auto summary = bank.Summary(i1, i2);
+		ASSERT_EQ(min, summary.Min);
+		ASSERT_EQ(max, summary.Max);
+		ASSERT_NEAR(std::sqrt(sumSquares / (double)(i2 - i1)), summary.Rms, 1e-3);
+	}
+}
+
+TEST(BufferBank, SummaryFollowsOverwrite) {
+	BufferBank bank;
+	RefillPools();
+	std::vector<float> samps(1000, 0.1f);
+
+	bank.SetLength(1000, true);
+	bank.Overwrite(0, samps.data(), 1000);
+	bank.UpdateSummary(0, 1000);
+
+	ASSERT_TRUE(bank.IsSilent(0, 1000, 0.2f));
+
+	auto loud = -0.9f;
+	bank.Overwrite(500, &loud, 1);
+	bank.UpdateSummary(500, 1);
+
+	ASSERT_FALSE(bank.IsSilent(0, 1000, 0.2f));
+	ASSERT_TRUE(bank.IsSilent(0, 500, 0.2f));
+	ASSERT_EQ(-0.9f, bank.SubMin(100, 900));
+	ASSERT_EQ(0.1f, bank.SubMax(100, 900));
+}
+
+TEST(BufferBank, SummaryIsSilentMidChange) {
+	ChangingBank bank;
+	RefillPools();
+	std::vector<float> samps(1000, 0.5f);
+
+	bank.SetLength(1000, true);
+	bank.Overwrite(0, samps.data(), 1000);
+	bank.UpdateSummary(0, 1000);
+
+	bank.Begin();
+	ASSERT_EQ(0.0f, bank.SubMax(0, 1000));
+
+	bank.End();
+	ASSERT_EQ(0.5f, bank.SubMax(0, 1000));
+}
+
+TEST(BufferBank, MappedSampsReadInPlace) {
+	BufferBank bank;
+	RefillPools();
+	auto samps = std::make_shared<std::vector<float>>(BufferBank::_BufferBankSize + 1000u, 0.25f);
+	(*samps)[BufferBank::_BufferBankSize + 10u] = -0.75f;
+
+	bank.Map(samps, samps->data(), (unsigned long)samps->size());
+	bank.UpdateSummary(0, bank.Length());
+
+	ASSERT_TRUE(bank.IsMapped());
+	ASSERT_EQ(samps->size(), bank.Length());
+	ASSERT_EQ(samps->data() + 5u, std::get<0>(bank.ReadSpan(5u, 10u)));
+	ASSERT_EQ(990u, std::get<1>(bank.ReadSpan(BufferBank::_BufferBankSize + 10u, 2000u)));
+	ASSERT_EQ(-0.75f, bank.SubMin(0, bank.Length()));
+	ASSERT_EQ(nullptr, std::get<0>(bank.WriteSpan(0, 10u)));
+
+	// Writes are dropped until unmapped
+	bank[0] = 0.5f;
+	ASSERT_EQ(0.25f, ((const BufferBank&)bank)[0]);
+}
+
+TEST(BufferBank, UnmapCopiesSamps) {
+	BufferBank bank;
+	RefillPools();
+	auto samps = std::make_shared<std::vector<float>>(3000u, 0.25f);
+
+	bank.Map(samps, samps->data(), (unsigned long)samps->size());
+	bank.UpdateSummary(0, bank.Length());
+	bank.Unmap();
+
+	ASSERT_FALSE(bank.IsMapped());
+	ASSERT_EQ(3000u, bank.Length());
+	ASSERT_NE(samps->data(), std::get<0>(bank.ReadSpan(0, 10u)));
+	ASSERT_EQ(0.25f, bank.SubMax(0, 3000));
+
+	bank[0] = 0.5f;
+	bank.UpdateSummary(0, 1);
+	ASSERT_EQ(0.5f, bank.SubMax(0, 3000));
+	ASSERT_EQ(0.25f, (*samps)[0]);
+}
+
+TEST(BufferBank, SnapshotReadsEverySamp) {
+	BufferBank bank;
+	RefillPools();
+	auto length = BufferBank::_BufferBankSize + 1000ul;
+	bank.SetLength(length, true);
+
+	for (auto i = 0ul; i < length; i++)
+		bank[i] = (float)(i % 100);
+
+	std::vector<float> samps;
+	auto isTaken = bank.Snapshot(bank.Generation(), length, [&](const float* buf, unsigned int numSamps) {
+		samps.insert(samps.end(), buf, buf + numSamps);
+		return true;
+	});
+
+	ASSERT_TRUE(isTaken);
+	ASSERT_EQ(length, samps.size());
+	ASSERT_EQ(99.0f, samps[BufferBank::_BufferBankSize + 99u]);
+}
+
+TEST(BufferBank, SnapshotFailsWhenRecordedOver) {
+	BufferBank bank;
+	RefillPools();
+	auto length = 3ul * BufferBank::_BufferBankSize;
+	bank.SetLength(length, true);
+
+	auto generation = bank.Generation();
+	auto numBanks = bank.Capacity() / BufferBank::_BufferBankSize;
+	auto numSpans = 0u;
+
+	auto isTaken = bank.Snapshot(generation, length, [&](const float* buf, unsigned int numSamps) {
+		// Recording afresh part way through
+		if (0u == numSpans++)
+			bank.SetLength(10ul, true);
+
+		return true;
+	});
+
+	ASSERT_FALSE(isTaken);
+	ASSERT_EQ(1u, numSpans);
+	ASSERT_NE(generation, bank.Generation());
+
+	// Pages were held back until the snapshot finished
+	ASSERT_EQ(numBanks * BufferBank::_BufferBankSize, bank.Capacity());
+	bank.UpdateCapacity();
+	ASSERT_GT(numBanks * BufferBank::_BufferBankSize, bank.Capacity());
+
+	ASSERT_FALSE(bank.Snapshot(generation, 10ul, [](const float*, unsigned int) { return true; }));
+}
+
+TEST(BufferBank, PackedSampsReadBack) {
+	auto length = BufferBank::_BufferBankSize + 3000ul;
+
+	for (auto mode : { BufferBank::STORAGE_INT16, BufferBank::STORAGE_FLOAT16 })
+	{
+		BufferBank bank;
+		RefillPools();
+		bank.SetLength(length, true);
+
+		for (auto i = 0ul; i < length; i++)
+			bank[i] = (float)((long)(i % 200) - 100) / 128.0f;
+
+		bank.UpdateSummary(0, length);
+
+		BufferBank::PackedSamps packed;
+		BufferBank::SpentSamps spent;
+		ASSERT_TRUE(bank.PackInto(mode, packed));
+		ASSERT_TRUE(bank.Pack(packed, spent));
+		ASSERT_TRUE(bank.IsPacked());
+		ASSERT_EQ(mode, bank.Storage());
+		ASSERT_EQ(length, bank.Length());
+		ASSERT_EQ(nullptr, std::get<0>(bank.ReadSpan(0, 10u)));
+
+		// Values on a 1/128 grid survive both modes exactly
+		std::vector<float> samps(length);
+		ASSERT_EQ(length, bank.Read(0, samps.data(), (unsigned int)length));
+
+		for (auto i = 0ul; i < length; i++)
+			ASSERT_EQ((float)((long)(i % 200) - 100) / 128.0f, samps[i]);
+
+		ASSERT_EQ(-100.0f / 128.0f, bank.SubMin(3, BufferBank::_BufferBankSize + 7ul));
+		ASSERT_EQ(99.0f / 128.0f, bank.SubMax(0, length));
+
+		std::vector<float> snapshot;
+		ASSERT_TRUE(bank.Snapshot(bank.Generation(), length, [&](const float* buf, unsigned int numSamps) {
+			snapshot.insert(snapshot.end(), buf, buf + numSamps);
+			return true;
+		}));
+		ASSERT_EQ(samps, snapshot);
+	}
+}
+
+TEST(BufferBank, PackingHalvesStorage) {
+	BufferBank bank;
+	RefillPools();
+	auto length = 4ul * BufferBank::_BufferBankSize;
+	bank.SetLength(length, true);
+
+	auto floatBytes = BufferBank::StorageBytes(BufferBank::STORAGE_FLOAT);
+	auto int16Bytes = BufferBank::StorageBytes(BufferBank::STORAGE_INT16);
+	auto numBanks = bank.Capacity() / BufferBank::_BufferBankSize;
+
+	BufferBank::PackedSamps packed;
+	BufferBank::SpentSamps spent;
+	ASSERT_TRUE(bank.PackInto(BufferBank::STORAGE_INT16, packed));
+	ASSERT_TRUE(bank.Pack(packed, spent));
+
+	// The float pages are handed out rather than released
+	ASSERT_EQ(numBanks, spent.Pages.size());
+
+	auto pageBytes = BufferBank::_BufferBankSize * sizeof(float);
+	ASSERT_EQ(floatBytes - numBanks * pageBytes, BufferBank::StorageBytes(BufferBank::STORAGE_FLOAT));
+	ASSERT_EQ(int16Bytes + 2u * pageBytes, BufferBank::StorageBytes(BufferBank::STORAGE_INT16));
+
+	bank.Init();
+	ASSERT_EQ(int16Bytes, BufferBank::StorageBytes(BufferBank::STORAGE_INT16));
+}
+
+TEST(BufferBank, UnpackTakesWrites) {
+	BufferBank bank;
+	RefillPools();
+	bank.SetLength(5000ul, true);
+
+	for (auto i = 0ul; i < 5000ul; i++)
+		bank[i] = 0.25f;
+
+	BufferBank::PackedSamps packed;
+	BufferBank::SpentSamps spent;
+	ASSERT_TRUE(bank.PackInto(BufferBank::STORAGE_FLOAT16, packed));
+	ASSERT_TRUE(bank.Pack(packed, spent));
+
+	// Writes are dropped until unpacked
+	bank[0] = 0.5f;
+	ASSERT_EQ(nullptr, std::get<0>(bank.WriteSpan(0, 10u)));
+
+	bank.Unpack();
+	ASSERT_FALSE(bank.IsPacked());
+	ASSERT_EQ(5000ul, bank.Length());
+	ASSERT_EQ(0.25f, ((const BufferBank&)bank)[4999]);
+
+	bank[0] = 0.5f;
+	ASSERT_EQ(0.5f, ((const BufferBank&)bank)[0]);
+}
+
+TEST(BufferBank, PackFailsWhenRecordedOver) {
+	BufferBank bank;
+	RefillPools();
+	bank.SetLength(5000ul, true);
+
+	BufferBank::PackedSamps packed;
+	ASSERT_TRUE(bank.PackInto(BufferBank::STORAGE_INT16, packed));
+
+	bank.SetLength(10ul, true);
+
+	BufferBank::SpentSamps spent;
+	ASSERT_FALSE(bank.Pack(packed, spent));
+	ASSERT_FALSE(bank.IsPacked());
+	ASSERT_TRUE(packed.Pages.empty());
+	ASSERT_EQ(1u, spent.Pages.size());
+	ASSERT_FALSE(bank.PackInto(BufferBank::STORAGE_FLOAT, packed));
+}
+
+TEST(BufferBank, PackWaitsForRoomToHandOut) {
+	BufferBank bank;
+	RefillPools();
+	bank.SetLength(5000ul, true);
+
+	BufferBank::PackedSamps packed;
+	ASSERT_TRUE(bank.PackInto(BufferBank::STORAGE_INT16, packed));
+
+	// Handing out must never allocate on the audio thread
+	BufferBank::SpentSamps spent;
+	std::vector<std::unique_ptr<float[]>>().swap(spent.Pages);
+
+	ASSERT_FALSE(bank.Pack(packed, spent));
+	ASSERT_FALSE(bank.IsPacked());
+	ASSERT_EQ(1u, packed.Pages.size());
+	ASSERT_TRUE(spent.IsEmpty());
+
+	BufferBank::SpentSamps roomySpent;
+	ASSERT_TRUE(bank.Pack(packed, roomySpent));
+	ASSERT_TRUE(bank.IsPacked());
+}
+
+TEST(BufferBank, CompressedSampsReadBack) {
+	auto length = BufferBank::_BufferBankSize + 3000ul;
+
+	BufferBank bank;
+	RefillPools();
+	bank.SetLength(length, true);
+
+	for (auto i = 0ul; i < length; i++)
+		bank[i] = (float)((long)(i % 200) - 100) / 32768.0f;
+
+	bank.UpdateSummary(0, length);
+
+	auto floatBytes = BufferBank::StorageBytes(BufferBank::STORAGE_FLOAT);
+	auto numBanks = bank.Capacity() / BufferBank::_BufferBankSize;
+
+	BufferBank::CompressedSamps compressed;
+	BufferBank::SpentSamps spent;
+	ASSERT_TRUE(bank.CompressInto(compressed));
+	ASSERT_TRUE(bank.Compress(compressed, spent));
+	ASSERT_TRUE(bank.IsPacked());
+	ASSERT_EQ(BufferBank::STORAGE_COMPRESSED, bank.Storage());
+	ASSERT_EQ(length, bank.Length());
+
+	auto pageBytes = BufferBank::_BufferBankSize * sizeof(float);
+	ASSERT_EQ(floatBytes - numBanks * pageBytes, BufferBank::StorageBytes(BufferBank::STORAGE_FLOAT));
+	ASSERT_LT(0ull, BufferBank::StorageBytes(BufferBank::STORAGE_COMPRESSED));
+	ASSERT_GT(length * sizeof(float) / 4u, BufferBank::StorageBytes(BufferBank::STORAGE_COMPRESSED));
+
+	std::vector<float> samps(5000u);
+	auto index = BufferBank::_BufferBankSize - 2500ul;
+	ASSERT_EQ(5000u, bank.Read(index, samps.data(), 5000u));
+
+	for (auto i = 0u; i < 5000u; i++)
+		ASSERT_EQ((float)((long)((index + i) % 200) - 100) / 32768.0f, samps[i]);
+
+	ASSERT_EQ(-100.0f / 32768.0f, bank.SubMin(3, length));
+}
+
+TEST(BufferBank, RestoreHandsBackCompressedData) {
+	BufferBank bank;
+	RefillPools();
+	bank.SetLength(5000ul, true);
+
+	for (auto i = 0ul; i < 5000ul; i++)
+		bank[i] = (float)(i % 7) / 8.0f;
+
+	BufferBank::CompressedSamps compressed;
+	BufferBank::SpentSamps spent;
+	ASSERT_TRUE(bank.CompressInto(compressed));
+	ASSERT_TRUE(bank.Compress(compressed, spent));
+	ASSERT_EQ(1u, spent.Pages.size());
+
+	auto compressedBytes = BufferBank::StorageBytes(BufferBank::STORAGE_COMPRESSED);
+
+	BufferBank::PackedSamps restored;
+	BufferBank::SpentSamps restoreSpent;
+	ASSERT_TRUE(bank.RestoreInto(restored));
+	ASSERT_TRUE(bank.Restore(restored, restoreSpent));
+
+	ASSERT_FALSE(bank.IsPacked());
+	ASSERT_TRUE(restoreSpent.Pages.empty());
+	ASSERT_FALSE(restoreSpent.Data.empty());
+	ASSERT_EQ(compressedBytes - restoreSpent.Data.size(), BufferBank::StorageBytes(BufferBank::STORAGE_COMPRESSED));
+	ASSERT_EQ(1.0f / 8.0f, ((const BufferBank&)bank)[4999]);
+
+	bank[0] = 0.5f;
+	ASSERT_EQ(0.5f, ((const BufferBank&)bank)[0]);
+}
+
+TEST(BufferBank, UnpackDecompresses) {
+	BufferBank bank;
+	RefillPools();
+	bank.SetLength(5000ul, true);
+
+	for (auto i = 0ul; i < 5000ul; i++)
+		bank[i] = 0.25f;
+
+	BufferBank::CompressedSamps compressed;
+	BufferBank::SpentSamps spent;
+	ASSERT_TRUE(bank.CompressInto(compressed));
+	ASSERT_TRUE(bank.Compress(compressed, spent));
+
+	bank.Unpack();
+	ASSERT_FALSE(bank.IsPacked());
+	ASSERT_EQ(0.25f, ((const BufferBank&)bank)[4999]);
+
+	BufferBank::PackedSamps restored;
+	ASSERT_FALSE(bank.RestoreInto(restored));
+}
+
+TEST(BufferBank, CompressFailsWhenRecordedOver) {
+	BufferBank bank;
+	RefillPools();
+	bank.SetLength(5000ul, true);
+
+	BufferBank::CompressedSamps compressed;
+	ASSERT_TRUE(bank.CompressInto(compressed));
+
+	bank.SetLength(10ul, true);
+
+	BufferBank::SpentSamps spent;
+	ASSERT_FALSE(bank.Compress(compressed, spent));
+	ASSERT_FALSE(bank.IsPacked());
+	ASSERT_TRUE(spent.IsEmpty());
+}
+
+TEST(BufferBank, RestoreTakesMappedSampsForWrites) {
+	BufferBank bank;
+	RefillPools();
+	auto samps = std::make_shared<std::vector<float>>(3000u, 0.25f);
+
+	bank.Map(samps, samps->data(), (unsigned long)samps->size());
+	bank.UpdateSummary(0, bank.Length());
+
+	// Left mapped rather than copied on the audio thread
+	bank.SetLength(3000ul, true);
+	ASSERT_TRUE(bank.IsMapped());
+
+	BufferBank::PackedSamps restored;
+	BufferBank::SpentSamps spent;
+	ASSERT_TRUE(bank.RestoreInto(restored));
+	ASSERT_TRUE(bank.Restore(restored, spent));
+
+	ASSERT_FALSE(bank.IsMapped());
+	ASSERT_EQ(samps, spent.Mapping);
+	ASSERT_EQ(3000u, bank.Length());
+	ASSERT_EQ(0.25f, ((const BufferBank&)bank)[2999]);
+
+	bank[0] = 0.5f;
+	ASSERT_EQ(0.5f, ((const BufferBank&)bank)[0]);
+}
+
+TEST(BufferBank, RestoreFailsWhenRecordedOver) {
+	BufferBank bank;
+	RefillPools();
+	bank.SetLength(5000ul, true);
+
+	BufferBank::PackedSamps packed;
+	BufferBank::SpentSamps spent;
+	ASSERT_TRUE(bank.PackInto(BufferBank::STORAGE_INT16, packed));
+	ASSERT_TRUE(bank.Pack(packed, spent));
+
+	BufferBank::PackedSamps restored;
+	ASSERT_TRUE(bank.RestoreInto(restored));
+
+	BufferBank::SpentSamps discardSpent;
+	ASSERT_TRUE(bank.Discard(discardSpent));
+
+	BufferBank::SpentSamps restoreSpent;
+	ASSERT_FALSE(bank.Restore(restored, restoreSpent));
+	ASSERT_TRUE(restored.Pages.empty());
+	ASSERT_EQ(1u, restoreSpent.Pages.size());
+}
+
+TEST(BufferBank, DiscardHandsOutPackedSamps) {
+	BufferBank bank;
+	RefillPools();
+	bank.SetLength(5000ul, true);
+
+	auto int16Bytes = BufferBank::StorageBytes(BufferBank::STORAGE_INT16);
+
+	BufferBank::PackedSamps packed;
+	BufferBank::SpentSamps spent;
+	ASSERT_TRUE(bank.PackInto(BufferBank::STORAGE_INT16, packed));
+	ASSERT_TRUE(bank.Pack(packed, spent));
+
+	// Packed samples are left alone rather than decoded
+	bank.SetLength(5000ul, true);
+	ASSERT_TRUE(bank.IsPacked());
+
+	BufferBank::SpentSamps discardSpent;
+	ASSERT_TRUE(bank.Discard(discardSpent));
+	ASSERT_FALSE(bank.IsPacked());
+	ASSERT_EQ(0ul, bank.Length());
+	ASSERT_EQ(1u, discardSpent.Pages.size());
+	ASSERT_EQ(int16Bytes, BufferBank::StorageBytes(BufferBank::STORAGE_INT16));
+
+	// Recorded over with pages from the pool
+	RefillPools();
+	bank.SetLength(10ul, true);
+	bank[0] = 0.5f;
+	ASSERT_EQ(0.5f, ((const BufferBank&)bank)[0]);
+}
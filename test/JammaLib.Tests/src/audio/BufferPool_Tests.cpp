@@ -0,0 +1,82 @@
+
+#include "gtest/gtest.h"
+#include "audio/BufferPool.h"
+
+using audio::BufferPool;
+
+TEST(BufferPool, AcquiresFromRefilledPool) {
+	BufferPool pool(100, 2);
+
+	pool.Refill();
+	ASSERT_EQ(2u, pool.NumFree());
+
+	auto pageA = pool.Acquire();
+	auto pageB = pool.Acquire();
+
+	ASSERT_TRUE(pageA);
+	ASSERT_TRUE(pageB);
+	ASSERT_EQ(0u, pool.NumFree());
+	ASSERT_EQ(0ul, pool.NumMisses());
+}
+
+TEST(BufferPool, CountsMisses) {
+	BufferPool pool(100, 1);
+
+	auto page = pool.Acquire();
+
+	ASSERT_FALSE(page);
+	ASSERT_EQ(1ul, pool.NumMisses());
+}
+
+TEST(BufferPool, AllocatesWhenDry) {
+	BufferPool pool(100, 1);
+
+	auto page = pool.Allocate();
+
+	ASSERT_TRUE(page);
+	ASSERT_EQ(1ul, pool.NumMisses());
+
+	for (auto i = 0u; i < 100; i++)
+		ASSERT_EQ(0.0f, page[i]);
+}
+
+TEST(BufferPool, KeepsEveryReleasedPage) {
+	BufferPool pool(100, 2);
+
+	std::vector<std::unique_ptr<float[]>> pages;
+	for (auto i = 0u; i < 5u; i++)
+		pages.push_back(pool.Allocate());
+
+	// More than the pool holds, but none are freed until Refill
+	for (auto& page : pages)
+		pool.Release(std::move(page));
+
+	ASSERT_EQ(0u, pool.NumFree());
+
+	pool.Refill();
+	ASSERT_EQ(2u, pool.NumFree());
+	ASSERT_EQ(5ul, pool.NumMisses());
+}
+
+TEST(BufferPool, RecyclesZeroedPages) {
+	BufferPool pool(100, 1);
+
+	pool.Refill();
+	auto page = pool.Acquire();
+	auto pagePtr = page.get();
+
+	for (auto i = 0u; i < 100; i++)
+		page[i] = 1.0f;
+
+	pool.Release(std::move(page));
+	ASSERT_EQ(0u, pool.NumFree());
+
+	pool.Refill();
+	ASSERT_EQ(1u, pool.NumFree());
+
+	page = pool.Acquire();
+	ASSERT_EQ(pagePtr, page.get());
+
+	for (auto i = 0u; i < 100; i++)
+		ASSERT_EQ(0.0f, page[i]);
+}
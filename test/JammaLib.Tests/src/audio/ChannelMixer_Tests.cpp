@@ -76,6 +76,7 @@ public:
 
 	bool IsFilled() { return _sink->IsFilled(); }
 	bool MatchesBuffer(const std::vector<float>& buf) { return _sink->MatchesBuffer(buf); }
+	const std::vector<float>& Samples() const { return _sink->Samples; }
 
 protected:
 	virtual const std::shared_ptr<AudioSink> InputChannel(unsigned int channel)
@@ -260,3 +261,169 @@ TEST(ChannelMixer, WriteWrapsAroundAndMatches) {
 	ASSERT_TRUE(source->WasPlayed());
 	ASSERT_TRUE(source->MatchesBuffer(buf));
 }
+
+TEST(ChannelMixer, MixChannelsWrapsAroundAndMatches) {
+	auto bufSize = (unsigned int)constants::MaxBlockSize;
+	auto blockSize = 1000u;
+
+	ChannelMixerParams chanParams;
+	chanParams.InputBufferSize = bufSize;
+	chanParams.OutputBufferSize = bufSize;
+	chanParams.NumInputChannels = 1;
+	chanParams.NumOutputChannels = 2;
+
+	auto chanMixer = ChannelMixer(chanParams);
+
+	auto samps = std::vector<float>(blockSize);
+	auto gains = std::vector<float>(blockSize, 0.5f);
+	for (auto samp = 0u; samp < blockSize; samp++)
+		samps[samp] = ((rand() % 2000) - 1000) / 1001.0f;
+
+	std::vector<unsigned int> channels = { 0, 1 };
+	std::vector<float> levels = { 1.0f, 0.25f };
+
+	auto numBlocks = (bufSize * 2) / blockSize;
+	for (auto i = 0u; i < numBlocks; i++)
+	{
+		chanMixer.Sink()->Zero(blockSize);
+		chanMixer.Sink()->OnMixChannels(samps.data(), gains.data(), channels.data(), levels.data(), 2, blockSize, 0);
+
+		auto outBuf = std::vector<float>(blockSize * 2);
+		chanMixer.ToDac(outBuf.data(), 2, blockSize);
+		chanMixer.Sink()->EndMultiWrite(blockSize, true);
+
+		for (auto samp = 0u; samp < blockSize; samp++)
+		{
+			ASSERT_EQ(samps[samp] * 0.5f, outBuf[samp * 2]);
+			ASSERT_EQ(samps[samp] * 0.5f * 0.25f, outBuf[samp * 2 + 1]);
+		}
+	}
+}
+
+TEST(ChannelMixer, MixBusSumsIntoSink) {
+	auto bufSize = (unsigned int)constants::MaxBlockSize;
+	auto blockSize = 1000u;
+
+	ChannelMixerParams chanParams;
+	chanParams.InputBufferSize = bufSize;
+	chanParams.OutputBufferSize = bufSize;
+	chanParams.NumInputChannels = 1;
+	chanParams.NumOutputChannels = 2;
+
+	auto chanMixer = ChannelMixer(chanParams);
+	auto bus = std::make_shared<ChannelMixer>(ChannelMixerParams({ 0, bufSize, 0, 2 }));
+
+	auto samps = std::vector<float>(blockSize);
+	auto gains = std::vector<float>(blockSize, 1.0f);
+	for (auto samp = 0u; samp < blockSize; samp++)
+		samps[samp] = ((rand() % 2000) - 1000) / 1001.0f;
+
+	std::vector<unsigned int> channels = { 0, 1 };
+	std::vector<float> levels = { 1.0f, 0.5f };
+
+	auto numBlocks = (bufSize * 2) / blockSize;
+	for (auto i = 0u; i < numBlocks; i++)
+	{
+		bus->Sink()->Zero(blockSize);
+		bus->Sink()->OnMixChannels(samps.data(), gains.data(), channels.data(), levels.data(), 2, blockSize, 0);
+
+		chanMixer.Sink()->Zero(blockSize);
+		chanMixer.MixBus(bus, blockSize);
+		chanMixer.MixBus(bus, blockSize);
+
+		auto outBuf = std::vector<float>(blockSize * 2);
+		chanMixer.ToDac(outBuf.data(), 2, blockSize);
+		chanMixer.Sink()->EndMultiWrite(blockSize, true);
+
+		for (auto samp = 0u; samp < blockSize; samp++)
+		{
+			ASSERT_EQ(samps[samp] + samps[samp], outBuf[samp * 2]);
+			ASSERT_EQ((samps[samp] * 0.5f) + (samps[samp] * 0.5f), outBuf[samp * 2 + 1]);
+		}
+	}
+}
+
+TEST(ChannelMixer, ToDacClearsSink) {
+	auto bufSize = (unsigned int)constants::MaxBlockSize;
+	auto blockSize = 700u;
+
+	ChannelMixerParams chanParams;
+	chanParams.InputBufferSize = bufSize;
+	chanParams.OutputBufferSize = bufSize;
+	chanParams.NumInputChannels = 1;
+	chanParams.NumOutputChannels = 2;
+
+	auto chanMixer = ChannelMixer(chanParams);
+
+	auto samps = std::vector<float>(blockSize);
+	auto gains = std::vector<float>(blockSize, 1.0f);
+	for (auto samp = 0u; samp < blockSize; samp++)
+		samps[samp] = ((rand() % 2000) - 1000) / 1001.0f;
+
+	std::vector<unsigned int> channels = { 0, 1 };
+	std::vector<float> levels = { 1.0f, 1.0f };
+
+	// Never zeroed explicitly, so any leftover samples
+	// would build up once the ring wraps around
+	auto numBlocks = (bufSize * 3) / blockSize;
+	for (auto i = 0u; i < numBlocks; i++)
+	{
+		chanMixer.Sink()->OnMixChannels(samps.data(), gains.data(), channels.data(), levels.data(), 2, blockSize, 0);
+
+		// Three output channels, one more than the mixer has
+		auto outBuf = std::vector<float>(blockSize * 3, 1.0f);
+		chanMixer.ToDac(outBuf.data(), 3, blockSize);
+		chanMixer.Sink()->EndMultiWrite(blockSize, true);
+
+		for (auto samp = 0u; samp < blockSize; samp++)
+		{
+			ASSERT_EQ(samps[samp], outBuf[samp * 3]);
+			ASSERT_EQ(samps[samp], outBuf[samp * 3 + 1]);
+			ASSERT_EQ(0.0f, outBuf[samp * 3 + 2]);
+		}
+	}
+}
+
+TEST(ChannelMixer, InputLatencyIsPinnedByBufferSize) {
+	auto blockSize = 512u;
+	auto numBlocks = 30u;
+
+	// One delay the ring holds, and one clamped to it
+	for (auto delay : { 300u, constants::MaxBlockSize + 1000u })
+	{
+		ChannelMixerParams chanParams;
+		chanParams.InputBufferSize = delay;
+		chanParams.OutputBufferSize = constants::MaxBlockSize;
+		chanParams.NumInputChannels = 1;
+		chanParams.NumOutputChannels = 1;
+
+		auto chanMixer = ChannelMixer(chanParams);
+		auto ringSize = std::max(delay, constants::MaxBlockSize);
+		auto latency = std::min(delay + blockSize, ringSize) - blockSize;
+
+		auto inBuf = std::vector<float>(blockSize);
+		for (auto block = 0u; block < numBlocks; block++)
+		{
+			auto blockStart = block * blockSize;
+
+			for (auto samp = 0u; samp < blockSize; samp++)
+				inBuf[samp] = (float)(blockStart + samp + 1);
+
+			chanMixer.FromAdc(inBuf.data(), 1, blockSize);
+			chanMixer.InitPlay(delay, blockSize);
+
+			auto sink = std::make_shared<MockedMultiSink>(blockSize);
+			chanMixer.Source()->OnPlay(sink, blockSize);
+			chanMixer.Source()->EndMultiPlay(blockSize);
+
+			if (blockStart < latency)
+				continue;
+
+			auto expected = std::vector<float>(blockSize);
+			for (auto samp = 0u; samp < blockSize; samp++)
+				expected[samp] = (float)(blockStart + samp - latency + 1);
+
+			ASSERT_EQ(expected, sink->Samples());
+		}
+	}
+}
@@ -1,11 +1,14 @@
 
 #include "gtest/gtest.h"
+#include <algorithm>
 #include "resources/ResourceLib.h"
 #include "engine/Loop.h"
 
 using resources::ResourceLib;
 using engine::Loop;
 using engine::LoopParams;
+using audio::BufferBank;
+using actions::JobAction;
 using audio::WireMixBehaviourParams;
 using audio::AudioMixerParams;
 using base::AudioSource;
@@ -60,6 +63,7 @@ public:
 	virtual unsigned int NumInputChannels() const { return 1; };
 
 	bool IsFilled() { return _sink->IsFilled(); }
+	const std::vector<float>& Samples() const { return _sink->Samples; }
 
 protected:
 	virtual const std::shared_ptr<AudioSink> InputChannel(unsigned int channel)
@@ -164,3 +168,230 @@ TEST(Loop, PlayWrapsAround) {
 
 	ASSERT_TRUE(sink->IsFilled());
 }
+
+class MockedLoop :
+	public Loop
+{
+public:
+	MockedLoop() :
+		base::GuiElement(LoopParams()),
+		Loop(LoopParams(), AudioMixerParams())
+	{
+	}
+	MockedLoop(AudioMixerParams mixerParams) :
+		base::GuiElement(LoopParams()),
+		Loop(LoopParams(), mixerParams)
+	{
+	}
+
+public:
+	BufferBank::StorageMode BankStorage() const { return _bufferBank.Storage(); }
+	bool IsBankWritable() const { return nullptr != std::get<0>(_bufferBank.ReadSpan(0, 1u)); }
+	bool IsLoopIdle() const { return IsIdle(); }
+	bool IsOverdubbing() const { return STATE_OVERDUBBING == _state; }
+	bool IsPunchedIn() const { return STATE_PUNCHEDIN == _state; }
+	float FirstPlayed() const { return _playBuffer[0]; }
+	double MixerLevel() const { return _mixer->Level(); }
+	void SetLevel(double level) { _mixer->OnAction(actions::DoubleAction(level)); }
+
+	// Where in the bank the next block is read from
+	unsigned long PlayIndex() const
+	{
+		auto index = _playIndex;
+		while (index >= _loopLength + constants::MaxLoopFadeSamps)
+			index -= _loopLength;
+
+		return index;
+	}
+
+	// The sample recorded at index
+	static float Recorded(unsigned long index) { return (float)(1ul + index % 1000ul) / 1000.0f; }
+
+	void RunJob(JobAction::JobType jobType)
+	{
+		JobAction job;
+		job.JobActionType = jobType;
+		OnAction(job);
+	}
+
+	// Records length samples and sets them playing
+	void RecordPlaying(unsigned int length)
+	{
+		BufferBank::Pool().Refill();
+		BufferBank::SummaryPool().Refill();
+
+		auto numSamps = length + constants::MaxLoopFadeSamps;
+		std::vector<float> samps(numSamps);
+
+		for (auto i = 0u; i < numSamps; i++)
+			samps[i] = Recorded(i);
+
+		Record();
+		OnOverwriteBlock(samps.data(), numSamps, 0);
+		EndWrite(numSamps, true);
+		Play(0, length, false);
+	}
+
+	// As RecordPlaying, then packed to int16
+	// and swapped in between blocks
+	void RecordPacked(unsigned int length)
+	{
+		RecordPlaying(length);
+
+		SetStorage(BufferBank::STORAGE_INT16);
+		RunJob(JobAction::JOB_PACKLOOP);
+		EndMultiPlay(0u);
+	}
+};
+
+TEST(Loop, PackedPagesAreFreedByTheJob) {
+	MockedLoop loop;
+	loop.RecordPacked(1000u);
+
+	ASSERT_EQ(BufferBank::STORAGE_INT16, loop.BankStorage());
+
+	// The float pages wait for the job rather than
+	// going back on the audio thread
+	ASSERT_TRUE(loop.IsRestoreDue());
+	loop.RunJob(JobAction::JOB_RESTORELOOP);
+	ASSERT_FALSE(loop.IsRestoreDue());
+	ASSERT_EQ(BufferBank::STORAGE_INT16, loop.BankStorage());
+}
+
+TEST(Loop, OverdubWaitsForRestore) {
+	MockedLoop loop;
+	loop.RecordPacked(1000u);
+	loop.RunJob(JobAction::JOB_RESTORELOOP);
+
+	// Nothing is decoded on the audio thread, and nothing
+	// is written until there are float samples to write to
+	loop.Overdub();
+	ASSERT_EQ(BufferBank::STORAGE_INT16, loop.BankStorage());
+	ASSERT_FALSE(loop.IsBankWritable());
+	ASSERT_FALSE(loop.IsOverdubbing());
+	ASSERT_TRUE(loop.IsRestoreDue());
+	ASSERT_FALSE(loop.IsLoopIdle());
+
+	loop.RunJob(JobAction::JOB_RESTORELOOP);
+	ASSERT_FALSE(loop.IsOverdubbing());
+	loop.EndMultiPlay(0u);
+
+	ASSERT_EQ(BufferBank::STORAGE_FLOAT, loop.BankStorage());
+	ASSERT_TRUE(loop.IsBankWritable());
+	ASSERT_TRUE(loop.IsOverdubbing());
+
+	// Then the packed pages are freed in turn
+	ASSERT_TRUE(loop.IsRestoreDue());
+	loop.RunJob(JobAction::JOB_RESTORELOOP);
+	ASSERT_FALSE(loop.IsRestoreDue());
+}
+
+TEST(Loop, PunchInWaitsForRestore) {
+	MockedLoop loop;
+	loop.RecordPacked(1000u);
+	loop.RunJob(JobAction::JOB_RESTORELOOP);
+
+	loop.PunchIn();
+	ASSERT_FALSE(loop.IsPunchedIn());
+	ASSERT_TRUE(loop.IsRestoreDue());
+
+	loop.RunJob(JobAction::JOB_RESTORELOOP);
+	loop.EndMultiPlay(0u);
+	ASSERT_TRUE(loop.IsPunchedIn());
+
+	// Punching out before the restore lands leaves it overdubbing
+	MockedLoop punchedOut;
+	punchedOut.RecordPacked(1000u);
+	punchedOut.RunJob(JobAction::JOB_RESTORELOOP);
+
+	punchedOut.PunchIn();
+	punchedOut.PunchOut();
+	punchedOut.RunJob(JobAction::JOB_RESTORELOOP);
+	punchedOut.EndMultiPlay(0u);
+	ASSERT_TRUE(punchedOut.IsOverdubbing());
+}
+
+TEST(Loop, RecordOverPackedHandsItOut) {
+	MockedLoop loop;
+	loop.RecordPacked(1000u);
+
+	// Still waiting on the pages from packing, so
+	// the pack is only dropped once they are freed
+	loop.Record();
+	ASSERT_EQ(BufferBank::STORAGE_INT16, loop.BankStorage());
+
+	loop.RunJob(JobAction::JOB_RESTORELOOP);
+	loop.EndMultiPlay(0u);
+	ASSERT_EQ(BufferBank::STORAGE_FLOAT, loop.BankStorage());
+	ASSERT_TRUE(loop.IsRestoreDue());
+
+	BufferBank::Pool().Refill();
+	BufferBank::SummaryPool().Refill();
+	loop.EndWrite(10u, true);
+	ASSERT_TRUE(loop.IsBankWritable());
+}
+
+TEST(Loop, CompressedFadesInFromPlayIndexOnceRestored) {
+	WireMixBehaviourParams mixBehaviour;
+	mixBehaviour.Channels = { 0 };
+	AudioMixerParams mixerParams;
+	mixerParams.Behaviour = mixBehaviour;
+
+	MockedLoop loop(mixerParams);
+	loop.RecordPlaying(1000u);
+
+	// Muted, then compressed once it has been idle long enough
+	auto blockSize = 64u;
+	auto muted = std::make_shared<MockedMultiSink>(1u);
+	loop.SetLevel(0.0);
+
+	for (auto block = 0u; (block < 10000u) && !loop.IsLoopIdle(); block++)
+	{
+		loop.OnPlay(muted, blockSize);
+		loop.EndMultiPlay(blockSize);
+	}
+
+	ASSERT_TRUE(loop.IsLoopIdle());
+	ASSERT_FALSE(loop.IsCompressDue());
+
+	loop.EndMultiPlay(Loop::_CompressIdleSamps);
+	ASSERT_TRUE(loop.IsCompressDue());
+	loop.RunJob(JobAction::JOB_COMPRESSLOOP);
+	loop.EndMultiPlay(0u);
+	ASSERT_EQ(BufferBank::STORAGE_COMPRESSED, loop.BankStorage());
+	loop.RunJob(JobAction::JOB_RESTORELOOP);
+
+	// Nothing is decoded on the audio thread, and the
+	// mixer stays faded out until the restore lands
+	auto numHeldBlocks = 4u;
+	auto heard = std::make_shared<MockedMultiSink>((numHeldBlocks + 1u) * blockSize);
+	loop.SetLevel(1.0);
+	ASSERT_TRUE(loop.IsRestoreDue());
+
+	for (auto block = 0u; block < numHeldBlocks; block++)
+	{
+		loop.OnPlay(heard, blockSize);
+		loop.EndMultiPlay(blockSize);
+		heard->EndMultiWrite(blockSize, true);
+		ASSERT_GE(0.001, loop.MixerLevel());
+	}
+
+	loop.RunJob(JobAction::JOB_RESTORELOOP);
+	loop.EndMultiPlay(0u);
+	ASSERT_EQ(BufferBank::STORAGE_FLOAT, loop.BankStorage());
+
+	// Then it fades in from where it has got to, in time
+	// with everything else, rather than part way through
+	auto index = loop.PlayIndex();
+	loop.OnPlay(heard, blockSize);
+	loop.EndMultiPlay(blockSize);
+	heard->EndMultiWrite(blockSize, true);
+
+	ASSERT_EQ(MockedLoop::Recorded(index), loop.FirstPlayed());
+	ASSERT_LT(0.001, loop.MixerLevel());
+
+	auto& samps = heard->Samples();
+	auto firstHeard = std::find_if(samps.begin(), samps.end(), [](float samp) { return samp != 0.0f; });
+	ASSERT_EQ((long)(numHeldBlocks * blockSize), firstHeard - samps.begin());
+	ASSERT_GT(0.02f * MockedLoop::Recorded(index), *firstHeard);
+}
@@ -0,0 +1,108 @@
+
+#include "gtest/gtest.h"
+#include "audio/LosslessCodec.h"
+#include <cmath>
+#include <cstring>
+
+using audio::LosslessEncoder;
+using audio::LosslessDecoder;
+
+namespace
+{
+	// As a 16-bit interface would deliver it
+	std::vector<float> Recording(unsigned int numSamps)
+	{
+		std::vector<float> samps(numSamps);
+
+		for (auto i = 0u; i < numSamps; i++)
+		{
+			auto value = 0.5 * std::sin(0.01 * i) + 0.01 * (((rand() % 2000) - 1000) / 1000.0);
+			samps[i] = (float)std::lrint(value * 32767.0) / 32768.0f;
+		}
+
+		return samps;
+	}
+
+	std::vector<std::uint8_t> Encode(const std::vector<float>& samps, unsigned int spanSamps)
+	{
+		LosslessEncoder encoder((unsigned long)samps.size());
+
+		for (auto i = 0u; i < samps.size(); i += spanSamps)
+			encoder.Write(samps.data() + i, std::min(spanSamps, (unsigned int)samps.size() - i));
+
+		return encoder.Finish();
+	}
+
+	bool IsExact(const std::vector<float>& samps, const std::vector<float>& decoded)
+	{
+		return (samps.size() == decoded.size()) &&
+			(0 == std::memcmp(samps.data(), decoded.data(), samps.size() * sizeof(float)));
+	}
+}
+
+TEST(LosslessCodec, RoundTripsRecordings) {
+	auto samps = Recording(100000u);
+	auto data = Encode(samps, 333u);
+
+	ASSERT_FALSE(data.empty());
+	ASSERT_EQ(100000ul, LosslessDecoder::NumSamps(data.data(), data.size()));
+	ASSERT_GT(samps.size() * sizeof(float) / 2u, data.size());
+
+	std::vector<float> decoded(samps.size());
+	ASSERT_EQ(100000u, LosslessDecoder::Read(data.data(), data.size(), 0ul, decoded.data(), 100000u));
+	ASSERT_TRUE(IsExact(samps, decoded));
+}
+
+TEST(LosslessCodec, KeepsOtherFloatsExact) {
+	std::vector<float> samps(5000u);
+
+	for (auto& samp : samps)
+		samp = ((rand() % 2000) - 1000) / 1001.0f;
+
+	samps[10] = -0.0f;
+	samps[11] = 1e-30f;
+	samps[12] = 3.5f;
+
+	auto data = Encode(samps, 5000u);
+	std::vector<float> decoded(samps.size());
+
+	ASSERT_EQ(5000u, LosslessDecoder::Read(data.data(), data.size(), 0ul, decoded.data(), 5000u));
+	ASSERT_TRUE(IsExact(samps, decoded));
+}
+
+TEST(LosslessCodec, ReadsFromAnyIndex) {
+	auto samps = Recording(3u * LosslessEncoder::FrameSamps + 100u);
+	auto data = Encode(samps, 4096u);
+
+	for (auto [index, numSamps] : std::vector<std::pair<unsigned long, unsigned int>>({ { 0ul, 1u }, { 5ul, 2048u }, { 2047ul, 2u }, { 4000ul, 3000u }, { 6100ul, 500u } }))
+	{
+		std::vector<float> decoded(numSamps, 9.0f);
+		auto numRead = LosslessDecoder::Read(data.data(), data.size(), index, decoded.data(), numSamps);
+		auto numExpected = (unsigned int)std::min((unsigned long)numSamps, samps.size() - index);
+
+		ASSERT_EQ(numExpected, numRead);
+
+		for (auto i = 0u; i < numRead; i++)
+			ASSERT_EQ(samps[index + i], decoded[i]);
+	}
+}
+
+TEST(LosslessCodec, PacksSilenceToHeaders) {
+	std::vector<float> samps(1000000u, 0.0f);
+	auto data = Encode(samps, 65536u);
+
+	ASSERT_GT(10000u, data.size());
+
+	std::vector<float> decoded(100u, 1.0f);
+	ASSERT_EQ(100u, LosslessDecoder::Read(data.data(), data.size(), 500000ul, decoded.data(), 100u));
+	ASSERT_EQ(0.0f, decoded[99]);
+}
+
+TEST(LosslessCodec, NeedsEverySamp) {
+	auto samps = Recording(5000u);
+
+	LosslessEncoder encoder(6000ul);
+	encoder.Write(samps.data(), 5000u);
+
+	ASSERT_TRUE(encoder.Finish().empty());
+}
@@ -0,0 +1,248 @@
+#include "gtest/gtest.h"
+#include "audio/MixKernels.h"
+#include <algorithm>
+#include <cmath>
+
+using audio::MixKernels;
+
+class MixKernelsFixture
+{
+public:
+	MixKernelsFixture(unsigned int numChannels, unsigned int numSamps) :
+		Samps(std::vector<float>(numSamps)),
+		Gains(std::vector<float>(numSamps)),
+		Levels(std::vector<float>(numChannels)),
+		Outputs(numChannels, std::vector<float>(numSamps))
+	{
+		for (auto samp = 0u; samp < numSamps; samp++)
+		{
+			Samps[samp] = ((rand() % 2000) - 1000) / 1001.0f;
+			Gains[samp] = (rand() % 1000) / 999.0f;
+		}
+
+		for (auto chan = 0u; chan < numChannels; chan++)
+		{
+			Levels[chan] = (rand() % 1000) / 999.0f;
+
+			for (auto samp = 0u; samp < numSamps; samp++)
+				Outputs[chan][samp] = ((rand() % 2000) - 1000) / 1001.0f;
+		}
+	}
+
+public:
+	void Mix()
+	{
+		std::vector<float*> dests;
+		for (auto& output : Outputs)
+			dests.push_back(output.data());
+
+		MixKernels::MixRamped(dests.data(),
+			Levels.data(),
+			(unsigned int)Levels.size(),
+			Samps.data(),
+			Gains.data(),
+			(unsigned int)Samps.size());
+	}
+
+	bool MatchesReference(const std::vector<std::vector<float>>& original)
+	{
+		for (auto chan = 0u; chan < Outputs.size(); chan++)
+		{
+			for (auto samp = 0u; samp < Samps.size(); samp++)
+			{
+				auto expected = original[chan][samp] + (Samps[samp] * Gains[samp]) * Levels[chan];
+				if (Outputs[chan][samp] != expected)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	std::vector<float> Samps;
+	std::vector<float> Gains;
+	std::vector<float> Levels;
+	std::vector<std::vector<float>> Outputs;
+};
+
+TEST(MixKernels, MatchesScalarMixForAllChannelCounts) {
+	auto numSamps = 37u;
+
+	for (auto numChannels = 1u; numChannels <= MixKernels::MaxChannels; numChannels++)
+	{
+		MixKernelsFixture fixture(numChannels, numSamps);
+		auto original = fixture.Outputs;
+
+		fixture.Mix();
+
+		ASSERT_TRUE(fixture.MatchesReference(original));
+	}
+}
+
+TEST(MixKernels, AccumulatesIntoOutput) {
+	auto numSamps = 64u;
+	auto numChannels = 2u;
+
+	MixKernelsFixture fixture(numChannels, numSamps);
+	auto original = fixture.Outputs;
+
+	fixture.Mix();
+	fixture.Mix();
+
+	for (auto chan = 0u; chan < numChannels; chan++)
+	{
+		for (auto samp = 0u; samp < numSamps; samp++)
+		{
+			auto mixed = (fixture.Samps[samp] * fixture.Gains[samp]) * fixture.Levels[chan];
+			ASSERT_FLOAT_EQ(original[chan][samp] + mixed + mixed, fixture.Outputs[chan][samp]);
+		}
+	}
+}
+
+TEST(MixKernels, DeinterleaveMatchesScalar) {
+	auto numSamps = 149u;
+
+	for (auto numChannels : { 1u, 2u, 3u, 4u, 6u, 8u, 32u })
+	{
+		// A wider stride leaves extra interleaved channels untouched
+		for (auto stride : { numChannels, numChannels + 3u })
+		{
+			std::vector<float> in(numSamps * stride);
+			for (auto& samp : in)
+				samp = ((rand() % 2000) - 1000) / 1001.0f;
+
+			std::vector<std::vector<float>> outputs(numChannels, std::vector<float>(numSamps));
+			std::vector<float*> dests;
+			for (auto& output : outputs)
+				dests.push_back(output.data());
+
+			MixKernels::Deinterleave(in.data(), stride, dests.data(), numChannels, numSamps);
+
+			for (auto chan = 0u; chan < numChannels; chan++)
+			{
+				for (auto samp = 0u; samp < numSamps; samp++)
+					ASSERT_EQ(in[samp * stride + chan], outputs[chan][samp]);
+			}
+		}
+	}
+}
+
+TEST(MixKernels, InterleaveMatchesScalarAndClears) {
+	auto numSamps = 149u;
+
+	for (auto numChannels : { 1u, 2u, 3u, 4u, 6u, 8u, 32u })
+	{
+		for (auto stride : { numChannels, numChannels + 3u })
+		{
+			std::vector<std::vector<float>> inputs(numChannels, std::vector<float>(numSamps));
+			std::vector<float*> srcs;
+			for (auto& input : inputs)
+			{
+				for (auto& samp : input)
+					samp = ((rand() % 2000) - 1000) / 1001.0f;
+
+				srcs.push_back(input.data());
+			}
+
+			auto original = inputs;
+			std::vector<float> out(numSamps * stride, 2.0f);
+
+			MixKernels::Interleave(srcs.data(), numChannels, out.data(), stride, numSamps, true);
+
+			for (auto samp = 0u; samp < numSamps; samp++)
+			{
+				for (auto chan = 0u; chan < stride; chan++)
+				{
+					auto expected = chan < numChannels ? original[chan][samp] : 2.0f;
+					ASSERT_EQ(expected, out[samp * stride + chan]);
+				}
+			}
+
+			for (auto& input : inputs)
+			{
+				for (auto samp : input)
+					ASSERT_EQ(0.0f, samp);
+			}
+		}
+	}
+}
+
+TEST(MixKernels, PeakMatchesScalar) {
+	for (auto numSamps : { 0u, 3u, 8u, 37u, 1000u })
+	{
+		std::vector<float> samps(numSamps);
+		for (auto& samp : samps)
+			samp = ((rand() % 2000) - 1000) / 1001.0f;
+
+		auto expected = 0.1f;
+		for (auto samp : samps)
+			expected = std::max(expected, std::abs(samp));
+
+		ASSERT_EQ(expected, MixKernels::Peak(samps.data(), numSamps, 0.1f));
+	}
+}
+
+TEST(MixKernels, Int16ToFloatMatchesScalar) {
+	std::vector<std::int16_t> in(2 * 37);
+	std::vector<float> out(37);
+
+	for (auto& samp : in)
+		samp = (std::int16_t)((rand() % 65536) - 32768);
+
+	MixKernels::Int16ToFloat(in.data(), 1u, out.data(), 37u);
+
+	for (auto samp = 0u; samp < 37u; samp++)
+		ASSERT_EQ((float)in[samp] / 32768.0f, out[samp]);
+
+	MixKernels::Int16ToFloat(in.data(), 2u, out.data(), 37u);
+
+	for (auto samp = 0u; samp < 37u; samp++)
+		ASSERT_EQ((float)in[samp * 2u] / 32768.0f, out[samp]);
+}
+
+TEST(MixKernels, FloatToInt16RoundsAndClips) {
+	std::vector<float> in = { 0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f, 1.0f / 65536.0f };
+	std::vector<std::int16_t> out(in.size());
+
+	for (auto samp = 0u; samp < 29u; samp++)
+		in.push_back(((rand() % 2000) - 1000) / 1001.0f);
+
+	out.resize(in.size());
+	MixKernels::FloatToInt16(in.data(), out.data(), (unsigned int)in.size());
+
+	ASSERT_EQ(0, out[0]);
+	ASSERT_EQ(16384, out[1]);
+	ASSERT_EQ(-16384, out[2]);
+	ASSERT_EQ(32767, out[3]);
+	ASSERT_EQ(-32768, out[4]);
+	ASSERT_EQ(32767, out[5]);
+	ASSERT_EQ(-32768, out[6]);
+	ASSERT_EQ(0, out[7]);
+
+	for (auto samp = 8u; samp < in.size(); samp++)
+		ASSERT_EQ((std::int16_t)std::lrint(in[samp] * 32768.0f), out[samp]);
+}
+
+TEST(MixKernels, HalfRoundTripsWithinPrecision) {
+	std::vector<float> in(45);
+	std::vector<std::uint16_t> half(45);
+	std::vector<float> out(45);
+
+	for (auto& samp : in)
+		samp = ((rand() % 2000) - 1000) / 1001.0f;
+
+	in[0] = 0.0f;
+	in[1] = 0.5f;
+	in[2] = -1.0f;
+
+	MixKernels::FloatToHalf(in.data(), half.data(), 45u);
+	MixKernels::HalfToFloat(half.data(), out.data(), 45u);
+
+	ASSERT_EQ(0.0f, out[0]);
+	ASSERT_EQ(0.5f, out[1]);
+	ASSERT_EQ(-1.0f, out[2]);
+
+	// 11 bits of mantissa
+	for (auto samp = 0u; samp < 45u; samp++)
+		ASSERT_NEAR(in[samp], out[samp], std::abs(in[samp]) / 2048.0f + 1e-7f);
+}
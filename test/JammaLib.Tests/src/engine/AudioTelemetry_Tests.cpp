@@ -0,0 +1,91 @@
+
+#include "gtest/gtest.h"
+#include "engine/AudioTelemetry.h"
+#include <sstream>
+
+using engine::AudioTelemetry;
+using engine::AudioTelemetryParams;
+using engine::CallbackTiming;
+
+CallbackTiming MakeTiming(double load, bool isUnderflow)
+{
+	// 100 samples at 1000Hz gives a 0.1s deadline
+	CallbackTiming timing;
+	timing.NumSamps = 100;
+	timing.WallSeconds = load * 0.1;
+	timing.CpuSeconds = load * 0.05;
+	timing.InputSeconds = load * 0.03;
+	timing.OutputSeconds = load * 0.06;
+	timing.TickSeconds = load * 0.01;
+	timing.IsInputOverflow = false;
+	timing.IsOutputUnderflow = isUnderflow;
+
+	return timing;
+}
+
+TEST(AudioTelemetry, CalculatesPercentiles) {
+	AudioTelemetry telemetry(AudioTelemetryParams{ 128, 128, 1000 });
+
+	for (auto i = 1; i <= 100; i++)
+		telemetry.Push(MakeTiming(i / 100.0, false));
+
+	telemetry.Update();
+	auto summary = telemetry.Summary();
+
+	ASSERT_EQ(100ull, summary.NumCallbacks);
+	ASSERT_EQ(100u, summary.NumWindowCallbacks);
+	ASSERT_NEAR(0.505, summary.Wall.Mean, 1e-9);
+	ASSERT_NEAR(0.51, summary.Wall.P50, 1e-9);
+	ASSERT_NEAR(0.95, summary.Wall.P95, 1e-9);
+	ASSERT_NEAR(1.0, summary.Wall.Max, 1e-9);
+	ASSERT_NEAR(0.5, summary.Cpu.Max, 1e-9);
+	ASSERT_NEAR(0.6, summary.Output.Max, 1e-9);
+}
+
+TEST(AudioTelemetry, WindowKeepsNewest) {
+	AudioTelemetry telemetry(AudioTelemetryParams{ 64, 10, 1000 });
+
+	for (auto i = 0; i < 30; i++)
+	{
+		telemetry.Push(MakeTiming(i < 20 ? 2.0 : 0.5, false));
+		telemetry.Update();
+	}
+
+	auto summary = telemetry.Summary();
+
+	ASSERT_EQ(30ull, summary.NumCallbacks);
+	ASSERT_EQ(10u, summary.NumWindowCallbacks);
+	ASSERT_NEAR(0.5, summary.Wall.Max, 1e-9);
+}
+
+TEST(AudioTelemetry, CountsXrunsAndDrops) {
+	AudioTelemetry telemetry(AudioTelemetryParams{ 4, 16, 1000 });
+
+	for (auto i = 0; i < 6; i++)
+		telemetry.Push(MakeTiming(0.1, 0 == (i % 2)));
+
+	telemetry.Update();
+	auto summary = telemetry.Summary();
+
+	ASSERT_EQ(4ull, summary.NumCallbacks);
+	ASSERT_EQ(2ull, summary.NumDropped);
+	ASSERT_EQ(2ull, summary.NumOutputUnderflows);
+	ASSERT_EQ(0ull, summary.NumInputOverflows);
+}
+
+TEST(AudioTelemetry, WritesHistogram) {
+	AudioTelemetry telemetry(AudioTelemetryParams{ 16, 16, 1000 });
+
+	telemetry.Push(MakeTiming(0.01, false));
+	telemetry.Push(MakeTiming(0.07, false));
+	telemetry.Push(MakeTiming(5.0, false));
+	telemetry.Update();
+
+	std::stringstream ss;
+	telemetry.WriteJson(ss);
+	auto json = ss.str();
+
+	ASSERT_NE(std::string::npos, json.find("\"callbacks\":3"));
+	ASSERT_NE(std::string::npos, json.find("\"wall\":[1,1,0,"));
+	ASSERT_NE(std::string::npos, json.find(",1],\"cpu\":"));
+}
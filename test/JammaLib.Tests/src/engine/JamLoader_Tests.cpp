@@ -0,0 +1,72 @@
+
+#include "gtest/gtest.h"
+#include <atomic>
+#include "engine/JamLoader.h"
+#include "../JamFixture.h"
+
+using engine::JamLoader;
+using engine::JamLoaderParams;
+
+TEST(JamLoader, LoadsEveryLoop) {
+	JamFixture fixture("loader", 2, 3, constants::MaxLoopFadeSamps);
+	std::atomic<unsigned int> maxDone(0u);
+
+	JamLoaderParams params;
+	params.NumWorkers = 2;
+	params.OnProgress = [&](unsigned int numDone, unsigned int numLoops) {
+		auto done = maxDone.load();
+		while ((numDone > done) && !maxDone.compare_exchange_weak(done, numDone)) {}
+	};
+
+	JamLoader loader(params);
+	auto loops = loader.Load(fixture.Jam, fixture.Dir.wstring());
+
+	ASSERT_TRUE(loops.has_value());
+	ASSERT_EQ(2u, loops.value().size());
+
+	for (auto& stationLoops : loops.value())
+	{
+		ASSERT_EQ(1u, stationLoops.size());
+		ASSERT_EQ(3u, stationLoops[0].size());
+
+		for (auto& loop : stationLoops[0])
+			ASSERT_NE(nullptr, loop);
+	}
+
+	ASSERT_EQ(6u, loader.Stats().NumLoops);
+	ASSERT_EQ(6u, loader.Stats().NumLoaded);
+	ASSERT_EQ(6u, maxDone.load());
+}
+
+TEST(JamLoader, LeavesMissingLoopsEmpty) {
+	JamFixture fixture("loader", 1, 2, constants::MaxLoopFadeSamps);
+	fixture.Jam.Stations[0].LoopTakes[0].Loops[1].Name = "missing.wav";
+
+	JamLoader loader({ 1, nullptr });
+	auto loops = loader.Load(fixture.Jam, fixture.Dir.wstring());
+
+	ASSERT_TRUE(loops.has_value());
+	ASSERT_NE(nullptr, loops.value()[0][0][0]);
+	ASSERT_EQ(nullptr, loops.value()[0][0][1]);
+	ASSERT_EQ(1u, loader.Stats().NumLoaded);
+}
+
+TEST(JamLoader, CancelSkipsLoops) {
+	JamFixture fixture("loader", 1, 4, constants::MaxLoopFadeSamps);
+	JamLoader* loaderPtr = nullptr;
+
+	JamLoaderParams params;
+	params.NumWorkers = 0;
+	params.OnProgress = [&](unsigned int numDone, unsigned int numLoops) {
+		if (numDone == 1u)
+			loaderPtr->Cancel();
+	};
+
+	JamLoader loader(params);
+	loaderPtr = &loader;
+	auto loops = loader.Load(fixture.Jam, fixture.Dir.wstring());
+
+	ASSERT_FALSE(loops.has_value());
+	ASSERT_TRUE(loader.IsCancelled());
+	ASSERT_EQ(1u, loader.Stats().NumLoaded);
+}
@@ -0,0 +1,141 @@
+
+#include "gtest/gtest.h"
+#include <fstream>
+#include <sstream>
+#include "engine/JamSaver.h"
+#include "engine/JamLoader.h"
+#include "io/WavReadWriter.h"
+#include "../JamFixture.h"
+
+using engine::JamSaver;
+using engine::JamSnapshot;
+using engine::JamLoader;
+using engine::Loop;
+using engine::LoopParams;
+using io::JamFile;
+using io::WavReadWriter;
+
+// The fixture's loops, loaded and ready to save
+JamSnapshot MakeSnapshot(const JamFixture& fixture)
+{
+	JamSnapshot snapshot;
+	snapshot.Jam = fixture.Jam;
+	snapshot.Loops.resize(1);
+	snapshot.Loops[0].resize(1);
+
+	for (auto& loopStruct : fixture.Jam.Stations[0].LoopTakes[0].Loops)
+	{
+		auto loop = Loop::FromFile(LoopParams(), loopStruct, fixture.Dir.wstring()).value();
+		snapshot.Loops[0][0].push_back({ loop, loop->Snapshot().value() });
+	}
+
+	// Takes get their loops back as they are written
+	snapshot.Jam.Stations[0].LoopTakes[0].Loops.clear();
+
+	return snapshot;
+}
+
+TEST(JamSaver, SavesEveryLoop) {
+	JamFixture fixture("saved", 1, 4, constants::MaxLoopFadeSamps);
+	auto snapshot = MakeSnapshot(fixture);
+	auto jamFile = fixture.Dir / "saved.jam";
+
+	JamSaver saver({ 2, nullptr });
+	ASSERT_TRUE(saver.Save(snapshot, jamFile.wstring()));
+	ASSERT_EQ(4u, saver.Stats().NumLoops);
+	ASSERT_EQ(4u, saver.Stats().NumSaved);
+	ASSERT_FALSE(std::filesystem::exists(fixture.Dir / "saved.jam.tmp"));
+
+	std::ifstream stream(jamFile);
+	std::stringstream ss;
+	ss << stream.rdbuf();
+	auto jam = JamFile::FromStream(std::move(ss));
+
+	ASSERT_TRUE(jam.has_value());
+	ASSERT_EQ("saved", jam.value().Name);
+	ASSERT_EQ(1000u, jam.value().QuantiseSamps);
+
+	auto& loops = jam.value().Stations[0].LoopTakes[0].Loops;
+	ASSERT_EQ(4u, loops.size());
+	ASSERT_EQ("saved-1-1-3.wav", loops[2].Name);
+	ASSERT_EQ(1002ul, loops[2].Length);
+	ASSERT_EQ(JamFile::LoopMix::MIX_WIRE, loops[2].Mix.Mix);
+
+	auto wav = WavReadWriter().Read((fixture.Dir / loops[2].Name).wstring(), constants::MaxLoopBufferSize);
+	ASSERT_TRUE(wav.has_value());
+	ASSERT_EQ(constants::MaxLoopFadeSamps + 1002u, std::get<1>(wav.value()));
+	ASSERT_FLOAT_EQ(0.52f, std::get<0>(wav.value())[50]);
+
+	JamLoader loader({ 0, nullptr });
+	auto reloaded = loader.Load(jam.value(), fixture.Dir.wstring());
+	ASSERT_TRUE(reloaded.has_value());
+	ASSERT_EQ(4u, loader.Stats().NumLoaded);
+}
+
+TEST(JamSaver, LeavesOutLoopsRecordedOver) {
+	JamFixture fixture("saved", 1, 2, constants::MaxLoopFadeSamps);
+	auto snapshot = MakeSnapshot(fixture);
+	auto jamFile = fixture.Dir / "saved.jam";
+
+	snapshot.Loops[0][0][1].Source->Record();
+
+	JamSaver saver({ 0, nullptr });
+	ASSERT_TRUE(saver.Save(snapshot, jamFile.wstring()));
+	ASSERT_EQ(2u, saver.Stats().NumLoops);
+	ASSERT_EQ(1u, saver.Stats().NumSaved);
+	ASSERT_FALSE(std::filesystem::exists(fixture.Dir / "saved-1-1-2.wav"));
+	ASSERT_FALSE(std::filesystem::exists(fixture.Dir / "saved-1-1-2.wav.tmp"));
+}
+
+TEST(JamSaver, KeepsPhasesAndGroups) {
+	JamFixture fixture("saved", 1, 2, constants::MaxLoopFadeSamps);
+	auto& loopStructs = fixture.Jam.Stations[0].LoopTakes[0].Loops;
+	loopStructs[0].MasterLoopCount = 100ul;
+	loopStructs[1].MasterLoopCount = 300ul;
+	loopStructs[1].MuteGroups = 3u;
+	loopStructs[1].SelectGroups = 5u;
+	loopStructs[1].Muted = true;
+
+	auto snapshot = MakeSnapshot(fixture);
+	auto jamFile = fixture.Dir / "saved.jam";
+
+	// Played on to different phases, the first past its end
+	std::vector<unsigned int> played = { 950u, 200u };
+	for (auto i = 0u; i < played.size(); i++)
+	{
+		auto& loop = snapshot.Loops[0][0][i];
+		loop.Source->EndMultiPlay(played[i]);
+		loop.Snapshot = loop.Source->Snapshot().value();
+	}
+
+	JamSaver saver({ 0, nullptr });
+	ASSERT_TRUE(saver.Save(snapshot, jamFile.wstring()));
+
+	std::ifstream stream(jamFile);
+	std::stringstream ss;
+	ss << stream.rdbuf();
+	auto jam = JamFile::FromStream(std::move(ss));
+	ASSERT_TRUE(jam.has_value());
+
+	auto& loops = jam.value().Stations[0].LoopTakes[0].Loops;
+	ASSERT_EQ(2u, loops.size());
+	ASSERT_EQ(50ul, loops[0].MasterLoopCount);
+	ASSERT_EQ(500ul, loops[1].MasterLoopCount);
+	ASSERT_EQ(0u, loops[0].MuteGroups);
+	ASSERT_FALSE(loops[0].Muted);
+	ASSERT_EQ(3u, loops[1].MuteGroups);
+	ASSERT_EQ(5u, loops[1].SelectGroups);
+	ASSERT_TRUE(loops[1].Muted);
+
+	// Reloaded loops play on from where they were saved
+	for (auto i = 0u; i < loops.size(); i++)
+	{
+		auto reloaded = Loop::FromFile(LoopParams(), loops[i], fixture.Dir.wstring());
+		ASSERT_TRUE(reloaded.has_value());
+
+		auto reloadedSnapshot = reloaded.value()->Snapshot();
+		ASSERT_TRUE(reloadedSnapshot.has_value());
+		ASSERT_EQ(loops[i].MasterLoopCount, reloadedSnapshot.value().Struct.MasterLoopCount);
+		ASSERT_EQ(loops[i].Muted, reloadedSnapshot.value().Struct.Muted);
+	}
+}
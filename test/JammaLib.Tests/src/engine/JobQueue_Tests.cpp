@@ -0,0 +1,130 @@
+
+#include "gtest/gtest.h"
+#include <atomic>
+#include "engine/JobQueue.h"
+
+using actions::JobAction;
+using engine::JobQueue;
+using engine::JobQueueParams;
+
+JobAction MakeJob(JobAction::JobType type, std::string sourceId)
+{
+	JobAction job;
+	job.JobActionType = type;
+	job.SourceId = sourceId;
+
+	return job;
+}
+
+TEST(JobQueue, RunsPostedJobs) {
+	std::atomic<unsigned int> numRun = 0;
+	JobQueue queue(JobQueueParams{ 3, [&](JobAction&) { numRun++; } });
+
+	for (auto i = 0u; i < 50u; i++)
+		queue.Push(MakeJob(JobAction::JOB_UPDATELOOPS, "loop" + std::to_string(i)));
+
+	ASSERT_TRUE(queue.WaitIdle(std::chrono::milliseconds(5000)));
+	ASSERT_EQ(50u, numRun.load());
+	ASSERT_EQ(50ull, queue.GetMetrics().NumRun);
+	ASSERT_EQ(0u, queue.GetMetrics().Depth);
+}
+
+TEST(JobQueue, CoalescesWaitingJobs) {
+	std::mutex gate;
+	std::vector<std::string> ran;
+	std::unique_lock hold(gate);
+
+	JobQueue queue(JobQueueParams{ 1, [&](JobAction& job) {
+		std::scoped_lock lock(gate);
+		ran.push_back(job.SourceId);
+	} });
+
+	// The first job blocks the worker while the rest queue up
+	queue.Push(MakeJob(JobAction::JOB_UPDATELOOPS, "blocker"));
+	while (queue.GetMetrics().Depth > 0)
+		std::this_thread::yield();
+
+	for (auto i = 0u; i < 10u; i++)
+		queue.Push(MakeJob(JobAction::JOB_UPDATELOOPS, "loop"));
+
+	queue.Push(MakeJob(JobAction::JOB_RESTORELOOP, "loop"));
+
+	ASSERT_EQ(2u, queue.GetMetrics().Depth);
+	ASSERT_EQ(9ull, queue.GetMetrics().NumCoalesced);
+
+	hold.unlock();
+	ASSERT_TRUE(queue.WaitIdle(std::chrono::milliseconds(5000)));
+	ASSERT_EQ(3u, ran.size());
+}
+
+TEST(JobQueue, RunsHighPriorityFirst) {
+	std::mutex gate;
+	std::vector<JobAction::JobType> ran;
+	std::unique_lock hold(gate);
+
+	JobQueue queue(JobQueueParams{ 1, [&](JobAction& job) {
+		std::scoped_lock lock(gate);
+		ran.push_back(job.JobActionType);
+	} });
+
+	queue.Push(MakeJob(JobAction::JOB_UPDATELOOPS, "blocker"));
+	while (queue.GetMetrics().Depth > 0)
+		std::this_thread::yield();
+
+	queue.Push(MakeJob(JobAction::JOB_UPDATELOOPS, "loop1"));
+	queue.Push(MakeJob(JobAction::JOB_UPDATELOOPS, "loop2"));
+	queue.Push(MakeJob(JobAction::JOB_RESTORELOOP, "loop3"));
+
+	hold.unlock();
+	ASSERT_TRUE(queue.WaitIdle(std::chrono::milliseconds(5000)));
+	ASSERT_EQ(4u, ran.size());
+	ASSERT_EQ(JobAction::JOB_RESTORELOOP, ran[1]);
+}
+
+TEST(JobQueue, NeverRunsSameJobConcurrently) {
+	std::atomic<unsigned int> numActive = 0;
+	std::atomic<unsigned int> maxActive = 0;
+
+	JobQueue queue(JobQueueParams{ 4, [&](JobAction&) {
+		auto active = ++numActive;
+		if (active > maxActive)
+			maxActive = active;
+
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+		numActive--;
+	} });
+
+	for (auto i = 0u; i < 200u; i++)
+	{
+		queue.Push(MakeJob(JobAction::JOB_UPDATELOOPS, "loop"));
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+
+	ASSERT_TRUE(queue.WaitIdle(std::chrono::milliseconds(5000)));
+	ASSERT_EQ(1u, maxActive.load());
+}
+
+TEST(JobQueue, StopDropsWaitingJobs) {
+	std::atomic<unsigned int> numRun = 0;
+	std::mutex gate;
+	std::unique_lock hold(gate);
+
+	JobQueue queue(JobQueueParams{ 1, [&](JobAction&) {
+		std::scoped_lock lock(gate);
+		numRun++;
+	} });
+
+	queue.Push(MakeJob(JobAction::JOB_UPDATELOOPS, "blocker"));
+	while (queue.GetMetrics().Depth > 0)
+		std::this_thread::yield();
+
+	queue.Push(MakeJob(JobAction::JOB_UPDATELOOPS, "loop"));
+
+	std::thread stopper([&]() { queue.Stop(); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	hold.unlock();
+	stopper.join();
+
+	ASSERT_EQ(1u, numRun.load());
+	ASSERT_EQ(0u, queue.GetMetrics().Depth);
+}
@@ -0,0 +1,105 @@
+
+#include "gtest/gtest.h"
+#include "engine/LoopModel.h"
+
+using engine::LoopModel;
+using engine::LoopModelParams;
+using audio::BufferBank;
+
+class MockedLoopModel :
+	public LoopModel
+{
+public:
+	MockedLoopModel() :
+		gui::GuiModel(LoopModelParams{}),
+		LoopModel(LoopModelParams{})
+	{
+	}
+
+public:
+	bool IsDirty() const { return _geometryNeedsUpdating; }
+	unsigned int DirtyStart() const { return _dirtyTriStart; }
+	unsigned int DirtyEnd() const { return _dirtyTriEnd; }
+	unsigned int NumTris() const { return (unsigned int)_backVerts.size() / 9; }
+	void Uploaded() { _geometryNeedsUpdating = false; }
+	static unsigned int TrisPerGrain() { return _TrisPerGrain; }
+};
+
+unsigned long GrainsLength(unsigned int numGrains)
+{
+	return constants::MaxLoopFadeSamps + numGrains * constants::GrainSamps;
+}
+
+void WriteBank(BufferBank& bank, unsigned long length)
+{
+	auto oldLength = bank.Length();
+	std::vector<float> samps(length - oldLength, 0.5f);
+
+	bank.Reserve(length);
+	bank.SetLength(length, true);
+	bank.Overwrite(oldLength, samps.data(), (unsigned int)samps.size());
+	bank.UpdateSummary(oldLength, length - oldLength);
+}
+
+TEST(LoopModel, BuildsEveryGrainFirst) {
+	BufferBank bank;
+	WriteBank(bank, GrainsLength(10));
+
+	MockedLoopModel model;
+	model.UpdateModel(bank, 10 * constants::GrainSamps, 100.0f);
+
+	ASSERT_TRUE(model.IsDirty());
+	ASSERT_EQ(10u * MockedLoopModel::TrisPerGrain(), model.NumTris());
+	ASSERT_EQ(0u, model.DirtyStart());
+	ASSERT_EQ(10u * MockedLoopModel::TrisPerGrain(), model.DirtyEnd());
+}
+
+TEST(LoopModel, RebuildsOnlyNewGrainsWhileRecording) {
+	BufferBank bank;
+	WriteBank(bank, GrainsLength(10) + constants::GrainSamps / 2);
+
+	MockedLoopModel model;
+	model.UpdateModel(bank, 10 * constants::GrainSamps + constants::GrainSamps / 2, 100.0f);
+	model.Uploaded();
+
+	// Half a grain was still being recorded, so it is rebuilt
+	// along with the new grains, whose count moves the radius too
+	WriteBank(bank, GrainsLength(20));
+	model.UpdateModel(bank, 20 * constants::GrainSamps, 120.0f);
+
+	ASSERT_TRUE(model.IsDirty());
+	ASSERT_EQ(20u * MockedLoopModel::TrisPerGrain(), model.NumTris());
+	ASSERT_EQ(10u * MockedLoopModel::TrisPerGrain(), model.DirtyStart());
+	ASSERT_EQ(20u * MockedLoopModel::TrisPerGrain(), model.DirtyEnd());
+}
+
+TEST(LoopModel, KeepsGeometryWhenRadiusChanges) {
+	BufferBank bank;
+	WriteBank(bank, GrainsLength(10));
+
+	MockedLoopModel model;
+	model.UpdateModel(bank, 10 * constants::GrainSamps, 100.0f);
+	model.Uploaded();
+
+	model.UpdateModel(bank, 10 * constants::GrainSamps, 150.0f);
+
+	ASSERT_FALSE(model.IsDirty());
+}
+
+TEST(LoopModel, RebuildsEveryGrainWhenBankChanges) {
+	BufferBank bank;
+	WriteBank(bank, GrainsLength(10));
+
+	MockedLoopModel model;
+	model.UpdateModel(bank, 10 * constants::GrainSamps, 100.0f);
+	model.Uploaded();
+
+	// Same length, but recorded afresh
+	bank.Init();
+	WriteBank(bank, GrainsLength(10));
+	model.UpdateModel(bank, 10 * constants::GrainSamps, 100.0f);
+
+	ASSERT_TRUE(model.IsDirty());
+	ASSERT_EQ(0u, model.DirtyStart());
+	ASSERT_EQ(10u * MockedLoopModel::TrisPerGrain(), model.DirtyEnd());
+}
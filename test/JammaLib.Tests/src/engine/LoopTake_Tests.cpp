@@ -0,0 +1,131 @@
+
+#include "gtest/gtest.h"
+#include "resources/ResourceLib.h"
+#include "engine/LoopTake.h"
+#include "audio/BufferBank.h"
+
+using engine::LoopTake;
+using engine::LoopTakeParams;
+using audio::BufferBank;
+using base::AudioSource;
+using base::AudioSink;
+using base::AudioSourceParams;
+
+class MockedTakeSource :
+	public AudioSource
+{
+public:
+	MockedTakeSource() :
+		AudioSource(AudioSourceParams()),
+		NumPlayed(0)
+	{
+	}
+
+public:
+	virtual void OnPlay(const std::shared_ptr<AudioSink> dest,
+		unsigned int numSamps)
+	{
+		for (auto i = 0u; i < numSamps; i++)
+			dest->OnWrite(0.5f, i);
+
+		NumPlayed += numSamps;
+	}
+	virtual void EndPlay(unsigned int numSamps) {}
+
+	unsigned long NumPlayed;
+};
+
+void WriteBlocks(LoopTake& take,
+	std::shared_ptr<MockedTakeSource> src,
+	unsigned int numBlocks,
+	unsigned int blockSize)
+{
+	for (auto block = 0u; block < numBlocks; block++)
+	{
+		take.OnWriteChannel(0, src, blockSize);
+		src->EndPlay(blockSize);
+		take.EndMultiWrite(blockSize, true);
+	}
+}
+
+TEST(LoopTake, EndsRecordingAtExactSample) {
+	auto blockSize = 64u;
+	auto endRecordSamps = 100u;
+	auto src = std::make_shared<MockedTakeSource>();
+
+	LoopTake take(LoopTakeParams{});
+	take.Prepare({ 0 });
+	ASSERT_TRUE(take.Record({ 0 }));
+	WriteBlocks(take, src, 10, blockSize);
+
+	ASSERT_EQ(640ul, take.NumRecordedSamps());
+
+	take.Play(0, 600, endRecordSamps);
+	ASSERT_EQ(LoopTake::STATE_PLAYINGRECORDING, take.GetState());
+
+	// The tail ends part way through the second block
+	WriteBlocks(take, src, 1, blockSize);
+	ASSERT_EQ(LoopTake::STATE_PLAYINGRECORDING, take.GetState());
+
+	WriteBlocks(take, src, 1, blockSize);
+	ASSERT_EQ(LoopTake::STATE_PLAYING, take.GetState());
+	ASSERT_EQ(640ul + endRecordSamps, take.NumRecordedSamps());
+	ASSERT_EQ(640ul + endRecordSamps, src->NumPlayed);
+
+	// Nothing more is recorded once playing
+	WriteBlocks(take, src, 5, blockSize);
+	ASSERT_EQ(640ul + endRecordSamps, take.NumRecordedSamps());
+}
+
+TEST(LoopTake, RecordsOnPreparedLoops) {
+	auto src = std::make_shared<MockedTakeSource>();
+
+	LoopTake take(LoopTakeParams{});
+	ASSERT_FALSE(take.Record({ 0 }));
+
+	take.Prepare({ 0, 1 });
+	ASSERT_FALSE(take.Record({ 0, 2 }));
+	ASSERT_EQ(LoopTake::STATE_DEFAULT, take.GetState());
+
+	ASSERT_TRUE(take.Record({ 1 }));
+	ASSERT_EQ(LoopTake::STATE_RECORDING, take.GetState());
+
+	WriteBlocks(take, src, 2, 64);
+	ASSERT_EQ(128ul, take.NumRecordedSamps());
+
+	// Each prepared loop is only recorded on once
+	ASSERT_FALSE(take.Record({ 1 }));
+	ASSERT_TRUE(take.Record({ 0 }));
+}
+
+TEST(LoopTake, StartsRecordingWithPoolDry) {
+	auto src = std::make_shared<MockedTakeSource>();
+
+	LoopTake take(LoopTakeParams{});
+	take.Prepare({ 0, 1 });
+
+	// Every loop starting at once can empty the pool
+	// before the gui thread gets round to refilling it
+	std::vector<std::unique_ptr<float[]>> pages;
+	std::vector<std::unique_ptr<float[]>> summaries;
+
+	while (auto page = BufferBank::Pool().Acquire())
+		pages.push_back(std::move(page));
+	while (auto summary = BufferBank::SummaryPool().Acquire())
+		summaries.push_back(std::move(summary));
+
+	auto numMisses = BufferBank::Pool().NumMisses();
+	auto numSummaryMisses = BufferBank::SummaryPool().NumMisses();
+
+	ASSERT_TRUE(take.Record({ 0, 1 }));
+	WriteBlocks(take, src, 2, 64);
+
+	ASSERT_EQ(128ul, take.NumRecordedSamps());
+	ASSERT_EQ(numMisses, BufferBank::Pool().NumMisses());
+	ASSERT_EQ(numSummaryMisses, BufferBank::SummaryPool().NumMisses());
+
+	for (auto& page : pages)
+		BufferBank::Pool().Release(std::move(page));
+	for (auto& summary : summaries)
+		BufferBank::SummaryPool().Release(std::move(summary));
+}
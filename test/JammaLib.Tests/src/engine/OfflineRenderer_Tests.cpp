@@ -0,0 +1,280 @@
+
+#include "gtest/gtest.h"
+#include "engine/Scene.h"
+#include "engine/OfflineRenderer.h"
+#include "engine/Station.h"
+#include "engine/Trigger.h"
+#include "utils/RealtimeCheck.h"
+
+using engine::Scene;
+using engine::SceneParams;
+using engine::Station;
+using engine::StationParams;
+using engine::Trigger;
+using engine::TriggerParams;
+using engine::OfflineRenderer;
+using engine::OfflineRendererParams;
+using actions::KeyAction;
+
+class StationScene :
+	public Scene
+{
+public:
+	using Scene::Scene;
+	using Scene::AddStation;
+};
+
+// A station whose trigger records input 0 on a key
+std::shared_ptr<Trigger> AddKeyStation(StationScene& scene, unsigned int keyChar)
+{
+	TriggerParams trigParams;
+	trigParams.Activate = { engine::DualBinding(
+		engine::TriggerBinding{ engine::TRIGGER_KEY, keyChar, 1 },
+		engine::TriggerBinding{ engine::TRIGGER_KEY, keyChar, 0 }) };
+	trigParams.DebounceMs = 0;
+	auto trigger = std::make_shared<Trigger>(trigParams);
+	trigger->AddInputChannel(0);
+
+	auto station = std::make_shared<Station>(StationParams());
+	station->AddTrigger(trigger);
+	scene.AddStation(station);
+
+	return trigger;
+}
+
+void PressKey(Scene& scene, unsigned int keyChar, bool isDown)
+{
+	KeyAction action;
+	action.KeyActionType = isDown ? KeyAction::KEY_DOWN : KeyAction::KEY_UP;
+	action.KeyChar = keyChar;
+	action.Modifiers = actions::MODIFIER_NONE;
+	action.IsSystem = false;
+	scene.OnAction(action);
+}
+
+TEST(OfflineRenderer, RendersAllBlocks) {
+	auto sceneParams = SceneParams(base::DrawableParams(), base::SizeableParams());
+	io::UserConfig userConfig = {};
+	Scene scene(sceneParams, userConfig);
+
+	OfflineRendererParams params;
+	params.BlockSize = 256;
+	params.SampleRate = 48000;
+	params.NumInputChannels = 2;
+	params.NumOutputChannels = 2;
+	params.NumSamps = 10000;
+
+	auto numSamps = 0ul;
+	auto isSilent = true;
+	OfflineRenderer renderer(params);
+	auto stats = renderer.Render(scene, [&](const float* buf, unsigned int blockSamps) {
+		for (auto i = 0u; i < blockSamps * 2; i++)
+		{
+			if (buf[i] != 0.0f)
+				isSilent = false;
+		}
+
+		numSamps += blockSamps;
+	});
+
+	ASSERT_TRUE(stats.has_value());
+	ASSERT_EQ(10000ul, stats.value().NumSamps);
+	ASSERT_EQ(40u, stats.value().NumBlocks);
+	ASSERT_EQ(10000ul, numSamps);
+	ASSERT_TRUE(isSilent);
+}
+
+TEST(OfflineRenderer, WritesMultichannelWav) {
+	auto sceneParams = SceneParams(base::DrawableParams(), base::SizeableParams());
+	io::UserConfig userConfig = {};
+	Scene scene(sceneParams, userConfig);
+
+	auto fileName = std::filesystem::temp_directory_path() / "jamma_offline_test.wav";
+
+	OfflineRendererParams params;
+	params.BlockSize = 100;
+	params.SampleRate = 44100;
+	params.NumInputChannels = 0;
+	params.NumOutputChannels = 3;
+	params.NumSamps = 1000;
+	params.OutputFile = fileName.wstring();
+
+	OfflineRenderer renderer(params);
+	auto stats = renderer.Render(scene);
+
+	ASSERT_TRUE(stats.has_value());
+	ASSERT_EQ(io::WavStreamWriter::HeaderSize + (1000u * 3u * sizeof(float)), std::filesystem::file_size(fileName));
+
+	std::filesystem::remove(fileName);
+}
+
+TEST(OfflineRenderer, RejectsOversizedBlocks) {
+	auto sceneParams = SceneParams(base::DrawableParams(), base::SizeableParams());
+	io::UserConfig userConfig = {};
+	Scene scene(sceneParams, userConfig);
+
+	OfflineRendererParams params;
+	params.BlockSize = constants::MaxBlockSize + 1;
+	params.SampleRate = 44100;
+	params.NumInputChannels = 1;
+	params.NumOutputChannels = 1;
+	params.NumSamps = 1000;
+
+	OfflineRenderer renderer(params);
+
+	ASSERT_FALSE(renderer.Render(scene).has_value());
+}
+
+TEST(OfflineRenderer, RejectsMismatchedInputRate) {
+	auto sceneParams = SceneParams(base::DrawableParams(), base::SizeableParams());
+	io::UserConfig userConfig = {};
+	Scene scene(sceneParams, userConfig);
+
+	auto fileName = std::filesystem::temp_directory_path() / "jamma_offline_rate_test.wav";
+	std::vector<float> samps(1000, 0.1f);
+
+	io::WavStreamWriter writer;
+	writer.Open(fileName.wstring(), 1, 44100);
+	writer.Write(samps.data(), (unsigned int)samps.size());
+	writer.Close();
+
+	OfflineRendererParams params;
+	params.BlockSize = 100;
+	params.SampleRate = 48000;
+	params.NumInputChannels = 1;
+	params.NumOutputChannels = 1;
+	params.NumSamps = 1000;
+	params.InputFiles = { fileName.wstring() };
+
+	OfflineRenderer renderer(params);
+
+	ASSERT_FALSE(renderer.Render(scene).has_value());
+
+	std::filesystem::remove(fileName);
+}
+
+TEST(OfflineRenderer, RestoresRealtimeChecks) {
+	auto sceneParams = SceneParams(base::DrawableParams(), base::SizeableParams());
+	io::UserConfig userConfig = {};
+	Scene scene(sceneParams, userConfig);
+
+	OfflineRendererParams params;
+	params.BlockSize = 100;
+	params.SampleRate = 44100;
+	params.NumInputChannels = 0;
+	params.NumOutputChannels = 1;
+	params.NumSamps = 1000;
+
+	OfflineRenderer renderer(params);
+	auto wasEnabled = utils::RealtimeCheck::IsEnabled();
+
+	ASSERT_TRUE(renderer.Render(scene).has_value());
+	ASSERT_EQ(wasEnabled, utils::RealtimeCheck::IsEnabled());
+}
+
+TEST(OfflineRenderer, BoundKeyIsRealtimeSafe) {
+	auto sceneParams = SceneParams(base::DrawableParams(), base::SizeableParams());
+	io::UserConfig userConfig = {};
+	// Too long to be held inline, so any copy of the config allocates
+	userConfig.Audio.Name = "An audio device with a long name";
+	StationScene scene(sceneParams, userConfig);
+
+	const unsigned int keyChar = 49;
+	auto trigger = AddKeyStation(scene, keyChar);
+
+	OfflineRendererParams params;
+	params.BlockSize = 64;
+	params.SampleRate = 48000;
+	params.NumInputChannels = 1;
+	params.NumOutputChannels = 2;
+	params.NumSamps = 64 * 40;
+
+	// Recorded for a while then ended, with each
+	// press landing at the start of the next block
+	auto numBlocks = 0u;
+	auto wasRecording = false;
+	OfflineRenderer renderer(params);
+	auto stats = renderer.Render(scene, [&](const float* buf, unsigned int blockSamps) {
+		numBlocks++;
+
+		if ((2u == numBlocks) || (20u == numBlocks))
+			PressKey(scene, keyChar, true);
+		else if ((3u == numBlocks) || (21u == numBlocks))
+			PressKey(scene, keyChar, false);
+		else if (10u == numBlocks)
+			wasRecording = engine::TRIGSTATE_RECORDING == trigger->GetState();
+	});
+
+	ASSERT_TRUE(stats.has_value());
+	ASSERT_TRUE(wasRecording);
+	ASSERT_EQ(engine::TRIGSTATE_DEFAULT, trigger->GetState());
+	ASSERT_EQ(0ull, stats.value().NumRealtimeViolations);
+}
+
+TEST(OfflineRenderer, OutputMatchesForAnyNumWorkers) {
+	auto sceneParams = SceneParams(base::DrawableParams(), base::SizeableParams());
+	auto fileName = std::filesystem::temp_directory_path() / "jamma_offline_workers_test.wav";
+	std::vector<float> samps(48000 * 4);
+
+	for (auto i = 0u; i < samps.size(); i++)
+		samps[i] = 0.5f * (float)std::sin(0.01 * (double)i);
+
+	io::WavStreamWriter writer;
+	writer.Open(fileName.wstring(), 1, 48000);
+	writer.Write(samps.data(), (unsigned int)samps.size());
+	writer.Close();
+
+	const std::vector<unsigned int> keyChars = { 49, 50, 51 };
+
+	// Each station records its own stretch of the input, so every
+	// bus carries a different loop by the end (input reaches the
+	// loops well over a second late, so they start after that)
+	auto render = [&](unsigned int numWorkers) {
+		io::UserConfig userConfig = {};
+		userConfig.Audio.NumWorkers = numWorkers;
+		StationScene scene(sceneParams, userConfig);
+
+		for (auto keyChar : keyChars)
+			AddKeyStation(scene, keyChar);
+
+		OfflineRendererParams params;
+		params.BlockSize = 512;
+		params.SampleRate = 48000;
+		params.NumInputChannels = 1;
+		params.NumOutputChannels = 2;
+		params.NumSamps = 512 * 400;
+		params.InputFiles = { fileName.wstring() };
+
+		auto numBlocks = 0u;
+		std::vector<float> output;
+		OfflineRenderer renderer(params);
+		auto stats = renderer.Render(scene, [&](const float* buf, unsigned int blockSamps) {
+			numBlocks++;
+
+			for (auto station = 0u; station < keyChars.size(); station++)
+			{
+				auto start = 150u + (station * 5u);
+				auto end = 250u + (station * 20u);
+
+				if ((start == numBlocks) || (end == numBlocks))
+					PressKey(scene, keyChars[station], true);
+				else if ((start + 1 == numBlocks) || (end + 1 == numBlocks))
+					PressKey(scene, keyChars[station], false);
+			}
+
+			output.insert(output.end(), buf, buf + (blockSamps * 2));
+		});
+
+		EXPECT_TRUE(stats.has_value());
+		return output;
+	};
+
+	auto serial = render(0);
+	auto parallel = render(3);
+
+	ASSERT_EQ(serial.size(), parallel.size());
+	ASSERT_TRUE(std::any_of(serial.begin(), serial.end(), [](float samp) { return samp != 0.0f; }));
+	ASSERT_EQ(0, memcmp(serial.data(), parallel.data(), serial.size() * sizeof(float)));
+
+	std::filesystem::remove(fileName);
+}
@@ -41,7 +41,7 @@ public:
 		_lastMatched(false),
 		_numTimesCalled(0) {}
 public:
-	virtual actions::ActionResult OnAction(actions::TriggerAction action)
+	virtual actions::ActionResult OnAction(const actions::TriggerAction& action)
 	{
 		_numTimesCalled++;
 		_lastMatched = action.ActionType == _expected;
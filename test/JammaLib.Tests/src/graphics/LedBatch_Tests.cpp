@@ -0,0 +1,27 @@
+
+#include "gtest/gtest.h"
+#include "graphics/LedBatch.h"
+
+using graphics::LedBatch;
+
+TEST(LedBatch, SubmitAddsInstances) {
+	LedBatch batch;
+
+	for (auto vu = 0u; vu < 20u; vu++)
+	{
+		for (auto led = 0u; led < 16u; led++)
+			batch.Submit(glm::mat4(1.0), 40.0f, 0.0f, led * 1.5f, (led + 1) * 1.5f, glm::vec4(1.0f));
+	}
+
+	ASSERT_EQ(320u, batch.NumInstances());
+	ASSERT_EQ(0u, batch.NumDrawCalls());
+}
+
+TEST(LedBatch, ClearEmptiesBatch) {
+	LedBatch batch;
+
+	batch.Submit(glm::mat4(1.0), 40.0f, 0.0f, 0.0f, 1.0f, glm::vec4(1.0f));
+	batch.Clear();
+
+	ASSERT_EQ(0u, batch.NumInstances());
+}
@@ -0,0 +1,213 @@
+
+#include "gtest/gtest.h"
+#include <map>
+#include <set>
+#include "graphics/VertexArray.h"
+
+using graphics::GlBackend;
+using graphics::VertexArray;
+
+class MockedGlBackend :
+	public GlBackend
+{
+public:
+	MockedGlBackend() :
+		NumGenerated(0),
+		NumBufferDatas(0),
+		NumBufferSubDatas(0),
+		LiveArrays({}),
+		LiveBuffers({}),
+		BufferBytes({}),
+		Divisors({}),
+		_nextId(1),
+		_boundBuffer(0)
+	{
+	}
+
+public:
+	virtual unsigned int GenVertexArray() override
+	{
+		NumGenerated++;
+		LiveArrays.insert(_nextId);
+		return _nextId++;
+	}
+
+	virtual void DeleteVertexArray(unsigned int vertexArray) override
+	{
+		LiveArrays.erase(vertexArray);
+	}
+
+	virtual void BindVertexArray(unsigned int vertexArray) override {}
+
+	virtual unsigned int GenBuffer() override
+	{
+		NumGenerated++;
+		LiveBuffers.insert(_nextId);
+		return _nextId++;
+	}
+
+	virtual void DeleteBuffer(unsigned int buffer) override
+	{
+		LiveBuffers.erase(buffer);
+		BufferBytes.erase(buffer);
+	}
+
+	virtual void BindArrayBuffer(unsigned int buffer) override
+	{
+		_boundBuffer = buffer;
+	}
+
+	virtual void BufferData(size_t numBytes, const void* data) override
+	{
+		NumBufferDatas++;
+		BufferBytes[_boundBuffer] = numBytes;
+	}
+
+	virtual void BufferSubData(size_t offsetBytes, size_t numBytes, const void* data) override
+	{
+		NumBufferSubDatas++;
+		LastSubData = { offsetBytes, numBytes };
+	}
+
+	virtual void VertexAttribPointer(unsigned int index, unsigned int numComponents) override {}
+
+	virtual void VertexAttribDivisor(unsigned int index, unsigned int divisor) override
+	{
+		Divisors[index] = divisor;
+	}
+
+	size_t TotalBytes() const
+	{
+		size_t total = 0;
+
+		for (auto& bytes : BufferBytes)
+			total += bytes.second;
+
+		return total;
+	}
+
+public:
+	unsigned int NumGenerated;
+	unsigned int NumBufferDatas;
+	unsigned int NumBufferSubDatas;
+	std::set<unsigned int> LiveArrays;
+	std::set<unsigned int> LiveBuffers;
+	std::map<unsigned int, size_t> BufferBytes;
+	std::map<unsigned int, unsigned int> Divisors;
+	std::pair<size_t, size_t> LastSubData;
+
+private:
+	unsigned int _nextId;
+	unsigned int _boundBuffer;
+};
+
+TEST(VertexArray, GrowsWithoutRecreatingBuffers) {
+	auto backend = std::make_shared<MockedGlBackend>();
+	VertexArray vertexArray(backend, { 3, 2 });
+
+	ASSERT_TRUE(vertexArray.Resize(30));
+	auto numGenerated = backend->NumGenerated;
+	ASSERT_EQ(3u, numGenerated);
+
+	for (auto numVerts = 31u; numVerts < 3000u; numVerts += 3)
+		vertexArray.Resize(numVerts);
+
+	ASSERT_EQ(numGenerated, backend->NumGenerated);
+	ASSERT_EQ(1u, backend->LiveArrays.size());
+	ASSERT_EQ(2u, backend->LiveBuffers.size());
+	ASSERT_GE(vertexArray.Capacity(), 2998u);
+
+	// Geometric growth keeps reallocations logarithmic
+	ASSERT_LT(backend->NumBufferDatas, 40u);
+}
+
+TEST(VertexArray, ResizeWithinCapacityKeepsStorage) {
+	auto backend = std::make_shared<MockedGlBackend>();
+	VertexArray vertexArray(backend, { 3, 2 });
+
+	vertexArray.Resize(100);
+	vertexArray.Resize(120);
+	auto numBufferDatas = backend->NumBufferDatas;
+
+	ASSERT_FALSE(vertexArray.Resize(140));
+	ASSERT_FALSE(vertexArray.Resize(50));
+	ASSERT_EQ(numBufferDatas, backend->NumBufferDatas);
+	ASSERT_EQ(50u, vertexArray.NumVerts());
+}
+
+TEST(VertexArray, UploadsOnlyDirtyRange) {
+	auto backend = std::make_shared<MockedGlBackend>();
+	VertexArray vertexArray(backend, { 3, 2 });
+	std::vector<float> verts(300 * 3);
+
+	vertexArray.Resize(300);
+	auto numBufferDatas = backend->NumBufferDatas;
+
+	vertexArray.Upload(0, 240, 60, verts.data() + 240 * 3);
+
+	ASSERT_EQ(numBufferDatas, backend->NumBufferDatas);
+	ASSERT_EQ(240u * 3u * sizeof(float), backend->LastSubData.first);
+	ASSERT_EQ(60u * 3u * sizeof(float), backend->LastSubData.second);
+}
+
+TEST(VertexArray, FullUploadOrphansStorage) {
+	auto backend = std::make_shared<MockedGlBackend>();
+	VertexArray vertexArray(backend, { 3, 2 });
+	std::vector<float> uvs(300 * 2);
+
+	vertexArray.Resize(300);
+	auto numBufferDatas = backend->NumBufferDatas;
+
+	vertexArray.Upload(1, 0, 300, uvs.data());
+
+	ASSERT_EQ(numBufferDatas + 1, backend->NumBufferDatas);
+	ASSERT_EQ(300u * 2u * sizeof(float), backend->LastSubData.second);
+}
+
+TEST(VertexArray, TracksGpuBytes) {
+	auto backend = std::make_shared<MockedGlBackend>();
+	VertexArray vertexArray(backend, { 3, 2 });
+
+	ASSERT_EQ(0u, vertexArray.GpuBytes());
+
+	vertexArray.Resize(100);
+	vertexArray.Resize(1000);
+
+	ASSERT_EQ(backend->TotalBytes(), vertexArray.GpuBytes());
+	ASSERT_EQ((size_t)vertexArray.Capacity() * 5u * sizeof(float), vertexArray.GpuBytes());
+}
+
+TEST(VertexArray, ReleaseDeletesEverything) {
+	auto backend = std::make_shared<MockedGlBackend>();
+	VertexArray vertexArray(backend, { 3, 2, 3 });
+
+	vertexArray.Resize(100);
+	vertexArray.Release();
+
+	ASSERT_TRUE(backend->LiveArrays.empty());
+	ASSERT_TRUE(backend->LiveBuffers.empty());
+	ASSERT_EQ(0u, vertexArray.GpuBytes());
+	ASSERT_EQ(0u, vertexArray.Id());
+
+	vertexArray.Resize(100);
+	vertexArray.Release();
+
+	ASSERT_TRUE(backend->LiveArrays.empty());
+	ASSERT_TRUE(backend->LiveBuffers.empty());
+}
+
+TEST(VertexArray, InstancedSetsDivisors) {
+	auto backend = std::make_shared<MockedGlBackend>();
+	VertexArray perVertex(backend, { 3, 2 });
+	perVertex.Resize(10);
+
+	ASSERT_TRUE(backend->Divisors.empty());
+
+	VertexArray perInstance(backend, { 4, 4, 4 }, 1);
+	perInstance.Resize(10);
+
+	ASSERT_EQ(3u, backend->Divisors.size());
+
+	for (auto& divisor : backend->Divisors)
+		ASSERT_EQ(1u, divisor.second);
+}
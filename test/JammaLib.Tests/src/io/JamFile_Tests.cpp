@@ -183,4 +183,35 @@ TEST(JamFile, ParsesFile) {
 
 	ASSERT_EQ(4321, jam.value().QuantiseSamps);
 	ASSERT_EQ(engine::Timer::QUANTISE_POWER, jam.value().Quantisation);
-}
\ No newline at end of file
+}
+
+TEST(JamFile, WritesWhatItReads) {
+	auto loop1 = std::regex_replace(std::regex_replace(LoopString, std::regex("%NAME%"), "loop1"), std::regex("%INDEX%"), "1");
+	auto wire = "{\"name\":\"loop2\",\"length\":440,\"mix\":{\"type\":\"wire\",\"chans\":[3,1]}}";
+	auto take = "{\"name\":\"take1\",\"loops\":[" + loop1 + "," + wire + "]}";
+	auto str = "{\"name\":\"jam\",\"stations\":[{\"name\":\"station1\",\"stationtype\":2,\"takes\":[" + take + "]}],\"quantisesamps\":4321,\"quantisation\":\"multiple\"}";
+	auto jam = JamFile::FromStream(std::stringstream(str));
+	ASSERT_TRUE(jam.has_value());
+
+	std::stringstream ss;
+	ASSERT_TRUE(JamFile::ToStream(jam.value(), ss));
+
+	auto reread = JamFile::FromStream(std::move(ss));
+	ASSERT_TRUE(reread.has_value());
+	ASSERT_EQ("jam", reread.value().Name);
+	ASSERT_EQ(4321, reread.value().QuantiseSamps);
+	ASSERT_EQ(engine::Timer::QUANTISE_MULTIPLE, reread.value().Quantisation);
+	ASSERT_EQ(1, reread.value().Stations.size());
+	ASSERT_EQ(2, reread.value().Stations[0].StationType);
+
+	auto& loops = reread.value().Stations[0].LoopTakes[0].Loops;
+	ASSERT_EQ(2, loops.size());
+	ASSERT_EQ("loop1", loops[0].Name);
+	ASSERT_EQ(220, loops[0].Length);
+	ASSERT_EQ(7, loops[0].MasterLoopCount);
+	ASSERT_EQ(0.56, loops[0].Level);
+	ASSERT_EQ(11, loops[0].MuteGroups);
+	ASSERT_EQ(0.8, std::get<std::vector<double>>(loops[0].Mix.Params)[1]);
+	ASSERT_EQ(JamFile::LoopMix::MIX_WIRE, loops[1].Mix.Mix);
+	ASSERT_EQ(3ul, std::get<std::vector<unsigned long>>(loops[1].Mix.Params)[0]);
+}
@@ -14,6 +14,26 @@ public:
 	{
 		return std::get<Json::JsonPart>(Json::FromStream(std::move(ss)).value());
 	}
+
+	static std::optional<Json::JsonValue> FromStreamLegacy(std::stringstream ss)
+	{
+		return Json::ParseValue(std::move(ss)).Value;
+	}
+};
+
+const std::vector<std::string> JsonCorpus = {
+	"{\"bool\":true}",
+	"{\"int\":-12}",
+	"{\"ulong\":2147483648}",
+	"{\"double\":0.34}",
+	"{\"string\":\"hello\"}",
+	"{\"string\":\"hello\",\"int\":-7}",
+	"{\"arr\":[TrUe,fAlsE]}",
+	"{\"arr\":[-3,4]}",
+	"{\"arr\":[333,444]}",
+	"{\"arr\":[1.1,2.2]}",
+	"{\"arr\":[\"hello\",\"you\"]}",
+	"{\"struct\":{\"name\":\"you\",\"business\":\"monkeying\"}}"
 };
 
 TEST(Json, ParsesBool) {
@@ -204,3 +224,114 @@ TEST(Json, ParsesStruct) {
 	ASSERT_EQ("you", res1);
 	ASSERT_EQ("monkeying", res2);
 }
+
+TEST(Json, ParsesStringWithSpacesAndEscapes) {
+	auto str = "{\"string\":\"hello \\\"you\\\" \\u00e9\"}";
+	auto json = JsonMock::FromStream(std::stringstream(str));
+
+	ASSERT_TRUE(json.has_value());
+	ASSERT_EQ("hello \"you\" \xC3\xA9", std::get<std::string>(json.value().KeyValues["string"]));
+}
+
+TEST(Json, ParsesExponent) {
+	auto str = "{\"double\":-1.5e3}";
+	auto json = JsonMock::FromStream(std::stringstream(str));
+
+	ASSERT_TRUE(json.has_value());
+	ASSERT_EQ(-1500.0, std::get<double>(json.value().KeyValues["double"]));
+}
+
+TEST(Json, WidensNumberArrays) {
+	auto str = "{\"doubles\":[0, 0.5], \"longs\":[3, -4]}";
+	auto json = JsonMock::FromStream(std::stringstream(str));
+
+	ASSERT_TRUE(json.has_value());
+
+	auto doubles = std::get<std::vector<double>>(std::get<Json::JsonArray>(json.value().KeyValues["doubles"]).Array);
+	auto longs = std::get<std::vector<long>>(std::get<Json::JsonArray>(json.value().KeyValues["longs"]).Array);
+
+	ASSERT_EQ(2, doubles.size());
+	ASSERT_EQ(0.5, doubles[1]);
+	ASSERT_EQ(2, longs.size());
+	ASSERT_EQ(-4, (int)longs[1]);
+}
+
+TEST(Json, ParsesStructArrayAndEmptyArray) {
+	auto str = "{\"parts\":[{\"a\":1},{\"a\":2}],\"empty\":[]}";
+	auto json = JsonMock::FromStream(std::stringstream(str));
+
+	ASSERT_TRUE(json.has_value());
+
+	auto parts = std::get<Json::JsonArray>(json.value().KeyValues["parts"]);
+	auto empty = std::get<Json::JsonArray>(json.value().KeyValues["empty"]);
+
+	ASSERT_EQ(2u, parts.Length);
+	ASSERT_EQ(2ul, std::get<unsigned long>(std::get<std::vector<Json::JsonPart>>(parts.Array)[1].KeyValues["a"]));
+	ASSERT_EQ(0u, empty.Length);
+}
+
+TEST(Json, ToleratesUnclosedText) {
+	auto str = "{\"name\":\"rig\",\"triggers\":[{\"name\":\"Trig1\",\"input\":[0,1]}";
+	auto json = Json::FromString(str);
+
+	ASSERT_TRUE(json.has_value());
+
+	auto part = std::get<Json::JsonPart>(json.value());
+	auto triggers = std::get<Json::JsonArray>(part.KeyValues["triggers"]);
+
+	ASSERT_EQ("rig", std::get<std::string>(part.KeyValues["name"]));
+	ASSERT_EQ(1u, triggers.Length);
+}
+
+TEST(Json, WritesWhatItReads) {
+	for (auto& str : JsonCorpus)
+	{
+		auto json = Json::FromString(str);
+		ASSERT_TRUE(json.has_value());
+
+		std::stringstream ss;
+		ASSERT_TRUE(Json::ToStream(json.value(), ss));
+
+		auto reread = Json::FromString(ss.str());
+		ASSERT_TRUE(reread.has_value());
+
+		std::stringstream rewritten;
+		Json::ToStream(reread.value(), rewritten);
+		ASSERT_EQ(ss.str(), rewritten.str());
+	}
+}
+
+TEST(Json, WritesEscapesAndWholeDoubles) {
+	Json::JsonPart part;
+	part.KeyValues["text"] = std::string("say \"hi\"\n\\");
+	part.KeyValues["whole"] = 2.0;
+	part.KeyValues["small"] = 1.5e-7;
+
+	std::stringstream ss;
+	ASSERT_TRUE(Json::ToStream(part, ss));
+
+	auto json = std::get<Json::JsonPart>(Json::FromString(ss.str()).value());
+
+	ASSERT_EQ("say \"hi\"\n\\", std::get<std::string>(json.KeyValues["text"]));
+	ASSERT_EQ(2.0, std::get<double>(json.KeyValues["whole"]));
+	ASSERT_EQ(1.5e-7, std::get<double>(json.KeyValues["small"]));
+}
+
+TEST(Json, MatchesLegacyParser) {
+	// The corpus is repeated into one large document
+	std::string doc = "{";
+	for (auto i = 0u; i < 100u; i++)
+	{
+		for (auto j = 0u; j < JsonCorpus.size(); j++)
+			doc += (doc.size() > 1 ? ",\"" : "\"") + std::to_string(i) + "_" + std::to_string(j) + "\":" + JsonCorpus[j];
+	}
+	doc += "}";
+
+	auto legacy = JsonMock::FromStreamLegacy(std::stringstream(doc));
+	auto json = Json::FromString(doc);
+
+	ASSERT_TRUE(legacy.has_value());
+	ASSERT_TRUE(json.has_value());
+	ASSERT_EQ(100u * JsonCorpus.size(), std::get<Json::JsonPart>(json.value()).KeyValues.size());
+	ASSERT_EQ(std::get<Json::JsonPart>(legacy.value()).KeyValues.size(), std::get<Json::JsonPart>(json.value()).KeyValues.size());
+}
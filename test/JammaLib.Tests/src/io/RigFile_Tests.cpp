@@ -108,4 +108,25 @@ TEST(RigFile, ParsesFile) {
 
 	ASSERT_EQ(5, rig.value().Triggers[1].TriggerPairs[0].ActivateDown);
 	ASSERT_EQ(6, rig.value().Triggers[1].TriggerPairs[0].DitchDown);
-}
\ No newline at end of file
+}
+
+TEST(RigFile, WritesWhatItReads) {
+	auto rig = RigFile::FromStream(std::stringstream(RigFile::DefaultJson));
+	ASSERT_TRUE(rig.has_value());
+
+	rig.value().User.Loop.FadeSamps = 512;
+
+	std::stringstream ss;
+	ASSERT_TRUE(RigFile::ToStream(rig.value(), ss));
+
+	auto reread = RigFile::FromStream(std::move(ss));
+	ASSERT_TRUE(reread.has_value());
+	ASSERT_EQ("default", reread.value().Name);
+	ASSERT_EQ(512, reread.value().User.Audio.BufSize);
+	ASSERT_EQ(3000, reread.value().User.Audio.Latency);
+	ASSERT_EQ(512, reread.value().User.Loop.FadeSamps);
+	ASSERT_EQ(280, reread.value().User.Trigger.DebounceSamps);
+	ASSERT_EQ(1, reread.value().Triggers.size());
+	ASSERT_EQ(50, reread.value().Triggers[0].TriggerPairs[0].DitchDown);
+	ASSERT_EQ(2, reread.value().Triggers[0].InputChannels.size());
+}
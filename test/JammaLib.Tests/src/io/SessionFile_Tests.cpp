@@ -0,0 +1,126 @@
+
+#include "gtest/gtest.h"
+#include <fstream>
+#include <cstdint>
+#include "io/SessionFile.h"
+#include "io/WavReadWriter.h"
+#include "../JamFixture.h"
+
+using io::SessionFile;
+using io::SessionWriter;
+using io::JamFile;
+using io::WavReadWriter;
+
+// The first numLoops of the fixture's loops, as a session
+bool WriteSession(const JamFixture& fixture, std::filesystem::path file, unsigned int numLoops)
+{
+	SessionWriter writer;
+	writer.Open(file.wstring(), fixture.Jam, JamFixture::SampleRate);
+
+	for (auto loop = 0u; loop < numLoops; loop++)
+	{
+		writer.BeginLoop();
+		writer.Write(fixture.Samps[loop].data(), (unsigned int)fixture.Samps[loop].size());
+	}
+
+	return writer.Close();
+}
+
+TEST(SessionFile, MapsEveryLoopOnAPage) {
+	JamFixture fixture("session", 1, 3, 0);
+	auto file = fixture.Dir / "test.jamsession";
+
+	ASSERT_TRUE(WriteSession(fixture, file, 3));
+
+	auto session = SessionFile::Open(file.wstring());
+	ASSERT_TRUE(session.has_value());
+	ASSERT_EQ(1u, session.value()->Version());
+	ASSERT_EQ(48000u, session.value()->SampleRate());
+	ASSERT_EQ(3u, session.value()->NumLoops());
+	ASSERT_EQ("session", session.value()->Jam().Name);
+	ASSERT_EQ(engine::Timer::QUANTISE_POWER, session.value()->Jam().Quantisation);
+	ASSERT_EQ(3u, session.value()->Jam().Stations[0].LoopTakes[0].Loops.size());
+
+	for (auto loop = 0u; loop < 3u; loop++)
+	{
+		auto [samps, numSamps] = session.value()->LoopSamps(loop);
+
+		ASSERT_NE(nullptr, samps);
+		ASSERT_EQ(0u, (std::uintptr_t)samps % SessionWriter::PageSize);
+		ASSERT_EQ(fixture.Samps[loop].size(), numSamps);
+
+		for (auto i = 0u; i < numSamps; i++)
+			ASSERT_EQ(fixture.Samps[loop][i], samps[i]);
+	}
+
+	auto [samps, numSamps] = session.value()->LoopSamps(3u);
+	ASSERT_EQ(nullptr, samps);
+}
+
+TEST(SessionFile, NeedsEveryLoopWritten) {
+	JamFixture fixture("session", 1, 2, 0);
+	auto file = fixture.Dir / "test.jamsession";
+
+	ASSERT_FALSE(WriteSession(fixture, file, 1));
+	ASSERT_FALSE(SessionFile::Open(file.wstring()).has_value());
+}
+
+TEST(SessionFile, RefusesNewerVersions) {
+	JamFixture fixture("session", 1, 1, 0);
+	auto file = fixture.Dir / "test.jamsession";
+
+	ASSERT_TRUE(WriteSession(fixture, file, 1));
+
+	{
+		std::fstream stream(file, std::ios::binary | std::ios::in | std::ios::out);
+		stream.seekp(4);
+		stream.put((char)(SessionFile::CurrentVersion + 1));
+	}
+
+	ASSERT_FALSE(SessionFile::Open(file.wstring()).has_value());
+}
+
+TEST(SessionFile, RefusesOtherFiles) {
+	JamFixture fixture("session", 1, 1, 0);
+	auto jamFile = fixture.WriteJam();
+
+	ASSERT_FALSE(SessionFile::Open(jamFile.wstring()).has_value());
+	ASSERT_FALSE(SessionFile::Open((fixture.Dir / "loop0_0.wav").wstring()).has_value());
+}
+
+TEST(SessionFile, ConvertsToAndFromJam) {
+	JamFixture fixture("session", 1, 2, 0);
+	auto jamFile = fixture.WriteJam();
+
+	auto file = fixture.Dir / "converted.jamsession";
+	ASSERT_TRUE(SessionFile::IsSessionFile(file.wstring()));
+	ASSERT_TRUE(SessionFile::FromJam(jamFile.wstring(), file.wstring()));
+
+	auto session = SessionFile::Open(file.wstring());
+	ASSERT_TRUE(session.has_value());
+	ASSERT_EQ(48000u, session.value()->SampleRate());
+
+	auto [samps, numSamps] = session.value()->LoopSamps(1u);
+	ASSERT_EQ(fixture.Samps[1].size(), numSamps);
+	ASSERT_FLOAT_EQ(fixture.Samps[1][77], samps[77]);
+
+	auto outDir = fixture.Dir / "out";
+	ASSERT_TRUE(SessionFile::ToJam(file.wstring(), (outDir / "back.jam").wstring()));
+
+	std::ifstream stream(outDir / "back.jam");
+	std::stringstream ss;
+	ss << stream.rdbuf();
+	auto jam = JamFile::FromStream(std::move(ss));
+
+	ASSERT_TRUE(jam.has_value());
+	ASSERT_EQ(2u, jam.value().Stations[0].LoopTakes[0].Loops.size());
+
+	auto& loop = jam.value().Stations[0].LoopTakes[0].Loops[1];
+	ASSERT_EQ(fixture.Samps[1].size(), loop.Length);
+
+	auto wav = WavReadWriter().Read((outDir / loop.Name).wstring(), 1000000u);
+	ASSERT_TRUE(wav.has_value());
+	ASSERT_EQ(fixture.Samps[1].size(), std::get<1>(wav.value()));
+	ASSERT_EQ(48000u, std::get<2>(wav.value()));
+	ASSERT_FLOAT_EQ(fixture.Samps[1][77], std::get<0>(wav.value())[77]);
+}
@@ -32,6 +32,42 @@ TEST(UserConfig, ParsesLoopSettings) {
 	ASSERT_EQ(13, loop.value().FadeSamps);
 }
 
+TEST(UserConfig, ParsesLoopStorage) {
+	auto str = "{\"fadeSamps\":13,\"storage\":\"float16\"}";
+	auto testStream = std::stringstream(str);
+	auto json = std::get<Json::JsonPart>(Json::FromStream(std::move(testStream)).value());
+	auto loop = UserConfig::LoopSettings::FromJson(json);
+
+	ASSERT_TRUE(loop.has_value());
+	ASSERT_EQ(audio::BufferBank::STORAGE_FLOAT16, loop.value().Storage);
+
+	str = "{\"storage\":\"lossy\"}";
+	testStream = std::stringstream(str);
+	json = std::get<Json::JsonPart>(Json::FromStream(std::move(testStream)).value());
+	loop = UserConfig::LoopSettings::FromJson(json);
+
+	ASSERT_TRUE(loop.has_value());
+	ASSERT_EQ(audio::BufferBank::STORAGE_FLOAT, loop.value().Storage);
+}
+
+TEST(UserConfig, ParsesLoopMemoryBudget) {
+	auto str = "{\"memoryBudgetMb\":512}";
+	auto testStream = std::stringstream(str);
+	auto json = std::get<Json::JsonPart>(Json::FromStream(std::move(testStream)).value());
+	auto loop = UserConfig::LoopSettings::FromJson(json);
+
+	ASSERT_TRUE(loop.has_value());
+	ASSERT_EQ(512u, loop.value().MemoryBudgetMb);
+
+	str = "{\"fadeSamps\":13}";
+	testStream = std::stringstream(str);
+	json = std::get<Json::JsonPart>(Json::FromStream(std::move(testStream)).value());
+	loop = UserConfig::LoopSettings::FromJson(json);
+
+	ASSERT_TRUE(loop.has_value());
+	ASSERT_EQ(0u, loop.value().MemoryBudgetMb);
+}
+
 TEST(UserConfig, ParsesTriggerSettings) {
 	auto str = "{\"preDelay\":42,\"debounceSamps\":59}";
 	auto testStream = std::stringstream(str);
@@ -43,6 +79,16 @@ TEST(UserConfig, ParsesTriggerSettings) {
 	ASSERT_EQ(59, trig.value().DebounceSamps);
 }
 
+TEST(UserConfig, ParsesJobSettings) {
+	auto str = "{\"numworkers\":3}";
+	auto testStream = std::stringstream(str);
+	auto json = std::get<Json::JsonPart>(Json::FromStream(std::move(testStream)).value());
+	auto jobs = UserConfig::JobSettings::FromJson(json);
+
+	ASSERT_TRUE(jobs.has_value());
+	ASSERT_EQ(3, jobs.value().NumWorkers);
+}
+
 TEST(UserConfig, ParsesFile) {
 	std::string audio = "{\"name\":\"HDMI\",\"bufsize\":255,\"latency\":414,\"numchannelsin\":0,\"numchannelsout\":10}";
 	std::string loop = "{\"fadeSamps\":54}";
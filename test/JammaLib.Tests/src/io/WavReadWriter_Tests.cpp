@@ -0,0 +1,176 @@
+
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <cstdint>
+#include "io/WavReadWriter.h"
+#include "io/WavStreamWriter.h"
+
+using io::WavReadWriter;
+using io::WavStreamWriter;
+using io::WavFormat;
+
+class RiffBuilder
+{
+public:
+	RiffBuilder()
+	{
+		Bytes.insert(Bytes.end(), { 'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E' });
+	}
+
+public:
+	void AddChunk(const char* id, const std::vector<char>& body)
+	{
+		Bytes.insert(Bytes.end(), id, id + 4);
+		AddUint((std::uint32_t)body.size(), 4);
+		Bytes.insert(Bytes.end(), body.begin(), body.end());
+
+		if (body.size() & 1)
+			Bytes.push_back(0);
+	}
+
+	void AddFormat(unsigned int formatTag, unsigned int numChans, unsigned int bitsPerSamp)
+	{
+		RiffBuilder fmt;
+		fmt.Bytes.clear();
+		fmt.AddUint(formatTag, 2);
+		fmt.AddUint(numChans, 2);
+		fmt.AddUint(48000, 4);
+		fmt.AddUint(48000 * numChans * bitsPerSamp / 8, 4);
+		fmt.AddUint(numChans * bitsPerSamp / 8, 2);
+		fmt.AddUint(bitsPerSamp, 2);
+
+		AddChunk("fmt ", fmt.Bytes);
+	}
+
+	void AddUint(std::uint32_t value, unsigned int numBytes)
+	{
+		for (auto i = 0u; i < numBytes; i++)
+			Bytes.push_back((char)((value >> (8 * i)) & 0xFF));
+	}
+
+public:
+	std::vector<char> Bytes;
+};
+
+TEST(WavReadWriter, ParsesPcm16) {
+	RiffBuilder riff;
+	riff.AddFormat(1, 2, 16);
+	riff.AddChunk("data", std::vector<char>(400));
+
+	auto format = WavReadWriter::ParseRiff(riff.Bytes.data(), riff.Bytes.size());
+
+	ASSERT_TRUE(format.has_value());
+	ASSERT_EQ(WavFormat::FORMAT_PCM16, format->Format);
+	ASSERT_EQ(2u, format->NumChans);
+	ASSERT_EQ(48000u, format->SampleRate);
+	ASSERT_EQ(100ul, format->NumFrames);
+	ASSERT_EQ(riff.Bytes.size() - 400, format->DataOffset);
+}
+
+TEST(WavReadWriter, SkipsUnknownChunks) {
+	RiffBuilder riff;
+	riff.AddChunk("JUNK", std::vector<char>(13));
+	riff.AddFormat(3, 1, 32);
+	riff.AddChunk("LIST", std::vector<char>(7));
+	riff.AddChunk("data", std::vector<char>(40));
+
+	auto format = WavReadWriter::ParseRiff(riff.Bytes.data(), riff.Bytes.size());
+
+	ASSERT_TRUE(format.has_value());
+	ASSERT_EQ(WavFormat::FORMAT_FLOAT32, format->Format);
+	ASSERT_EQ(10ul, format->NumFrames);
+}
+
+TEST(WavReadWriter, ClampsDataToFile) {
+	RiffBuilder riff;
+	riff.AddFormat(1, 1, 24);
+	riff.AddChunk("data", std::vector<char>(30));
+	riff.Bytes.resize(riff.Bytes.size() - 9);
+
+	auto format = WavReadWriter::ParseRiff(riff.Bytes.data(), riff.Bytes.size());
+
+	ASSERT_TRUE(format.has_value());
+	ASSERT_EQ(WavFormat::FORMAT_PCM24, format->Format);
+	ASSERT_EQ(7ul, format->NumFrames);
+}
+
+TEST(WavReadWriter, RejectsUnsupported) {
+	RiffBuilder noData;
+	noData.AddFormat(1, 1, 16);
+
+	RiffBuilder noFormat;
+	noFormat.AddChunk("data", std::vector<char>(40));
+
+	RiffBuilder muLaw;
+	muLaw.AddFormat(257, 1, 8);
+	muLaw.AddChunk("data", std::vector<char>(40));
+
+	ASSERT_FALSE(WavReadWriter::ParseRiff(noData.Bytes.data(), noData.Bytes.size()).has_value());
+	ASSERT_FALSE(WavReadWriter::ParseRiff(noFormat.Bytes.data(), noFormat.Bytes.size()).has_value());
+	ASSERT_FALSE(WavReadWriter::ParseRiff(muLaw.Bytes.data(), muLaw.Bytes.size()).has_value());
+	ASSERT_FALSE(WavReadWriter::ParseRiff("RIFX", 4).has_value());
+}
+
+TEST(WavReadWriter, ConvertsFirstChannel) {
+	RiffBuilder frames;
+	frames.Bytes.clear();
+	frames.AddUint(0x4000, 2);
+	frames.AddUint(0x7FFF, 2);
+	frames.AddUint(0xC000, 2);
+	frames.AddUint(0x0000, 2);
+
+	WavFormat pcm16 = {};
+	pcm16.Format = WavFormat::FORMAT_PCM16;
+	pcm16.NumChans = 2;
+
+	std::vector<float> dest(2);
+	WavReadWriter::Convert(pcm16, frames.Bytes.data(), dest.data(), 2);
+
+	ASSERT_EQ(0.5f, dest[0]);
+	ASSERT_EQ(-0.5f, dest[1]);
+
+	frames.Bytes.clear();
+	frames.AddUint(0xC00000, 3);
+	frames.AddUint(0x400000, 3);
+
+	WavFormat pcm24 = {};
+	pcm24.Format = WavFormat::FORMAT_PCM24;
+	pcm24.NumChans = 1;
+
+	WavReadWriter::Convert(pcm24, frames.Bytes.data(), dest.data(), 2);
+
+	ASSERT_EQ(-0.5f, dest[0]);
+	ASSERT_EQ(0.5f, dest[1]);
+}
+
+TEST(WavReadWriter, MapsFloatWav) {
+	auto fileName = std::filesystem::temp_directory_path() / "jamma_map_test.wav";
+	std::vector<float> samps(1000);
+
+	for (auto i = 0u; i < samps.size(); i++)
+		samps[i] = (float)i / 1000.0f;
+
+	WavStreamWriter writer;
+	ASSERT_TRUE(writer.Open(fileName.wstring(), 1, 44100));
+	ASSERT_TRUE(writer.Write(samps.data(), (unsigned int)samps.size()));
+	ASSERT_TRUE(writer.Close());
+
+	{
+		WavReadWriter readWriter;
+		auto wav = readWriter.Map(fileName.wstring());
+
+		ASSERT_TRUE(wav.has_value());
+		ASSERT_TRUE(wav->IsInPlace());
+		ASSERT_EQ(1000ul, wav->Format.NumFrames);
+		ASSERT_EQ(44100u, wav->Format.SampleRate);
+		ASSERT_EQ(0.5f, reinterpret_cast<const float*>(wav->Frames())[500]);
+
+		auto read = readWriter.Read(fileName.wstring(), 600);
+
+		ASSERT_TRUE(read.has_value());
+		ASSERT_EQ(600u, std::get<1>(read.value()));
+		ASSERT_EQ(samps[599], std::get<0>(read.value())[599]);
+	}
+
+	std::filesystem::remove(fileName);
+}
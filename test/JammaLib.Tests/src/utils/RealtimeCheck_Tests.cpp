@@ -0,0 +1,131 @@
+
+#include "gtest/gtest.h"
+#include "utils/RealtimeCheck.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+
+using utils::RealtimeCheck;
+using utils::RealtimeTag;
+using utils::RealtimeScope;
+using utils::RealtimeCallbackScope;
+using utils::CheckedMutex;
+using utils::CheckedSharedMutex;
+
+TEST(RealtimeCheck, IgnoresNonRealtimeThread) {
+	RealtimeCheck::Reset();
+	RealtimeCheck::Enable();
+
+	RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_ALLOC);
+
+	{
+		RealtimeTag tag("NotRealtime");
+		ASSERT_FALSE(RealtimeCheck::IsRealtimeThread());
+		RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_ALLOC);
+	}
+
+	RealtimeCheck::Disable();
+
+	ASSERT_EQ(0ull, RealtimeCheck::NumViolations());
+}
+
+TEST(RealtimeCheck, RecordsTagStack) {
+	RealtimeCheck::Reset();
+	RealtimeCheck::Enable();
+
+	{
+		RealtimeCallbackScope callback("OnAudio");
+		RealtimeTag tag("Record");
+		RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_ALLOC);
+	}
+
+	RealtimeCheck::Disable();
+	auto report = RealtimeCheck::GetReport();
+
+	ASSERT_EQ(1ull, report.NumViolations);
+	ASSERT_EQ(1u, report.Violations.size());
+	ASSERT_EQ(RealtimeCheck::VIOLATION_ALLOC, report.Violations[0].Type);
+	ASSERT_EQ(std::string("OnAudio > Record"), std::string(report.Violations[0].Stack));
+}
+
+TEST(RealtimeCheck, CountsPerCallback) {
+	RealtimeCheck::Reset();
+	RealtimeCheck::Enable();
+
+	{
+		RealtimeCallbackScope callback("OnAudio");
+		RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_ALLOC);
+		RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_FREE);
+	}
+
+	{
+		RealtimeCallbackScope callback("OnAudio");
+	}
+
+	{
+		RealtimeCallbackScope callback("OnAudio");
+		RealtimeCheck::OnViolation(RealtimeCheck::VIOLATION_STDIO);
+	}
+
+	RealtimeCheck::Disable();
+	auto report = RealtimeCheck::GetReport();
+
+	ASSERT_EQ(3ull, report.NumCallbacks);
+	ASSERT_EQ(2ull, report.NumViolatingCallbacks);
+	ASSERT_EQ(2u, report.MaxViolationsPerCallback);
+	ASSERT_EQ(3u, report.Violations.size());
+	ASSERT_EQ(0ull, report.Violations[1].Callback);
+	ASSERT_EQ(2u, report.Violations[1].IndexInCallback);
+	ASSERT_EQ(2ull, report.Violations[2].Callback);
+	ASSERT_EQ(1u, report.Violations[2].IndexInCallback);
+}
+
+TEST(RealtimeCheck, FlagsMutexInCallback) {
+	RealtimeCheck::Reset();
+	RealtimeCheck::Enable();
+
+	CheckedSharedMutex mutex;
+
+	{
+		std::scoped_lock lock(mutex);
+	}
+
+	{
+		RealtimeScope scope("Job");
+		std::shared_lock lock(mutex);
+	}
+
+	RealtimeCheck::Disable();
+	auto report = RealtimeCheck::GetReport();
+
+	ASSERT_EQ(1u, report.Violations.size());
+	ASSERT_EQ(RealtimeCheck::VIOLATION_LOCK, report.Violations[0].Type);
+}
+
+#if defined(JAMMA_REALTIME_CHECKS)
+TEST(RealtimeCheck, HooksAllocAndLockInCallback) {
+	RealtimeCheck::Reset();
+	RealtimeCheck::Enable();
+
+	CheckedMutex mutex;
+	auto samps = std::make_unique<float[]>(1);
+
+	{
+		JAMMA_REALTIME_CALLBACK("OnAudio");
+		samps.reset(new float[16]);
+		std::scoped_lock lock(mutex);
+	}
+
+	RealtimeCheck::Disable();
+	auto report = RealtimeCheck::GetReport();
+	auto numOfType = [&report](RealtimeCheck::ViolationType type) {
+		return std::count_if(report.Violations.begin(), report.Violations.end(), [type](const RealtimeCheck::Violation& v) { return type == v.Type; });
+	};
+
+	ASSERT_EQ(1ull, report.NumCallbacks);
+	ASSERT_EQ(1, numOfType(RealtimeCheck::VIOLATION_ALLOC));
+	ASSERT_EQ(1, numOfType(RealtimeCheck::VIOLATION_FREE));
+	ASSERT_EQ(1, numOfType(RealtimeCheck::VIOLATION_LOCK));
+}
+#endif
@@ -0,0 +1,95 @@
+
+#include "gtest/gtest.h"
+#include "utils/SpscQueue.h"
+#include <memory>
+#include <thread>
+
+using utils::SpscQueue;
+
+TEST(SpscQueue, PopsInOrder) {
+	SpscQueue<int> queue(4);
+
+	for (auto i = 0; i < 4; i++)
+		ASSERT_TRUE(queue.TryPush(i));
+
+	ASSERT_FALSE(queue.TryPush(4));
+
+	int item;
+	for (auto i = 0; i < 4; i++)
+	{
+		ASSERT_TRUE(queue.TryPop(item));
+		ASSERT_EQ(i, item);
+	}
+
+	ASSERT_FALSE(queue.TryPop(item));
+	ASSERT_TRUE(queue.IsEmpty());
+}
+
+TEST(SpscQueue, CountsRoomToPush) {
+	SpscQueue<int> queue(3);
+
+	ASSERT_TRUE(queue.CanPush(3));
+	ASSERT_FALSE(queue.CanPush(4));
+
+	queue.TryPush(1);
+	queue.TryPush(2);
+	ASSERT_TRUE(queue.CanPush(1));
+	ASSERT_FALSE(queue.CanPush(2));
+
+	// Still right once the indices wrap
+	int item;
+	queue.TryPop(item);
+	queue.TryPush(3);
+	queue.TryPush(4);
+	ASSERT_FALSE(queue.CanPush(1));
+
+	queue.TryPop(item);
+	queue.TryPop(item);
+	ASSERT_TRUE(queue.CanPush(2));
+	ASSERT_FALSE(queue.CanPush(3));
+}
+
+TEST(SpscQueue, ReleasesOnPop) {
+	SpscQueue<std::shared_ptr<int>> queue(2);
+	auto ptr = std::make_shared<int>(5);
+
+	queue.TryPush(ptr);
+	ASSERT_EQ(2, ptr.use_count());
+
+	std::shared_ptr<int> popped;
+	queue.TryPop(popped);
+	popped.reset();
+
+	ASSERT_EQ(1, ptr.use_count());
+}
+
+TEST(SpscQueue, TransfersAcrossThreads) {
+	auto numItems = 100000u;
+	SpscQueue<unsigned int> queue(16);
+
+	std::thread producer([&]() {
+		for (auto i = 0u; i < numItems; i++)
+		{
+			while (!queue.TryPush(i))
+				std::this_thread::yield();
+		}
+	});
+
+	auto expected = 0u;
+	auto isOrdered = true;
+	unsigned int item;
+	while (expected < numItems)
+	{
+		if (queue.TryPop(item))
+		{
+			if (item != expected)
+				isOrdered = false;
+
+			expected++;
+		}
+	}
+
+	producer.join();
+
+	ASSERT_TRUE(isOrdered);
+}
@@ -0,0 +1,58 @@
+
+#include "gtest/gtest.h"
+#include "utils/WorkerPool.h"
+#include <cmath>
+#include <cstring>
+
+using utils::WorkerPool;
+using utils::WorkerPoolParams;
+
+TEST(WorkerPool, RunsEveryJobOnce) {
+	auto numJobs = 37u;
+	auto numBatches = 2000u;
+	WorkerPool pool(WorkerPoolParams{ 3, 100, false });
+
+	std::vector<std::atomic<unsigned int>> counts(numJobs);
+	std::function<void(unsigned int)> job = [&](unsigned int index) { counts[index]++; };
+
+	for (auto batch = 0u; batch < numBatches; batch++)
+		pool.Run(numJobs, job);
+
+	for (auto i = 0u; i < numJobs; i++)
+		ASSERT_EQ(numBatches, counts[i].load());
+}
+
+TEST(WorkerPool, ParallelMatchesSerial) {
+	auto numJobs = 12u;
+	auto numSamps = 512u;
+
+	auto render = [&](WorkerPool& pool) {
+		std::vector<std::vector<float>> buses(numJobs, std::vector<float>(numSamps));
+		std::function<void(unsigned int)> job = [&](unsigned int index) {
+			for (auto samp = 0u; samp < numSamps; samp++)
+				buses[index][samp] = std::sin(0.01f * (float)(samp * (index + 1))) * 0.3f;
+		};
+
+		std::vector<float> mix(numSamps, 0.0f);
+		for (auto block = 0u; block < 50u; block++)
+		{
+			pool.Run(numJobs, job);
+
+			for (auto& bus : buses)
+			{
+				for (auto samp = 0u; samp < numSamps; samp++)
+					mix[samp] += bus[samp];
+			}
+		}
+
+		return mix;
+	};
+
+	WorkerPool serialPool(WorkerPoolParams{ 0, 0, false });
+	WorkerPool parallelPool(WorkerPoolParams{ 4, 0, false });
+
+	auto serial = render(serialPool);
+	auto parallel = render(parallelPool);
+
+	ASSERT_EQ(0, std::memcmp(serial.data(), parallel.data(), numSamps * sizeof(float)));
+}